@@ -0,0 +1,19 @@
+local size = 100
+local rounds = 3000
+
+local values = {}
+for i = 1, size do
+    values[i] = i
+end
+
+local sum = 0
+for _ = 1, rounds do
+    for i = 1, size do
+        if values[i] < size / 2 then
+            sum = sum + values[i] * 2
+        else
+            sum = sum - 1
+        end
+    end
+end
+print(sum)
@@ -0,0 +1,7 @@
+local n = 200000
+
+local x = 0
+for i = 1, n do
+    x = x + math.sin(i)
+end
+print(math.floor(x * 1000))
@@ -6,7 +6,13 @@
  * @version 0.1.0
  */
 
+#include <chrono>
+#include <istream>
+
+#include "../backend/chunk.hpp"
+#include "../backend/optimizer.hpp"
 #include "../core/types.hpp"
+#include "../frontend/ast.hpp"
 #include "../runtime/value.hpp"
 #include "../runtime/vm.hpp"
 
@@ -21,6 +27,12 @@ namespace rangelua::api {
         bool enable_profiling = false;
         Size initial_stack_size = 1024;
         Size max_stack_size = 65536;
+        backend::Optimizer::OptimizationLevel optimization_level =
+            backend::Optimizer::OptimizationLevel::Standard;  // Bytecode passes run by compile()
+        String cache_directory;  // Compilation cache consulted by compile(); empty disables it
+        bool single_pass = false;  // Generate code per top-level statement (ParserConfig)
+        bool lazy_functions = false;  // Compile function bodies on first use (ParserConfig)
+        Size compile_jobs = 1;  // Threads compiling and optimizing function bodies; 0: one per core
     };
 
     /**
@@ -38,16 +50,55 @@ namespace rangelua::api {
         State(State&&) noexcept = default;
         State& operator=(State&&) noexcept = default;
 
+        /**
+         * @brief Compile Lua code to bytecode without running it
+         *
+         * With StateConfig::cache_directory set, compiled chunks are looked up
+         * in and added to the on-disk compilation cache. Otherwise, with
+         * StateConfig::lazy_functions, function bodies are left as deferred
+         * prototypes and the chunk keeps a copy of the source to compile them from.
+         */
+        Result<backend::BytecodeFunction> compile(StringView code, String name = "<input>");
+
+        /**
+         * @brief Compile Lua code read incrementally from a stream, e.g. a pipe
+         *
+         * The source is never held in memory as a whole, so the compilation
+         * cache is not consulted. StateConfig::lazy_functions needs the text
+         * later and reads the whole stream first.
+         */
+        Result<backend::BytecodeFunction> compile(std::istream& input, String name = "<stdin>");
+
         /**
          * @brief Execute Lua code
          */
         Result<std::vector<runtime::Value>> execute(StringView code, String name = "<input>");
 
+        /**
+         * @brief Execute Lua code read incrementally from a stream
+         */
+        Result<std::vector<runtime::Value>> execute(std::istream& input, String name = "<stdin>");
+
+        /**
+         * @brief Execute an already compiled main chunk
+         */
+        Result<std::vector<runtime::Value>> execute(const backend::BytecodeFunction& function);
+
         /**
          * @brief Load and execute file
+         *
+         * Regular files are memory-mapped and lexed in place. Files starting
+         * with the precompiled chunk signature (written by `rangelua -c`) are
+         * run without being compiled again. Files that cannot be mapped, such
+         * as named pipes, are streamed through the lexer.
          */
         Result<std::vector<runtime::Value>> execute_file(const String& filename);
 
+        /**
+         * @brief Load an ahead-of-time compiled module produced by `rangelua --aot`
+         */
+        Status load_aot_module(const String& path);
+
         /**
          * @brief Get stack size
          */
@@ -93,6 +144,10 @@ namespace rangelua::api {
         [[nodiscard]] const runtime::Value& stack_at(Register reg) const override;
         [[nodiscard]] Size instruction_pointer() const noexcept override;
         void set_instruction_pointer(Size ip) noexcept override;
+        bool patch_current_instruction(Instruction instruction) noexcept override;
+        bool observe_quickening(bool matched) override;
+        [[nodiscard]] runtime::InvariantSlot& invariant_slot(Size index) override;
+        [[nodiscard]] std::shared_ptr<runtime::PrototypeState> prototype_state(Size index) override;
         void adjust_instruction_pointer(std::int32_t offset) noexcept override;
         [[nodiscard]] const backend::BytecodeFunction* current_function() const noexcept override;
         [[nodiscard]] Size call_depth() const noexcept override;
@@ -140,11 +195,44 @@ namespace rangelua::api {
          */
         [[nodiscard]] const StateConfig& config() const noexcept { return config_; }
 
+        /**
+         * @brief Render collected type feedback (requires enable_profiling)
+         */
+        [[nodiscard]] String dump_feedback() const;
+
+        /**
+         * @brief Render dynamic instruction counts (requires VMConfig::count_instructions)
+         */
+        [[nodiscard]] String dump_instruction_counts() const;
+
+        /**
+         * @brief Optimizer statistics accumulated over every compile() of this state
+         */
+        [[nodiscard]] const std::unordered_map<String, Size>& optimizer_statistics() const noexcept {
+            return optimizer_statistics_;
+        }
+
+        /**
+         * @brief Source bytes, parse and code generation time and AST arena usage summed over
+         *        every compile()
+         */
+        [[nodiscard]] const std::unordered_map<String, Size>& parse_statistics() const noexcept {
+            return parse_statistics_;
+        }
+
+        /**
+         * @brief Compilation cache hits, misses, stores and time saved (empty without a cache)
+         */
+        [[nodiscard]] const std::unordered_map<String, Size>& cache_statistics() const noexcept;
+
         runtime::VirtualMachine& get_vm() override { return *vm_; }
 
     private:
         std::unique_ptr<runtime::VirtualMachine> vm_;
         StateConfig config_;
+        std::unordered_map<String, Size> optimizer_statistics_;
+        std::unordered_map<String, Size> parse_statistics_;
+        std::unique_ptr<backend::ChunkCache> cache_;
 
         /**
          * @brief Initialize global environment
@@ -156,6 +244,27 @@ namespace rangelua::api {
          */
         void setup_standard_library();
 
+        /**
+         * @brief Parse, generate code for and optimize the tokens of one chunk
+         * @param source Text the lexer reads; when set, function bodies are deferred
+         */
+        Result<backend::BytecodeFunction>
+        compile_tokens(frontend::Lexer& lexer,
+                       std::chrono::steady_clock::time_point start,
+                       SharedPtr<const String> source = nullptr);
+
+        /**
+         * @brief Accumulate parse_statistics() for one parsed chunk
+         *
+         * Parse time includes lexing. In single-pass mode the time spent in the
+         * code generator between statements is subtracted from it and counted as
+         * code generation instead, and the arena size is its peak.
+         */
+        void record_parse_statistics(Size source_bytes,
+                                     const frontend::ASTArena* arena,
+                                     std::chrono::nanoseconds parse_time,
+                                     std::chrono::nanoseconds codegen_time);
+
         /**
          * @brief Cleanup state resources and break circular references
          */
@@ -208,6 +208,20 @@ namespace rangelua::backend {
             : name(std::move(name)), in_stack(in_stack), index(index) {}
     };
 
+    struct FunctionPrototype;
+
+    /**
+     * @brief Function body compiled on first use rather than with its chunk
+     *
+     * Implemented by the code generator (DeferredFunction). compile() does the
+     * work at most once and returns the same prototype on every later call.
+     */
+    class DeferredBody {
+    public:
+        virtual ~DeferredBody() = default;
+        [[nodiscard]] virtual Result<const FunctionPrototype*> compile() const = 0;
+    };
+
     /**
      * @brief Function prototype for nested functions
      */
@@ -224,6 +238,10 @@ namespace rangelua::backend {
         // Debug information
         std::vector<Size> line_info;
         String source_name;
+
+        // Set while the body is not compiled yet; the fields above then only hold the name,
+        // parameter count and vararg flag
+        SharedPtr<const DeferredBody> deferred;
     };
 
     /**
@@ -246,6 +264,12 @@ namespace rangelua::backend {
         String source_name;
     };
 
+    /**
+     * @brief Compile every deferred prototype of a chunk in place, e.g. before writing it out
+     * @param jobs Threads to compile on (0: one per hardware thread)
+     */
+    Status compile_deferred_prototypes(BytecodeFunction& function, Size jobs = 1);
+
     /**
      * @brief Bytecode emitter for generating instructions
      */
@@ -338,6 +362,11 @@ namespace rangelua::backend {
          */
         Size add_prototype(const FunctionPrototype& prototype);
 
+        /**
+         * @brief Prototypes added so far, e.g. to fill in bodies compiled in parallel
+         */
+        [[nodiscard]] std::vector<FunctionPrototype>& prototypes() noexcept;
+
         /**
          * @brief Set function parameters
          */
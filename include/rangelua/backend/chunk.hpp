@@ -0,0 +1,157 @@
+#pragma once
+
+/**
+ * @file chunk.hpp
+ * @brief Binary format for precompiled bytecode chunks
+ * @version 0.1.0
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+
+#include "../core/error.hpp"
+#include "../core/types.hpp"
+#include "bytecode.hpp"
+
+namespace rangelua::backend {
+
+    /**
+     * @brief Version of the binary chunk layout
+     *
+     * Bump whenever the layout below, the instruction encoding or the opcode
+     * numbering change; chunks written by another version are rejected.
+     */
+    inline constexpr std::uint32_t CHUNK_FORMAT_VERSION = 1;
+
+    /**
+     * @brief Signature at the start of every chunk ("\x1bRLC")
+     */
+    inline constexpr std::uint8_t CHUNK_SIGNATURE[4] = {0x1B, 'R', 'L', 'C'};
+
+    /**
+     * @brief Writes a compiled main chunk and its prototypes in the binary chunk format
+     *
+     * Layout (host byte order, checked on load):
+     * - header: signature, format version, opcode count, sizes of Instruction,
+     *   Int and Number, and an Int and a Number sample to detect byte order
+     *   and float format;
+     * - the main function: name, source name, parameter count, stack size,
+     *   vararg flag, instructions, constants, locals, legacy upvalue names,
+     *   upvalue descriptors, line info, then each nested prototype in the
+     *   same layout.
+     *
+     * Counts and string lengths are 32-bit. Instruction arrays are aligned to
+     * four bytes so the loader can read them straight out of the mapping.
+     */
+    class ChunkWriter {
+    public:
+        /**
+         * @brief Serialize a function to chunk bytes
+         *
+         * Deferred prototypes have no code yet; see compile_deferred_prototypes().
+         */
+        [[nodiscard]] static String write(const BytecodeFunction& function);
+
+        /**
+         * @brief Serialize a function to a file
+         * @return IO_ERROR if the file cannot be written
+         */
+        static Status write_file(const BytecodeFunction& function, const String& path);
+    };
+
+    /**
+     * @brief Loads chunks written by ChunkWriter
+     *
+     * Files are mapped read-only and decoded in a single pass: instruction
+     * arrays are copied in bulk from the mapping, and nothing is lexed or
+     * parsed. Every function is checked with BytecodeValidator before it is
+     * returned; a chunk that is truncated, has a different format version or
+     * layout, or fails validation is rejected with SYNTAX_ERROR.
+     */
+    class ChunkLoader {
+    public:
+        /**
+         * @brief Check whether data starts with the chunk signature
+         */
+        [[nodiscard]] static bool has_signature(std::span<const std::uint8_t> data) noexcept;
+
+        /**
+         * @brief Check whether a file starts with the chunk signature
+         */
+        [[nodiscard]] static bool is_chunk_file(const String& path);
+
+        /**
+         * @brief Decode a chunk held in memory
+         */
+        [[nodiscard]] static Result<BytecodeFunction> load(std::span<const std::uint8_t> data);
+
+        /**
+         * @brief Map a chunk file and decode it
+         * @return IO_ERROR if the file cannot be opened or mapped
+         */
+        [[nodiscard]] static Result<BytecodeFunction> load_file(const String& path);
+    };
+
+    /**
+     * @brief Content-addressed on-disk cache of compiled chunks
+     *
+     * Entries are keyed by a hash of the source bytes, the compiler version,
+     * the chunk format version and the optimization level, so any process
+     * compiling the same source with the same compiler can reuse them. Each
+     * entry is a chunk preceded by a short header that repeats the source
+     * size and a second source hash (checked on load) and records how long
+     * the original compilation took. Entries are written to a temporary file
+     * and renamed into place, so concurrent readers see either no entry or a
+     * complete one. An unreadable or stale entry counts as a miss and is
+     * replaced on the next store.
+     *
+     * Compiler changes that alter the generated code must bump
+     * CHUNK_FORMAT_VERSION or the version in config.hpp to invalidate
+     * existing entries.
+     */
+    class ChunkCache {
+    public:
+        /**
+         * @param directory cache directory, created on first store
+         * @param optimization_level optimizer level the cached code was built with
+         */
+        ChunkCache(String directory, std::uint32_t optimization_level);
+
+        /**
+         * @brief Load the compiled chunk for source, if cached
+         *
+         * The source name of every loaded function is set to name, so errors
+         * report the script that was run rather than the one that filled the
+         * cache.
+         */
+        [[nodiscard]] Optional<BytecodeFunction> lookup(StringView source, const String& name);
+
+        /**
+         * @brief Cache the compiled chunk for source
+         * @param compile_time time the compilation took, credited to later hits
+         */
+        void store(StringView source,
+                   const BytecodeFunction& function,
+                   std::chrono::nanoseconds compile_time);
+
+        /**
+         * @brief Path of the entry for source
+         */
+        [[nodiscard]] String entry_path(StringView source) const;
+
+        /**
+         * @brief Hits, misses, stores, failed stores and compile time saved by hits (microseconds)
+         */
+        [[nodiscard]] const std::unordered_map<String, Size>& statistics() const noexcept {
+            return statistics_;
+        }
+
+    private:
+        String directory_;
+        std::uint32_t optimization_level_;
+        std::unordered_map<String, Size> statistics_;
+    };
+
+}  // namespace rangelua::backend
@@ -6,6 +6,7 @@
  * @version 0.1.0
  */
 
+#include <mutex>
 #include <stack>
 #include <unordered_map>
 #include <vector>
@@ -14,7 +15,9 @@
 #include "../core/instruction.hpp"
 #include "../core/types.hpp"
 #include "../frontend/ast.hpp"
+#include "../frontend/parser.hpp"
 #include "bytecode.hpp"
+#include "optimizer.hpp"
 
 namespace rangelua::backend {
 
@@ -345,6 +348,9 @@ namespace rangelua::backend {
             Size start_pc;
             Size end_pc;
             bool is_captured;
+            bool is_const = false;
+            // Compile-time constants have a value and no register
+            Optional<frontend::LiteralExpression::Value> value;
         };
 
         struct Upvalue {
@@ -370,7 +376,28 @@ namespace rangelua::backend {
          * @param reg Register assigned to variable
          * @return Local variable index
          */
-        Size declare_local(String name, Register reg);
+        Size declare_local(StringView name, Register reg, bool is_const = false);
+
+        /**
+         * @brief Declare a <const> local whose value is known at compile time
+         * @param name Variable name
+         * @param value Constant value; uses of the variable are replaced by it
+         * @return Local variable index
+         */
+        Size declare_constant(StringView name, frontend::LiteralExpression::Value value);
+
+        /**
+         * @brief Make the constants visible in an enclosing function visible here
+         * @param enclosing Scope manager of the enclosing function
+         */
+        void import_constants(const ScopeManager& enclosing);
+
+        /**
+         * @brief Find the innermost visible local with the given name
+         * @param name Variable name
+         * @return Local variable, or nullptr if the name is not a local
+         */
+        [[nodiscard]] const LocalVariable* find_local(StringView name) const;
 
         /**
          * @brief Variable resolution result
@@ -386,7 +413,7 @@ namespace rangelua::backend {
          * @param name Variable name
          * @return Variable resolution result
          */
-        VariableResolution resolve_variable(const String& name);
+        VariableResolution resolve_variable(StringView name);
 
         /**
          * @brief Get current scope depth
@@ -400,6 +427,12 @@ namespace rangelua::backend {
          */
         const std::vector<LocalVariable>& current_locals() const noexcept;
 
+        /**
+         * @brief Get the number of locals that occupy a register
+         * @return Locals in scope minus compile-time constants
+         */
+        Size register_local_count() const noexcept;
+
     private:
         struct Scope {
             Size start_local;
@@ -409,7 +442,33 @@ namespace rangelua::backend {
         std::vector<Scope> scopes_;
         std::vector<LocalVariable> locals_;
         std::vector<Upvalue> upvalues_;
-        std::unordered_map<String, Size> local_names_;
+        // Transparent so names can be looked up straight from AST string views
+        struct NameHash {
+            using is_transparent = void;
+            Size operator()(StringView name) const noexcept {
+                return std::hash<StringView>{}(name);
+            }
+        };
+        std::unordered_map<String, Size, NameHash, std::equal_to<>> local_names_;
+    };
+
+    /**
+     * @brief How a nested function's generator is set up before its body is generated
+     */
+    struct FunctionSignature {
+        String name;                     // anonymous_function, local_function, declared_function
+        std::vector<String> parameters;  // Named parameters, in order
+        bool is_vararg = false;
+        bool emit_varargprep = false;  // Start the body with VARARGPREP
+        bool parameter_scope = false;  // Declare the parameters in a scope of their own
+    };
+
+    /**
+     * @brief Source that deferred function bodies are compiled from
+     */
+    struct DeferredSource {
+        SharedPtr<const String> text;  // The whole chunk; body ranges are offsets into it
+        Optimizer::OptimizationLevel optimization_level = Optimizer::OptimizationLevel::None;
     };
 
     /**
@@ -424,7 +483,7 @@ namespace rangelua::backend {
      * The parser should ONLY provide AST nodes and NEVER interfere with
      * low-level code generation concerns.
      */
-    class CodeGenerator : public frontend::ASTVisitor {
+    class CodeGenerator : public frontend::ASTVisitor, public frontend::StatementSink {
     public:
         explicit CodeGenerator(BytecodeEmitter& emitter);
 
@@ -443,6 +502,33 @@ namespace rangelua::backend {
          */
         Status generate(const frontend::Program& ast);
 
+        /**
+         * @brief Statement-at-a-time generation, driven by Parser::parse(StatementSink&)
+         *
+         * generate() runs the same three steps over a whole tree, so both paths
+         * emit identical bytecode. Nothing retains a statement after consume().
+         */
+        void begin_chunk(const SourceLocation& location) override;
+        Status consume(const frontend::Statement& statement) override;
+        Status end_chunk() override;
+
+        /**
+         * @brief Source for function bodies the parser deferred (ParserConfig::lazy_functions)
+         *
+         * Such a function gets a prototype whose body is compiled on first use,
+         * from this text and at this optimization level (see DeferredFunction).
+         */
+        void set_deferred_source(DeferredSource source);
+
+        /**
+         * @brief Compile the chunk's function bodies on up to jobs threads (0: one per core)
+         *
+         * Bodies are queued as their definitions are reached and compiled together at the
+         * end of the chunk, or of each statement passed to consume(). Each one fills the
+         * prototype slot reserved for it, so the bytecode is identical to serial compilation.
+         */
+        void set_compile_jobs(Size jobs);
+
         /**
          * @brief Generate code for expression
          * @param expr Expression AST
@@ -534,6 +620,18 @@ namespace rangelua::backend {
         };
         std::vector<LoopContext> loop_stack_;
 
+        DeferredSource deferred_source_;
+
+        // Function bodies queued for parallel compilation (set_compile_jobs)
+        struct PendingFunction {
+            Size prototype_index;
+            FunctionSignature signature;
+            ScopeManager constants;
+            const frontend::Statement* body;
+        };
+        Size compile_jobs_ = 1;
+        std::vector<PendingFunction> pending_functions_;
+
         // Label management for goto statements
         struct LabelInfo {
             String name;
@@ -555,9 +653,10 @@ namespace rangelua::backend {
         void free_expressions(ExpressionDesc& e1, ExpressionDesc& e2);
 
         // Constant and optimization methods
-        bool try_constant_folding(frontend::BinaryOpExpression::Operator op,
-                                  ExpressionDesc& e1,
-                                  const ExpressionDesc& e2);
+        Optional<frontend::LiteralExpression::Value>
+        fold_constant(const frontend::Expression& expr) const;
+        ExpressionDesc constant_expression(const frontend::LiteralExpression::Value& value);
+        void check_assignable(const frontend::Expression& target) const;
         bool expression_to_constant(ExpressionDesc& expr);
         Size add_constant(const frontend::LiteralExpression::Value& value);
 
@@ -598,13 +697,25 @@ namespace rangelua::backend {
         void add_continue_jump(Size jump_index);
 
         // Label management helpers
-        void define_label(const String& name);
-        void emit_goto(const String& label);
+        void define_label(StringView name);
+        void emit_goto(StringView label);
         void resolve_pending_gotos();
 
         // Register allocator synchronization
         void update_register_allocator_nvarstack();
 
+        // Nested functions: compiled now, queued for the worker pool, or deferred when the
+        // parser skipped the body
+        FunctionPrototype generate_function(const FunctionSignature& signature,
+                                            const frontend::Statement& body,
+                                            const Optional<frontend::SourceRange>& deferred_body);
+        static BytecodeFunction compile_function(const FunctionSignature& signature,
+                                                 const ScopeManager& enclosing,
+                                                 const frontend::Statement& body,
+                                                 const DeferredSource& source);
+        void compile_pending_functions();
+        friend class DeferredFunction;
+
         // Enhanced register allocation methods for function calls and multi-return handling
         void set_expression_returns(ExpressionDesc& expr, Size nresults);
         void set_expression_one_return(ExpressionDesc& expr);
@@ -621,6 +732,34 @@ namespace rangelua::backend {
                                     Size expected_returns);
     };
 
+    /**
+     * @brief Nested function whose body is compiled from source on first use
+     *
+     * Keeps what the enclosing generator would have handed the nested one: the
+     * signature, the compile-time constants in scope at the definition and the
+     * chunk's optimization level, so the prototype it builds is the one eager
+     * compilation emits. Functions nested in the body are deferred in turn.
+     */
+    class DeferredFunction final : public DeferredBody {
+    public:
+        DeferredFunction(FunctionSignature signature,
+                         ScopeManager constants,
+                         DeferredSource source,
+                         frontend::SourceRange range);
+
+        [[nodiscard]] Result<const FunctionPrototype*> compile() const override;
+
+    private:
+        [[nodiscard]] Result<FunctionPrototype> build() const;
+
+        FunctionSignature signature_;
+        ScopeManager constants_;
+        DeferredSource source_;
+        frontend::SourceRange range_;
+        mutable std::once_flag compiled_;
+        mutable Result<FunctionPrototype> prototype_ = ErrorCode::UNKNOWN_ERROR;
+    };
+
     /**
      * @brief Code generation context for nested functions
      */
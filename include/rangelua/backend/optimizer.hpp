@@ -6,6 +6,11 @@
  * @version 0.1.0
  */
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
 #include <functional>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,6 +18,7 @@
 #include <vector>
 
 #include "../core/concepts.hpp"
+#include "../core/config.hpp"
 #include "../core/error.hpp"
 #include "../core/instruction.hpp"
 #include "../core/types.hpp"
@@ -52,6 +58,30 @@ namespace rangelua::backend {
          */
         [[nodiscard]] virtual bool is_transformative() const noexcept = 0;
 
+        /**
+         * @brief Check if pass runs on every iteration of the optimizer's fixed-point loop
+         * @return false if pass runs only on the first iteration
+         */
+        [[nodiscard]] virtual bool is_iterative() const noexcept { return true; }
+
+        /**
+         * @brief Check if pass runs once, after the fixed-point loop has finished
+         * @return true if pass emits instructions the other passes do not analyze
+         */
+        [[nodiscard]] virtual bool is_final() const noexcept { return false; }
+
+        /**
+         * @brief Check if pass runs last, once every function of the chunk has been optimized
+         * @return true if pass emits instructions function inlining cannot copy into a caller
+         */
+        [[nodiscard]] virtual bool is_lowering() const noexcept { return false; }
+
+        /**
+         * @brief Take pass-specific counters gathered since the last call
+         * @return Counters, reported by the optimizer as `<pass>_<counter>`
+         */
+        [[nodiscard]] virtual std::unordered_map<String, Size> take_counters() { return {}; }
+
     protected:
         OptimizationPass() = default;
     };
@@ -102,6 +132,10 @@ namespace rangelua::backend {
 
     /**
      * @brief Dead code elimination pass
+     *
+     * Removes instructions no path from the entry can reach. Dead stores are
+     * left alone: proving a register dead needs liveness that accounts for
+     * open upvalues and the implicit register ranges of calls.
      */
     class DeadCodeEliminationPass : public OptimizationPass {
     public:
@@ -110,10 +144,7 @@ namespace rangelua::backend {
         [[nodiscard]] bool is_transformative() const noexcept override { return true; }
 
     private:
-        std::unordered_set<Size> find_reachable_instructions(const BytecodeFunction& function);
-        std::unordered_set<Register> find_live_registers(const BytecodeFunction& function);
-        [[nodiscard]] bool is_side_effect_free(OpCode op) const noexcept;
-        [[nodiscard]] bool is_control_flow_instruction(OpCode op) const noexcept;
+        std::vector<bool> find_reachable_instructions(const BytecodeFunction& function);
     };
 
     /**
@@ -134,34 +165,45 @@ namespace rangelua::backend {
 
         std::vector<Pattern> patterns_;
         void initialize_patterns();
-        bool
-        apply_pattern(std::vector<Instruction>& instructions, Size start, const Pattern& pattern);
+        bool apply_pattern(std::vector<Instruction>& instructions,
+                           Size start,
+                           const Pattern& pattern,
+                           const std::vector<bool>& leaders,
+                           std::vector<bool>& removed);
     };
 
     /**
-     * @brief Register allocation optimization pass
+     * @brief Register allocation over live ranges
+     *
+     * The code generator hands out registers in stack order and frees them in
+     * scope order, so temporaries of different statements rarely share a
+     * register and frames grow with the length of a block. This pass splits
+     * each register into webs (its SSA values joined through phis), builds
+     * their interference graph from liveness and colours it greedily in
+     * program order:
+     *
+     * - registers an instruction addresses as a block (CALL, RETURN, SETLIST,
+     *   CONCAT, LOADNIL, SELF and both for loops) are placed as a unit;
+     * - the target of a MOVE prefers its source's register, and MOVEs whose
+     *   registers end up equal are deleted;
+     * - parameters keep their numbers.
+     *
+     * stack_size becomes the number of registers the code names. Functions
+     * with open register ranges (multiple results), varargs, captured
+     * registers or to-be-closed variables are left alone.
+     *
+     * Counters: `registers_saved` (frame registers removed) and `moves_removed`.
      */
     class RegisterOptimizationPass : public OptimizationPass {
     public:
         Status optimize(BytecodeFunction& function) override;
         [[nodiscard]] StringView name() const noexcept override { return "register-optimization"; }
         [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+        [[nodiscard]] bool is_final() const noexcept override { return true; }
+        [[nodiscard]] std::unordered_map<String, Size> take_counters() override;
 
     private:
-        struct RegisterInfo {
-            Size first_use = SIZE_MAX;
-            Size last_use = 0;
-            std::vector<Size> uses;
-            bool is_parameter = false;
-            bool is_local = false;
-        };
-
-        std::unordered_map<Register, RegisterInfo>
-        analyze_register_usage(const BytecodeFunction& function);
-        std::unordered_map<Register, Register>
-        compute_register_mapping(const std::unordered_map<Register, RegisterInfo>& usage);
-        void remap_registers(BytecodeFunction& function,
-                             const std::unordered_map<Register, Register>& mapping);
+        std::unordered_map<String, Size> counters_;
     };
 
     /**
@@ -195,6 +237,158 @@ namespace rangelua::backend {
         void convert_to_tail_call(BytecodeFunction& function, Size call_index);
     };
 
+    /**
+     * @brief Runs the SSA pass pipeline (ssa.hpp) over the function
+     *
+     * Functions the SSA builder cannot represent are left unchanged.
+     */
+    class SsaOptimizationPass : public OptimizationPass {
+    public:
+        Status optimize(BytecodeFunction& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "ssa-optimization"; }
+        [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+    };
+
+    /**
+     * @brief Scalar replacement of tables that do not escape
+     *
+     * A table built by OP_NEWTABLE escapes unless its value, followed through
+     * MOVE copies in SSA form, is only used as the table of field reads and
+     * writes with constant string keys. Such a table is never stored, passed
+     * to a call, returned, captured or merged with another value at a phi, so
+     * no metatable can be set on it. Each of its fields then lives in a
+     * register of its own: the constructor becomes an OP_LOADNIL of those
+     * registers and every field access a MOVE, removing the allocation and the
+     * hash lookups.
+     *
+     * Counters: `replaced` (tables), `fields` and `escaped` (tables kept).
+     */
+    class ScalarReplacementPass : public OptimizationPass {
+    public:
+        Status optimize(BytecodeFunction& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "scalar-replacement"; }
+        [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+        [[nodiscard]] bool is_iterative() const noexcept override { return false; }
+        [[nodiscard]] std::unordered_map<String, Size> take_counters() override;
+
+    private:
+        std::unordered_map<String, Size> counters_;
+    };
+
+    /**
+     * @brief Loop-invariant code motion
+     *
+     * Finds natural loops from the dominator tree (a back edge enters a block
+     * that dominates its source) and caches runs of invariant table loads and
+     * arithmetic, such as the `math.sin` lookup in a loop body, in slots of the
+     * call frame. The run stays in place behind an OP_HOISTGET that skips it
+     * while the cached value is current: any table write, metatable change,
+     * upvalue write or metamethod call since the value was computed bumps the
+     * runtime's mutation epoch and forces the run to execute again. An
+     * OP_HOISTCLEAR in the loop preheader drops the loop's slots on every entry,
+     * since registers defined before the loop may have changed.
+     *
+     * Leaving the loads in place, instead of moving them ahead of the loop,
+     * keeps the first iteration's behaviour, including errors, and is safe
+     * when the loop calls functions that reassign globals.
+     */
+    class LoopInvariantCodeMotionPass : public OptimizationPass {
+    public:
+        Status optimize(BytecodeFunction& function) override;
+        [[nodiscard]] StringView name() const noexcept override {
+            return "loop-invariant-code-motion";
+        }
+        [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+    };
+
+    /**
+     * @brief Inlines calls to small local functions
+     *
+     * A call whose callee register can only hold the closure of one prototype
+     * (a CLOSURE reached through MOVE copies, none of them reassigned) is
+     * replaced by the prototype's body. The body's registers move above the
+     * call's function slot, its constants and upvalues are renumbered into the
+     * caller's, and each return becomes moves into the call's result
+     * registers. Bodies must be small, take fixed arguments and results,
+     * create no closures and write no upvalues; inlined instructions keep the
+     * callee's line numbers. Calls within inlined code, such as a function
+     * passed to an inlined helper, are inlined in turn up to a depth limit.
+     *
+     * Counters: `inlined` (call sites), `inlined_instructions`,
+     * `callee_rejected`, `site_rejected`, `depth_limited` and `budget_limited`.
+     */
+    class FunctionInliningPass : public OptimizationPass {
+    public:
+        Status optimize(BytecodeFunction& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "function-inlining"; }
+        [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+        [[nodiscard]] bool is_iterative() const noexcept override { return false; }
+        [[nodiscard]] std::unordered_map<String, Size> take_counters() override;
+
+    private:
+        std::unordered_map<String, Size> counters_;
+    };
+
+    /**
+     * @brief Static numeric type inference
+     *
+     * Proves, over the SSA form, which values are always numbers: numeric
+     * constants, numeric for loop variables, arithmetic on numbers, and copies
+     * and phis of those. Loops are solved optimistically, so a variable that
+     * only ever receives numbers stays a number around its back edge. OP_ADD,
+     * OP_SUB, OP_MUL, OP_DIV, OP_EQ, OP_LT and OP_LE whose operands are both
+     * proven numbers become their typed forms (OP_ADDF and so on), which skip
+     * the type checks, coercions and metamethod lookups of the generic ones;
+     * everything else keeps the generic form and its runtime quickening.
+     *
+     * Runs after the other passes, which do not analyze typed opcodes.
+     *
+     * Counters: `typed` (instructions specialized) and `untyped` (left generic).
+     */
+    class NumericTypeInferencePass : public OptimizationPass {
+    public:
+        Status optimize(BytecodeFunction& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "numeric-type-inference"; }
+        [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+        [[nodiscard]] bool is_final() const noexcept override { return true; }
+        [[nodiscard]] std::unordered_map<String, Size> take_counters() override;
+
+    private:
+        std::unordered_map<String, Size> counters_;
+    };
+
+    /**
+     * @brief Superinstruction fusion
+     *
+     * Replaces instruction sequences the code generator emits back to back
+     * with one superinstruction, so the interpreter dispatches once instead of
+     * several times. The sequences were picked from opcode pair counts over
+     * the test and benchmark suites (`--count-instructions`):
+     *
+     * - `LOADFALSE R; EQ/LT/LE a b 0; LOADTRUE R; TEST R 0; JMP` (a condition
+     *   that only decides a branch) becomes OP_EQJMP, OP_LTJMP or OP_LEJMP
+     *   when R is dead on both edges and the branch is forward and short;
+     * - `MOVE R[A+1] R[B]; CALL A 2 C` (a call with one copied argument)
+     *   becomes OP_MOVECALL.
+     *
+     * No instruction inside a fused sequence may be the target of a jump or
+     * skip from outside it. Runs as a lowering pass, after function inlining
+     * has copied every callee body it wants.
+     *
+     * Counters: `compare_jumps` and `move_calls` (sequences fused).
+     */
+    class SuperinstructionFusionPass : public OptimizationPass {
+    public:
+        Status optimize(BytecodeFunction& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "superinstruction-fusion"; }
+        [[nodiscard]] bool is_transformative() const noexcept override { return true; }
+        [[nodiscard]] bool is_lowering() const noexcept override { return true; }
+        [[nodiscard]] std::unordered_map<String, Size> take_counters() override;
+
+    private:
+        std::unordered_map<String, Size> counters_;
+    };
+
     /**
      * @brief Main optimizer class that manages optimization passes
      */
@@ -224,6 +418,22 @@ namespace rangelua::backend {
          */
         Status optimize(BytecodeFunction& function);
 
+        /**
+         * @brief Optimize a compiled chunk: the main function and all nested prototypes
+         * @param chunk Chunk returned by the code generator
+         * @return Success or error
+         */
+        Status optimize_chunk(BytecodeFunction& chunk);
+
+        /**
+         * @brief Optimize a chunk's prototypes on up to jobs threads (0: one per hardware thread)
+         *
+         * Each worker runs its own optimizer with this one's level and pass settings, and the
+         * statistics are merged afterwards; the bytecode is the same as with one job. A pipeline
+         * changed with add_pass() or remove_pass() always runs on the calling thread.
+         */
+        void set_jobs(Size jobs);
+
         /**
          * @brief Add custom optimization pass
          * @param pass Optimization pass
@@ -263,7 +473,12 @@ namespace rangelua::backend {
         [[nodiscard]] bool is_pass_enabled(StringView name) const noexcept;
 
         /**
-         * @brief Get optimization statistics
+         * @brief Get optimization statistics, accumulated until reset_statistics()
+         *
+         * Per pass: `<pass>_runs`, `<pass>_changes` (runs that modified code),
+         * `<pass>_removed` (instructions deleted), `<pass>_time_us` and the pass's
+         * own counters (OptimizationPass::take_counters); overall:
+         * `functions`, `instructions_before` and `instructions_after`.
          * @return Statistics map
          */
         [[nodiscard]] const std::unordered_map<String, Size>& statistics() const noexcept;
@@ -278,9 +493,32 @@ namespace rangelua::backend {
         std::vector<UniquePtr<OptimizationPass>> passes_;
         std::unordered_map<String, bool> pass_enabled_;
         std::unordered_map<String, Size> statistics_;
+        Size jobs_ = 1;
+        bool custom_passes_ = false;
 
         void initialize_default_passes();
         void configure_passes_for_level(OptimizationLevel level);
+
+        /**
+         * @brief Run every enabled pass except the lowering passes
+         */
+        Status optimize_function(BytecodeFunction& function);
+
+        /**
+         * @brief Run the enabled lowering passes
+         */
+        Status lower_function(BytecodeFunction& function);
+
+        /**
+         * @brief Optimize, or with lowering lower, every prototype compiled with the chunk
+         */
+        Status process_prototypes(std::vector<FunctionPrototype>& prototypes, bool lowering);
+
+        /**
+         * @brief Run one pass and record its statistics
+         * @return Whether the pass changed the function, or the pass's error
+         */
+        Result<bool> run_pass(OptimizationPass& pass, BytecodeFunction& function);
     };
 
     /**
@@ -289,21 +527,256 @@ namespace rangelua::backend {
     namespace optimization_analysis {
 
         /**
-         * @brief Control flow graph node
+         * @brief Check if an instruction conditionally skips the one after it
+         */
+        [[nodiscard]] bool skips_next(OpCode op) noexcept;
+
+        /**
+         * @brief Check if control never falls through to the next instruction
+         */
+        [[nodiscard]] bool ends_block(OpCode op) noexcept;
+
+        /**
+         * @brief Branch target of the instruction at pc, if it has one
+         *
+         * Covers jumps, numeric and generic for-loop branches, and the TFORLOOP
+         * that a TFORCALL transfers to when the iterator is exhausted.
+         */
+        [[nodiscard]] Optional<Size> branch_target(const std::vector<Instruction>& code, Size pc);
+
+        /**
+         * @brief Mark instructions that start a basic block
+         *
+         * An instruction that is not a leader can only be entered by falling
+         * through from the one before it, and always runs when that one does
+         * (instructions a skip can jump over start their own block). The result
+         * has one extra entry for the end of the code.
+         */
+        [[nodiscard]] std::vector<bool> find_block_leaders(const std::vector<Instruction>& code);
+
+        /**
+         * @brief Delete marked instructions, retargeting branches and line info
+         *
+         * Branches to a deleted instruction land on the next surviving one. The
+         * caller must not delete an instruction that a skip instruction may jump
+         * over, since the skip would then cover a different instruction.
+         * @return Number of instructions deleted
+         */
+        Size remove_instructions(BytecodeFunction& function, const std::vector<bool>& removed);
+
+        /**
+         * @brief Instructions to insert ahead of the instruction at pc
+         */
+        struct Insertion {
+            Size pc = 0;
+            std::vector<Instruction> code;
+        };
+
+        /**
+         * @brief Insert instructions, retargeting branches and line info
+         *
+         * Insertions must be sorted by pc, one per pc. Falling through into pc
+         * runs all of its inserted code; a branch from source to pc skips the
+         * first landing(source, pc) inserted instructions. The inserted code is
+         * copied unchanged, so branches in it must be relative to where it ends up.
+         * @return Number of instructions inserted
+         */
+        Size insert_instructions(BytecodeFunction& function,
+                                 const std::vector<Insertion>& insertions,
+                                 const std::function<Size(Size source, Size pc)>& landing);
+
+        /**
+         * @brief Consecutive registers first .. first+count-1
+         */
+        struct RegisterRange {
+            static constexpr Size TO_TOP = SIZE_MAX;  // Runs to the dynamic stack top
+
+            Register first = 0;
+            Size count = 0;
+
+            /**
+             * @brief One past the last register, with open ranges ending at frame_size
+             */
+            [[nodiscard]] Size end(Size frame_size) const noexcept {
+                if (first >= frame_size) {
+                    return first;
+                }
+                return count == TO_TOP ? frame_size : std::min<Size>(first + count, frame_size);
+            }
+        };
+
+        /**
+         * @brief Registers an instruction reads and writes
+         *
+         * Writes that may not happen (loop counters, TESTSET) are also listed as
+         * reads, so the previous value stays live. Registers captured by closures
+         * are not covered: callees reach them through upvalues.
+         */
+        struct RegisterEffects {
+            std::array<RegisterRange, 3> reads{};
+            std::array<RegisterRange, 2> writes{};
+            Size read_count = 0;
+            Size write_count = 0;
+
+            void read(Register first, Size count = 1) noexcept { reads[read_count++] = {first, count}; }
+            void write(Register first, Size count = 1) noexcept { writes[write_count++] = {first, count}; }
+        };
+
+        /**
+         * @brief Register effects of an instruction, or nullopt if unknown
+         */
+        [[nodiscard]] Optional<RegisterEffects> register_effects(Instruction instr) noexcept;
+
+        /**
+         * @brief Number of registers the function's instructions can name
+         */
+        [[nodiscard]] Size frame_register_count(const BytecodeFunction& function);
+
+        /**
+         * @brief Registers captured as open upvalues by closures the function creates
+         *
+         * Callees can read and write these at any call, so passes must not reason
+         * about their contents. Returns nullopt when a closure's prototype is not
+         * available, in which case every register may be captured.
+         */
+        [[nodiscard]] Optional<std::unordered_set<Register>>
+        captured_registers(const BytecodeFunction& function);
+
+        /**
+         * @brief Instruction loading a constant into a register, adding it to the constant table if needed
+         * @return nullopt if the value cannot be encoded (non-finite or -0 numbers, full table)
+         */
+        [[nodiscard]] Optional<Instruction>
+        load_constant(std::vector<ConstantValue>& constants, Register target, const ConstantValue& value);
+
+        /**
+         * @brief Dense bit set over a fixed (array) or runtime (vector) number of words
+         *
+         * Set operations work a word at a time, so the data flow analyses below
+         * cost a few instructions per 64 registers or definitions.
+         */
+        template <typename Words>
+        class BitSet {
+        public:
+            static constexpr Size WORD_BITS = 64;
+
+            BitSet() = default;
+            explicit BitSet(Size bits)
+                requires std::same_as<Words, std::vector<std::uint64_t>>
+                : words_((bits + WORD_BITS - 1) / WORD_BITS, 0) {}
+
+            [[nodiscard]] Size capacity() const noexcept { return words_.size() * WORD_BITS; }
+
+            void insert(Size bit) noexcept { words_[bit / WORD_BITS] |= mask(bit); }
+            void erase(Size bit) noexcept { words_[bit / WORD_BITS] &= ~mask(bit); }
+            [[nodiscard]] bool contains(Size bit) const noexcept {
+                return (words_[bit / WORD_BITS] & mask(bit)) != 0;
+            }
+
+            /**
+             * @brief Insert bits first .. end-1
+             */
+            void insert_range(Size first, Size end) noexcept {
+                for (Size bit = first; bit < end; ++bit) {
+                    insert(bit);
+                }
+            }
+
+            /**
+             * @brief Union with other
+             * @return true if any bit was added
+             */
+            bool unite(const BitSet& other) noexcept {
+                std::uint64_t added = 0;
+                for (Size i = 0; i < words_.size(); ++i) {
+                    added |= other.words_[i] & ~words_[i];
+                    words_[i] |= other.words_[i];
+                }
+                return added != 0;
+            }
+
+            void subtract(const BitSet& other) noexcept {
+                for (Size i = 0; i < words_.size(); ++i) {
+                    words_[i] &= ~other.words_[i];
+                }
+            }
+
+            void intersect(const BitSet& other) noexcept {
+                for (Size i = 0; i < words_.size(); ++i) {
+                    words_[i] &= other.words_[i];
+                }
+            }
+
+            void fill() noexcept { std::fill(words_.begin(), words_.end(), ~std::uint64_t{0}); }
+            void clear() noexcept { std::fill(words_.begin(), words_.end(), std::uint64_t{0}); }
+
+            [[nodiscard]] bool empty() const noexcept {
+                return std::all_of(
+                    words_.begin(), words_.end(), [](std::uint64_t word) { return word == 0; });
+            }
+
+            [[nodiscard]] Size count() const noexcept {
+                Size total = 0;
+                for (std::uint64_t word : words_) {
+                    total += static_cast<Size>(std::popcount(word));
+                }
+                return total;
+            }
+
+            /**
+             * @brief Call visit(bit) for every set bit in increasing order
+             */
+            template <typename Visitor>
+            void for_each(Visitor&& visit) const {
+                for (Size i = 0; i < words_.size(); ++i) {
+                    for (std::uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                        visit(i * WORD_BITS + static_cast<Size>(std::countr_zero(word)));
+                    }
+                }
+            }
+
+            bool operator==(const BitSet&) const = default;
+
+        private:
+            Words words_{};
+
+            static constexpr std::uint64_t mask(Size bit) noexcept {
+                return std::uint64_t{1} << (bit % WORD_BITS);
+            }
+        };
+
+        /**
+         * @brief One bit per addressable register (256 bits)
+         */
+        using RegisterSet =
+            BitSet<std::array<std::uint64_t, (static_cast<Size>(config::MAX_REGISTERS) + 1) / 64>>;
+
+        /**
+         * @brief Bit set sized at runtime (definition sites, blocks)
+         */
+        using BitVector = BitSet<std::vector<std::uint64_t>>;
+
+        /**
+         * @brief Control flow graph node (basic block)
          */
         struct CFGNode {
             Size start_instruction;
-            Size end_instruction;
+            Size end_instruction;  // Inclusive
             std::vector<Size> predecessors;
             std::vector<Size> successors;
-            std::unordered_set<Register> live_in;
-            std::unordered_set<Register> live_out;
-            std::unordered_set<Register> def;
-            std::unordered_set<Register> use;
+            RegisterSet live_in;
+            RegisterSet live_out;
+            RegisterSet def;  // Registers always written in the block
+            RegisterSet use;  // Registers read before any such write (plus captured registers)
         };
 
         /**
          * @brief Control flow graph
+         *
+         * Blocks follow find_block_leaders, so an instruction a skip can jump
+         * over is a block of its own and every instruction in a block runs
+         * whenever the block is entered. Only blocks reachable from the entry
+         * appear in the reverse postorder; the analyses ignore the rest.
          */
         class ControlFlowGraph {
         public:
@@ -312,9 +785,37 @@ namespace rangelua::backend {
             [[nodiscard]] const std::vector<CFGNode>& nodes() const noexcept { return nodes_; }
             [[nodiscard]] Size node_count() const noexcept { return nodes_.size(); }
 
+            /**
+             * @brief Block containing an instruction
+             */
+            [[nodiscard]] Size block_of(Size pc) const noexcept { return block_of_[pc]; }
+
+            /**
+             * @brief Reachable blocks in reverse postorder (entry first)
+             */
+            [[nodiscard]] const std::vector<Size>& reverse_postorder() const noexcept {
+                return reverse_postorder_;
+            }
+            [[nodiscard]] bool is_reachable(Size block) const noexcept {
+                return rpo_index_[block] != UNREACHABLE;
+            }
+
+            /**
+             * @brief Registers the function can address (see frame_register_count)
+             */
+            [[nodiscard]] Size frame_size() const noexcept { return frame_size_; }
+
+            /**
+             * @brief Registers captured by closures, treated as read by every block
+             */
+            [[nodiscard]] const RegisterSet& captured() const noexcept { return captured_; }
+
             void compute_liveness();
             void compute_dominators();
 
+            /**
+             * @brief Immediate dominator of each block (SIZE_MAX when unreachable)
+             */
             [[nodiscard]] const std::vector<Size>& dominators() const noexcept {
                 return dominators_;
             }
@@ -322,27 +823,154 @@ namespace rangelua::backend {
                 return dominator_tree_;
             }
 
+            /**
+             * @brief Whether block a dominates block b (requires compute_dominators)
+             */
+            [[nodiscard]] bool dominates(Size a, Size b) const noexcept;
+
         private:
+            static constexpr Size UNREACHABLE = SIZE_MAX;
+
             std::vector<CFGNode> nodes_;
+            std::vector<Size> block_of_;
+            std::vector<Size> reverse_postorder_;
+            std::vector<Size> rpo_index_;
             std::vector<Size> dominators_;
             std::vector<std::vector<Size>> dominator_tree_;
+            std::vector<Size> tree_entry_;  // Dominator tree DFS numbering for dominates()
+            std::vector<Size> tree_exit_;
+            RegisterSet captured_;
+            Size frame_size_ = 0;
 
             void build_cfg(const BytecodeFunction& function);
             void compute_def_use_sets(const BytecodeFunction& function);
             Size intersect_dominators(Size b1, Size b2);
         };
 
+        enum class DataFlowDirection : std::uint8_t { Forward, Backward };
+
+        /**
+         * @brief Worklist solver shared by the data flow analyses
+         *
+         * entry[b] and exit[b] hold the facts at the start and end of block b and
+         * must be initialized (boundary and starting values) by the caller. Each
+         * visit recomputes the block's input by joining its neighbours' outputs
+         * (predecessor exits going forward, successor entries going backward;
+         * blocks without such neighbours keep their initial input), applies
+         * transfer(block, input) and requeues the dependents if the output
+         * changed. The queue starts in reverse postorder (postorder for backward
+         * problems), so acyclic regions settle in a single sweep.
+         *
+         * @return Number of block visits
+         */
+        template <typename Set, typename Join, typename Transfer>
+        Size solve_data_flow(const ControlFlowGraph& cfg,
+                             DataFlowDirection direction,
+                             std::vector<Set>& entry,
+                             std::vector<Set>& exit,
+                             Join&& join,
+                             Transfer&& transfer) {
+            const bool forward = direction == DataFlowDirection::Forward;
+            const auto& order = cfg.reverse_postorder();
+
+            // Ring buffer queue; each block is queued at most once at a time
+            std::vector<Size> queue(order.size());
+            std::vector<bool> queued(cfg.node_count(), false);
+            Size head = 0;
+            Size pending = order.size();
+            for (Size i = 0; i < order.size(); ++i) {
+                queue[i] = forward ? order[i] : order[order.size() - 1 - i];
+                queued[queue[i]] = true;
+            }
+
+            Size visits = 0;
+            while (pending > 0) {
+                Size block = queue[head];
+                head = (head + 1) % queue.size();
+                --pending;
+                queued[block] = false;
+                ++visits;
+
+                const CFGNode& node = cfg.nodes()[block];
+                const auto& sources = forward ? node.predecessors : node.successors;
+                Set& input = forward ? entry[block] : exit[block];
+                bool first = true;
+                for (Size source : sources) {
+                    if (!cfg.is_reachable(source)) {
+                        continue;
+                    }
+                    const Set& value = forward ? exit[source] : entry[source];
+                    if (first) {
+                        input = value;
+                        first = false;
+                    } else {
+                        join(input, value);
+                    }
+                }
+
+                Set output = transfer(block, input);
+                Set& current = forward ? exit[block] : entry[block];
+                if (output == current) {
+                    continue;
+                }
+                current = std::move(output);
+                for (Size target : forward ? node.successors : node.predecessors) {
+                    if (cfg.is_reachable(target) && !queued[target]) {
+                        queued[target] = true;
+                        queue[(head + pending) % queue.size()] = target;
+                        ++pending;
+                    }
+                }
+            }
+            return visits;
+        }
+
+        /**
+         * @brief Register definitions reaching each block
+         */
+        struct ReachingDefinitions {
+            struct Definition {
+                Size pc;
+                Register reg;
+            };
+
+            std::vector<Definition> definitions;  // Indexed by definition id
+            std::vector<BitVector> block_in;      // Definition ids reaching each block's entry
+            std::vector<BitVector> block_out;
+        };
+
         /**
          * @brief Data flow analysis utilities
          */
         class DataFlowAnalysis {
         public:
-            static std::unordered_map<Register, std::vector<Size>>
-            compute_reaching_definitions(const BytecodeFunction& function);
-            static std::unordered_set<Register>
-            compute_live_variables(const BytecodeFunction& function, Size instruction);
-            static std::unordered_map<Register, std::vector<Size>>
-            compute_use_def_chains(const BytecodeFunction& function);
+            /**
+             * @brief Forward may-analysis of the writes reaching every block
+             *
+             * Writes that happen only on one outcome of a test (TESTSET, FORLOOP,
+             * TFORLOOP) do not kill earlier definitions.
+             */
+            static ReachingDefinitions
+            compute_reaching_definitions(const ControlFlowGraph& cfg, const BytecodeFunction& function);
+
+            /**
+             * @brief Registers live just before an instruction
+             *
+             * Requires cfg.compute_liveness(); walks back from the end of the
+             * instruction's block only.
+             */
+            static RegisterSet compute_live_variables(const ControlFlowGraph& cfg,
+                                                      const BytecodeFunction& function,
+                                                      Size instruction);
+
+            /**
+             * @brief Definitions of the read registers that may reach an instruction
+             * @return Definition ids (indices into reaching.definitions)
+             */
+            static std::vector<Size> compute_use_def_chain(const ControlFlowGraph& cfg,
+                                                           const ReachingDefinitions& reaching,
+                                                           const BytecodeFunction& function,
+                                                           Size instruction);
         };
 
     }  // namespace optimization_analysis
@@ -0,0 +1,249 @@
+#pragma once
+
+/**
+ * @file ssa.hpp
+ * @brief SSA intermediate representation of compiled functions and its pass manager
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "../core/error.hpp"
+#include "../core/types.hpp"
+#include "bytecode.hpp"
+#include "optimizer.hpp"
+
+namespace rangelua::backend::ssa {
+
+    using ValueId = std::uint32_t;
+    inline constexpr ValueId NO_VALUE = std::numeric_limits<ValueId>::max();
+
+    /**
+     * @brief How an SSA value comes into existence
+     */
+    enum class ValueKind : std::uint8_t {
+        Entry,  // Register contents on function entry (parameters, or nil)
+        Phi,    // Merge of the values reaching a block from its predecessors
+        Def     // Written by a node
+    };
+
+    /**
+     * @brief One SSA value: a single definition of one register
+     */
+    struct Value {
+        ValueKind kind = ValueKind::Entry;
+        Register reg = 0;
+        Size block = 0;
+        Size node = 0;                   // Defining node (Def only)
+        std::vector<ValueId> operands;   // Phi only: one per predecessor (entry block: entry value first)
+        ValueId replaced_by = NO_VALUE;  // Set when a trivial phi or redundant def is folded away
+    };
+
+    /**
+     * @brief One bytecode instruction in SSA form
+     *
+     * uses[i] is the value in use_registers[i] when the instruction runs;
+     * defs[i] is written to def_registers[i], whose value before the
+     * instruction was previous[i]. Registers captured by closures are left out.
+     */
+    struct Node {
+        Size pc = 0;
+        Instruction instruction = 0;
+        Size block = 0;
+        std::vector<Register> use_registers;
+        std::vector<ValueId> uses;
+        std::vector<Register> def_registers;
+        std::vector<ValueId> defs;
+        std::vector<ValueId> previous;
+        bool removable = true;  // Not skippable and writes only tracked registers
+        bool removed = false;
+        bool rewritten = false;
+    };
+
+    /**
+     * @brief Basic block: nodes first .. last-1
+     */
+    struct Block {
+        Size first = 0;
+        Size last = 0;
+        std::vector<Size> predecessors;
+        std::vector<Size> successors;
+        std::vector<ValueId> phis;
+        bool reachable = false;
+    };
+
+    /**
+     * @brief SSA form of one bytecode function
+     *
+     * Built from the code generator's register bytecode with Braun et al.'s
+     * on-the-fly construction, so only the phis that are actually needed are
+     * created. Passes edit the nodes in place (rewriting or removing
+     * instructions and redirecting values); lower() writes the result back.
+     * Construction and every pass are linear in the instruction count apart
+     * from phi placement, which is bounded by blocks times live registers.
+     */
+    class Function {
+    public:
+        /**
+         * @brief Build SSA form for a function
+         * @return nullopt if the function cannot be represented (unknown instructions
+         *         or closures whose captures are not visible)
+         */
+        static Optional<Function> build(const BytecodeFunction& function);
+
+        [[nodiscard]] const std::vector<Block>& blocks() const noexcept { return blocks_; }
+        [[nodiscard]] const std::vector<Node>& nodes() const noexcept { return nodes_; }
+        [[nodiscard]] std::vector<Node>& nodes() noexcept { return nodes_; }
+        [[nodiscard]] const Value& value(ValueId id) const { return values_[id]; }
+        [[nodiscard]] Size value_count() const noexcept { return values_.size(); }
+        [[nodiscard]] Size register_count() const noexcept { return register_count_; }
+
+        /**
+         * @brief Follow replacements to the value that stands for id
+         */
+        [[nodiscard]] ValueId resolve(ValueId id) const noexcept;
+
+        /**
+         * @brief Make every use of from refer to to instead
+         */
+        void replace_value(ValueId from, ValueId to);
+
+        /**
+         * @brief Replace a node's instruction, keeping the registers it writes
+         *
+         * The new instruction may read fewer registers than the old one, plus
+         * register source, whose value at the node is source_value.
+         */
+        void rewrite(Size node,
+                     Instruction instruction,
+                     Register source = 0,
+                     ValueId source_value = NO_VALUE);
+
+        /**
+         * @brief Delete a node; its definitions must be unused or replaced
+         */
+        void remove(Size node);
+
+        /**
+         * @brief Constant table of the function, for passes that materialize constants
+         */
+        [[nodiscard]] std::vector<ConstantValue>& constants() noexcept { return constants_; }
+
+        /**
+         * @brief Constant held by a value, as established by constant propagation
+         */
+        [[nodiscard]] const ConstantValue* constant(ValueId id) const;
+        void set_constant(ValueId id, ConstantValue value);
+
+        /**
+         * @brief Write rewritten and removed instructions back to the function
+         * @return Number of instructions removed
+         */
+        Size lower(BytecodeFunction& function) const;
+
+    private:
+        std::vector<Block> blocks_;
+        std::vector<Node> nodes_;
+        std::vector<Value> values_;
+        std::vector<ConstantValue> constants_;
+        std::vector<Optional<ConstantValue>> constant_values_;  // Per value
+        std::vector<bool> tracked_;  // Per register: not captured by a closure
+        Size register_count_ = 0;
+
+        class Builder;
+    };
+
+    /**
+     * @brief A transformation over SSA form
+     */
+    class Pass {
+    public:
+        virtual ~Pass() = default;
+
+        /**
+         * @brief Run the pass
+         * @return Number of changes made
+         */
+        virtual Size run(Function& function) = 0;
+
+        [[nodiscard]] virtual StringView name() const noexcept = 0;
+    };
+
+    /**
+     * @brief Propagates constants through copies, phis and foldable operations
+     *
+     * Values computed from constants are rematerialized as loads, which frees
+     * their operands for dead code elimination.
+     */
+    class ConstantPropagationPass : public Pass {
+    public:
+        Size run(Function& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "constant-propagation"; }
+    };
+
+    /**
+     * @brief Reads through MOVE copies whose source register still holds the value
+     */
+    class CopyPropagationPass : public Pass {
+    public:
+        Size run(Function& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "copy-propagation"; }
+    };
+
+    /**
+     * @brief Global value numbering of side-effect-free definitions
+     *
+     * A definition congruent to the value its register already holds is
+     * removed, and uses are redirected to the earlier value.
+     */
+    class GlobalValueNumberingPass : public Pass {
+    public:
+        Size run(Function& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "value-numbering"; }
+    };
+
+    /**
+     * @brief Removes side-effect-free definitions no use reaches
+     */
+    class DeadDefinitionEliminationPass : public Pass {
+    public:
+        Size run(Function& function) override;
+        [[nodiscard]] StringView name() const noexcept override { return "dead-definitions"; }
+    };
+
+    /**
+     * @brief Runs SSA passes in order until none of them changes anything
+     */
+    class PassManager {
+    public:
+        PassManager() = default;
+
+        void add_pass(UniquePtr<Pass> pass);
+
+        /**
+         * @brief Run all passes to a fixed point (bounded by max_rounds)
+         * @return Total number of changes
+         */
+        Size run(Function& function, Size max_rounds = 4);
+
+        /**
+         * @brief Changes per pass name, accumulated over every run
+         */
+        [[nodiscard]] const std::unordered_map<String, Size>& statistics() const noexcept {
+            return statistics_;
+        }
+
+        /**
+         * @brief Pass manager with constant propagation, copy propagation, GVN and dead code elimination
+         */
+        static PassManager create_default();
+
+    private:
+        std::vector<UniquePtr<Pass>> passes_;
+        std::unordered_map<String, Size> statistics_;
+    };
+
+}  // namespace rangelua::backend::ssa
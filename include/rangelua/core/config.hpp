@@ -57,10 +57,13 @@ namespace rangelua::config {
     constexpr Size MAX_PARSE_DEPTH = 1000;
     constexpr Size MAX_EXPRESSION_DEPTH = 200;
     constexpr Size TOKEN_BUFFER_SIZE = 1024;
+    constexpr Size AST_ARENA_BLOCK_SIZE = 64 * 1024;        // First arena block; later ones double
+    constexpr Size MAX_AST_ARENA_BLOCK_SIZE = 4 * 1024 * 1024;
 
     // Lexer configuration
     constexpr Size MAX_TOKEN_LENGTH = 1024;
     constexpr Size LEXER_BUFFER_SIZE = 4096;
+    constexpr Size LEXER_TOKEN_TEXT_SLOTS = 8;  // Streamed token text kept alive (lookahead)
 
     // Error configuration
     constexpr Size MAX_ERROR_MESSAGE_LENGTH = 1024;
@@ -99,7 +102,11 @@ namespace rangelua::config {
     constexpr Number NUMBER_EPSILON = std::numeric_limits<Number>::epsilon();
 
     // Feature flags
-    constexpr bool ENABLE_JIT = false;  // Future JIT compilation support
+#if defined(__x86_64__) && defined(__linux__)
+    constexpr bool ENABLE_JIT = true;  // Baseline JIT (x86-64 only)
+#else
+    constexpr bool ENABLE_JIT = false;
+#endif
     constexpr bool ENABLE_PROFILING = true;
     constexpr bool ENABLE_DEBUGGING = true;
     constexpr bool ENABLE_COROUTINES = true;
@@ -134,8 +134,46 @@ namespace rangelua {
 
         OP_EXTRAARG,  // extra (larger) argument for previous opcode
 
+        // Optimizer opcodes (emitted by loop-invariant code motion, never by the code generator).
+        // A cache slot holds a value together with the mutation epoch it was computed at.
+        OP_HOISTCLEAR,  // invalidate cache slots A, ... ,A+B-1
+        OP_HOISTGET,    // if slot B is current then { R[A] := slot B; pc+=C } else record epoch in slot B
+        OP_HOISTSET,    // slot B := R[A] at the epoch recorded by the HOISTGET that missed
+
+        // Statically typed opcodes (emitted by numeric type inference, never by the code
+        // generator). Both operands are proven to be numbers, so there is no type check.
+        OP_ADDF,  // R[A] := R[B] + R[C]
+        OP_SUBF,  // R[A] := R[B] - R[C]
+        OP_MULF,  // R[A] := R[B] * R[C]
+        OP_DIVF,  // R[A] := R[B] / R[C]
+        OP_EQF,   // if ((R[A] == R[B]) ~= k) then pc++
+        OP_LTF,   // if ((R[A] <  R[B]) ~= k) then pc++
+        OP_LEF,   // if ((R[A] <= R[B]) ~= k) then pc++
+
+        // Superinstructions (emitted by superinstruction fusion, never by the code generator).
+        // Each does the work of a sequence the code generator emits back to back.
+        OP_EQJMP,     // if not (R[A] == R[B]) then pc += C
+        OP_LTJMP,     // if not (R[A] <  R[B]) then pc += C
+        OP_LEJMP,     // if not (R[A] <= R[B]) then pc += C
+        OP_MOVECALL,  // R[A+1] := R[B]; R[A], ... ,R[A+C-2] := R[A](R[A+1])
+
         // Total number of opcodes
-        NUM_OPCODES
+        NUM_OPCODES,
+
+        // Quickened opcodes (private to the VM, never emitted by the code generator).
+        // The interpreter rewrites a generic instruction in place to one of these once it
+        // observes stable operand types; on a guard miss it rewrites it back.
+        OP_ADD_NUM,         // R[A] := R[B] + R[C]   (guard: numbers)
+        OP_SUB_NUM,         // R[A] := R[B] - R[C]   (guard: numbers)
+        OP_MUL_NUM,         // R[A] := R[B] * R[C]   (guard: numbers)
+        OP_DIV_NUM,         // R[A] := R[B] / R[C]   (guard: numbers)
+        OP_EQ_NUM,          // if ((R[A] == R[B]) ~= k) then pc++  (guard: numbers)
+        OP_LT_NUM,          // if ((R[A] <  R[B]) ~= k) then pc++  (guard: numbers)
+        OP_LE_NUM,          // if ((R[A] <= R[B]) ~= k) then pc++  (guard: numbers)
+        OP_GETTABLE_ARRAY,  // R[A] := R[B][R[C]]    (guard: plain table, integer key)
+
+        // Upper bound of all opcodes, including quickened ones
+        NUM_ALL_OPCODES
     };
 
     /**
@@ -164,6 +202,14 @@ namespace rangelua {
         explicit constexpr LuaInstruction(std::uint32_t instruction = 0) noexcept
             : raw(instruction) {}
 
+        /**
+         * @brief Same instruction with a different opcode (operands are preserved)
+         */
+        [[nodiscard]] constexpr LuaInstruction with_opcode(OpCode op) const noexcept {
+            constexpr std::uint32_t opcode_mask = (1U << OPCODE_BITS) - 1U;
+            return LuaInstruction((raw & ~opcode_mask) | static_cast<std::uint32_t>(op));
+        }
+
         // Modern C++20 comparison operators
         constexpr auto operator<=>(const LuaInstruction&) const noexcept = default;
 
@@ -273,9 +319,134 @@ namespace rangelua {
         }
     };
 
+    static_assert(static_cast<std::uint32_t>(OpCode::NUM_ALL_OPCODES) <=
+                      (1U << LuaInstruction::OPCODE_BITS),
+                  "Quickened opcodes must fit in the opcode field");
+
     // Modern C++20 instruction utility functions
     namespace instruction_utils {
 
+        /**
+         * @brief Check if opcode is a private quickened variant
+         */
+        [[nodiscard]] constexpr bool is_quickened(OpCode op) noexcept {
+            return op > OpCode::NUM_OPCODES && op < OpCode::NUM_ALL_OPCODES;
+        }
+
+        /**
+         * @brief Map a quickened or statically typed opcode back to the generic opcode it specializes
+         */
+        [[nodiscard]] constexpr OpCode generic_opcode(OpCode op) noexcept {
+            switch (op) {
+                case OpCode::OP_ADDF:
+                    return OpCode::OP_ADD;
+                case OpCode::OP_SUBF:
+                    return OpCode::OP_SUB;
+                case OpCode::OP_MULF:
+                    return OpCode::OP_MUL;
+                case OpCode::OP_DIVF:
+                    return OpCode::OP_DIV;
+                case OpCode::OP_EQF:
+                    return OpCode::OP_EQ;
+                case OpCode::OP_LTF:
+                    return OpCode::OP_LT;
+                case OpCode::OP_LEF:
+                    return OpCode::OP_LE;
+                case OpCode::OP_ADD_NUM:
+                    return OpCode::OP_ADD;
+                case OpCode::OP_SUB_NUM:
+                    return OpCode::OP_SUB;
+                case OpCode::OP_MUL_NUM:
+                    return OpCode::OP_MUL;
+                case OpCode::OP_DIV_NUM:
+                    return OpCode::OP_DIV;
+                case OpCode::OP_EQ_NUM:
+                    return OpCode::OP_EQ;
+                case OpCode::OP_LT_NUM:
+                    return OpCode::OP_LT;
+                case OpCode::OP_LE_NUM:
+                    return OpCode::OP_LE;
+                case OpCode::OP_GETTABLE_ARRAY:
+                    return OpCode::OP_GETTABLE;
+                default:
+                    return op;
+            }
+        }
+
+        /**
+         * @brief Get the number-specialized variant of a generic opcode
+         * @return The quickened opcode, or op itself if none exists
+         */
+        [[nodiscard]] constexpr OpCode number_specialized_opcode(OpCode op) noexcept {
+            switch (op) {
+                case OpCode::OP_ADD:
+                    return OpCode::OP_ADD_NUM;
+                case OpCode::OP_SUB:
+                    return OpCode::OP_SUB_NUM;
+                case OpCode::OP_MUL:
+                    return OpCode::OP_MUL_NUM;
+                case OpCode::OP_DIV:
+                    return OpCode::OP_DIV_NUM;
+                case OpCode::OP_EQ:
+                    return OpCode::OP_EQ_NUM;
+                case OpCode::OP_LT:
+                    return OpCode::OP_LT_NUM;
+                case OpCode::OP_LE:
+                    return OpCode::OP_LE_NUM;
+                default:
+                    return op;
+            }
+        }
+
+        /**
+         * @brief Get the unguarded variant of a generic opcode, for operands proven to be numbers
+         * @return The statically typed opcode, or op itself if none exists
+         */
+        [[nodiscard]] constexpr OpCode number_typed_opcode(OpCode op) noexcept {
+            switch (op) {
+                case OpCode::OP_ADD:
+                    return OpCode::OP_ADDF;
+                case OpCode::OP_SUB:
+                    return OpCode::OP_SUBF;
+                case OpCode::OP_MUL:
+                    return OpCode::OP_MULF;
+                case OpCode::OP_DIV:
+                    return OpCode::OP_DIVF;
+                case OpCode::OP_EQ:
+                    return OpCode::OP_EQF;
+                case OpCode::OP_LT:
+                    return OpCode::OP_LTF;
+                case OpCode::OP_LE:
+                    return OpCode::OP_LEF;
+                default:
+                    return op;
+            }
+        }
+
+        /**
+         * @brief Get the compare-and-branch superinstruction for a register comparison
+         * @return OP_EQJMP, OP_LTJMP or OP_LEJMP for generic or typed EQ, LT and LE; op itself otherwise
+         */
+        [[nodiscard]] constexpr OpCode compare_jump_opcode(OpCode op) noexcept {
+            switch (generic_opcode(op)) {
+                case OpCode::OP_EQ:
+                    return OpCode::OP_EQJMP;
+                case OpCode::OP_LT:
+                    return OpCode::OP_LTJMP;
+                case OpCode::OP_LE:
+                    return OpCode::OP_LEJMP;
+                default:
+                    return op;
+            }
+        }
+
+        /**
+         * @brief Check if opcode is a compare-and-branch superinstruction
+         */
+        [[nodiscard]] constexpr bool is_compare_jump(OpCode op) noexcept {
+            return op == OpCode::OP_EQJMP || op == OpCode::OP_LTJMP || op == OpCode::OP_LEJMP;
+        }
+
         /**
          * @brief Get instruction format as string for debugging
          */
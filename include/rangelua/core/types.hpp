@@ -71,15 +71,47 @@ namespace rangelua {
     using UpvalueIndex = std::uint8_t;
     using LocalIndex = std::uint8_t;
 
-    // Source location information
+    /**
+     * @brief Process-wide table of source file names
+     *
+     * Names are registered once and referred to by a small id, so locations
+     * carried by every token and AST node do not copy the file name. Id 0 is
+     * the empty name. Registration is thread-safe and names are never removed.
+     */
+    class SourceFileTable {
+    public:
+        using FileId = std::uint32_t;
+
+        /**
+         * @brief Id for a file name, registering it on first use
+         */
+        static FileId intern(StringView filename);
+
+        /**
+         * @brief Name registered under an id; stays valid for the life of the process
+         */
+        static StringView name(FileId id) noexcept;
+    };
+
+    // Source location information: a (file id, line, column) triple
     struct SourceLocation {
-        String filename_;
-        Size line_ = 0;
-        Size column_ = 0;
+        SourceFileTable::FileId file_id_ = 0;
+        std::uint32_t line_ = 0;
+        std::uint32_t column_ = 0;
 
         constexpr SourceLocation() noexcept = default;
-        constexpr SourceLocation(String source_file, Size source_line, Size source_column) noexcept
-            : filename_(std::move(source_file)), line_(source_line), column_(source_column) {}
+        constexpr SourceLocation(SourceFileTable::FileId file_id,
+                                 Size source_line,
+                                 Size source_column) noexcept
+            : file_id_(file_id),
+              line_(static_cast<std::uint32_t>(source_line)),
+              column_(static_cast<std::uint32_t>(source_column)) {}
+        SourceLocation(StringView source_file, Size source_line, Size source_column)
+            : SourceLocation(SourceFileTable::intern(source_file), source_line, source_column) {}
+
+        [[nodiscard]] StringView filename() const noexcept {
+            return SourceFileTable::name(file_id_);
+        }
     };
 
     // Forward declarations for core types
@@ -0,0 +1,186 @@
+#pragma once
+
+/**
+ * @file arena.hpp
+ * @brief Bump-pointer arena for AST nodes, child arrays and identifier names
+ * @version 0.1.0
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../core/config.hpp"
+#include "../core/types.hpp"
+
+namespace rangelua::frontend {
+
+    /**
+     * @brief Bump-pointer allocator that owns everything built during one parse
+     *
+     * Allocations are carved out of large blocks (config::AST_ARENA_BLOCK_SIZE,
+     * doubling up to config::MAX_AST_ARENA_BLOCK_SIZE), so the number of heap
+     * allocations grows with the size of the source in megabytes rather than
+     * with the number of nodes. Nothing is released individually: every block
+     * is freed at once when the arena is destroyed, or rewound by reset() once
+     * everything built in it has been destroyed.
+     */
+    class ASTArena {
+    public:
+        ASTArena() = default;
+        ~ASTArena() = default;
+
+        // Addresses handed out must stay valid, so the arena never moves
+        ASTArena(const ASTArena&) = delete;
+        ASTArena& operator=(const ASTArena&) = delete;
+        ASTArena(ASTArena&&) = delete;
+        ASTArena& operator=(ASTArena&&) = delete;
+
+        /**
+         * @brief Allocate uninitialized memory
+         * @param alignment power of two, at most alignof(std::max_align_t)
+         */
+        [[nodiscard]] void* allocate(Size size, Size alignment) {
+            auto address = (reinterpret_cast<std::uintptr_t>(cursor_) + alignment - 1) &
+                           ~(static_cast<std::uintptr_t>(alignment) - 1);
+            if (cursor_ != nullptr && address + size <= reinterpret_cast<std::uintptr_t>(limit_)) {
+                cursor_ = reinterpret_cast<std::byte*>(address + size);
+                bytes_used_ += size;
+                return reinterpret_cast<void*>(address);
+            }
+            return allocate_block(size, alignment);
+        }
+
+        /**
+         * @brief Construct an object in the arena
+         */
+        template <typename T, typename... Args>
+        [[nodiscard]] T* create(Args&&... args) {
+            ++object_count_;
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Copy text into the arena; the view lives as long as the arena
+         */
+        [[nodiscard]] StringView intern(StringView text);
+
+        /**
+         * @brief Release everything allocated so far, keeping the newest block for reuse
+         *
+         * Objects built in the arena must already have been destroyed. Used by
+         * single-pass parsing, which rebuilds the tree for each statement.
+         */
+        void reset() noexcept;
+
+        [[nodiscard]] Size bytes_used() const noexcept { return bytes_used_; }
+        // Largest bytes_used() seen, including before any reset()
+        [[nodiscard]] Size peak_bytes_used() const noexcept {
+            return bytes_used_ > peak_bytes_used_ ? bytes_used_ : peak_bytes_used_;
+        }
+        [[nodiscard]] Size bytes_reserved() const noexcept { return bytes_reserved_; }
+        [[nodiscard]] Size block_count() const noexcept { return blocks_.size(); }
+        [[nodiscard]] Size object_count() const noexcept { return object_count_; }
+
+        /**
+         * @brief Arena that ArenaAllocator and ASTBuilder use on this thread (nullptr if none)
+         */
+        [[nodiscard]] static ASTArena* current() noexcept;
+
+        /**
+         * @brief Makes an arena current for its lifetime, restoring the previous one after
+         */
+        class Scope {
+        public:
+            explicit Scope(ASTArena& arena) noexcept;
+            ~Scope();
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            ASTArena* previous_;
+        };
+
+    private:
+        void* allocate_block(Size size, Size alignment);
+
+        std::vector<std::unique_ptr<std::byte[]>> blocks_;
+        std::byte* bump_block_ = nullptr;  // Start of the block cursor_ points into
+        std::byte* cursor_ = nullptr;
+        std::byte* limit_ = nullptr;
+        Size next_block_size_ = config::AST_ARENA_BLOCK_SIZE;
+        Size bytes_used_ = 0;
+        Size peak_bytes_used_ = 0;
+        Size bytes_reserved_ = 0;
+        Size object_count_ = 0;
+    };
+
+    /**
+     * @brief Standard allocator that draws from an ASTArena
+     *
+     * A default-constructed allocator binds to ASTArena::current(), so
+     * containers declared while a parse is running land in that parse's arena
+     * without naming it. Without a current arena it falls back to the heap.
+     * Deallocation into an arena is a no-op; the memory returns with the arena.
+     */
+    template <typename T>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        ArenaAllocator() noexcept : arena_(ASTArena::current()) {}
+        explicit ArenaAllocator(ASTArena* arena) noexcept : arena_(arena) {}
+
+        template <typename U>
+        // NOLINTNEXTLINE(google-explicit-constructor)
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+        [[nodiscard]] T* allocate(Size count) {
+            if (arena_ != nullptr) {
+                return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+            }
+            return std::allocator<T>{}.allocate(count);
+        }
+
+        void deallocate(T* pointer, Size count) noexcept {
+            if (arena_ == nullptr) {
+                std::allocator<T>{}.deallocate(pointer, count);
+            }
+        }
+
+        [[nodiscard]] ASTArena* arena() const noexcept { return arena_; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept {
+            return arena_ == other.arena();
+        }
+
+    private:
+        ASTArena* arena_;
+    };
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    /**
+     * @brief Deleter for arena objects: runs the destructor and leaves the memory to the arena
+     */
+    struct ArenaDeleter {
+        template <typename T>
+        void operator()(T* object) const noexcept {
+            std::destroy_at(object);
+        }
+    };
+
+    template <typename T>
+    using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+}  // namespace rangelua::frontend
@@ -15,6 +15,7 @@
 #include "../core/concepts.hpp"
 #include "../core/error.hpp"
 #include "../core/types.hpp"
+#include "arena.hpp"
 #include "lexer.hpp"
 
 namespace rangelua::frontend {
@@ -91,8 +92,9 @@ namespace rangelua::frontend {
         SourceLocation location_;
     };
 
-    using ASTNodePtr = UniquePtr<ASTNode>;
-    using ASTNodeList = std::vector<ASTNodePtr>;
+    // Nodes, child lists and names live in the ASTArena of the parse that built them
+    using ASTNodePtr = ArenaPtr<ASTNode>;
+    using ASTNodeList = ArenaVector<ASTNodePtr>;
 
     /**
      * @brief Expression base class
@@ -103,8 +105,8 @@ namespace rangelua::frontend {
             : ASTNode(type, std::move(location)) {}
     };
 
-    using ExpressionPtr = UniquePtr<Expression>;
-    using ExpressionList = std::vector<ExpressionPtr>;
+    using ExpressionPtr = ArenaPtr<Expression>;
+    using ExpressionList = ArenaVector<ExpressionPtr>;
 
     /**
      * @brief Statement base class
@@ -115,8 +117,13 @@ namespace rangelua::frontend {
             : ASTNode(type, std::move(location)) {}
     };
 
-    using StatementPtr = UniquePtr<Statement>;
-    using StatementList = std::vector<StatementPtr>;
+    using StatementPtr = ArenaPtr<Statement>;
+    using StatementList = ArenaVector<StatementPtr>;
+
+    /**
+     * @brief Variable names, interned in the arena
+     */
+    using NameList = ArenaVector<StringView>;
 
     /**
      * @brief Literal expression (numbers, strings, booleans, nil)
@@ -148,10 +155,10 @@ namespace rangelua::frontend {
      */
     class IdentifierExpression : public Expression {
     public:
-        explicit IdentifierExpression(String name, SourceLocation location = {}) noexcept
-            : Expression(NodeType::Identifier, std::move(location)), name_(std::move(name)) {}
+        explicit IdentifierExpression(StringView name, SourceLocation location = {}) noexcept
+            : Expression(NodeType::Identifier, std::move(location)), name_(name) {}
 
-        [[nodiscard]] const String& name() const noexcept { return name_; }
+        [[nodiscard]] StringView name() const noexcept { return name_; }
 
         void accept(ASTVisitor& visitor) const override;
 
@@ -163,7 +170,7 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
-        String name_;
+        StringView name_;
     };
 
     /**
@@ -301,16 +308,16 @@ namespace rangelua::frontend {
     class MethodCallExpression : public Expression {
     public:
         MethodCallExpression(ExpressionPtr object,
-                             String method_name,
+                             StringView method_name,
                              ExpressionList arguments,
                              SourceLocation location = {}) noexcept
             : Expression(NodeType::MethodCall, std::move(location)),
               object_(std::move(object)),
-              method_name_(std::move(method_name)),
+              method_name_(method_name),
               arguments_(std::move(arguments)) {}
 
         [[nodiscard]] const Expression& object() const noexcept { return *object_; }
-        [[nodiscard]] const String& method_name() const noexcept { return method_name_; }
+        [[nodiscard]] StringView method_name() const noexcept { return method_name_; }
         [[nodiscard]] const ExpressionList& arguments() const noexcept { return arguments_; }
 
         void accept(ASTVisitor& visitor) const override;
@@ -324,7 +331,7 @@ namespace rangelua::frontend {
 
     private:
         ExpressionPtr object_;
-        String method_name_;
+        StringView method_name_;
         ExpressionList arguments_;
     };
 
@@ -376,7 +383,7 @@ namespace rangelua::frontend {
                 : type(t), key(std::move(k)), value(std::move(v)) {}
         };
 
-        using FieldList = std::vector<Field>;
+        using FieldList = ArenaVector<Field>;
 
         explicit TableConstructorExpression(FieldList fields, SourceLocation location = {}) noexcept
             : Expression(NodeType::TableConstructor, std::move(location)),
@@ -400,28 +407,49 @@ namespace rangelua::frontend {
     /**
      * @brief Function expression (function(...) ... end)
      */
+    /**
+     * @brief Byte range of source text, with the locations of both ends
+     */
+    struct SourceRange {
+        Size begin = 0;
+        Size end = 0;
+        SourceLocation begin_location;
+        SourceLocation end_location;
+    };
+
     class FunctionExpression : public Expression {
     public:
         struct Parameter {
-            String name;
+            StringView name;
             bool is_vararg = false;
 
-            explicit Parameter(String n, bool vararg = false) noexcept
-                : name(std::move(n)), is_vararg(vararg) {}
+            explicit Parameter(StringView n, bool vararg = false) noexcept
+                : name(n), is_vararg(vararg) {}
         };
 
-        using ParameterList = std::vector<Parameter>;
+        using ParameterList = ArenaVector<Parameter>;
 
         FunctionExpression(ParameterList parameters,
                            StatementPtr body,
-                           SourceLocation location = {}) noexcept
+                           SourceLocation location = {},
+                           Optional<SourceRange> deferred_body = std::nullopt) noexcept
             : Expression(NodeType::FunctionExpression, std::move(location)),
               parameters_(std::move(parameters)),
-              body_(std::move(body)) {}
+              body_(std::move(body)),
+              deferred_body_(deferred_body) {}
 
         [[nodiscard]] const ParameterList& parameters() const noexcept { return parameters_; }
         [[nodiscard]] const Statement& body() const noexcept { return *body_; }
 
+        /**
+         * @brief Source of a body the parser skipped (ParserConfig::lazy_functions)
+         *
+         * When set, body() is an empty block and the body is compiled on first use.
+         */
+        [[nodiscard]] const Optional<SourceRange>& deferred_body() const noexcept {
+            return deferred_body_;
+        }
+
         void accept(ASTVisitor& visitor) const override;
 
         template <typename T>
@@ -434,6 +462,7 @@ namespace rangelua::frontend {
     private:
         ParameterList parameters_;
         StatementPtr body_;
+        Optional<SourceRange> deferred_body_;
     };
 
     /**
@@ -541,9 +570,11 @@ namespace rangelua::frontend {
             StatementPtr body;
         };
 
+        using ElseIfClauseList = ArenaVector<ElseIfClause>;
+
         IfStatement(ExpressionPtr condition,
                     StatementPtr then_body,
-                    std::vector<ElseIfClause> elseif_clauses = {},
+                    ElseIfClauseList elseif_clauses = {},
                     StatementPtr else_body = nullptr,
                     SourceLocation location = {}) noexcept
             : Statement(NodeType::IfStatement, std::move(location)),
@@ -554,7 +585,7 @@ namespace rangelua::frontend {
 
         [[nodiscard]] const Expression& condition() const noexcept { return *condition_; }
         [[nodiscard]] const Statement& then_body() const noexcept { return *then_body_; }
-        [[nodiscard]] const std::vector<ElseIfClause>& elseif_clauses() const noexcept {
+        [[nodiscard]] const ElseIfClauseList& elseif_clauses() const noexcept {
             return elseif_clauses_;
         }
         [[nodiscard]] const Statement* else_body() const noexcept { return else_body_.get(); }
@@ -571,7 +602,7 @@ namespace rangelua::frontend {
     private:
         ExpressionPtr condition_;
         StatementPtr then_body_;
-        std::vector<ElseIfClause> elseif_clauses_;
+        ElseIfClauseList elseif_clauses_;
         StatementPtr else_body_;
     };
 
@@ -580,16 +611,32 @@ namespace rangelua::frontend {
      */
     class LocalDeclarationStatement : public Statement {
     public:
-        LocalDeclarationStatement(std::vector<String> names,
+        /**
+         * @brief Variable attribute (Lua 5.4+ <const> and <close>)
+         */
+        enum class Attribute : std::uint8_t { None, Const, Close };
+
+        using AttributeList = ArenaVector<Attribute>;
+
+        LocalDeclarationStatement(NameList names,
                                   ExpressionList values = {},
-                                  SourceLocation location = {}) noexcept
+                                  SourceLocation location = {},
+                                  AttributeList attributes = {}) noexcept
             : Statement(NodeType::LocalDeclaration, std::move(location)),
               names_(std::move(names)),
-              values_(std::move(values)) {}
+              values_(std::move(values)),
+              attributes_(std::move(attributes)) {}
 
-        [[nodiscard]] const std::vector<String>& names() const noexcept { return names_; }
+        [[nodiscard]] const NameList& names() const noexcept { return names_; }
         [[nodiscard]] const ExpressionList& values() const noexcept { return values_; }
 
+        /**
+         * @brief Attribute of the variable at the given position (None if it has none)
+         */
+        [[nodiscard]] Attribute attribute(Size index) const noexcept {
+            return index < attributes_.size() ? attributes_[index] : Attribute::None;
+        }
+
         void accept(ASTVisitor& visitor) const override;
 
         template <typename T>
@@ -600,8 +647,9 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
-        std::vector<String> names_;
+        NameList names_;
         ExpressionList values_;
+        AttributeList attributes_;
     };
 
     /**
@@ -613,11 +661,13 @@ namespace rangelua::frontend {
                                      FunctionExpression::ParameterList parameters,
                                      StatementPtr body,
                                      bool is_local = false,
-                                     SourceLocation location = {}) noexcept
+                                     SourceLocation location = {},
+                                     Optional<SourceRange> deferred_body = std::nullopt) noexcept
             : Statement(NodeType::FunctionDeclaration, std::move(location)),
               name_(std::move(name)),
               parameters_(std::move(parameters)),
               body_(std::move(body)),
+              deferred_body_(deferred_body),
               is_local_(is_local) {}
 
         [[nodiscard]] const Expression& name() const noexcept { return *name_; }
@@ -627,6 +677,13 @@ namespace rangelua::frontend {
         [[nodiscard]] const Statement& body() const noexcept { return *body_; }
         [[nodiscard]] bool is_local() const noexcept { return is_local_; }
 
+        /**
+         * @brief Source of a body the parser skipped, see FunctionExpression::deferred_body()
+         */
+        [[nodiscard]] const Optional<SourceRange>& deferred_body() const noexcept {
+            return deferred_body_;
+        }
+
         void accept(ASTVisitor& visitor) const override;
 
         template <typename T>
@@ -640,6 +697,7 @@ namespace rangelua::frontend {
         ExpressionPtr name_;
         FunctionExpression::ParameterList parameters_;
         StatementPtr body_;
+        Optional<SourceRange> deferred_body_;
         bool is_local_;
     };
 
@@ -677,20 +735,20 @@ namespace rangelua::frontend {
      */
     class ForNumericStatement : public Statement {
     public:
-        ForNumericStatement(String variable,
+        ForNumericStatement(StringView variable,
                             ExpressionPtr start,
                             ExpressionPtr stop,
                             ExpressionPtr step,
                             StatementPtr body,
                             SourceLocation location = {}) noexcept
             : Statement(NodeType::ForNumericStatement, std::move(location)),
-              variable_(std::move(variable)),
+              variable_(variable),
               start_(std::move(start)),
               stop_(std::move(stop)),
               step_(std::move(step)),
               body_(std::move(body)) {}
 
-        [[nodiscard]] const String& variable() const noexcept { return variable_; }
+        [[nodiscard]] StringView variable() const noexcept { return variable_; }
         [[nodiscard]] const Expression& start() const noexcept { return *start_; }
         [[nodiscard]] const Expression& stop() const noexcept { return *stop_; }
         [[nodiscard]] const Expression* step() const noexcept { return step_.get(); }
@@ -706,7 +764,7 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
-        String variable_;
+        StringView variable_;
         ExpressionPtr start_;
         ExpressionPtr stop_;
         ExpressionPtr step_;  // nullptr if not specified (defaults to 1)
@@ -718,7 +776,7 @@ namespace rangelua::frontend {
      */
     class ForGenericStatement : public Statement {
     public:
-        ForGenericStatement(std::vector<String> variables,
+        ForGenericStatement(NameList variables,
                             ExpressionList expressions,
                             StatementPtr body,
                             SourceLocation location = {}) noexcept
@@ -727,7 +785,7 @@ namespace rangelua::frontend {
               expressions_(std::move(expressions)),
               body_(std::move(body)) {}
 
-        [[nodiscard]] const std::vector<String>& variables() const noexcept { return variables_; }
+        [[nodiscard]] const NameList& variables() const noexcept { return variables_; }
         [[nodiscard]] const ExpressionList& expressions() const noexcept { return expressions_; }
         [[nodiscard]] const Statement& body() const noexcept { return *body_; }
 
@@ -741,7 +799,7 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
-        std::vector<String> variables_;
+        NameList variables_;
         ExpressionList expressions_;
         StatementPtr body_;
     };
@@ -845,10 +903,10 @@ namespace rangelua::frontend {
      */
     class GotoStatement : public Statement {
     public:
-        explicit GotoStatement(String label, SourceLocation location = {}) noexcept
-            : Statement(NodeType::GotoStatement, std::move(location)), label_(std::move(label)) {}
+        explicit GotoStatement(StringView label, SourceLocation location = {}) noexcept
+            : Statement(NodeType::GotoStatement, std::move(location)), label_(label) {}
 
-        [[nodiscard]] const String& label() const noexcept { return label_; }
+        [[nodiscard]] StringView label() const noexcept { return label_; }
 
         void accept(ASTVisitor& visitor) const override;
 
@@ -860,7 +918,7 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
-        String label_;
+        StringView label_;
     };
 
     /**
@@ -868,10 +926,10 @@ namespace rangelua::frontend {
      */
     class LabelStatement : public Statement {
     public:
-        explicit LabelStatement(String name, SourceLocation location = {}) noexcept
-            : Statement(NodeType::LabelStatement, std::move(location)), name_(std::move(name)) {}
+        explicit LabelStatement(StringView name, SourceLocation location = {}) noexcept
+            : Statement(NodeType::LabelStatement, std::move(location)), name_(name) {}
 
-        [[nodiscard]] const String& name() const noexcept { return name_; }
+        [[nodiscard]] StringView name() const noexcept { return name_; }
 
         void accept(ASTVisitor& visitor) const override;
 
@@ -883,7 +941,7 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
-        String name_;
+        StringView name_;
     };
 
     /**
@@ -913,14 +971,27 @@ namespace rangelua::frontend {
 
     /**
      * @brief Program root node
+     *
+     * The program is the one node allocated on the heap: it owns the arena
+     * holding the rest of the tree, so destroying it releases the whole AST
+     * in one step.
      */
     class Program : public ASTNode {
     public:
-        explicit Program(StatementList statements, SourceLocation location = {}) noexcept
-            : ASTNode(NodeType::Program, std::move(location)), statements_(std::move(statements)) {}
+        explicit Program(StatementList statements,
+                         SourceLocation location = {},
+                         UniquePtr<ASTArena> arena = nullptr) noexcept
+            : ASTNode(NodeType::Program, std::move(location)),
+              arena_(std::move(arena)),
+              statements_(std::move(statements)) {}
 
         [[nodiscard]] const StatementList& statements() const noexcept { return statements_; }
 
+        /**
+         * @brief Arena holding the tree (nullptr if the statements live elsewhere)
+         */
+        [[nodiscard]] const ASTArena* arena() const noexcept { return arena_.get(); }
+
         void accept(ASTVisitor& visitor) const override;
 
         template <typename T>
@@ -931,6 +1002,7 @@ namespace rangelua::frontend {
         [[nodiscard]] String to_string() const override;
 
     private:
+        UniquePtr<ASTArena> arena_;  // Declared first so the statements are destroyed before it
         StatementList statements_;
     };
 
@@ -1038,7 +1110,7 @@ namespace rangelua::frontend {
     // Utility type aliases for convenience
     using TableFieldList = TableConstructorExpression::FieldList;
     using ParameterList = FunctionExpression::ParameterList;
-    using ElseIfClauseList = std::vector<IfStatement::ElseIfClause>;
+    using ElseIfClauseList = IfStatement::ElseIfClauseList;
 
     // AST node variant for generic processing
     using AnyExpression = Variant<LiteralExpression,
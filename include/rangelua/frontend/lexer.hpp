@@ -101,10 +101,17 @@ namespace rangelua::frontend {
 
     /**
      * @brief Token structure containing type, value, and location information
+     *
+     * The value is a view: into the source text for identifiers, numbers and
+     * strings without escapes, and into storage owned by the lexer for strings
+     * whose escapes had to be decoded. Either way it is valid while the lexer
+     * that produced it is alive, except on a streamed source: there names stay
+     * valid, but any other value only until config::LEXER_TOKEN_TEXT_SLOTS
+     * more tokens with copied text have been read.
      */
     struct Token {
         TokenType type = TokenType::Invalid;
-        String value;
+        StringView value;
         SourceLocation location;
 
         // For numeric tokens
@@ -113,14 +120,14 @@ namespace rangelua::frontend {
 
         constexpr Token() noexcept = default;
 
-        Token(TokenType t, String v, SourceLocation loc) noexcept
-            : type(t), value(std::move(v)), location(std::move(loc)) {}
+        Token(TokenType t, StringView v, SourceLocation loc) noexcept
+            : type(t), value(v), location(loc) {}
 
-        Token(TokenType t, String v, SourceLocation loc, Number num) noexcept
-            : type(t), value(std::move(v)), location(std::move(loc)), number_value(num) {}
+        Token(TokenType t, StringView v, SourceLocation loc, Number num) noexcept
+            : type(t), value(v), location(loc), number_value(num) {}
 
-        Token(TokenType t, String v, SourceLocation loc, Int integer) noexcept
-            : type(t), value(std::move(v)), location(std::move(loc)), integer_value(integer) {}
+        Token(TokenType t, StringView v, SourceLocation loc, Int integer) noexcept
+            : type(t), value(v), location(loc), integer_value(integer) {}
 
         [[nodiscard]] bool is_keyword() const noexcept;
         [[nodiscard]] bool is_operator() const noexcept;
@@ -132,12 +139,26 @@ namespace rangelua::frontend {
 
     /**
      * @brief Lexical analyzer that converts source code into tokens
+     *
+     * A lexer built from a StringView does not copy the source, which must
+     * outlive both the lexer and the tokens it returns. One built from a stream
+     * reads it incrementally, config::LEXER_BUFFER_SIZE bytes at a time, into a
+     * window that is compacted between tokens. Token text is copied out of the
+     * window: names once per distinct name, other text into a few slots that are
+     * reused, so memory use follows the parser's lookahead rather than the input.
      */
     class Lexer {
     public:
         using Token = rangelua::frontend::Token;  // For concept compliance
 
         explicit Lexer(StringView source, String filename = "<input>");
+
+        /**
+         * @brief Lex a fragment of a larger source, e.g. a deferred function body
+         * @param start Location of the fragment's first byte; token locations continue from it
+         */
+        Lexer(StringView source, const SourceLocation& start);
+
         explicit Lexer(std::istream& input, String filename = "<stream>");
 
         ~Lexer();
@@ -172,9 +193,20 @@ namespace rangelua::frontend {
          */
         [[nodiscard]] bool at_end() const noexcept;
 
+        /**
+         * @brief Number of source bytes read so far (the whole source for a StringView)
+         */
+        [[nodiscard]] Size bytes_read() const noexcept;
+
+        /**
+         * @brief Byte offset in the input of the token last returned by next_token()
+         */
+        [[nodiscard]] Size token_offset() const noexcept;
+
         /**
          * @brief Get all tokens from input
-         * @return Vector of all tokens
+         * @return Vector of all tokens; on a streamed source only the names and the
+         *         last few other values remain valid (see Token)
          */
         std::vector<Token> tokenize();
 
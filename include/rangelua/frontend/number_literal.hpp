@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file number_literal.hpp
+ * @brief Conversion of Lua numeric literals to integer and float values
+ * @version 0.1.0
+ */
+
+#include "../core/types.hpp"
+
+namespace rangelua::frontend {
+
+    /**
+     * @brief Value of a numeric literal: an integer or a float, as Lua 5.5 reads it
+     */
+    struct NumberLiteral {
+        bool is_integer = true;
+        Int integer = 0;
+        Number number = 0.0;
+    };
+
+    /**
+     * @brief Convert a complete numeric literal, without sign or surrounding space
+     *
+     * Follows the reference interpreter: a decimal literal without a point or
+     * exponent is an integer unless it overflows Int, in which case it is read
+     * as a float; a hexadecimal literal without a point or exponent is an
+     * integer that wraps around modulo 2^64; anything else is a float,
+     * correctly rounded, including hexadecimal floats such as 0x1.8p3.
+     * Plain digit runs are accumulated directly; floats go through
+     * std::from_chars on the text in place, without a copy.
+     *
+     * @return nullopt if the text is not a well-formed literal
+     */
+    [[nodiscard]] Optional<NumberLiteral> parse_number_literal(StringView text) noexcept;
+
+}  // namespace rangelua::frontend
@@ -28,6 +28,31 @@ namespace rangelua::frontend {
         bool lua_5_2_compat = false;
         bool lua_5_3_compat = true;
         bool lua_5_4_compat = true;
+        // parse(StatementSink&) hands over each top-level statement as soon as it is
+        // parsed and then frees its tree, instead of building the whole program first.
+        // Each statement still gets a complete AST, including the bodies of the
+        // functions it defines; code is generated from that tree, not from the parser
+        bool single_pass = false;
+        // Function bodies are only pre-scanned for balanced blocks and brackets; their
+        // nodes carry the source range (deferred_body()) and an empty block instead.
+        // Token offsets must index the text the caller keeps for compiling them later
+        bool lazy_functions = false;
+    };
+
+    /**
+     * @brief Consumer of a chunk's top-level statements, in source order
+     *
+     * Implemented by the code generator so the parser can feed it without
+     * depending on the backend. A statement passed to consume() is only valid
+     * for the duration of the call.
+     */
+    class StatementSink {
+    public:
+        virtual ~StatementSink() = default;
+
+        virtual void begin_chunk(const SourceLocation& location) = 0;
+        virtual Status consume(const Statement& statement) = 0;
+        virtual Status end_chunk() = 0;
     };
 
     /**
@@ -60,22 +85,41 @@ namespace rangelua::frontend {
 
         /**
          * @brief Parse the input and return AST
-         * @return Program AST or error
+         * @return Program AST or error; the program owns the arena the tree was built in
          */
         Result<ProgramPtr> parse();
 
+        /**
+         * @brief Parse the input and feed its top-level statements to a sink
+         *
+         * With ParserConfig::single_pass, each statement is consumed as soon as
+         * it is parsed and its tree is released before the next one is built, so
+         * only one top-level statement is ever held in memory. Otherwise the
+         * whole program is parsed first, as parse() does, and then consumed.
+         * Statements that fail to parse are skipped in both modes.
+         *
+         * @return the first error returned by the sink, if any
+         */
+        Status parse(StatementSink& sink);
+
         /**
          * @brief Parse a single expression
-         * @return Expression AST or error
+         * @return Expression AST or error, valid until the parser is destroyed or parse() runs
          */
         Result<ExpressionPtr> parse_expression();
 
         /**
          * @brief Parse a single statement
-         * @return Statement AST or error
+         * @return Statement AST or error, valid until the parser is destroyed or parse() runs
          */
         Result<StatementPtr> parse_statement();
 
+        /**
+         * @brief Parse the rest of the input as one block, e.g. a deferred function body
+         * @return Block statement or error, valid until the parser is destroyed or parse() runs
+         */
+        Result<StatementPtr> parse_block();
+
         /**
          * @brief Check if parser has encountered errors
          * @return true if errors occurred
@@ -94,6 +138,11 @@ namespace rangelua::frontend {
          */
         [[nodiscard]] const ParserConfig& config() const noexcept;
 
+        /**
+         * @brief Arena of the last single-pass parse(StatementSink&), for statistics
+         */
+        [[nodiscard]] const ASTArena& arena() const noexcept;
+
     private:
         class Impl;
         UniquePtr<Impl> impl_;
@@ -198,13 +247,18 @@ namespace rangelua::frontend {
 
     /**
      * @brief AST builder helper class with complete Lua 5.5 support
+     *
+     * Nodes are allocated in ASTArena::current(), which must be set (the
+     * parser opens an ASTArena::Scope around every parse). Names passed as
+     * views are interned into the arena; the entries of a NameList must
+     * already live there.
      */
     class ASTBuilder {
     public:
         // Expression builders
         static ExpressionPtr make_literal(LiteralExpression::Value value,
                                           SourceLocation location = {});
-        static ExpressionPtr make_identifier(String name, SourceLocation location = {});
+        static ExpressionPtr make_identifier(StringView name, SourceLocation location = {});
         static ExpressionPtr make_binary_op(BinaryOpExpression::Operator op,
                                             ExpressionPtr left,
                                             ExpressionPtr right,
@@ -216,7 +270,7 @@ namespace rangelua::frontend {
                                                 ExpressionList arguments,
                                                 SourceLocation location = {});
         static ExpressionPtr make_method_call(ExpressionPtr object,
-                                              String method_name,
+                                              StringView method_name,
                                               ExpressionList arguments,
                                               SourceLocation location = {});
         static ExpressionPtr make_table_access(ExpressionPtr table,
@@ -225,9 +279,11 @@ namespace rangelua::frontend {
                                                SourceLocation location = {});
         static ExpressionPtr make_table_constructor(TableConstructorExpression::FieldList fields,
                                                     SourceLocation location = {});
-        static ExpressionPtr make_function_expression(FunctionExpression::ParameterList parameters,
-                                                      StatementPtr body,
-                                                      SourceLocation location = {});
+        static ExpressionPtr make_function_expression(
+            FunctionExpression::ParameterList parameters,
+            StatementPtr body,
+            SourceLocation location = {},
+            Optional<SourceRange> deferred_body = std::nullopt);
         static ExpressionPtr make_vararg(SourceLocation location = {});
         static ExpressionPtr make_parenthesized(ExpressionPtr expression,
                                                 SourceLocation location = {});
@@ -237,28 +293,32 @@ namespace rangelua::frontend {
         static StatementPtr make_assignment(ExpressionList targets,
                                             ExpressionList values,
                                             SourceLocation location = {});
-        static StatementPtr make_local_declaration(std::vector<String> names,
-                                                   ExpressionList values = {},
-                                                   SourceLocation location = {});
-        static StatementPtr make_function_declaration(ExpressionPtr name,
-                                                      FunctionExpression::ParameterList parameters,
-                                                      StatementPtr body,
-                                                      bool is_local = false,
-                                                      SourceLocation location = {});
+        static StatementPtr make_local_declaration(
+            NameList names,
+            ExpressionList values = {},
+            SourceLocation location = {},
+            LocalDeclarationStatement::AttributeList attributes = {});
+        static StatementPtr make_function_declaration(
+            ExpressionPtr name,
+            FunctionExpression::ParameterList parameters,
+            StatementPtr body,
+            bool is_local = false,
+            SourceLocation location = {},
+            Optional<SourceRange> deferred_body = std::nullopt);
         static StatementPtr make_if(ExpressionPtr condition,
                                     StatementPtr then_body,
-                                    std::vector<IfStatement::ElseIfClause> elseif_clauses = {},
+                                    IfStatement::ElseIfClauseList elseif_clauses = {},
                                     StatementPtr else_body = nullptr,
                                     SourceLocation location = {});
         static StatementPtr
         make_while(ExpressionPtr condition, StatementPtr body, SourceLocation location = {});
-        static StatementPtr make_for_numeric(String variable,
+        static StatementPtr make_for_numeric(StringView variable,
                                              ExpressionPtr start,
                                              ExpressionPtr stop,
                                              ExpressionPtr step,
                                              StatementPtr body,
                                              SourceLocation location = {});
-        static StatementPtr make_for_generic(std::vector<String> variables,
+        static StatementPtr make_for_generic(NameList variables,
                                              ExpressionList expressions,
                                              StatementPtr body,
                                              SourceLocation location = {});
@@ -267,13 +327,15 @@ namespace rangelua::frontend {
         static StatementPtr make_do(StatementPtr body, SourceLocation location = {});
         static StatementPtr make_return(ExpressionList values = {}, SourceLocation location = {});
         static StatementPtr make_break(SourceLocation location = {});
-        static StatementPtr make_goto(String label, SourceLocation location = {});
-        static StatementPtr make_label(String name, SourceLocation location = {});
+        static StatementPtr make_goto(StringView label, SourceLocation location = {});
+        static StatementPtr make_label(StringView name, SourceLocation location = {});
         static StatementPtr make_expression_statement(ExpressionPtr expression,
                                                       SourceLocation location = {});
 
-        // Program builder
-        static ProgramPtr make_program(StatementList statements, SourceLocation location = {});
+        // Program builder; the program takes ownership of the arena holding its statements
+        static ProgramPtr make_program(StatementList statements,
+                                       SourceLocation location = {},
+                                       UniquePtr<ASTArena> arena = nullptr);
     };
 
     /**
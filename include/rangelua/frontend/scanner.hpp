@@ -0,0 +1,80 @@
+#pragma once
+
+/**
+ * @file scanner.hpp
+ * @brief Vectorized byte scanning primitives used by the lexer
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+
+#include "../core/types.hpp"
+
+namespace rangelua::frontend::scan {
+
+    /**
+     * @brief Instruction set the scanning kernels run on
+     */
+    enum class Implementation : std::uint8_t {
+        Scalar,
+        SSE2,
+        AVX2,
+    };
+
+    /**
+     * @brief Best implementation the running CPU supports (checked once via CPUID)
+     */
+    [[nodiscard]] Implementation detect_implementation() noexcept;
+
+    /**
+     * @brief Implementation used by the functions below; defaults to detect_implementation()
+     */
+    [[nodiscard]] Implementation active_implementation() noexcept;
+
+    /**
+     * @brief Select the kernels, e.g. to compare against the scalar fallback
+     * @return false if the CPU does not support the requested instruction set
+     */
+    bool set_implementation(Implementation implementation) noexcept;
+
+    [[nodiscard]] StringView implementation_name(Implementation implementation) noexcept;
+
+    /**
+     * @brief Scanning operations for one instruction set
+     *
+     * Each search starts at a position and returns the index of the first byte
+     * that stops it, or text.size() if none does. Blocks of 16 (SSE2) or 32
+     * (AVX2) bytes are classified at once; the tail is finished byte by byte.
+     * The lexer looks the table up once and calls through it directly.
+     */
+    struct Kernels {
+        Implementation implementation;
+
+        // First byte that is not whitespace (space, \t, \n, \v, \f, \r)
+        Size (*skip_whitespace)(StringView text, Size position) noexcept;
+
+        // First byte that cannot continue an identifier ([A-Za-z0-9_])
+        Size (*find_identifier_end)(StringView text, Size position) noexcept;
+
+        // First byte that is not a decimal digit
+        Size (*find_digits_end)(StringView text, Size position) noexcept;
+
+        // First \n or \r, i.e. the end of a line comment
+        Size (*find_line_end)(StringView text, Size position) noexcept;
+
+        // First byte a short string must handle: the quote, a backslash, \n or \r
+        Size (*find_string_special)(StringView text, Size position, char quote) noexcept;
+
+        // First ']', where a long string or comment may close
+        Size (*find_closing_bracket)(StringView text, Size position) noexcept;
+
+        // Number of \n bytes in [begin, end)
+        Size (*count_newlines)(StringView text, Size begin, Size end) noexcept;
+    };
+
+    /**
+     * @brief Kernels for active_implementation()
+     */
+    [[nodiscard]] const Kernels& kernels() noexcept;
+
+}  // namespace rangelua::frontend::scan
@@ -30,6 +30,7 @@
 
 // Backend components
 #include "backend/bytecode.hpp"
+#include "backend/chunk.hpp"
 #include "backend/codegen.hpp"
 #include "backend/optimizer.hpp"
 
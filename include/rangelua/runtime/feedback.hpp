@@ -0,0 +1,141 @@
+#pragma once
+
+/**
+ * @file feedback.hpp
+ * @brief Per-instruction type feedback collected by the interpreter
+ * @version 0.1.0
+ */
+
+#include <unordered_map>
+#include <vector>
+
+#include "../core/instruction.hpp"
+#include "../core/types.hpp"
+#include "value.hpp"
+
+namespace rangelua::runtime {
+
+    /**
+     * @brief Set of value types observed by an operand (one bit per ValueType)
+     */
+    using TypeSet = std::uint16_t;
+
+    /**
+     * @brief Bit representing a value type in a TypeSet
+     */
+    [[nodiscard]] constexpr TypeSet type_bit(ValueType type) noexcept {
+        return static_cast<TypeSet>(1U << static_cast<unsigned>(type));
+    }
+
+    /**
+     * @brief Convert a TypeSet to a readable list, e.g. "number|string"
+     */
+    [[nodiscard]] String type_set_to_string(TypeSet types);
+
+    /**
+     * @brief Which operands an instruction records feedback for
+     */
+    enum class FeedbackKind : std::uint8_t {
+        None,
+        BinaryBC,     // Types of R[B] and R[C]
+        UnaryB,       // Type of R[B]
+        CompareAB,    // Types of R[A] and R[B]
+        CompareA,     // Type of R[A]
+        Call,         // Callee in R[A]
+        FieldReadB,   // Receiver R[B] and its shape
+        FieldWriteA,  // Receiver R[A] and its shape
+        Jump,         // Backward jumps are loop back-edges
+        Loop          // FORLOOP/TFORLOOP back-edge
+    };
+
+    /**
+     * @brief Classify an opcode (quickened opcodes share their generic kind)
+     */
+    [[nodiscard]] FeedbackKind feedback_kind(OpCode op) noexcept;
+
+    /**
+     * @brief Feedback recorded for a single instruction
+     */
+    struct FeedbackSlot {
+        OpCode opcode = OpCode::OP_MOVE;          // Generic opcode of the instruction
+        FeedbackKind kind = FeedbackKind::None;   // Operands recorded for the opcode
+        bool executed = false;                    // Ran at least once (opcode and kind are set)
+        Size count = 0;                           // Times executed (sampled estimate)
+        TypeSet operand_types[2] = {};            // Types seen by the first/second operand (sampled)
+        const void* target = nullptr;             // CALL callee or field receiver's metatable
+        bool has_target = false;                  // A target has been observed at least once
+        bool polymorphic = false;                 // More than one distinct target observed
+
+        /**
+         * @brief Record an observed call target or receiver shape
+         */
+        void observe_target(const void* observed) noexcept {
+            if (!has_target) {
+                target = observed;
+                has_target = true;
+            } else if (target != observed) {
+                polymorphic = true;
+            }
+        }
+    };
+
+    /**
+     * @brief Type-feedback vector for one function prototype
+     *
+     * Slots are indexed by program counter. Later optimization tiers read
+     * the vector to decide which specializations are worth compiling.
+     */
+    class FeedbackVector {
+    public:
+        FeedbackVector() = default;
+        FeedbackVector(String name, Size instruction_count);
+
+        /**
+         * @brief Get slot for a program counter (grows the vector if needed)
+         */
+        [[nodiscard]] FeedbackSlot& slot(Size pc) {
+            if (pc >= slots_.size()) [[unlikely]] {
+                slots_.resize(pc + 1);
+            }
+            return slots_[pc];
+        }
+
+        /**
+         * @brief Count taken loop back-edges
+         */
+        void record_backedge(Size weight = 1) noexcept { backedges_ += weight; }
+
+        [[nodiscard]] const String& name() const noexcept { return name_; }
+        [[nodiscard]] const std::vector<FeedbackSlot>& slots() const noexcept { return slots_; }
+        [[nodiscard]] Size backedges() const noexcept { return backedges_; }
+        [[nodiscard]] Size invocations() const noexcept { return invocations_; }
+
+        /**
+         * @brief Count an activation of the function
+         */
+        void record_invocation() noexcept { ++invocations_; }
+
+        /**
+         * @brief Render the vector as text, one line per executed instruction
+         */
+        [[nodiscard]] String to_string() const;
+
+    private:
+        String name_;
+        std::vector<FeedbackSlot> slots_;
+        Size backedges_ = 0;
+        Size invocations_ = 0;
+    };
+
+    /**
+     * @brief Feedback vectors keyed by prototype identity
+     *
+     * The main chunk is "source@run" and a closure's prototype "source@run#index", where
+     * run is the serial number of the chunk execution and index the prototype's position
+     * in the chunk's prototype table, so chunks sharing a name never share vectors.
+     * Functions the VM cannot attribute to a chunk run fall back to "source:name".
+     * The vector's name() is only a label.
+     */
+    using FeedbackTable = std::unordered_map<String, FeedbackVector>;
+
+}  // namespace rangelua::runtime
@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * @file aot.hpp
+ * @brief Ahead-of-time compilation of bytecode to C++ and loading of the resulting modules
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../../backend/bytecode.hpp"
+#include "../../core/error.hpp"
+#include "../../core/types.hpp"
+#include "baseline_jit.hpp"
+
+namespace rangelua::runtime::jit {
+
+    /**
+     * @brief Version of the interface between generated modules and the runtime
+     *
+     * Bump whenever AotRuntime, AotModuleInfo, HelperId or the helper
+     * signature change; modules built for another version are rejected.
+     */
+    inline constexpr std::uint32_t AOT_ABI_VERSION = 2;
+
+    /**
+     * @brief Entry symbol exported by every generated module
+     */
+    inline constexpr const char* AOT_ENTRY_SYMBOL = "rangelua_aot_module";
+
+    /**
+     * @brief Copies number registers of the running frame into values[register]
+     */
+    using NumberLoad = void (*)(JitFrame* frame,
+                                const std::uint8_t* registers,
+                                std::uint32_t count,
+                                double* values);
+
+    /**
+     * @brief Writes values[register] back to number registers of the running frame
+     */
+    using NumberStore = void (*)(JitFrame* frame,
+                                 const std::uint8_t* registers,
+                                 std::uint32_t count,
+                                 const double* values);
+
+    /**
+     * @brief Runtime services handed to a module when it is bound
+     *
+     * Generated code declares a layout-compatible copy of this structure so it
+     * can be compiled without RangeLua headers.
+     */
+    struct AotRuntime {
+        std::uint32_t abi_version = AOT_ABI_VERSION;
+        std::uint32_t helper_count = 0;
+        const HelperFunction* helpers = nullptr;    // Indexed by HelperId
+        const std::uint64_t* strategies = nullptr;  // Strategy address per opcode
+        NumberLoad load_numbers = nullptr;
+        NumberStore store_numbers = nullptr;
+    };
+
+    /**
+     * @brief One compiled prototype inside a module
+     */
+    struct AotPrototype {
+        const std::uint32_t* instructions = nullptr;  // Bytecode the code was generated from
+        std::uint32_t instruction_count = 0;
+        EntryPoint entry = nullptr;
+    };
+
+    /**
+     * @brief Table returned by a module's entry symbol
+     */
+    struct AotModuleInfo {
+        std::uint32_t abi_version = 0;
+        std::uint32_t prototype_count = 0;
+        const AotPrototype* prototypes = nullptr;
+    };
+
+    /**
+     * @brief Translates bytecode into a C++ translation unit
+     *
+     * Each prototype becomes one C++ function with the baseline JIT's entry
+     * point signature. Most instructions call the same helper stencils the JIT
+     * uses (through the table passed at bind time), jumps become gotos, and a
+     * switch over the pc replaces the JIT's address table, so compiled modules
+     * behave exactly like the interpreter.
+     *
+     * Runs of statically typed arithmetic (ADDF, SUBF, MULF, DIVF), optionally
+     * closed by EQF, LTF, LEF or a numeric FORLOOP, become straight-line C++ on
+     * doubles. Their registers are loaded into locals once, at the start of the
+     * run, and stored back before it branches or falls through to a helper.
+     * A jump into the middle of a run lands on helper calls for its remainder.
+     */
+    class AotCompiler {
+    public:
+        /**
+         * @brief Emit a module for a main chunk and all of its nested prototypes
+         */
+        [[nodiscard]] static String emit(const backend::BytecodeFunction& main,
+                                         const String& source_name);
+
+    private:
+        static void emit_prototype(String& out,
+                                   Size index,
+                                   const String& name,
+                                   const std::vector<Instruction>& instructions);
+    };
+
+    /**
+     * @brief A loaded AOT module
+     *
+     * Prototypes are matched against running functions by their exact
+     * instruction stream, so a module built from a different version of a
+     * script is simply not used. Modules stay mapped for the lifetime of the
+     * process: closures may keep pointing into their code.
+     */
+    class AotModule {
+    public:
+        /**
+         * @brief dlopen a module and bind it to the runtime helpers
+         */
+        static Result<std::shared_ptr<const AotModule>> load(const String& path);
+
+        /**
+         * @brief Compiled code for a function body, or nullptr if the module does not contain it
+         */
+        [[nodiscard]] std::shared_ptr<const CompiledFunction>
+        find(const std::vector<Instruction>& instructions) const;
+
+        [[nodiscard]] Size prototype_count() const noexcept { return prototypes_.size(); }
+
+        /**
+         * @brief Form in which instructions are stored in and matched against modules
+         *
+         * Runtime quickening is undone. Statically typed opcodes are kept: the
+         * code generated for them relies on the types they prove.
+         */
+        [[nodiscard]] static Instruction module_instruction(Instruction instruction) noexcept;
+
+    private:
+        struct Entry {
+            const AotPrototype* prototype = nullptr;
+            std::shared_ptr<const CompiledFunction> code;
+        };
+
+        std::vector<Entry> prototypes_;
+        std::unordered_multimap<std::uint64_t, Size> by_fingerprint_;
+    };
+
+}  // namespace rangelua::runtime::jit
@@ -0,0 +1,197 @@
+#pragma once
+
+/**
+ * @file baseline_jit.hpp
+ * @brief Baseline template JIT compiler for x86-64
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+
+#include "../../backend/bytecode.hpp"
+#include "../../core/error.hpp"
+#include "../../core/types.hpp"
+#include "code_arena.hpp"
+
+namespace rangelua::runtime {
+
+    class VirtualMachine;
+    class Value;
+    class IInstructionStrategy;
+    class InstructionStrategyRegistry;
+
+    namespace jit {
+
+        /**
+         * @brief Per-activation state shared between compiled code and its helpers
+         */
+        struct JitFrame {
+            VirtualMachine* vm = nullptr;
+            Size depth = 0;                // Call stack depth the compiled frame runs at
+            Status status{};               // Error status reported by a strategy
+            std::exception_ptr exception;  // Exception captured inside a helper
+        };
+
+        /**
+         * @brief Native entry point: runs from start_pc, returns the pc to resume at or -1
+         */
+        using EntryPoint = std::int64_t (*)(JitFrame* frame, std::int64_t start_pc);
+
+        /**
+         * @brief Helper stencil signature (see JitHelpers)
+         */
+        using HelperFunction = std::int64_t (*)(JitFrame* frame, std::uint64_t strategy,
+                                                std::uint32_t instruction, std::uint32_t pc);
+
+        /**
+         * @brief Helper stencils by index
+         *
+         * The order is part of the AOT module ABI: generated code indexes the
+         * helper table it receives when bound.
+         */
+        enum class HelperId : std::uint8_t {
+            Generic,
+            Move,
+            LoadInteger,
+            LoadFloat,
+            LoadFalse,
+            LoadTrue,
+            Test,
+            Add,
+            Sub,
+            Mul,
+            Div,
+            Eq,
+            Lt,
+            Le,
+            ForLoop,
+            Count
+        };
+
+        /**
+         * @brief Helper for an instruction and the extra pc it may branch to (-1 if none)
+         */
+        struct Stencil {
+            HelperId helper = HelperId::Generic;
+            std::int64_t alternate = -1;
+        };
+
+        /**
+         * @brief Select the stencil for the instruction at pc
+         */
+        [[nodiscard]] Stencil select_stencil(OpCode op, Instruction instruction, Size pc) noexcept;
+
+        /**
+         * @brief Address of a helper stencil
+         */
+        [[nodiscard]] HelperFunction helper_address(HelperId id) noexcept;
+
+        /**
+         * @brief Machine code for one bytecode function
+         */
+        struct CompiledFunction {
+            EntryPoint entry = nullptr;
+            Size instruction_count = 0;
+            Size code_size = 0;
+        };
+
+        /**
+         * @brief Counters for the baseline JIT
+         */
+        struct JitStats {
+            Size compiled = 0;    // Functions compiled to native code
+            Size code_bytes = 0;  // Machine code emitted
+        };
+
+        /**
+         * @brief Translates bytecode into call-threaded x86-64 code
+         *
+         * Every instruction becomes a direct call to a helper stencil with its
+         * operands baked in as immediates; jumps, loop back-edges and conditional
+         * skips become native branches, which removes fetch/decode and strategy
+         * lookup from the hot path. Instructions without a dedicated stencil call
+         * their interpreter strategy, so semantics stay identical to the interpreter.
+         */
+        class BaselineCompiler {
+        public:
+            explicit BaselineCompiler(const InstructionStrategyRegistry& registry);
+
+            /**
+             * @brief Compile a function
+             * @return Compiled code, or nullptr if the function cannot be compiled
+             */
+            [[nodiscard]] std::shared_ptr<const CompiledFunction>
+            compile(const backend::BytecodeFunction& function);
+
+            [[nodiscard]] const JitStats& stats() const noexcept { return stats_; }
+
+        private:
+            const InstructionStrategyRegistry& registry_;
+            CodeArena arena_;
+            JitStats stats_;
+        };
+
+        /**
+         * @brief Helper stencils called from compiled code
+         *
+         * All helpers share the signature
+         * `std::int64_t (JitFrame*, std::uint64_t strategy, std::uint32_t instruction, std::uint32_t pc)`
+         * and return the next pc, or -1 when the compiled frame has to be left
+         * (return, error, state change). They never let exceptions escape into
+         * native code.
+         */
+        struct JitHelpers {
+            static std::int64_t execute_generic(JitFrame* jf, std::uint64_t strategy,
+                                                std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t move(JitFrame* jf, std::uint64_t strategy,
+                                     std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t load_integer(JitFrame* jf, std::uint64_t strategy,
+                                             std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t load_float(JitFrame* jf, std::uint64_t strategy,
+                                           std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t load_false(JitFrame* jf, std::uint64_t strategy,
+                                           std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t load_true(JitFrame* jf, std::uint64_t strategy,
+                                          std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t test(JitFrame* jf, std::uint64_t strategy,
+                                     std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t add(JitFrame* jf, std::uint64_t strategy,
+                                    std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t sub(JitFrame* jf, std::uint64_t strategy,
+                                    std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t mul(JitFrame* jf, std::uint64_t strategy,
+                                    std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t div(JitFrame* jf, std::uint64_t strategy,
+                                    std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t eq(JitFrame* jf, std::uint64_t strategy,
+                                   std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t lt(JitFrame* jf, std::uint64_t strategy,
+                                   std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t le(JitFrame* jf, std::uint64_t strategy,
+                                   std::uint32_t instruction, std::uint32_t pc);
+            static std::int64_t for_loop(JitFrame* jf, std::uint64_t strategy,
+                                         std::uint32_t instruction, std::uint32_t pc);
+
+            // Register transfer for the straight-line number code of AOT modules (see AotRuntime)
+            static void load_numbers(JitFrame* jf, const std::uint8_t* registers,
+                                     std::uint32_t count, double* values);
+            static void store_numbers(JitFrame* jf, const std::uint8_t* registers,
+                                      std::uint32_t count, const double* values);
+
+        private:
+            template <typename Op>
+            static std::int64_t arithmetic(JitFrame* jf, std::uint64_t strategy,
+                                           std::uint32_t instruction, std::uint32_t pc, Op op);
+            template <typename Op>
+            static std::int64_t compare(JitFrame* jf, std::uint64_t strategy,
+                                        std::uint32_t instruction, std::uint32_t pc, Op op);
+            static std::int64_t resume_point(JitFrame* jf);
+            static Value* registers(JitFrame* jf, std::uint32_t pc, Size highest);
+            static void touch(JitFrame* jf, Size reg);
+        };
+
+    }  // namespace jit
+
+}  // namespace rangelua::runtime
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file code_arena.hpp
+ * @brief Executable memory arena for JIT-compiled code
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "../../core/types.hpp"
+
+namespace rangelua::runtime::jit {
+
+    /**
+     * @brief mmap-backed arena for native code with W^X protection
+     *
+     * Pages are never writable and executable at the same time: a chunk is
+     * switched to read/write for the duration of begin_write()/end_write()
+     * and back to read/execute afterwards.
+     */
+    class CodeArena {
+    public:
+        explicit CodeArena(Size chunk_size = 64 * 1024);
+        ~CodeArena();
+
+        // Non-copyable, non-movable (hands out raw code pointers)
+        CodeArena(const CodeArena&) = delete;
+        CodeArena& operator=(const CodeArena&) = delete;
+        CodeArena(CodeArena&&) = delete;
+        CodeArena& operator=(CodeArena&&) = delete;
+
+        /**
+         * @brief Reserve space and make it writable
+         * @return Destination for size bytes, or nullptr if memory is unavailable
+         */
+        [[nodiscard]] std::uint8_t* begin_write(Size size);
+
+        /**
+         * @brief Seal the region returned by begin_write() as executable
+         * @return false if the region could not be made executable
+         */
+        [[nodiscard]] bool end_write(std::uint8_t* code, Size size);
+
+        /**
+         * @brief Total bytes of code installed
+         */
+        [[nodiscard]] Size used_bytes() const noexcept { return used_bytes_; }
+
+    private:
+        struct Chunk {
+            std::uint8_t* base = nullptr;
+            Size size = 0;
+            Size used = 0;
+        };
+
+        Size chunk_size_;
+        Size used_bytes_ = 0;
+        std::vector<Chunk> chunks_;
+        Chunk* writing_ = nullptr;
+
+        static bool protect(const Chunk& chunk, bool writable) noexcept;
+    };
+
+}  // namespace rangelua::runtime::jit
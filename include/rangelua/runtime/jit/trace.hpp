@@ -0,0 +1,230 @@
+#pragma once
+
+/**
+ * @file trace.hpp
+ * @brief Loop trace recorder, trace IR and trace executor
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../../core/instruction.hpp"
+#include "../../core/types.hpp"
+#include "../value.hpp"
+
+namespace rangelua::backend {
+    struct BytecodeFunction;
+}
+
+namespace rangelua::runtime {
+
+    class IVMContext;
+
+    namespace jit {
+
+        /**
+         * @brief Reference to an IR instruction (its index in Trace::ir)
+         */
+        using IrRef = std::uint16_t;
+        inline constexpr IrRef IR_NONE = std::numeric_limits<IrRef>::max();
+
+        /**
+         * @brief Trace IR operations
+         *
+         * Values are unboxed: numbers and booleans live in plain doubles and only
+         * tables and functions are kept as boxed Values. Every guard carries the
+         * snapshot to restore when it fails.
+         */
+        enum class IrOp : std::uint8_t {
+            SLoad,        // Load stack slot `slot` (guard: type)
+            KNum,         // Number constant
+            KBool,        // Boolean constant
+            Add,          // a + b
+            Sub,          // a - b
+            Mul,          // a * b
+            Div,          // a / b
+            Unm,          // -a
+            Not,          // not a
+            ArrayGet,     // a[b] (guard: plain table, index in array part, element type)
+            ArraySet,     // a[b] = c (guard: index in array part)
+            GuardLt,      // (a < b) == expected
+            GuardLe,      // (a <= b) == expected
+            GuardEq,      // (a == b) == expected
+            GuardTruthy,  // truthy(a) == expected
+            GuardCallee,  // a is the function `object`
+            LoopTest,     // Leave when a numeric for loop with index a, limit b, step c is done
+        };
+
+        /**
+         * @brief One IR instruction in SSA form
+         */
+        struct IrInstruction {
+            IrOp op = IrOp::KNum;
+            ValueType type = ValueType::Number;  // Result type (guarded for loads)
+            bool expected = false;               // Expected guard outcome
+            IrRef a = IR_NONE;
+            IrRef b = IR_NONE;
+            IrRef c = IR_NONE;
+            std::uint16_t snapshot = 0;  // Exit taken when a guard fails
+            Register slot = 0;           // SLoad source slot
+            Number number = 0;           // KNum/KBool payload
+            const void* object = nullptr;  // GuardCallee identity
+
+            [[nodiscard]] bool is_guard() const noexcept;
+        };
+
+        /**
+         * @brief Stack slot to restore on a side exit
+         */
+        struct SnapshotEntry {
+            Register slot = 0;
+            IrRef ref = IR_NONE;
+            bool carried = false;  // Value of the previous iteration; skipped on the first one
+        };
+
+        /**
+         * @brief Interpreter state to reconstruct when leaving a trace
+         */
+        struct Snapshot {
+            Size pc = 0;  // Bytecode pc to resume at
+            std::vector<SnapshotEntry> entries;
+        };
+
+        /**
+         * @brief A compiled loop trace
+         *
+         * ir[0, body_start) runs once on entry (slot loads and loop-invariant code),
+         * ir[body_start, end) runs once per iteration. Loop-carried values flow
+         * through phis, copied at the end of every iteration.
+         */
+        struct Trace {
+            Size loop_pc = 0;   // FORLOOP closing the loop
+            Size start_pc = 0;  // First instruction of the loop body
+            std::vector<IrInstruction> ir;
+            IrRef body_start = 0;
+            std::vector<Snapshot> snapshots;          // snapshots[0] is the trace entry
+            std::vector<std::pair<IrRef, IrRef>> phis;  // (loop-carried load, value at iteration end)
+            Size max_slot = 0;
+
+            // Optimization counters
+            Size recorded_instructions = 0;
+            Size inlined_calls = 0;
+            Size folded = 0;
+            Size hoisted = 0;
+
+            [[nodiscard]] String to_string() const;
+        };
+
+        /**
+         * @brief Hotness, blacklist and trace for one loop
+         */
+        struct TraceCacheEntry {
+            Size hits = 0;
+            Size side_exits = 0;
+            bool blacklisted = false;
+            std::shared_ptr<const Trace> trace;
+        };
+
+        /**
+         * @brief Per-closure loop trace cache, keyed by FORLOOP pc
+         */
+        struct TraceCache {
+            std::unordered_map<Size, TraceCacheEntry> loops;
+        };
+
+        /**
+         * @brief Counters for the tracing tier
+         */
+        struct TraceStats {
+            Size recorded = 0;    // Traces compiled
+            Size aborted = 0;     // Recordings given up
+            Size entered = 0;     // Trace executions
+            Size side_exits = 0;  // Exits before the loop finished
+        };
+
+        /**
+         * @brief Records one iteration of a hot loop as the interpreter runs it
+         *
+         * The VM feeds every executed instruction (including those of called Lua
+         * functions) to record(); once the closing FORLOOP is reached, compile()
+         * turns the recording into optimized trace IR.
+         */
+        class TraceRecorder {
+        public:
+            enum class State { Recording, Completed, Aborted };
+
+            TraceRecorder(const backend::BytecodeFunction* function,
+                          Size depth,
+                          Size loop_pc,
+                          Size start_pc,
+                          Size max_length);
+
+            /**
+             * @brief Record an instruction before it executes
+             * @param registers Register window of the executing frame
+             */
+            State record(IVMContext& context,
+                         Size depth,
+                         Size pc,
+                         Instruction instruction,
+                         const Value* registers,
+                         Size register_count);
+
+            /**
+             * @brief Build the trace IR
+             * @return Trace, or nullptr if the recording contains unsupported operations
+             */
+            [[nodiscard]] std::shared_ptr<const Trace> compile() const;
+
+            [[nodiscard]] Size loop_pc() const noexcept { return loop_pc_; }
+            [[nodiscard]] Size depth() const noexcept { return depth_; }
+
+        private:
+            struct Step {
+                Size pc = 0;
+                Instruction instruction = 0;
+                Size level = 0;     // 0: loop frame, 1: inlined callee
+                Value operands[3];  // R[A], R[B], R[C] before execution
+                Value constant;     // K operand, if any
+            };
+
+            const backend::BytecodeFunction* function_;
+            Size depth_;
+            Size loop_pc_;
+            Size start_pc_;
+            Size max_length_;
+            std::vector<Step> steps_;
+
+            friend class TraceBuilder;
+        };
+
+        /**
+         * @brief Scratch storage reused across trace executions
+         */
+        struct TraceScratch {
+            std::vector<Number> numbers;
+            std::vector<Value> objects;
+            std::vector<Number> phi_numbers;
+            std::vector<Value> phi_objects;
+        };
+
+        /**
+         * @brief Where a trace left the loop
+         */
+        struct TraceExit {
+            Size pc = 0;
+            bool side_exit = false;  // Left before the loop finished
+        };
+
+        /**
+         * @brief Run a trace on the register window of the loop's frame
+         */
+        TraceExit execute_trace(const Trace& trace, Value* registers, TraceScratch& scratch);
+
+    }  // namespace jit
+
+}  // namespace rangelua::runtime
@@ -0,0 +1,96 @@
+#pragma once
+
+/**
+ * @file x64_assembler.hpp
+ * @brief Minimal x86-64 machine code emitter for the baseline JIT
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "../../core/types.hpp"
+
+namespace rangelua::runtime::jit {
+
+    /**
+     * @brief Position in the code buffer that jumps can target
+     */
+    struct Label {
+        Size id = 0;
+    };
+
+    /**
+     * @brief Emits the handful of x86-64 instructions the baseline JIT templates use
+     *
+     * Code is position independent except for the absolute addresses written
+     * by emit_address_table(), which are resolved in relocate().
+     */
+    class X64Assembler {
+    public:
+        [[nodiscard]] Label new_label();
+        void bind(Label label);
+
+        // Prologue/epilogue: preserve rbx, r12, r13 and keep rsp 16-byte aligned
+        void push_callee_saved();
+        void pop_callee_saved_and_return();
+
+        void mov_r12_rdi();                       // r12 := rdi (context pointer)
+        void mov_rdi_r12();                       // rdi := r12
+        void mov_rax_rsi();                       // rax := rsi
+        void mov_rsi_imm64(std::uint64_t value);  // rsi := imm64
+        void mov_edx_imm32(std::uint32_t value);  // edx := imm32
+        void mov_ecx_imm32(std::uint32_t value);  // ecx := imm32
+        void mov_rax_imm64(std::uint64_t value);  // rax := imm64
+        void call_rax();
+        void test_rax_rax();
+        void cmp_rax_imm32(std::int32_t value);
+
+        void jmp(Label target);
+        void je(Label target);
+        void jne(Label target);
+        void js(Label target);
+        void jae(Label target);
+
+        /**
+         * @brief jmp qword [table + rax*8]
+         */
+        void jmp_table_indexed_by_rax(Label table);
+
+        /**
+         * @brief Emit an 8-byte aligned table of absolute label addresses
+         */
+        void emit_address_table(Label table, const std::vector<Label>& entries);
+
+        /**
+         * @brief Resolve absolute addresses once the final load address is known
+         */
+        void relocate(std::uint8_t* load_address) const;
+
+        [[nodiscard]] const std::vector<std::uint8_t>& code() const noexcept { return code_; }
+        [[nodiscard]] Size size() const noexcept { return code_.size(); }
+
+    private:
+        struct Fixup {
+            Size position;  // Offset of the rel32 field
+            Size label;
+        };
+
+        struct AbsoluteFixup {
+            Size position;  // Offset of the 8-byte address field
+            Size label;
+        };
+
+        std::vector<std::uint8_t> code_;
+        std::vector<std::int64_t> labels_;  // Bound offsets, -1 while unbound
+        std::vector<Fixup> fixups_;
+        std::vector<AbsoluteFixup> absolute_fixups_;
+
+        void emit8(std::uint8_t byte) { code_.push_back(byte); }
+        void emit32(std::uint32_t value);
+        void emit64(std::uint64_t value);
+        void emit_rel32(Label target);
+        void patch32(Size position, std::uint32_t value);
+    };
+
+}  // namespace rangelua::runtime::jit
@@ -13,7 +13,9 @@
  * - Coroutine: Lua coroutines/threads
  */
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <typeinfo>
 #include <unordered_map>
 #include <utility>
@@ -23,9 +25,36 @@
 #include "gc.hpp"  // Include full GC system
 #include "value.hpp"  // Include full Value definition for hash support
 
+namespace rangelua::backend {
+    class DeferredBody;
+}
+
 namespace rangelua::runtime {
 
     class IVMContext;  // Forward declaration
+    class FeedbackVector;
+
+    namespace jit {
+        struct CompiledFunction;
+        struct TraceCache;
+    }
+
+    /**
+     * @brief Thread-wide counter of mutations that loop-invariant caches depend on
+     *
+     * Bumped by hash-part table writes, metatable changes, upvalue writes,
+     * metamethod calls and coroutine switches. A value cached by the optimizer's
+     * loop-invariant code motion (OP_HOISTGET) is reused only while the epoch it
+     * was computed at is still current.
+     */
+    class MutationEpoch {
+    public:
+        [[nodiscard]] static std::uint64_t current() noexcept { return value_; }
+        static void bump() noexcept { ++value_; }
+
+    private:
+        static inline thread_local std::uint64_t value_ = 0;
+    };
 
     /**
      * @brief Lua table implementation
@@ -168,6 +197,33 @@ namespace rangelua::runtime {
         bool isOpen_;
     };
 
+    /**
+     * @brief Warm-up and back-off state of one instruction that can be quickened
+     */
+    struct QuickeningSite {
+        std::uint32_t matches = 0;  // Consecutive observations that fit the specialized form
+        std::uint32_t deopts = 0;   // Guard misses so far; each doubles the warm-up
+    };
+
+    /**
+     * @brief Runtime state of a function prototype, shared by every closure created from it
+     *
+     * A chunk run creates one per prototype the first time CLOSURE instantiates
+     * it, so closures of the same prototype share native code and call counts,
+     * while running a chunk again starts from fresh state.
+     */
+    struct PrototypeState {
+        static constexpr Size npos = static_cast<Size>(-1);
+
+        Size chunk = 0;     // Serial number of the chunk run that owns the prototype
+        Size index = npos;  // Index in that chunk's prototype table (npos: no prototype)
+        std::shared_ptr<const jit::CompiledFunction> compiled_code;  // Baseline JIT or AOT code
+        Size call_count = 0;
+        bool jit_failed = false;  // The baseline JIT could not compile it; not retried
+        std::vector<QuickeningSite> quickening_sites;  // By PC (grown on demand)
+        FeedbackVector* feedback = nullptr;  // Type feedback, owned by the VM (profiling only)
+    };
+
     /**
      * @brief Lua function implementation
      *
@@ -202,6 +258,10 @@ namespace rangelua::runtime {
         [[nodiscard]] bool isVararg() const noexcept;
         void setVararg(bool vararg) noexcept;
 
+        // Registers a call frame needs (0 if unknown)
+        [[nodiscard]] Size stackSize() const noexcept;
+        void setStackSize(Size size) noexcept;
+
         // C function access
         [[nodiscard]] bool isCFunction() const noexcept;
         [[nodiscard]] const CFunction& cFunction() const;
@@ -209,8 +269,20 @@ namespace rangelua::runtime {
         // Lua function access
         [[nodiscard]] bool isLuaFunction() const noexcept;
         [[nodiscard]] const std::vector<Instruction>& bytecode() const;
+        void patchInstruction(Size index, Instruction instruction) noexcept;
         [[nodiscard]] const std::vector<Size>& lineInfo() const;
 
+        // Lazy compilation: a closure over a deferred prototype has no bytecode until the VM
+        // compiles the body on its first call and installs it with setBody()
+        [[nodiscard]] const std::shared_ptr<const backend::DeferredBody>&
+        deferredBody() const noexcept {
+            return deferred_body_;
+        }
+        void setDeferredBody(std::shared_ptr<const backend::DeferredBody> body) noexcept {
+            deferred_body_ = std::move(body);
+        }
+        void setBody(std::vector<Instruction> bytecode, std::vector<Size> line_info);
+
         // Constant management
         void addConstant(const Value& constant);
         [[nodiscard]] const std::vector<Value>& constants() const;
@@ -241,10 +313,39 @@ namespace rangelua::runtime {
         [[nodiscard]] const String& getSource() const { return source_; }
         [[nodiscard]] Size getLineDefined() const;
 
+        // State shared with the other closures of the same prototype; a function not
+        // created by CLOSURE gets a state of its own on first use
+        [[nodiscard]] const PrototypeState* prototype() const noexcept {
+            return prototype_state_.get();
+        }
+        [[nodiscard]] PrototypeState& prototypeState() {
+            if (!prototype_state_) {
+                prototype_state_ = std::make_shared<PrototypeState>();
+            }
+            return *prototype_state_;
+        }
+        void setPrototypeState(std::shared_ptr<PrototypeState> state) noexcept {
+            prototype_state_ = std::move(state);
+        }
+
+        // Baseline JIT support (kept in the prototype state)
+        [[nodiscard]] const std::shared_ptr<const jit::CompiledFunction>& compiledCode() const noexcept {
+            static const std::shared_ptr<const jit::CompiledFunction> none;
+            return prototype_state_ ? prototype_state_->compiled_code : none;
+        }
+        void setCompiledCode(std::shared_ptr<const jit::CompiledFunction> code) {
+            prototypeState().compiled_code = std::move(code);
+        }
+        Size recordCall() { return ++prototypeState().call_count; }
+
+        // Loop traces recorded for this closure (created on first use)
+        [[nodiscard]] std::shared_ptr<jit::TraceCache>& traceCache() noexcept { return trace_cache_; }
+
     private:
         Type type_;
         Size parameterCount_ = 0;
         bool isVararg_ = false;
+        Size stackSize_ = 0;
 
         // C function data
         CFunction cFunction_;
@@ -254,6 +355,7 @@ namespace rangelua::runtime {
         std::vector<Instruction> bytecode_;
         std::vector<Value> constants_;
         std::vector<Size> line_info_;
+        std::shared_ptr<const backend::DeferredBody> deferred_body_;
 
         // Upvalues (for closures)
         std::vector<GCPtr<Upvalue>> upvalues_;
@@ -262,6 +364,9 @@ namespace rangelua::runtime {
         String name_;
         String source_;
         [[maybe_unused]] Size lineNumber_ = 0;
+
+        std::shared_ptr<PrototypeState> prototype_state_;
+        std::shared_ptr<jit::TraceCache> trace_cache_;
     };
 
     /**
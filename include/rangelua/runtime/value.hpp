@@ -99,7 +99,10 @@ namespace rangelua::runtime {
         ~Value() = default;
 
         // Type queries
-        [[nodiscard]] ValueType type() const noexcept;
+        [[nodiscard]] ValueType type() const noexcept {
+            // The alternatives are declared in ValueType order
+            return static_cast<ValueType>(data_.index());
+        }
         [[nodiscard]] int type_id() const noexcept { return static_cast<int>(type()); }
 
         // For concept compatibility - provide type() that returns int
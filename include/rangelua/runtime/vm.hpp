@@ -14,9 +14,14 @@
 
 #include "../backend/bytecode.hpp"
 #include "../core/concepts.hpp"
+#include "../core/config.hpp"
 #include "../core/error.hpp"
 #include "../core/types.hpp"
 #include "environment.hpp"
+#include "feedback.hpp"
+#include "jit/aot.hpp"
+#include "jit/baseline_jit.hpp"
+#include "jit/trace.hpp"
 #include "memory.hpp"
 #include "value.hpp"
 #include "vm/instruction_strategy.hpp"
@@ -26,13 +31,29 @@ namespace rangelua::runtime {
     // Forward declarations for strategy pattern
     class InstructionStrategyRegistry;
 
+    /**
+     * @brief Loop-invariant cache entry of a call frame (OP_HOISTGET / OP_HOISTSET)
+     */
+    struct InvariantSlot {
+        Value value;
+        std::uint64_t epoch = 0;    // MutationEpoch the value was computed at
+        std::uint64_t pending = 0;  // Epoch recorded by the HOISTGET that missed
+        bool valid = false;
+    };
+
     /**
      * @brief Call frame for function calls
      */
     struct CallFrame {
         const backend::BytecodeFunction* function = nullptr;
-        std::unique_ptr<const backend::BytecodeFunction> owned_function; // Owns the function if created on the fly
+        std::unique_ptr<backend::BytecodeFunction> owned_function;  // Owns the function if created on the fly
         GCPtr<Function> closure{};                                       // Closure for upvalue access (default constructed to empty)
+        FeedbackVector* feedback = nullptr;  // Type feedback sink (only when profiling is enabled)
+        const jit::CompiledFunction* compiled = nullptr;  // Native code of the closure's prototype
+        Size backedge_counter = 0;                        // Loop iterations seen by the interpreter
+        std::vector<InvariantSlot> invariant_slots;       // Loop-invariant cache (grown on demand)
+        std::vector<std::shared_ptr<PrototypeState>> prototype_states;  // By prototype index
+        Size chunk = 0;  // Serial number given to the frame when it first instantiates a prototype
         Size instruction_pointer = 0;
         Size stack_base = 0;
         Size local_count = 0;
@@ -82,9 +103,44 @@ namespace rangelua::runtime {
         Size call_stack_size = 256;
         Size max_recursion_depth = 1000;
         bool enable_debugging = false;
-        bool enable_profiling = false;
+        bool enable_profiling = false;  // Collect per-instruction type feedback
+        Size profiling_sample_interval = 17;  // Record every Nth instruction (prime: avoids loop aliasing)
         bool enable_tail_call_optimization = true;
         bool enable_computed_goto = true;
+        bool enable_quickening = true;  // Rewrite hot instructions into type-specialized forms
+        Size quickening_warmup = 8;     // Consecutive matching observations before quickening
+        Size quickening_max_deopts = 4;  // Deoptimizations before a site is left generic
+        bool enable_jit = config::ENABLE_JIT;  // Compile hot functions to native code
+        Size jit_call_threshold = 100;         // Calls before a closure is compiled
+        Size jit_backedge_threshold = 1000;    // Loop back-edges before a running frame is compiled
+        bool enable_tracing = true;            // Record and run traces for hot numeric for loops
+        Size trace_hot_threshold = 50;         // Loop iterations before a trace is recorded
+        Size trace_max_length = 400;           // Recorded instructions before recording is abandoned
+        Size trace_max_side_exits = 64;        // Side exits before a trace is discarded
+        bool count_instructions = false;       // Count interpreted instructions and opcode pairs
+    };
+
+    /**
+     * @brief Counters for in-place instruction quickening
+     */
+    struct QuickeningStats {
+        Size quickened = 0;    // Generic instructions rewritten to a specialized form
+        Size deoptimized = 0;  // Specialized instructions reverted after a guard miss
+    };
+
+    /**
+     * @brief Dynamic instruction counts of the interpreter (VMConfig::count_instructions)
+     *
+     * Native tiers (JIT, traces, AOT modules) run without counting. Pairs are
+     * counted over generic opcodes, in execution order across calls.
+     */
+    struct InstructionCounts {
+        static constexpr Size OPCODES = static_cast<Size>(OpCode::NUM_ALL_OPCODES);
+
+        Size executed = 0;
+        std::vector<Size> opcodes = std::vector<Size>(OPCODES);
+        std::vector<Size> pairs = std::vector<Size>(OPCODES * OPCODES);  // [first * OPCODES + second]
+        OpCode previous = OpCode::NUM_OPCODES;  // None yet
     };
 
     /**
@@ -93,6 +149,7 @@ namespace rangelua::runtime {
     class VirtualMachine : public IVMContext {
         friend class ExecutionContext;
         friend class VMDebugger;
+        friend struct jit::JitHelpers;
 
     public:
         explicit VirtualMachine(VMConfig config = {});
@@ -229,6 +286,14 @@ namespace rangelua::runtime {
          */
         void set_instruction_pointer(Size ip) noexcept override;
 
+        /**
+         * @brief Rewrite the currently executing instruction (quickening/deoptimization)
+         */
+        bool patch_current_instruction(Instruction instruction) noexcept override;
+        bool observe_quickening(bool matched) override;
+        [[nodiscard]] InvariantSlot& invariant_slot(Size index) override;
+        [[nodiscard]] std::shared_ptr<PrototypeState> prototype_state(Size index) override;
+
         /**
          * @brief Adjust instruction pointer by offset
          */
@@ -264,7 +329,7 @@ namespace rangelua::runtime {
         /**
          * @brief Setup call frame for a bytecode function, taking ownership
          */
-        Status setup_call_frame(std::unique_ptr<const backend::BytecodeFunction> function, GCPtr<Function> closure, Size arg_count, Size stack_base);
+        Status setup_call_frame(std::unique_ptr<backend::BytecodeFunction> function, GCPtr<Function> closure, Size arg_count, Size stack_base);
 
         /**
          * @brief Return from function
@@ -319,6 +384,55 @@ namespace rangelua::runtime {
          */
         [[nodiscard]] const VMConfig& config() const noexcept { return config_; }
 
+        /**
+         * @brief Get quickening counters
+         */
+        [[nodiscard]] const QuickeningStats& quickening_stats() const noexcept {
+            return quickening_stats_;
+        }
+
+        /**
+         * @brief Get baseline JIT counters
+         */
+        [[nodiscard]] jit::JitStats jit_stats() const noexcept {
+            return jit_compiler_ ? jit_compiler_->stats() : jit::JitStats{};
+        }
+
+        /**
+         * @brief Get loop tracing counters
+         */
+        [[nodiscard]] const jit::TraceStats& trace_stats() const noexcept { return trace_stats_; }
+
+        /**
+         * @brief Load an ahead-of-time compiled module
+         *
+         * Closures whose code is found in the module run it from their first
+         * call on; everything else keeps the interpreter and JIT tiers.
+         */
+        Status load_aot_module(const String& path);
+
+        /**
+         * @brief Get collected type feedback, keyed by prototype
+         */
+        [[nodiscard]] const FeedbackTable& feedback() const noexcept { return feedback_; }
+
+        /**
+         * @brief Render all collected type feedback as text
+         */
+        [[nodiscard]] String dump_feedback() const;
+
+        /**
+         * @brief Get dynamic instruction counts (requires count_instructions)
+         */
+        [[nodiscard]] const InstructionCounts& instruction_counts() const noexcept {
+            return instruction_counts_;
+        }
+
+        /**
+         * @brief Render the instruction total and the most frequent opcodes and opcode pairs
+         */
+        [[nodiscard]] String dump_instruction_counts(Size top = 12) const;
+
         /**
          * @brief Get global table from environment
          */
@@ -369,11 +483,36 @@ namespace rangelua::runtime {
         // Current execution context
         Size stack_top_ = 0;
         ErrorCode last_error_ = ErrorCode::SUCCESS;
+        QuickeningStats quickening_stats_;
+        InstructionCounts instruction_counts_;
+        FeedbackTable feedback_;
+        Size feedback_countdown_ = 1;
+        Size chunk_count_ = 0;  // Chunk runs that have instantiated prototypes
+        std::unique_ptr<jit::BaselineCompiler> jit_compiler_;  // Created on first tier-up
+        std::shared_ptr<const jit::AotModule> aot_module_;      // Loaded with load_aot_module
+        std::unique_ptr<jit::TraceRecorder> trace_recorder_;    // Active while a loop is recorded
+        std::shared_ptr<jit::TraceCache> recording_cache_;      // Cache of the loop being recorded
+        jit::TraceScratch trace_scratch_;
+        jit::TraceStats trace_stats_;
         Value error_obj_{};  // Stores the current error object
 
         // Instruction execution methods
         Status execute_instruction(OpCode opcode, Instruction instruction);
 
+        // Type feedback collection
+        FeedbackVector& feedback_vector_for(const backend::BytecodeFunction& function,
+                                            const GCPtr<Function>& closure);
+        void record_feedback(CallFrame& frame, Instruction instruction);
+
+        // Baseline JIT
+        const jit::CompiledFunction* compile_frame(CallFrame& frame);
+        Status run_compiled(CallFrame& frame);
+
+        // Loop tracing
+        void count_backedge(CallFrame& frame);
+        void record_trace_step(CallFrame& frame, Instruction instruction);
+        void on_loop_backedge(CallFrame& frame, Size loop_pc);
+
         // Stack operations
         void ensure_stack_size(Size size);
 
@@ -21,6 +21,7 @@
 #include "upvalue_strategies.hpp"
 #include "global_strategies.hpp"
 #include "misc_strategies.hpp"
+#include "quickened_strategies.hpp"
 
 namespace rangelua::runtime {
 
@@ -203,6 +203,54 @@ namespace rangelua::runtime {
         Status execute_impl(IVMContext& context, Instruction instruction) override;
     };
 
+    /**
+     * @brief Strategy for OP_ADDF instruction
+     * R[A] := R[B] + R[C] (operands proven to be numbers)
+     */
+    class AddFStrategy : public InstructionStrategyBase<OpCode::OP_ADDF> {
+    public:
+        const char* name() const noexcept override { return "ADDF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_SUBF instruction
+     * R[A] := R[B] - R[C] (operands proven to be numbers)
+     */
+    class SubFStrategy : public InstructionStrategyBase<OpCode::OP_SUBF> {
+    public:
+        const char* name() const noexcept override { return "SUBF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_MULF instruction
+     * R[A] := R[B] * R[C] (operands proven to be numbers)
+     */
+    class MulFStrategy : public InstructionStrategyBase<OpCode::OP_MULF> {
+    public:
+        const char* name() const noexcept override { return "MULF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_DIVF instruction
+     * R[A] := R[B] / R[C] (operands proven to be numbers)
+     */
+    class DivFStrategy : public InstructionStrategyBase<OpCode::OP_DIVF> {
+    public:
+        const char* name() const noexcept override { return "DIVF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
     /**
      * @brief Factory for creating arithmetic operation strategies
      */
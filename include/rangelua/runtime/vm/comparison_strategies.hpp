@@ -143,6 +143,78 @@ namespace rangelua::runtime {
         Status execute_impl(IVMContext& context, Instruction instruction) override;
     };
 
+    /**
+     * @brief Strategy for OP_EQF instruction
+     * if ((R[A] == R[B]) ~= k) then pc++ (operands proven to be numbers)
+     */
+    class EqFStrategy : public InstructionStrategyBase<OpCode::OP_EQF> {
+    public:
+        const char* name() const noexcept override { return "EQF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_LTF instruction
+     * if ((R[A] < R[B]) ~= k) then pc++ (operands proven to be numbers)
+     */
+    class LtFStrategy : public InstructionStrategyBase<OpCode::OP_LTF> {
+    public:
+        const char* name() const noexcept override { return "LTF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_LEF instruction
+     * if ((R[A] <= R[B]) ~= k) then pc++ (operands proven to be numbers)
+     */
+    class LeFStrategy : public InstructionStrategyBase<OpCode::OP_LEF> {
+    public:
+        const char* name() const noexcept override { return "LEF"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_EQJMP superinstruction
+     * if not (R[A] == R[B]) then pc += C
+     */
+    class EqJmpStrategy : public InstructionStrategyBase<OpCode::OP_EQJMP> {
+    public:
+        const char* name() const noexcept override { return "EQJMP"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_LTJMP superinstruction
+     * if not (R[A] < R[B]) then pc += C
+     */
+    class LtJmpStrategy : public InstructionStrategyBase<OpCode::OP_LTJMP> {
+    public:
+        const char* name() const noexcept override { return "LTJMP"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_LEJMP superinstruction
+     * if not (R[A] <= R[B]) then pc += C
+     */
+    class LeJmpStrategy : public InstructionStrategyBase<OpCode::OP_LEJMP> {
+    public:
+        const char* name() const noexcept override { return "LEJMP"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
     /**
      * @brief Factory for creating comparison operation strategies
      */
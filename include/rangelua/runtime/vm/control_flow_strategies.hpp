@@ -35,6 +35,18 @@ namespace rangelua::runtime {
         Status execute_impl(IVMContext& context, Instruction instruction) override;
     };
 
+    /**
+     * @brief Strategy for OP_MOVECALL superinstruction
+     * R[A+1] := R[B]; R[A], ... ,R[A+C-2] := R[A](R[A+1])
+     */
+    class MoveCallStrategy : public InstructionStrategyBase<OpCode::OP_MOVECALL> {
+    public:
+        const char* name() const noexcept override { return "MOVECALL"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
     /**
      * @brief Strategy for OP_TAILCALL instruction
      * return R[A](R[A+1], ... ,R[A+B-1])
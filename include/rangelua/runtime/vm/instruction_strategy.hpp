@@ -19,6 +19,8 @@ namespace rangelua::runtime {
     class VirtualMachine;
     class RuntimeMemoryManager;
     class Value;
+    struct InvariantSlot;
+    struct PrototypeState;
 
     /**
      * @brief VM execution context interface for instruction strategies
@@ -45,6 +47,37 @@ namespace rangelua::runtime {
         [[nodiscard]] virtual const backend::BytecodeFunction* current_function() const noexcept = 0;
         [[nodiscard]] virtual Size call_depth() const noexcept = 0;
 
+        /**
+         * @brief Rewrite the currently executing instruction in place
+         *
+         * Used for quickening: a generic instruction is replaced by a type-specialized
+         * variant and replaced back when the specialization's guard fails.
+         * @return true if the instruction stream was updated
+         */
+        virtual bool patch_current_instruction(Instruction instruction) noexcept = 0;
+
+        /**
+         * @brief Record whether the operands of the current instruction fit its specialized form
+         *
+         * @return true once enough consecutive observations matched to quicken it
+         */
+        virtual bool observe_quickening(bool matched) = 0;
+
+        /**
+         * @brief Loop-invariant cache slot of the current call frame
+         *
+         * Slots are created on first use and live as long as the frame.
+         */
+        [[nodiscard]] virtual InvariantSlot& invariant_slot(Size index) = 0;
+
+        /**
+         * @brief State shared by the closures of a prototype of the current function
+         *
+         * Created the first time a prototype is instantiated and kept for as long as
+         * the frame or any of those closures lives.
+         */
+        [[nodiscard]] virtual std::shared_ptr<PrototypeState> prototype_state(Size index) = 0;
+
         // Global variables
         [[nodiscard]] virtual Value get_global(const String& name) const = 0;
         virtual void set_global(const String& name, Value value) = 0;
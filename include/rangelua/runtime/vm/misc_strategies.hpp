@@ -119,6 +119,42 @@ namespace rangelua::runtime {
         Status execute_impl(IVMContext& context, Instruction instruction) override;
     };
 
+    /**
+     * @brief Strategy for OP_HOISTCLEAR instruction
+     * invalidate loop-invariant cache slots A, ... ,A+B-1
+     */
+    class HoistClearStrategy : public InstructionStrategyBase<OpCode::OP_HOISTCLEAR> {
+    public:
+        const char* name() const noexcept override { return "HOISTCLEAR"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_HOISTGET instruction
+     * if slot B is current then { R[A] := slot B; pc+=C } else record epoch in slot B
+     */
+    class HoistGetStrategy : public InstructionStrategyBase<OpCode::OP_HOISTGET> {
+    public:
+        const char* name() const noexcept override { return "HOISTGET"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_HOISTSET instruction
+     * slot B := R[A] at the epoch recorded by the HOISTGET that missed
+     */
+    class HoistSetStrategy : public InstructionStrategyBase<OpCode::OP_HOISTSET> {
+    public:
+        const char* name() const noexcept override { return "HOISTSET"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
     /**
      * @brief Factory for creating miscellaneous operation strategies
      */
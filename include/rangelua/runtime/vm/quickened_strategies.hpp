@@ -0,0 +1,184 @@
+#pragma once
+
+/**
+ * @file quickened_strategies.hpp
+ * @brief Type-specialized (quickened) instruction strategies
+ * @version 0.1.0
+ *
+ * Generic instructions that keep observing monomorphic operand types rewrite
+ * themselves in place into one of these specialized variants. Each variant guards
+ * its assumption and, on a miss, rewrites the instruction back to its generic form
+ * and executes it through the generic strategy. Every miss doubles the warm-up a
+ * site needs before it is quickened again, and a site that keeps missing stays generic.
+ */
+
+#include "arithmetic_strategies.hpp"
+#include "comparison_strategies.hpp"
+#include "instruction_strategy.hpp"
+#include "table_strategies.hpp"
+#include "../../backend/bytecode.hpp"
+
+namespace rangelua::runtime {
+
+    class Value;
+
+    /**
+     * @brief Hooks used by generic strategies to quicken the current instruction
+     */
+    namespace quickening {
+
+        /**
+         * @brief Quicken a binary arithmetic/comparison instruction once its operands
+         * have been numbers for VMConfig::quickening_warmup consecutive executions
+         */
+        void observe_binary(IVMContext& context,
+                            Instruction instruction,
+                            const Value& left,
+                            const Value& right);
+
+        /**
+         * @brief Quicken OP_GETTABLE once it has indexed the array part of a plain
+         * table for VMConfig::quickening_warmup consecutive executions
+         */
+        void observe_index(IVMContext& context,
+                           Instruction instruction,
+                           const Value& table,
+                           const Value& key);
+
+    }  // namespace quickening
+
+    /**
+     * @brief Common base for quickened strategies
+     *
+     * Holds the generic strategy used as the deoptimization path.
+     */
+    template <OpCode Op, typename GenericStrategy>
+    class QuickenedStrategyBase : public InstructionStrategyBase<Op> {
+    protected:
+        /**
+         * @brief Revert the current instruction to its generic opcode and execute it
+         */
+        Status deoptimize(IVMContext& context, Instruction instruction) {
+            Instruction generic =
+                LuaInstruction(instruction).with_opcode(instruction_utils::generic_opcode(Op)).raw;
+            context.patch_current_instruction(generic);
+            return generic_.execute(context, generic);
+        }
+
+    private:
+        GenericStrategy generic_;
+    };
+
+    /**
+     * @brief Strategy for OP_ADD_NUM instruction
+     * R[A] := R[B] + R[C] (both numbers)
+     */
+    class AddNumStrategy : public QuickenedStrategyBase<OpCode::OP_ADD_NUM, AddStrategy> {
+    public:
+        const char* name() const noexcept override { return "ADD_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_SUB_NUM instruction
+     * R[A] := R[B] - R[C] (both numbers)
+     */
+    class SubNumStrategy : public QuickenedStrategyBase<OpCode::OP_SUB_NUM, SubStrategy> {
+    public:
+        const char* name() const noexcept override { return "SUB_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_MUL_NUM instruction
+     * R[A] := R[B] * R[C] (both numbers)
+     */
+    class MulNumStrategy : public QuickenedStrategyBase<OpCode::OP_MUL_NUM, MulStrategy> {
+    public:
+        const char* name() const noexcept override { return "MUL_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_DIV_NUM instruction
+     * R[A] := R[B] / R[C] (both numbers)
+     */
+    class DivNumStrategy : public QuickenedStrategyBase<OpCode::OP_DIV_NUM, DivStrategy> {
+    public:
+        const char* name() const noexcept override { return "DIV_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_EQ_NUM instruction
+     * if ((R[A] == R[B]) ~= k) then pc++ (both numbers)
+     */
+    class EqNumStrategy : public QuickenedStrategyBase<OpCode::OP_EQ_NUM, EqStrategy> {
+    public:
+        const char* name() const noexcept override { return "EQ_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_LT_NUM instruction
+     * if ((R[A] < R[B]) ~= k) then pc++ (both numbers)
+     */
+    class LtNumStrategy : public QuickenedStrategyBase<OpCode::OP_LT_NUM, LtStrategy> {
+    public:
+        const char* name() const noexcept override { return "LT_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_LE_NUM instruction
+     * if ((R[A] <= R[B]) ~= k) then pc++ (both numbers)
+     */
+    class LeNumStrategy : public QuickenedStrategyBase<OpCode::OP_LE_NUM, LeStrategy> {
+    public:
+        const char* name() const noexcept override { return "LE_NUM"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Strategy for OP_GETTABLE_ARRAY instruction
+     * R[A] := R[B][R[C]] (plain table, key inside the array part)
+     */
+    class GetTableArrayStrategy
+        : public QuickenedStrategyBase<OpCode::OP_GETTABLE_ARRAY, GetTableStrategy> {
+    public:
+        const char* name() const noexcept override { return "GETTABLE_ARRAY"; }
+
+    protected:
+        Status execute_impl(IVMContext& context, Instruction instruction) override;
+    };
+
+    /**
+     * @brief Factory for creating quickened instruction strategies
+     */
+    class QuickenedStrategyFactory {
+    public:
+        /**
+         * @brief Create all quickened instruction strategies
+         * @param registry Registry to register strategies with
+         */
+        static void register_strategies(InstructionStrategyRegistry& registry);
+
+    private:
+        QuickenedStrategyFactory() = default;
+    };
+
+}  // namespace rangelua::runtime
@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only memory mapping of a whole file
+ * @version 0.1.0
+ */
+
+#include <cstdint>
+#include <span>
+
+#include "../core/types.hpp"
+
+namespace rangelua::utils {
+
+    /**
+     * @brief Read-only mapping of a whole file, unmapped on destruction
+     *
+     * The contents are paged in by the kernel on demand instead of being copied
+     * into a buffer, so a large source or chunk costs no extra heap memory.
+     * Pipes, FIFOs and other files that cannot be mapped leave the mapping
+     * invalid; callers fall back to reading them as a stream.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const String& path);
+        ~MappedFile();
+
+        // Non-copyable, non-movable (views into the mapping are handed out)
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        /**
+         * @brief Whether the file was mapped; an empty regular file counts as mapped
+         */
+        [[nodiscard]] bool ok() const noexcept { return address_ != nullptr || empty_; }
+
+        [[nodiscard]] Size size() const noexcept { return size_; }
+
+        [[nodiscard]] std::span<const std::uint8_t> bytes() const noexcept {
+            return {static_cast<const std::uint8_t*>(address_), size_};
+        }
+
+        [[nodiscard]] StringView text() const noexcept {
+            return {static_cast<const char*>(address_), size_};
+        }
+
+    private:
+        void* address_ = nullptr;
+        Size size_ = 0;
+        bool empty_ = false;
+    };
+
+}  // namespace rangelua::utils
@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * @file parallel.hpp
+ * @brief Running independent tasks on a small pool of worker threads
+ * @version 0.1.0
+ */
+
+#include <functional>
+
+#include "../core/types.hpp"
+
+namespace rangelua::utils {
+
+    /**
+     * @brief Thread count for a jobs setting: 0 means one per hardware thread
+     */
+    [[nodiscard]] Size resolve_jobs(Size jobs) noexcept;
+
+    /**
+     * @brief Run task(index) for every index in [0, count) on up to jobs threads
+     *
+     * The calling thread works alongside the workers, which take indices in
+     * order from a shared counter, and the call returns once every task has
+     * run. Tasks must only write state owned by their index, so the result does
+     * not depend on scheduling. With one job or one task everything runs on the
+     * calling thread. The first exception a task throws is rethrown here.
+     */
+    void parallel_for(Size count, Size jobs, const std::function<void(Size)>& task);
+
+}  // namespace rangelua::utils
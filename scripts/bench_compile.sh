@@ -0,0 +1,146 @@
+#!/bin/bash
+
+# Script to benchmark compile time on a large generated Lua file
+# Generates roughly 50k lines of functions that are defined but never called,
+# so the run time is dominated by lexing, parsing, code generation and the
+# optimizer. Each optimization level is timed; -O3 also prints optimizer
+# statistics (per-pass time and instruction counts). The total time, parse and
+# code generation time, peak AST arena size and peak resident memory are then
+# compared between the whole-chunk AST path and --single-pass, both on the
+# generated functions and on a file of small top-level statements. Start-up time with
+# eager compilation is compared against --lazy, where the unused function
+# bodies are only scanned for balanced blocks. Finally the compile time at the
+# default level is measured with the function bodies compiled and optimized on
+# 1, 2, 4 and 8 threads (--jobs).
+#
+# Usage: scripts/bench_compile.sh [path/to/rangelua] [line count]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+LINES="${2:-50000}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+SOURCE="$WORK_DIR/generated.lua"
+
+# Each generated function is 25 lines of locals, arithmetic, copies, branches and loops
+{
+    echo "local M = {}"
+    functions=$((LINES / 25))
+    for ((i = 0; i < functions; i++)); do
+        cat <<EOF
+function M.f$i(a, b)
+    local x = a + $i
+    local y = x
+    local z = y * 2 + b
+    local k = 10
+    local w = k * 3 - 1
+    local t = {}
+    for j = 1, w do
+        local v = z
+        t[j] = v + j * k
+    end
+    if x > b then
+        z = z - x
+    else
+        z = z + y
+    end
+    local s = 0
+    while s < z do
+        s = s + w
+    end
+    local n = not (x == y)
+    local m = t[1]
+    local u = M.f0
+    return s, m, n
+end
+EOF
+    done
+    echo "print(\"ok\")"
+} > "$SOURCE"
+
+echo "Generated $(wc -l < "$SOURCE") lines"
+
+for level in 0 1 2 3; do
+    start=$(date +%s%N)
+    if ! "$RANGELUA" "-O$level" "$SOURCE" > /dev/null; then
+        echo "Error: compilation failed at -O$level"
+        exit 1
+    fi
+    end=$(date +%s%N)
+    echo "-O$level: $(((end - start) / 1000000)) ms"
+done
+
+echo "Optimizer statistics (-O3):"
+"$RANGELUA" -O3 --opt-stats "$SOURCE" | grep -v '^ok$'
+
+# One global assignment per line over 100 globals: the AST is many small nodes
+STATEMENTS="$WORK_DIR/statements.lua"
+{
+    for ((i = 0; i < 100; i++)); do
+        echo "g$i = $i"
+    done
+    for ((i = 0; i < LINES; i++)); do
+        echo "g$((i % 100)) = g$(((i + 7) % 100)) + $((i % 100))"
+    done
+    echo "print(\"ok\")"
+} > "$STATEMENTS"
+
+for file in "$SOURCE" "$STATEMENTS"; do
+    echo "AST path vs. single pass (-O0, $(basename "$file")):"
+    for mode in "" --single-pass; do
+        start=$(date +%s%N)
+        stats="$("$RANGELUA" -O0 $mode --parse-stats "$file" 2>&1 >/dev/null)"
+        end=$(date +%s%N)
+        label="${mode:-ast}"
+        echo "${label#--}: total $(((end - start) / 1000000)) ms," \
+            "$(grep -E '^(parse_time_us|codegen_time_us|arena_bytes|peak_rss_kb):' <<< "$stats" |
+                tr '\n' ' ')"
+    done
+done
+
+echo "Eager vs. lazy function bodies (default level):"
+for mode in "" --lazy; do
+    start=$(date +%s%N)
+    stats="$("$RANGELUA" $mode --parse-stats "$SOURCE" 2>&1 >/dev/null)"
+    end=$(date +%s%N)
+    label="${mode:-eager}"
+    echo "${label#--}: total $(((end - start) / 1000000)) ms," \
+        "$(grep -E '^(parse_time_us|peak_rss_kb):' <<< "$stats" | tr '\n' ' ')"
+done
+
+echo "Parallel compilation (default level):"
+for jobs in 1 2 4 8; do
+    start=$(date +%s%N)
+    if ! "$RANGELUA" --jobs "$jobs" "$SOURCE" > /dev/null; then
+        echo "Error: compilation failed with --jobs $jobs"
+        exit 1
+    fi
+    end=$(date +%s%N)
+    echo "--jobs $jobs: $(((end - start) / 1000000)) ms"
+done
+
+# A single function with about 10k basic blocks stresses the CFG and SSA construction
+BLOCKS="$WORK_DIR/blocks.lua"
+{
+    echo "local x, y = 1, 0"
+    for ((i = 0; i < 2000; i++)); do
+        echo "if x > y then y = x end"
+    done
+    echo "print(\"ok\")"
+} > "$BLOCKS"
+
+echo "Single function with ~10k blocks (-O3):"
+start=$(date +%s%N)
+"$RANGELUA" -O3 --opt-stats "$BLOCKS" | grep -E 'time_us|instructions'
+end=$(date +%s%N)
+echo "total: $(((end - start) / 1000000)) ms"
@@ -0,0 +1,188 @@
+#!/bin/bash
+
+# Script to benchmark lexing and parse throughput on large generated Lua files
+# Generates roughly 100k lines mixing declarations, calls, table constructors,
+# control flow and comments, then reports as MB/s the time of a standalone
+# lexing pass (--lex-stats) and the time spent lexing and parsing for
+# compilation (--parse-stats, so code generation and execution are excluded),
+# together with the size of the AST arena. The parse is repeated with the source
+# piped into standard input, where the lexer reads it block by block instead of
+# from a memory-mapped file. A data file made of numeric table literals measures
+# number conversion. A comment-heavy file of the
+# same length is lexed with every scanning implementation (--lex-scan) the CPU
+# supports. The best of several runs is kept.
+#
+# Usage: scripts/bench_parse.sh [path/to/rangelua] [line count] [runs]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+LINES="${2:-100000}"
+RUNS="${3:-5}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+SOURCE="$WORK_DIR/generated.lua"
+
+# Each generated function is 20 lines; functions are defined but never called
+{
+    echo "local M = {}"
+    functions=$((LINES / 20))
+    for ((i = 0; i < functions; i++)); do
+        cat <<EOF
+-- Helper number $i: builds a record and folds its fields
+function M.helper_$i(first_argument, second_argument, ...)
+    local record = {name = "helper_$i", index = $i, ratio = $i.5, tags = {"a", "b", "c"}}
+    local total, count = 0, #record.tags
+    for position = 1, count do
+        total = total + position * first_argument - (second_argument or 0)
+    end
+    for key, value in pairs(record) do
+        if type(value) == "number" and value > total then
+            total = value // 2 + (total % 7)
+        elseif key == "name" then
+            total = total .. "" == "0" and 0 or total
+        end
+    end
+    while total > 1000 do total = total >> 1 end
+    repeat count = count - 1 until count <= 0
+    local callback = function(x) return x * 2 + $i end
+    print(M.helper_0, callback(total), select("#", ...))
+    return total, record
+end
+EOF
+    done
+    echo "print(\"ok\")"
+} > "$SOURCE"
+
+bytes=$(wc -c < "$SOURCE")
+echo "Generated $(wc -l < "$SOURCE") lines, $bytes bytes"
+
+best=""
+best_lex=""
+for ((run = 0; run < RUNS; run++)); do
+    stats="$("$RANGELUA" -O0 --lex-stats --parse-stats "$SOURCE" 2>&1 >/dev/null)"
+    time_us=$(grep '^parse_time_us:' <<< "$stats" | awk '{print $2}')
+    lex_us=$(grep '^lex_time_us:' <<< "$stats" | awk '{print $2}')
+    if [ -z "$time_us" ] || [ -z "$lex_us" ]; then
+        echo "Error: no lexing or parse statistics"
+        echo "$stats"
+        exit 1
+    fi
+    if [ -z "$best" ] || [ "$time_us" -lt "$best" ]; then
+        best=$time_us
+        best_stats="$stats"
+    fi
+    if [ -z "$best_lex" ] || [ "$lex_us" -lt "$best_lex" ]; then
+        best_lex=$lex_us
+    fi
+done
+
+grep -v '^lex_' <<< "$best_stats"
+grep '^lex_tokens:\|^lex_scan:' <<< "$best_stats"
+# Bytes per microsecond is MB/s
+awk -v bytes="$bytes" -v us="$best_lex" 'BEGIN { printf "lex throughput: %.1f MB/s\n", bytes / us }'
+awk -v bytes="$bytes" -v us="$best" 'BEGIN { printf "parse throughput: %.1f MB/s\n", bytes / us }'
+
+best_stream=""
+for ((run = 0; run < RUNS; run++)); do
+    stats="$(cat "$SOURCE" | "$RANGELUA" -O0 --parse-stats - 2>&1 >/dev/null)"
+    time_us=$(grep '^parse_time_us:' <<< "$stats" | awk '{print $2}')
+    if [ -z "$time_us" ]; then
+        echo "Error: no parse statistics for standard input"
+        echo "$stats"
+        exit 1
+    fi
+    if [ -z "$best_stream" ] || [ "$time_us" -lt "$best_stream" ]; then
+        best_stream=$time_us
+    fi
+done
+awk -v bytes="$bytes" -v us="$best_stream" \
+    'BEGIN { printf "parse throughput (standard input): %.1f MB/s\n", bytes / us }'
+
+# Numeric data: rows of integer, float and hexadecimal literals, 50 rows per function
+NUMBERS="$WORK_DIR/numbers.lua"
+{
+    rows=$((LINES / 52))
+    for ((i = 0; i < rows; i++)); do
+        echo "function data_$i() return {"
+        for ((row = 0; row < 50; row++)); do
+            echo "    {$i$row, $row.$i, 0x$((i % 10))f$row, ${row}e-$((i % 30)), $((i * 7919 + row)), 0.00$row$i},"
+        done
+        echo "} end"
+    done
+} > "$NUMBERS"
+
+number_bytes=$(wc -c < "$NUMBERS")
+echo "Generated $(wc -l < "$NUMBERS") numeric data lines, $number_bytes bytes"
+best_lex=""
+best=""
+for ((run = 0; run < RUNS; run++)); do
+    stats="$("$RANGELUA" -O0 --lex-stats --parse-stats "$NUMBERS" 2>&1 >/dev/null)"
+    lex_us=$(grep '^lex_time_us:' <<< "$stats" | awk '{print $2}')
+    time_us=$(grep '^parse_time_us:' <<< "$stats" | awk '{print $2}')
+    if [ -z "$lex_us" ] || [ -z "$time_us" ]; then
+        echo "Error: no statistics for the numeric data file"
+        echo "$stats"
+        exit 1
+    fi
+    if [ -z "$best_lex" ] || [ "$lex_us" -lt "$best_lex" ]; then
+        best_lex=$lex_us
+    fi
+    if [ -z "$best" ] || [ "$time_us" -lt "$best" ]; then
+        best=$time_us
+    fi
+done
+awk -v bytes="$number_bytes" -v us="$best_lex" \
+    'BEGIN { printf "lex throughput (numbers): %.1f MB/s\n", bytes / us }'
+awk -v bytes="$number_bytes" -v us="$best" \
+    'BEGIN { printf "parse throughput (numbers): %.1f MB/s\n", bytes / us }'
+
+# Comment-heavy source: documentation blocks, long comments and indentation around little code
+COMMENTS="$WORK_DIR/comments.lua"
+{
+    blocks=$((LINES / 10))
+    for ((i = 0; i < blocks; i++)); do
+        cat <<EOF
+--------------------------------------------------------------------------------
+-- Section $i: this block is mostly documentation that the lexer has to skip over
+-- @param first_argument   the value that is folded into the running total here
+--[[ A long comment that spans lines and mentions ] brackets [ and -- dashes
+     so that the scanner has to look at every closing bracket it comes across ]]
+local value_$i = "a string literal that is long enough to cover a vector block" -- trailing
+
+        -- indented comment after a blank line
+--[==[ level two comment with ]] inside ]==]
+EOF
+    done
+} > "$COMMENTS"
+
+comment_bytes=$(wc -c < "$COMMENTS")
+echo "Generated $(wc -l < "$COMMENTS") comment-heavy lines, $comment_bytes bytes"
+for mode in scalar sse2 avx2 auto; do
+    best_lex=""
+    for ((run = 0; run < RUNS; run++)); do
+        stats="$("$RANGELUA" --lex-scan "$mode" --lex-stats "$COMMENTS" 2>&1 >/dev/null)"
+        lex_us=$(grep '^lex_time_us:' <<< "$stats" | awk '{print $2}')
+        if [ -z "$lex_us" ]; then
+            break
+        fi
+        if [ -z "$best_lex" ] || [ "$lex_us" -lt "$best_lex" ]; then
+            best_lex=$lex_us
+        fi
+    done
+    if [ -z "$best_lex" ]; then
+        echo "lex throughput ($mode, comments): not supported on this CPU"
+        continue
+    fi
+    awk -v bytes="$comment_bytes" -v us="$best_lex" -v mode="$mode" \
+        'BEGIN { printf "lex throughput (%s, comments): %.1f MB/s\n", mode, bytes / us }'
+done
@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# Script to measure the cost of collecting type feedback (--profile)
+# Runs every script in benchmarks/ on the interpreter alone (no baseline JIT,
+# no loop traces), once as is and once with --profile, and reports the best of
+# several alternating runs for each together with the profiling overhead in percent.
+#
+# Usage: scripts/bench_profile.sh [path/to/rangelua] [runs]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+RUNS="${2:-5}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+# Wall time of one run in microseconds
+run_time() {
+    local start end
+    start=$(date +%s%N)
+    "$@" > /dev/null 2>&1
+    end=$(date +%s%N)
+    echo $(((end - start) / 1000))
+}
+
+for script in "$PROJECT_ROOT"/benchmarks/*.lua; do
+    # Runs alternate between the two modes so that drift in machine load affects both
+    plain=""
+    profiled=""
+    for ((run = 0; run < RUNS; run++)); do
+        elapsed=$(run_time "$RANGELUA" --jit off --trace off "$script")
+        if [ -z "$plain" ] || [ "$elapsed" -lt "$plain" ]; then
+            plain=$elapsed
+        fi
+        elapsed=$(run_time "$RANGELUA" --jit off --trace off --profile "$script")
+        if [ -z "$profiled" ] || [ "$elapsed" -lt "$profiled" ]; then
+            profiled=$elapsed
+        fi
+    done
+    echo "$(basename "$script"): plain $((plain / 1000)) ms," \
+        "profiled $((profiled / 1000)) ms," \
+        "overhead $(((profiled - plain) * 100 / plain))%"
+done
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Script to check that ahead-of-time compiled modules behave like the interpreter
+# Every test script is compiled with `rangelua --aot`, built into a shared object
+# and run with `--aot-load`; its output must match a plain interpreter run.
+#
+# Usage: scripts/check_aot.sh [path/to/rangelua]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+CXX="${CXX:-c++}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+passed=0
+failed=0
+
+while IFS= read -r script; do
+    name="$(basename "$script" .lua)"
+    source_file="$WORK_DIR/$name.cpp"
+    module_file="$WORK_DIR/$name.so"
+
+    if ! "$RANGELUA" --aot "$source_file" "$script" ||
+       ! "$CXX" -O2 -shared -fPIC "$source_file" -o "$module_file"; then
+        echo "FAIL (build) $script"
+        failed=$((failed + 1))
+        continue
+    fi
+
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" "$script" 2>&1)"
+    actual="$(cd "$(dirname "$script")" && "$RANGELUA" --aot-load "$module_file" "$script" 2>&1)"
+    if [ "$expected" == "$actual" ]; then
+        passed=$((passed + 1))
+    else
+        echo "FAIL (output) $script"
+        diff <(echo "$expected") <(echo "$actual") | head -20
+        failed=$((failed + 1))
+    fi
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+echo "AOT check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,93 @@
+#!/bin/bash
+
+# Script to check the on-disk compilation cache
+# Every test script is run three times against a fresh cache directory: the first run must
+# miss and store an entry, the second must hit, and a run after the entry is corrupted must
+# fall back to compiling. All runs must print what an uncached run prints. Finally several
+# processes share one cache concurrently.
+#
+# Usage: scripts/check_cache.sh [path/to/rangelua]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+passed=0
+failed=0
+
+# Run a script with the cache and compare its output; the expected cache event is $3
+check_run() {
+    local script="$1" expected="$2" event="$3" label="$4"
+    local run output stats
+    run="$(cd "$(dirname "$script")" && "$RANGELUA" --cache-dir "$CACHE_DIR" --cache-stats "$script" 2>&1)"
+    # Statistics share stderr with script errors
+    output="$(grep -v '^cache_' <<< "$run")"
+    stats="$(grep '^cache_' <<< "$run")"
+    if [ "$output" != "$expected" ]; then
+        echo "FAIL ($label output) $script"
+        diff <(echo "$expected") <(echo "$output") | head -20
+        return 1
+    fi
+    if ! grep -q "^cache_$event: 1$" <<< "$stats"; then
+        echo "FAIL ($label) $script: expected a cache $event"
+        echo "$stats"
+        return 1
+    fi
+    return 0
+}
+
+while IFS= read -r script; do
+    CACHE_DIR="$WORK_DIR/cache-$(basename "$script" .lua)"
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" "$script" 2>&1)"
+
+    if check_run "$script" "$expected" misses "first run" &&
+        check_run "$script" "$expected" hits "second run"; then
+        # A damaged entry is ignored and replaced
+        for entry in "$CACHE_DIR"/*.rlc; do
+            printf '\xff\xff\xff\xff' | dd of="$entry" bs=1 seek=40 conv=notrunc status=none
+        done
+        if check_run "$script" "$expected" misses "corrupted entry"; then
+            passed=$((passed + 1))
+            continue
+        fi
+    fi
+    failed=$((failed + 1))
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+# Concurrent writers and readers share one directory through atomic renames
+CACHE_DIR="$WORK_DIR/shared"
+script="$PROJECT_ROOT/tests/scripts/basic/01_hello.lua"
+expected="$("$RANGELUA" "$script" 2>&1)"
+for i in $(seq 1 8); do
+    "$RANGELUA" --cache-dir "$CACHE_DIR" "$script" > "$WORK_DIR/shared-$i.out" 2>&1 &
+done
+wait
+concurrent_ok=1
+for i in $(seq 1 8); do
+    if [ "$(cat "$WORK_DIR/shared-$i.out")" != "$expected" ]; then
+        concurrent_ok=0
+    fi
+done
+if [ "$(find "$CACHE_DIR" -name '*.tmp' | wc -l)" -ne 0 ]; then
+    concurrent_ok=0
+fi
+if [ "$concurrent_ok" -eq 1 ]; then
+    passed=$((passed + 1))
+else
+    echo "FAIL (concurrent) shared cache runs disagreed or left temporaries behind"
+    failed=$((failed + 1))
+fi
+
+echo "Cache check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# Script to check that precompiled bytecode chunks behave like the source they came from
+# Every test script is compiled with `rangelua -c` and the chunk is run in place of the
+# script; its output must match a plain interpreter run. A chunk with a corrupted version
+# field must be rejected.
+#
+# Usage: scripts/check_chunks.sh [path/to/rangelua]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+passed=0
+failed=0
+
+while IFS= read -r script; do
+    name="$(basename "$script" .lua)"
+    chunk_file="$WORK_DIR/$name.rlc"
+
+    if ! "$RANGELUA" -c "$chunk_file" "$script"; then
+        echo "FAIL (compile) $script"
+        failed=$((failed + 1))
+        continue
+    fi
+
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" "$script" 2>&1)"
+    # The top-level error names the file that was run; runtime errors keep the source name
+    expected="${expected//"file '$script'"/"file '$chunk_file'"}"
+    actual="$(cd "$(dirname "$script")" && "$RANGELUA" "$chunk_file" 2>&1)"
+    if [ "$expected" == "$actual" ]; then
+        passed=$((passed + 1))
+    else
+        echo "FAIL (output) $script"
+        diff <(echo "$expected") <(echo "$actual") | head -20
+        failed=$((failed + 1))
+    fi
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+# The format version follows the four-byte signature
+echo 'print("stale")' > "$WORK_DIR/stale.lua"
+"$RANGELUA" -c "$WORK_DIR/stale.rlc" "$WORK_DIR/stale.lua"
+printf '\xff' | dd of="$WORK_DIR/stale.rlc" bs=1 seek=4 conv=notrunc status=none
+if "$RANGELUA" "$WORK_DIR/stale.rlc" > /dev/null 2>&1; then
+    echo "FAIL (version) mismatched chunk version was accepted"
+    failed=$((failed + 1))
+else
+    passed=$((passed + 1))
+fi
+
+echo "Chunk check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# Script to check that lazily compiled function bodies match eager compilation
+# Every test script is precompiled with `rangelua -c` twice, once normally and once with
+# --lazy, without optimization (-O0) and at -O1; `-c` compiles the deferred bodies before
+# writing, so the chunks must be byte-identical. (From -O2 on, eager bodies can be inlined into
+# the main chunk while deferred ones cannot, so the bytecode differs there by design.) The
+# script must also print the same output when run with --lazy at the default level.
+#
+# Usage: scripts/check_lazy.sh [path/to/rangelua]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+passed=0
+failed=0
+
+check_script() {
+    local script="$1" level expected actual
+    for level in -O0 -O1; do
+        if ! "$RANGELUA" "$level" -c "$WORK_DIR/eager.rlc" "$script" ||
+           ! "$RANGELUA" "$level" --lazy -c "$WORK_DIR/lazy.rlc" "$script"; then
+            echo "FAIL (compile $level) $script"
+            return 1
+        fi
+        if ! cmp -s "$WORK_DIR/eager.rlc" "$WORK_DIR/lazy.rlc"; then
+            echo "FAIL (bytecode $level) $script"
+            return 1
+        fi
+    done
+
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" "$script" 2>&1)"
+    actual="$(cd "$(dirname "$script")" && "$RANGELUA" --lazy "$script" 2>&1)"
+    if [ "$expected" != "$actual" ]; then
+        echo "FAIL (output) $script"
+        diff <(echo "$expected") <(echo "$actual") | head -20
+        return 1
+    fi
+    return 0
+}
+
+while IFS= read -r script; do
+    if check_script "$script"; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+    fi
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+echo "Lazy compilation check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
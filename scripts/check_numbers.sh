@@ -0,0 +1,169 @@
+#!/bin/bash
+
+# Script to fuzz numeric literal conversion against the C library
+# A small generator, built with the host C++ compiler, writes random decimal and hexadecimal
+# integer and float literals (with and without points and exponents, including overflowing
+# integers, subnormals and out-of-range exponents) into a Lua script. Next to each literal it
+# writes the value strtod/strtoull give it under Lua's rules, spelled in the other notation:
+# decimal literals are checked against a hexadecimal form and hexadecimal ones against a
+# decimal form, so each comparison exercises two independent conversion paths.
+#
+# Usage: scripts/check_numbers.sh [path/to/rangelua] [literal count] [seed]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+COUNT="${2:-20000}"
+SEED="${3:-$RANDOM}"
+CXX="${CXX:-c++}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+cat > "$WORK_DIR/generate.cpp" <<'CPP'
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+static std::mt19937_64 rng;
+
+static std::string digits(unsigned count, const char* set, unsigned set_size) {
+    std::string text;
+    for (unsigned i = 0; i < count; ++i) {
+        text += set[rng() % set_size];
+    }
+    return text;
+}
+
+static std::string decimal_digits(unsigned count) { return digits(count, "0123456789", 10); }
+static std::string hex_digits(unsigned count) { return digits(count, "0123456789abcdefABCDEF", 22); }
+
+static std::string exponent(char letter, unsigned limit) {
+    const char* signs[] = {"", "+", "-"};
+    return letter + std::string(signs[rng() % 3]) + std::to_string(rng() % limit);
+}
+
+// A float in decimal notation, written so that Lua reads it back exactly
+static std::string as_decimal(double value) {
+    if (std::isinf(value)) {
+        return "math.huge";
+    }
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+}
+
+static std::string as_hex(double value) {
+    if (std::isinf(value)) {
+        return "math.huge";
+    }
+    char text[64];
+    std::snprintf(text, sizeof(text), "%a", value);
+    return text;
+}
+
+// An integer in the notation the literal does not use
+static std::string as_integer(std::int64_t value, bool hex_literal) {
+    char text[64];
+    if (!hex_literal) {
+        std::snprintf(text, sizeof(text), "0x%" PRIx64, static_cast<std::uint64_t>(value));
+    } else if (value == INT64_MIN) {
+        return "(-9223372036854775807 - 1)";
+    } else {
+        std::snprintf(text, sizeof(text), "%" PRId64, value);
+    }
+    return text;
+}
+
+static std::string literal() {
+    switch (rng() % 8) {
+        case 0:
+            return decimal_digits(1 + rng() % 18);
+        case 1:
+            // Around and beyond the Int range, which turns into a float
+            return decimal_digits(19 + rng() % 6);
+        case 2: {
+            std::string text = decimal_digits(rng() % 20) + "." + decimal_digits(rng() % 20);
+            return text == "." ? "0." : text;
+        }
+        case 3:
+            return decimal_digits(1 + rng() % 20) + exponent("eE"[rng() % 2], 400);
+        case 4:
+            return decimal_digits(1 + rng() % 3) + "." + decimal_digits(rng() % 17) +
+                   exponent('e', 340);
+        case 5:
+            return "0x" + hex_digits(1 + rng() % 20);
+        case 6: {
+            std::string text = "0x" + hex_digits(rng() % 18) + "." + hex_digits(rng() % 18);
+            return text == "0x." ? "0x0." : text;
+        }
+        default:
+            return "0x" + hex_digits(1 + rng() % 16) + exponent("pP"[rng() % 2], 1100);
+    }
+}
+
+int main(int argc, char** argv) {
+    const long count = std::atol(argv[1]);
+    rng.seed(std::strtoull(argv[2], nullptr, 10));
+    for (long i = 0; i < count; ++i) {
+        const std::string text = literal();
+        const bool hex = text[1] == 'x';
+        const bool integer = text.find_first_of(hex ? ".pP" : ".eE") == std::string::npos;
+        std::string expected;
+        if (integer && hex) {
+            // Hexadecimal integers wrap around
+            std::uint64_t value = 0;
+            for (char c : text.substr(2)) {
+                value = value * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+            }
+            expected = as_integer(static_cast<std::int64_t>(value), true);
+        } else if (integer) {
+            errno = 0;
+            const std::uint64_t value = std::strtoull(text.c_str(), nullptr, 10);
+            if (errno == 0 && value <= static_cast<std::uint64_t>(INT64_MAX)) {
+                expected = as_integer(static_cast<std::int64_t>(value), false);
+            }
+        }
+        if (expected.empty()) {
+            const double value = std::strtod(text.c_str(), nullptr);
+            expected = hex ? as_decimal(value) : as_hex(value);
+        }
+        // One function per literal keeps each constant table small
+        std::printf("function check()\n"
+                    "    if %s ~= %s then print(\"mismatch\", \"%s\", \"%s\") end\n"
+                    "end\n"
+                    "check()\n",
+                    text.c_str(), expected.c_str(), text.c_str(), expected.c_str());
+    }
+    std::printf("print(\"checked\", %ld)\n", count);
+}
+CPP
+
+if ! "$CXX" -std=c++17 -O2 "$WORK_DIR/generate.cpp" -o "$WORK_DIR/generate"; then
+    echo "Error: cannot build the literal generator with $CXX"
+    exit 1
+fi
+
+"$WORK_DIR/generate" "$COUNT" "$SEED" > "$WORK_DIR/numbers.lua"
+output="$("$RANGELUA" "$WORK_DIR/numbers.lua" 2>&1)"
+expected="$(printf 'checked\t%s' "$COUNT")"
+
+if [ "$output" == "$expected" ]; then
+    echo "Number check: $COUNT literals agree with strtod (seed $SEED)"
+    exit 0
+fi
+echo "Number check: literals disagree with strtod (seed $SEED)"
+grep -v '^checked' <<< "$output" | head -20
+exit 1
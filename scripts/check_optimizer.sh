@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Script to check that every optimization level preserves behavior
+# Each test script is run at -O0 .. -O3; the output at every level must
+# match the unoptimized (-O0) run.
+#
+# Usage: scripts/check_optimizer.sh [path/to/rangelua] [extra rangelua options...]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+shift || true
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+passed=0
+failed=0
+
+while IFS= read -r script; do
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" -O0 "$@" "$script" 2>&1)"
+    for level in 1 2 3; do
+        actual="$(cd "$(dirname "$script")" && "$RANGELUA" "-O$level" "$@" "$script" 2>&1)"
+        if [ "$expected" == "$actual" ]; then
+            passed=$((passed + 1))
+        else
+            echo "FAIL (-O$level) $script"
+            diff <(echo "$expected") <(echo "$actual") | head -20
+            failed=$((failed + 1))
+        fi
+    done
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+echo "Optimizer check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# Script to check that parallel compilation matches serial compilation
+# Every test script is precompiled with `rangelua -c` twice, once on one thread and once with
+# --jobs 4, at every optimization level; the chunks must be byte-identical. The same is done
+# with --lazy, where -c compiles the deferred bodies on the worker threads. The script must
+# also print the same output when run with --jobs 4.
+#
+# Usage: scripts/check_parallel.sh [path/to/rangelua]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+JOBS=4
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+passed=0
+failed=0
+
+check_script() {
+    local script="$1" level mode expected actual
+    for level in -O0 -O1 -O2 -O3; do
+        for mode in "" --lazy; do
+            if ! "$RANGELUA" "$level" $mode -c "$WORK_DIR/serial.rlc" "$script" ||
+               ! "$RANGELUA" "$level" $mode --jobs "$JOBS" -c "$WORK_DIR/parallel.rlc" "$script"; then
+                echo "FAIL (compile $level $mode) $script"
+                return 1
+            fi
+            if ! cmp -s "$WORK_DIR/serial.rlc" "$WORK_DIR/parallel.rlc"; then
+                echo "FAIL (bytecode $level $mode) $script"
+                return 1
+            fi
+        done
+    done
+
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" "$script" 2>&1)"
+    actual="$(cd "$(dirname "$script")" && "$RANGELUA" --jobs "$JOBS" "$script" 2>&1)"
+    if [ "$expected" != "$actual" ]; then
+        echo "FAIL (output) $script"
+        diff <(echo "$expected") <(echo "$actual") | head -20
+        return 1
+    fi
+    return 0
+}
+
+while IFS= read -r script; do
+    if check_script "$script"; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+    fi
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+echo "Parallel compilation check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Script to check that single-pass compilation matches the AST path
+# Every test script is precompiled with `rangelua -c` twice, once normally and once with
+# --single-pass, both without optimization (-O0) and at the default level; the chunks must be
+# byte-identical. The script must also print the same output when run with --single-pass.
+#
+# Usage: scripts/check_single_pass.sh [path/to/rangelua]
+
+set -u
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+RANGELUA="${1:-$PROJECT_ROOT/build/linux/x86_64/release/rangelua}"
+
+if [ ! -x "$RANGELUA" ]; then
+    echo "Error: rangelua binary not found at $RANGELUA"
+    echo "Build it first (xmake) or pass its path as the first argument"
+    exit 1
+fi
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+passed=0
+failed=0
+
+check_script() {
+    local script="$1" level expected actual
+    for level in -O0 -O2; do
+        if ! "$RANGELUA" "$level" -c "$WORK_DIR/ast.rlc" "$script" ||
+           ! "$RANGELUA" "$level" --single-pass -c "$WORK_DIR/single.rlc" "$script"; then
+            echo "FAIL (compile $level) $script"
+            return 1
+        fi
+        if ! cmp -s "$WORK_DIR/ast.rlc" "$WORK_DIR/single.rlc"; then
+            echo "FAIL (bytecode $level) $script"
+            return 1
+        fi
+    done
+
+    expected="$(cd "$(dirname "$script")" && "$RANGELUA" "$script" 2>&1)"
+    actual="$(cd "$(dirname "$script")" && "$RANGELUA" --single-pass "$script" 2>&1)"
+    if [ "$expected" != "$actual" ]; then
+        echo "FAIL (output) $script"
+        diff <(echo "$expected") <(echo "$actual") | head -20
+        return 1
+    fi
+    return 0
+}
+
+while IFS= read -r script; do
+    if check_script "$script"; then
+        passed=$((passed + 1))
+    else
+        failed=$((failed + 1))
+    fi
+done < <(find "$PROJECT_ROOT/tests/scripts" -name '*.lua' | sort)
+
+echo "Single-pass check: $passed passed, $failed failed"
+[ "$failed" -eq 0 ]
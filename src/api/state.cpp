@@ -6,6 +6,7 @@
 
 #include <rangelua/api/state.hpp>
 #include <rangelua/backend/bytecode.hpp>
+#include <rangelua/backend/chunk.hpp>
 #include <rangelua/backend/codegen.hpp>
 #include <rangelua/core/error.hpp>
 #include <rangelua/frontend/lexer.hpp>
@@ -16,8 +17,11 @@
 #include <rangelua/stdlib/string.hpp>
 #include <rangelua/stdlib/table.hpp>
 #include <rangelua/utils/logger.hpp>
+#include <rangelua/utils/mapped_file.hpp>
 
+#include <chrono>
 #include <fstream>
+#include <iterator>
 
 namespace rangelua::api {
 
@@ -27,6 +31,49 @@ namespace rangelua::api {
             static auto log = utils::Logger::create_logger("api");
             return log;
         }
+
+        runtime::VMConfig make_vm_config(const StateConfig& config) {
+            runtime::VMConfig vm_config = config.vm_config;
+            vm_config.enable_profiling = vm_config.enable_profiling || config.enable_profiling;
+            return vm_config;
+        }
+
+        /**
+         * @brief Forwards statements to a sink and measures the time spent in it
+         *
+         * Single-pass compilation interleaves parsing and code generation; this
+         * separates the two for parse_statistics().
+         */
+        class TimedSink final : public frontend::StatementSink {
+        public:
+            explicit TimedSink(frontend::StatementSink& target) : target_(target) {}
+
+            void begin_chunk(const SourceLocation& location) override {
+                const auto start = std::chrono::steady_clock::now();
+                target_.begin_chunk(location);
+                elapsed_ += std::chrono::steady_clock::now() - start;
+            }
+
+            Status consume(const frontend::Statement& statement) override {
+                const auto start = std::chrono::steady_clock::now();
+                auto status = target_.consume(statement);
+                elapsed_ += std::chrono::steady_clock::now() - start;
+                return status;
+            }
+
+            Status end_chunk() override {
+                const auto start = std::chrono::steady_clock::now();
+                auto status = target_.end_chunk();
+                elapsed_ += std::chrono::steady_clock::now() - start;
+                return status;
+            }
+
+            [[nodiscard]] std::chrono::nanoseconds elapsed() const noexcept { return elapsed_; }
+
+        private:
+            frontend::StatementSink& target_;
+            std::chrono::nanoseconds elapsed_{0};
+        };
     }  // namespace
 
     State::State() : vm_(std::make_unique<runtime::VirtualMachine>()) {
@@ -39,9 +86,14 @@ namespace rangelua::api {
     }
 
     State::State(const StateConfig& config)
-        : vm_(std::make_unique<runtime::VirtualMachine>(config.vm_config)), config_(config) {
+        : vm_(std::make_unique<runtime::VirtualMachine>(make_vm_config(config))), config_(config) {
         logger()->info("Initializing RangeLua state with custom configuration");
 
+        if (!config_.cache_directory.empty()) {
+            cache_ = std::make_unique<backend::ChunkCache>(
+                config_.cache_directory, static_cast<std::uint32_t>(config_.optimization_level));
+        }
+
         // Initialize global environment
         initialize_globals();
 
@@ -59,39 +111,164 @@ namespace rangelua::api {
         logger()->debug("State destruction complete");
     }
 
-    Result<std::vector<runtime::Value>> State::execute(StringView code, String name) {
-        logger()->debug("Executing code: {} ({})", name, code.size());
+    Result<backend::BytecodeFunction> State::compile(StringView code, String name) {
+        logger()->debug("Compiling code: {} ({})", name, code.size());
 
-        try {
-            // Lexical analysis
-            frontend::Lexer lexer(code, std::move(name));
-
-            // Syntax analysis
-            frontend::Parser parser(lexer);
-            auto ast_result = parser.parse();
-            if (std::holds_alternative<ErrorCode>(ast_result)) {
-                auto error = std::get<ErrorCode>(ast_result);
-                logger()->error("Parse error: {}", error_code_to_string(error));
-                return error;
+        if (cache_) {
+            if (auto cached = cache_->lookup(code, name)) {
+                logger()->debug("Compilation cache hit: {}", name);
+                return std::move(*cached);
             }
+        }
+        const auto start = std::chrono::steady_clock::now();
+
+        if (config_.lazy_functions && !cache_) {
+            // Deferred bodies are compiled after the caller's text is gone
+            auto source = std::make_shared<const String>(code);
+            frontend::Lexer lexer(*source, std::move(name));
+            return compile_tokens(lexer, start, std::move(source));
+        }
 
-            // Code generation
+        // Lexical analysis reads the text in place; a cached chunk is always compiled in full
+        frontend::Lexer lexer(code, std::move(name));
+        auto compiled = compile_tokens(lexer, start);
+
+        if (cache_ && is_success(compiled)) {
+            cache_->store(code,
+                          get_value(compiled),
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start));
+        }
+        return compiled;
+    }
+
+    Result<backend::BytecodeFunction> State::compile(std::istream& input, String name) {
+        logger()->debug("Compiling stream: {}", name);
+
+        const auto start = std::chrono::steady_clock::now();
+        if (config_.lazy_functions) {
+            auto source = std::make_shared<const String>(std::istreambuf_iterator<char>(input),
+                                                         std::istreambuf_iterator<char>());
+            frontend::Lexer lexer(*source, std::move(name));
+            return compile_tokens(lexer, start, std::move(source));
+        }
+
+        // The cache is keyed by the whole source text, which a stream never holds at once
+        frontend::Lexer lexer(input, std::move(name));
+        return compile_tokens(lexer, start);
+    }
+
+    Result<backend::BytecodeFunction>
+    State::compile_tokens(frontend::Lexer& lexer,
+                          std::chrono::steady_clock::time_point start,
+                          SharedPtr<const String> source) {
+        try {
+            frontend::ParserConfig parser_config;
+            parser_config.single_pass = config_.single_pass;
+            parser_config.lazy_functions = source != nullptr;
+            frontend::Parser parser(lexer, parser_config);
             backend::BytecodeEmitter emitter;
             backend::CodeGenerator codegen(emitter);
-            auto codegen_result = codegen.generate(*std::get<frontend::ProgramPtr>(ast_result));
-            if (std::holds_alternative<ErrorCode>(codegen_result)) {
-                auto error = std::get<ErrorCode>(codegen_result);
-                logger()->error("Codegen error: {}", error_code_to_string(error));
-                return error;
+            codegen.set_compile_jobs(config_.compile_jobs);
+            if (source) {
+                codegen.set_deferred_source({std::move(source), config_.optimization_level});
+            }
+
+            if (config_.single_pass) {
+                // Parsing and code generation interleave, one top-level statement at a time
+                TimedSink sink(codegen);
+                auto status = parser.parse(sink);
+                if (is_error(status)) {
+                    auto error = get_error(status);
+                    logger()->error("Codegen error: {}", error_code_to_string(error));
+                    return error;
+                }
+                const auto total = std::chrono::steady_clock::now() - start;
+                record_parse_statistics(
+                    lexer.bytes_read(), &parser.arena(), total - sink.elapsed(), sink.elapsed());
+            } else {
+                // Syntax analysis
+                auto ast_result = parser.parse();
+                if (std::holds_alternative<ErrorCode>(ast_result)) {
+                    auto error = std::get<ErrorCode>(ast_result);
+                    logger()->error("Parse error: {}", error_code_to_string(error));
+                    return error;
+                }
+                auto& program = std::get<frontend::ProgramPtr>(ast_result);
+                const auto parsed = std::chrono::steady_clock::now();
+
+                // Code generation
+                auto codegen_result = codegen.generate(*program);
+                record_parse_statistics(lexer.bytes_read(),
+                                        program->arena(),
+                                        parsed - start,
+                                        std::chrono::steady_clock::now() - parsed);
+                // Release the tree, a single arena, before the optimizer runs
+                program.reset();
+                if (std::holds_alternative<ErrorCode>(codegen_result)) {
+                    auto error = std::get<ErrorCode>(codegen_result);
+                    logger()->error("Codegen error: {}", error_code_to_string(error));
+                    return error;
+                }
             }
 
             // Get generated bytecode
             auto function = emitter.get_function();
 
+            // Bytecode optimization of the chunk and every nested prototype
+            if (config_.optimization_level != backend::Optimizer::OptimizationLevel::None) {
+                backend::Optimizer optimizer(config_.optimization_level);
+                optimizer.set_jobs(config_.compile_jobs);
+                auto optimize_result = optimizer.optimize_chunk(function);
+                if (is_error(optimize_result)) {
+                    auto error = get_error(optimize_result);
+                    logger()->error("Optimization error: {}", error_code_to_string(error));
+                    return error;
+                }
+                for (const auto& [key, value] : optimizer.statistics()) {
+                    optimizer_statistics_[key] += value;
+                }
+            }
+
             // Disassemble the function for debugging
             logger()->debug("Generated bytecode:\n{}",
                             backend::Disassembler::disassemble_function(function));
+            return function;
+
+        } catch (const Exception& e) {
+            logger()->error("Exception during compilation: {}", e.what());
+            return e.code();
+        } catch (const std::exception& e) {
+            logger()->error("Standard exception during compilation: {}", e.what());
+            return ErrorCode::RUNTIME_ERROR;
+        } catch (...) {
+            logger()->error("Unknown exception during compilation");
+            return ErrorCode::UNKNOWN_ERROR;
+        }
+    }
+
+    Result<std::vector<runtime::Value>> State::execute(StringView code, String name) {
+        logger()->debug("Executing code: {} ({})", name, code.size());
+
+        auto compiled = compile(code, std::move(name));
+        if (is_error(compiled)) {
+            return get_error(compiled);
+        }
+        return execute(get_value(compiled));
+    }
+
+    Result<std::vector<runtime::Value>> State::execute(std::istream& input, String name) {
+        logger()->debug("Executing stream: {}", name);
 
+        auto compiled = compile(input, std::move(name));
+        if (is_error(compiled)) {
+            return get_error(compiled);
+        }
+        return execute(get_value(compiled));
+    }
+
+    Result<std::vector<runtime::Value>> State::execute(const backend::BytecodeFunction& function) {
+        try {
             // Execute
             logger()->debug("Executing bytecode function: {}", function.name);
             auto result = vm_->execute(function);
@@ -116,20 +293,36 @@ namespace rangelua::api {
         }
     }
 
+    Status State::load_aot_module(const String& path) {
+        return vm_->load_aot_module(path);
+    }
+
     Result<std::vector<runtime::Value>> State::execute_file(const String& filename) {
         logger()->info("Executing file: {}", filename);
 
-        std::ifstream file(filename);
+        // Regular files are mapped once and lexed or decoded in place, without a copy
+        utils::MappedFile mapping(filename);
+        if (mapping.ok()) {
+            if (backend::ChunkLoader::has_signature(mapping.bytes())) {
+                auto loaded = backend::ChunkLoader::load(mapping.bytes());
+                if (is_error(loaded)) {
+                    logger()->error("Failed to load chunk: {}", filename);
+                    return get_error(loaded);
+                }
+                return execute(get_value(loaded));
+            }
+
+            logger()->debug("File mapped, size: {} bytes", mapping.size());
+            return execute(mapping.text(), filename);
+        }
+
+        // Pipes and other files that cannot be mapped are lexed as they are read
+        std::ifstream file(filename, std::ios::binary);
         if (!file.is_open()) {
             logger()->error("Failed to open file: {}", filename);
             return ErrorCode::IO_ERROR;
         }
-
-        std::string content((std::istreambuf_iterator<char>(file)),
-                            std::istreambuf_iterator<char>());
-
-        logger()->debug("File loaded, size: {} bytes", content.size());
-        return execute(content, filename);
+        return execute(file, filename);
     }
 
     Size State::stack_size() const noexcept {
@@ -289,6 +482,52 @@ namespace rangelua::api {
         vm_->set_instruction_pointer(ip);
     }
 
+    String State::dump_feedback() const {
+        return vm_->dump_feedback();
+    }
+
+    String State::dump_instruction_counts() const {
+        return vm_->dump_instruction_counts();
+    }
+
+    void State::record_parse_statistics(Size source_bytes,
+                                        const frontend::ASTArena* arena,
+                                        std::chrono::nanoseconds parse_time,
+                                        std::chrono::nanoseconds codegen_time) {
+        parse_statistics_["source_bytes"] += source_bytes;
+        const auto parse_us = std::chrono::duration_cast<std::chrono::microseconds>(parse_time);
+        parse_statistics_["parse_time_us"] += static_cast<Size>(parse_us.count());
+        const auto codegen_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(codegen_time);
+        parse_statistics_["codegen_time_us"] += static_cast<Size>(codegen_us.count());
+        if (arena != nullptr) {
+            parse_statistics_["arena_nodes"] += arena->object_count();
+            parse_statistics_["arena_bytes"] += arena->peak_bytes_used();
+            parse_statistics_["arena_blocks"] += arena->block_count();
+        }
+    }
+
+    const std::unordered_map<String, Size>& State::cache_statistics() const noexcept {
+        static const std::unordered_map<String, Size> no_statistics;
+        return cache_ ? cache_->statistics() : no_statistics;
+    }
+
+    bool State::patch_current_instruction(Instruction instruction) noexcept {
+        return vm_->patch_current_instruction(instruction);
+    }
+
+    bool State::observe_quickening(bool matched) {
+        return vm_->observe_quickening(matched);
+    }
+
+    runtime::InvariantSlot& State::invariant_slot(Size index) {
+        return vm_->invariant_slot(index);
+    }
+
+    std::shared_ptr<runtime::PrototypeState> State::prototype_state(Size index) {
+        return vm_->prototype_state(index);
+    }
+
     void State::adjust_instruction_pointer(std::int32_t offset) noexcept {
         vm_->adjust_instruction_pointer(offset);
     }
@@ -5,6 +5,7 @@
  */
 
 #include <rangelua/backend/bytecode.hpp>
+#include <rangelua/utils/parallel.hpp>
 
 #include <iomanip>
 #include <sstream>
@@ -80,6 +81,31 @@ namespace rangelua::backend {
             value);
     }
 
+    Status compile_deferred_prototypes(BytecodeFunction& function, Size jobs) {
+        auto& prototypes = function.prototypes;
+        std::vector<Status> results(prototypes.size());
+        utils::parallel_for(prototypes.size(), jobs, [&](Size index) {
+            auto& prototype = prototypes[index];
+            if (!prototype.deferred) {
+                return;
+            }
+            auto compiled = prototype.deferred->compile();
+            if (is_error(compiled)) {
+                results[index] = get_error(compiled);
+                return;
+            }
+            // Copy before the assignment releases the body that owns the compiled prototype
+            FunctionPrototype body = *get_value(compiled);
+            prototype = std::move(body);
+        });
+        for (const auto& result : results) {
+            if (is_error(result)) {
+                return result;
+            }
+        }
+        return make_success();
+    }
+
     // InstructionEncoder methods are defined inline in the header
 
     // BytecodeEmitter implementation
@@ -194,6 +220,10 @@ namespace rangelua::backend {
         return index;
     }
 
+    std::vector<FunctionPrototype>& BytecodeEmitter::prototypes() noexcept {
+        return function_.prototypes;
+    }
+
     void BytecodeEmitter::set_parameter_count(Size count) {
         function_.parameter_count = count;
     }
@@ -240,10 +270,12 @@ namespace rangelua::backend {
     String Disassembler::disassemble_instruction(Instruction instr, Size index) {
         std::ostringstream oss;
 
-        OpCode op = InstructionEncoder::decode_opcode(instr);
+        // Specialized opcodes share the operand layout of the instruction they specialize
+        OpCode opcode = InstructionEncoder::decode_opcode(instr);
+        OpCode op = instruction_utils::generic_opcode(opcode);
         Register a = InstructionEncoder::decode_a(instr);
 
-        oss << std::setw(4) << index << ": " << opcode_name(op);
+        oss << std::setw(4) << index << ": " << opcode_name(opcode);
 
         switch (op) {
             // Simple load operations (no operands)
@@ -540,6 +572,43 @@ namespace rangelua::backend {
                 break;
             }
 
+            // Loop-invariant cache
+            case OpCode::OP_HOISTCLEAR: {
+                Register b = InstructionEncoder::decode_b(instr);
+                oss << " " << static_cast<int>(a) << " " << static_cast<int>(b);
+                break;
+            }
+            case OpCode::OP_HOISTGET: {
+                Register b = InstructionEncoder::decode_b(instr);
+                Register c = InstructionEncoder::decode_c(instr);
+                oss << " R" << static_cast<int>(a) << " " << static_cast<int>(b) << " "
+                    << static_cast<int>(c);
+                break;
+            }
+            case OpCode::OP_HOISTSET: {
+                Register b = InstructionEncoder::decode_b(instr);
+                oss << " R" << static_cast<int>(a) << " " << static_cast<int>(b);
+                break;
+            }
+
+            // Superinstructions
+            case OpCode::OP_EQJMP:
+            case OpCode::OP_LTJMP:
+            case OpCode::OP_LEJMP: {
+                Register b = InstructionEncoder::decode_b(instr);
+                Register c = InstructionEncoder::decode_c(instr);
+                oss << " R" << static_cast<int>(a) << " R" << static_cast<int>(b) << " "
+                    << static_cast<int>(c) << " (to " << (index + 1 + c) << ")";
+                break;
+            }
+            case OpCode::OP_MOVECALL: {
+                Register b = InstructionEncoder::decode_b(instr);
+                Register c = InstructionEncoder::decode_c(instr);
+                oss << " R" << static_cast<int>(a) << " R" << static_cast<int>(b) << " "
+                    << static_cast<int>(c);
+                break;
+            }
+
             default:
                 oss << " R" << static_cast<int>(a);
                 break;
@@ -573,7 +642,12 @@ namespace rangelua::backend {
             for (Size i = 0; i < function.prototypes.size(); ++i) {
                 oss << "  P" << i << ": " << function.prototypes[i].name
                     << " (params: " << function.prototypes[i].parameter_count
-                    << ", stack: " << function.prototypes[i].stack_size << ")\n";
+                    << ", stack: " << function.prototypes[i].stack_size << ")";
+                if (function.prototypes[i].deferred) {
+                    oss << " deferred\n";
+                    continue;
+                }
+                oss << "\n";
                 // Optionally show prototype instructions
                 oss << "    Instructions:\n";
                 for (Size j = 0; j < function.prototypes[i].instructions.size(); ++j) {
@@ -588,7 +662,36 @@ namespace rangelua::backend {
     }
 
     StringView Disassembler::opcode_name(OpCode op) noexcept {
+        // Statically typed opcodes and superinstructions are compiler output and keep their
+        // names; quickened opcodes are a VM-internal detail and show the instruction they specialize
         switch (op) {
+            case OpCode::OP_ADDF:
+                return "ADDF";
+            case OpCode::OP_SUBF:
+                return "SUBF";
+            case OpCode::OP_MULF:
+                return "MULF";
+            case OpCode::OP_DIVF:
+                return "DIVF";
+            case OpCode::OP_EQF:
+                return "EQF";
+            case OpCode::OP_LTF:
+                return "LTF";
+            case OpCode::OP_LEF:
+                return "LEF";
+            case OpCode::OP_EQJMP:
+                return "EQJMP";
+            case OpCode::OP_LTJMP:
+                return "LTJMP";
+            case OpCode::OP_LEJMP:
+                return "LEJMP";
+            case OpCode::OP_MOVECALL:
+                return "MOVECALL";
+            default:
+                break;
+        }
+
+        switch (instruction_utils::generic_opcode(op)) {
             // Load operations
             case OpCode::OP_MOVE:
                 return "MOVE";
@@ -784,6 +887,13 @@ namespace rangelua::backend {
             case OpCode::OP_EXTRAARG:
                 return "EXTRAARG";
 
+            case OpCode::OP_HOISTCLEAR:
+                return "HOISTCLEAR";
+            case OpCode::OP_HOISTGET:
+                return "HOISTGET";
+            case OpCode::OP_HOISTSET:
+                return "HOISTSET";
+
             default:
                 return "UNKNOWN";
         }
@@ -899,9 +1009,9 @@ namespace rangelua::backend {
         try {
             OpCode opcode = InstructionEncoder::decode_opcode(instr);
 
-            // Validate opcode is within valid range
+            // Validate opcode is within valid range (quickened opcodes are private to the VM)
             if (static_cast<std::uint8_t>(opcode) >=
-                static_cast<std::uint8_t>(OpCode::OP_EXTRAARG)) {
+                static_cast<std::uint8_t>(OpCode::NUM_OPCODES)) {
                 return ErrorCode::RUNTIME_ERROR;
             }
 
@@ -922,8 +1032,24 @@ namespace rangelua::backend {
     Result<std::monostate> BytecodeValidator::validate_register_usage(
         Instruction instr, const BytecodeFunction& function, Size /* index */) noexcept {
         try {
-            OpCode opcode = InstructionEncoder::decode_opcode(instr);
+            // Statically typed opcodes have the operands of the generic opcode they specialize
+            OpCode opcode = instruction_utils::generic_opcode(InstructionEncoder::decode_opcode(instr));
             Register a = InstructionEncoder::decode_a(instr);
+            Register b = InstructionEncoder::decode_b(instr);
+            Register c = InstructionEncoder::decode_c(instr);
+
+            switch (opcode) {
+                // A is not a register
+                case OpCode::OP_JMP:
+                case OpCode::OP_SETTABUP:
+                case OpCode::OP_EXTRAARG:
+                case OpCode::OP_VARARGPREP:
+                case OpCode::OP_HOISTCLEAR:
+                case OpCode::OP_RETURN0:
+                    return std::monostate{};
+                default:
+                    break;
+            }
 
             // Validate register A is within stack bounds
             if (a >= function.stack_size) {
@@ -933,7 +1059,6 @@ namespace rangelua::backend {
             // For instructions that use B and C registers, validate them too
             switch (opcode) {
                 // ABC format instructions with register operands
-                case OpCode::OP_MOVE:
                 case OpCode::OP_ADD:
                 case OpCode::OP_SUB:
                 case OpCode::OP_MUL:
@@ -946,25 +1071,28 @@ namespace rangelua::backend {
                 case OpCode::OP_BXOR:
                 case OpCode::OP_SHL:
                 case OpCode::OP_SHR:
-                case OpCode::OP_MMBIN:
-                case OpCode::OP_GETTABLE:
-                case OpCode::OP_SETTABLE:
-                case OpCode::OP_GETI:
-                case OpCode::OP_SETI:
-                case OpCode::OP_EQ:
-                case OpCode::OP_LT:
-                case OpCode::OP_LE:
-                case OpCode::OP_TESTSET: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    Register c = InstructionEncoder::decode_c(instr);
-
+                case OpCode::OP_GETTABLE: {
                     if (b >= function.stack_size || c >= function.stack_size) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
                 }
 
-                // ABC format instructions with constant operands (don't validate C as register)
+                // B is a register; C is a constant, an immediate, a flag or unused
+                case OpCode::OP_MOVE:
+                case OpCode::OP_MMBIN:
+                case OpCode::OP_SETTABLE:
+                case OpCode::OP_GETI:
+                case OpCode::OP_GETFIELD:
+                case OpCode::OP_SELF:
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                case OpCode::OP_TESTSET:
+                case OpCode::OP_EQJMP:
+                case OpCode::OP_LTJMP:
+                case OpCode::OP_LEJMP:
+                case OpCode::OP_MOVECALL:
                 case OpCode::OP_ADDK:
                 case OpCode::OP_SUBK:
                 case OpCode::OP_MULK:
@@ -975,77 +1103,29 @@ namespace rangelua::backend {
                 case OpCode::OP_BANDK:
                 case OpCode::OP_BORK:
                 case OpCode::OP_BXORK:
-                case OpCode::OP_MMBINK:
-                case OpCode::OP_GETFIELD:
-                case OpCode::OP_SETFIELD:
-                case OpCode::OP_GETTABUP:
-                case OpCode::OP_SETTABUP:
-                case OpCode::OP_SELF:
-                case OpCode::OP_EQK: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    if (b >= function.stack_size) {
-                        return ErrorCode::RUNTIME_ERROR;
-                    }
-                    break;
-                }
-
-                // ABC format instructions with immediate operands
                 case OpCode::OP_ADDI:
                 case OpCode::OP_SHRI:
                 case OpCode::OP_SHLI:
-                case OpCode::OP_MMBINI:
-                case OpCode::OP_EQI:
-                case OpCode::OP_LTI:
-                case OpCode::OP_LEI:
-                case OpCode::OP_GTI:
-                case OpCode::OP_GEI: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    if (b >= function.stack_size) {
-                        return ErrorCode::RUNTIME_ERROR;
-                    }
-                    break;
-                }
-
-                // Instructions with only B register
-                case OpCode::OP_GETUPVAL:
-                case OpCode::OP_SETUPVAL:
                 case OpCode::OP_UNM:
                 case OpCode::OP_NOT:
                 case OpCode::OP_LEN:
-                case OpCode::OP_BNOT:
-                case OpCode::OP_LOADNIL:
-                case OpCode::OP_CONCAT: {
-                    Register b = InstructionEncoder::decode_b(instr);
+                case OpCode::OP_BNOT: {
                     if (b >= function.stack_size) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
                 }
 
-                // Function call instructions
-                case OpCode::OP_CALL:
-                case OpCode::OP_TAILCALL:
-                case OpCode::OP_TFORCALL:
-                case OpCode::OP_RETURN:
-                case OpCode::OP_VARARG:
-                case OpCode::OP_NEWTABLE:
-                case OpCode::OP_SETLIST: {
-                    [[maybe_unused]] Register b = InstructionEncoder::decode_b(instr);
-                    [[maybe_unused]] Register c = InstructionEncoder::decode_c(instr);
-                    // For these instructions, B and C may be special values, not just register indices
-                    // Additional validation logic could be added here
-                    break;
-                }
-
-                // Instructions with only C register (TEST)
-                case OpCode::OP_TEST: {
-                    [[maybe_unused]] Register c = InstructionEncoder::decode_c(instr);
-                    // C is a boolean flag for TEST, not a register
+                // R[A] .. R[A+B] are written
+                case OpCode::OP_LOADNIL: {
+                    if (a + b >= function.stack_size) {
+                        return ErrorCode::RUNTIME_ERROR;
+                    }
                     break;
                 }
 
                 default:
-                    // Other instructions may have different register usage patterns
+                    // B and C are counts, upvalue or constant indices, or special values
                     break;
             }
 
@@ -1084,13 +1164,9 @@ namespace rangelua::backend {
                 case OpCode::OP_BANDK:
                 case OpCode::OP_BORK:
                 case OpCode::OP_BXORK:
-                case OpCode::OP_MMBINK:
                 case OpCode::OP_GETFIELD:
-                case OpCode::OP_SETFIELD:
                 case OpCode::OP_GETTABUP:
-                case OpCode::OP_SETTABUP:
-                case OpCode::OP_SELF:
-                case OpCode::OP_EQK: {
+                case OpCode::OP_SELF: {
                     Register c = InstructionEncoder::decode_c(instr);
                     if (c >= function.constants.size()) {
                         return ErrorCode::RUNTIME_ERROR;
@@ -1098,6 +1174,17 @@ namespace rangelua::backend {
                     break;
                 }
 
+                // ABC format instructions that use constants in B field
+                case OpCode::OP_SETFIELD:
+                case OpCode::OP_SETTABUP:
+                case OpCode::OP_EQK: {
+                    Register b = InstructionEncoder::decode_b(instr);
+                    if (b >= function.constants.size()) {
+                        return ErrorCode::RUNTIME_ERROR;
+                    }
+                    break;
+                }
+
                 // ABx format instructions that reference function prototypes
                 case OpCode::OP_CLOSURE: {
                     std::uint32_t bx = InstructionEncoder::decode_bx(instr);
@@ -1123,7 +1210,8 @@ namespace rangelua::backend {
         try {
             OpCode opcode = InstructionEncoder::decode_opcode(instr);
 
-            // For jump instructions, validate the target is within bounds
+            // For jump instructions, validate the target is within bounds; jumping to the
+            // end of the code returns from the function
             switch (opcode) {
                 // Unconditional jump
                 case OpCode::OP_JMP: {
@@ -1131,7 +1219,7 @@ namespace rangelua::backend {
                     std::int64_t target = static_cast<std::int64_t>(index) + 1 + sbx;
 
                     if (target < 0 ||
-                        target >= static_cast<std::int64_t>(function.instructions.size())) {
+                        target > static_cast<std::int64_t>(function.instructions.size())) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
@@ -1140,10 +1228,10 @@ namespace rangelua::backend {
                 // Loop instructions with backward jumps
                 case OpCode::OP_FORLOOP: {
                     std::int32_t sbx = InstructionEncoder::decode_sbx(instr);
-                    std::int64_t target = static_cast<std::int64_t>(index) + 1 - sbx;
+                    std::int64_t target = static_cast<std::int64_t>(index) + 1 + sbx;
 
                     if (target < 0 ||
-                        target >= static_cast<std::int64_t>(function.instructions.size())) {
+                        target > static_cast<std::int64_t>(function.instructions.size())) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
@@ -1155,7 +1243,7 @@ namespace rangelua::backend {
                     std::int64_t target = static_cast<std::int64_t>(index) + 1 + sbx;
 
                     if (target < 0 ||
-                        target >= static_cast<std::int64_t>(function.instructions.size())) {
+                        target > static_cast<std::int64_t>(function.instructions.size())) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
@@ -1166,7 +1254,7 @@ namespace rangelua::backend {
                     std::uint32_t bx = InstructionEncoder::decode_bx(instr);
                     std::int64_t target = static_cast<std::int64_t>(index) + 1 + bx;
 
-                    if (target >= static_cast<std::int64_t>(function.instructions.size())) {
+                    if (target > static_cast<std::int64_t>(function.instructions.size())) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
@@ -1197,7 +1285,20 @@ namespace rangelua::backend {
                     // These instructions conditionally skip the next instruction
                     std::int64_t target = static_cast<std::int64_t>(index) + 2;
 
-                    if (target >= static_cast<std::int64_t>(function.instructions.size())) {
+                    if (target > static_cast<std::int64_t>(function.instructions.size())) {
+                        return ErrorCode::RUNTIME_ERROR;
+                    }
+                    break;
+                }
+
+                // Compare-and-branch superinstructions jump forward by C
+                case OpCode::OP_EQJMP:
+                case OpCode::OP_LTJMP:
+                case OpCode::OP_LEJMP: {
+                    std::int64_t target = static_cast<std::int64_t>(index) + 1 +
+                                          InstructionEncoder::decode_c(instr);
+
+                    if (target > static_cast<std::int64_t>(function.instructions.size())) {
                         return ErrorCode::RUNTIME_ERROR;
                     }
                     break;
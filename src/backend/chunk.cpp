@@ -0,0 +1,540 @@
+/**
+ * @file chunk.cpp
+ * @brief Writing and mapping of precompiled bytecode chunks
+ * @version 0.1.0
+ */
+
+#include <rangelua/backend/chunk.hpp>
+#include <rangelua/core/config.hpp>
+#include <rangelua/utils/logger.hpp>
+#include <rangelua/utils/mapped_file.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace rangelua::backend {
+
+    namespace {
+
+        constexpr Int INT_SAMPLE = 0x5678;
+        constexpr Number NUMBER_SAMPLE = 370.5;
+        constexpr Size INSTRUCTION_ALIGNMENT = alignof(Instruction);
+
+        enum class ConstantTag : std::uint8_t { Nil, False, True, Integer, Float, String };
+
+        constexpr std::uint8_t CACHE_ENTRY_SIGNATURE[4] = {'R', 'L', 'C', 'E'};
+        // Signature, optimization level, source size, check hash and compile time
+        constexpr Size CACHE_HEADER_SIZE = 32;
+        constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+        // Independent basis for the check hash stored inside each entry
+        constexpr std::uint64_t CHECK_OFFSET_BASIS = 0x9E3779B97F4A7C15ULL;
+
+        std::uint64_t fnv1a(std::uint64_t hash, const void* data, Size size) noexcept {
+            const auto* bytes = static_cast<const std::uint8_t*>(data);
+            for (Size i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Appends fixed-size values and length-prefixed strings to a byte buffer
+         */
+        class ChunkBuffer {
+        public:
+            template <typename T>
+            void write(T value) {
+                const auto* bytes = reinterpret_cast<const char*>(&value);
+                data_.append(bytes, sizeof(T));
+            }
+
+            void write_count(Size count) { write(static_cast<std::uint32_t>(count)); }
+
+            void write_string(const String& value) {
+                write_count(value.size());
+                data_.append(value);
+            }
+
+            void align(Size alignment) { data_.resize((data_.size() + alignment - 1) / alignment * alignment); }
+
+            template <typename Function>
+            void write_function(const Function& function) {
+                write_string(function.name);
+                write_string(function.source_name);
+                write_count(function.parameter_count);
+                write_count(function.stack_size);
+                write(static_cast<std::uint8_t>(function.is_vararg ? 1 : 0));
+
+                write_count(function.instructions.size());
+                align(INSTRUCTION_ALIGNMENT);
+                data_.append(reinterpret_cast<const char*>(function.instructions.data()),
+                             function.instructions.size() * sizeof(Instruction));
+
+                write_count(function.constants.size());
+                for (const auto& constant : function.constants) {
+                    write_constant(constant);
+                }
+
+                write_count(function.locals.size());
+                for (const auto& local : function.locals) {
+                    write_string(local);
+                }
+
+                write_count(function.upvalue_descriptors.size());
+                for (const auto& upvalue : function.upvalue_descriptors) {
+                    write_string(upvalue.name);
+                    write(static_cast<std::uint8_t>(upvalue.in_stack ? 1 : 0));
+                    write(upvalue.index);
+                }
+
+                write_count(function.line_info.size());
+                for (Size line : function.line_info) {
+                    write(static_cast<std::uint32_t>(line));
+                }
+            }
+
+            String take() { return std::move(data_); }
+
+        private:
+            void write_constant(const ConstantValue& constant) {
+                std::visit(
+                    [this](const auto& value) {
+                        using T = std::decay_t<decltype(value)>;
+                        if constexpr (std::is_same_v<T, std::monostate>) {
+                            write(ConstantTag::Nil);
+                        } else if constexpr (std::is_same_v<T, bool>) {
+                            write(value ? ConstantTag::True : ConstantTag::False);
+                        } else if constexpr (std::is_same_v<T, Int>) {
+                            write(ConstantTag::Integer);
+                            write(value);
+                        } else if constexpr (std::is_same_v<T, Number>) {
+                            write(ConstantTag::Float);
+                            write(value);
+                        } else if constexpr (std::is_same_v<T, String>) {
+                            write(ConstantTag::String);
+                            write_string(value);
+                        }
+                    },
+                    constant);
+            }
+
+            String data_;
+        };
+
+        /**
+         * @brief Bounds-checked cursor over chunk bytes; any overrun marks the chunk invalid
+         */
+        class ChunkReader {
+        public:
+            explicit ChunkReader(std::span<const std::uint8_t> data) noexcept : data_(data) {}
+
+            template <typename T>
+            bool read(T& value) {
+                if (!ensure(sizeof(T))) {
+                    return false;
+                }
+                std::memcpy(&value, data_.data() + offset_, sizeof(T));
+                offset_ += sizeof(T);
+                return true;
+            }
+
+            bool read_count(Size& count) {
+                std::uint32_t value = 0;
+                if (!read(value)) {
+                    return false;
+                }
+                count = value;
+                return true;
+            }
+
+            bool read_string(String& value) {
+                Size length = 0;
+                if (!read_count(length) || !ensure(length)) {
+                    return false;
+                }
+                value.assign(reinterpret_cast<const char*>(data_.data() + offset_), length);
+                offset_ += length;
+                return true;
+            }
+
+            bool align(Size alignment) {
+                Size aligned = (offset_ + alignment - 1) / alignment * alignment;
+                if (aligned > data_.size()) {
+                    return false;
+                }
+                offset_ = aligned;
+                return true;
+            }
+
+            bool read_function(BytecodeFunction& function) {
+                std::uint8_t is_vararg = 0;
+                Size count = 0;
+                if (!read_string(function.name) || !read_string(function.source_name) ||
+                    !read_count(function.parameter_count) || !read_count(function.stack_size) ||
+                    !read(is_vararg)) {
+                    return false;
+                }
+                function.is_vararg = is_vararg != 0;
+
+                // Instructions are copied from the mapping in one block
+                if (!read_count(count) || !align(INSTRUCTION_ALIGNMENT) ||
+                    !ensure(count * sizeof(Instruction))) {
+                    return false;
+                }
+                function.instructions.resize(count);
+                std::memcpy(
+                    function.instructions.data(), data_.data() + offset_, count * sizeof(Instruction));
+                offset_ += count * sizeof(Instruction);
+
+                if (!read_count(count) || !plausible(count)) {
+                    return false;
+                }
+                function.constants.reserve(count);
+                for (Size i = 0; i < count; ++i) {
+                    if (!read_constant(function.constants.emplace_back())) {
+                        return false;
+                    }
+                }
+
+                if (!read_strings(function.locals)) {
+                    return false;
+                }
+
+                if (!read_count(count) || !plausible(count)) {
+                    return false;
+                }
+                function.upvalue_descriptors.resize(count);
+                for (auto& upvalue : function.upvalue_descriptors) {
+                    std::uint8_t in_stack = 0;
+                    if (!read_string(upvalue.name) || !read(in_stack) || !read(upvalue.index)) {
+                        return false;
+                    }
+                    upvalue.in_stack = in_stack != 0;
+                }
+
+                if (!read_count(count) || !ensure(count * sizeof(std::uint32_t))) {
+                    return false;
+                }
+                function.line_info.resize(count);
+                for (Size& line : function.line_info) {
+                    std::uint32_t value = 0;
+                    read(value);
+                    line = value;
+                }
+                return true;
+            }
+
+            bool read_strings(std::vector<String>& values) {
+                Size count = 0;
+                if (!read_count(count) || !plausible(count)) {
+                    return false;
+                }
+                values.resize(count);
+                return std::all_of(
+                    values.begin(), values.end(), [this](String& value) { return read_string(value); });
+            }
+
+            [[nodiscard]] bool at_end() const noexcept { return offset_ == data_.size(); }
+
+        private:
+            bool ensure(Size bytes) const noexcept { return bytes <= data_.size() - offset_; }
+
+            // Every counted element takes at least one byte; rejects absurd counts before allocating
+            bool plausible(Size count) const noexcept { return ensure(count); }
+
+            bool read_constant(ConstantValue& constant) {
+                ConstantTag tag{};
+                if (!read(tag)) {
+                    return false;
+                }
+                switch (tag) {
+                    case ConstantTag::Nil:
+                        constant = std::monostate{};
+                        return true;
+                    case ConstantTag::False:
+                    case ConstantTag::True:
+                        constant = tag == ConstantTag::True;
+                        return true;
+                    case ConstantTag::Integer: {
+                        Int value = 0;
+                        constant = value;
+                        return read(std::get<Int>(constant));
+                    }
+                    case ConstantTag::Float: {
+                        Number value = 0;
+                        constant = value;
+                        return read(std::get<Number>(constant));
+                    }
+                    case ConstantTag::String:
+                        constant = String{};
+                        return read_string(std::get<String>(constant));
+                }
+                return false;
+            }
+
+            std::span<const std::uint8_t> data_;
+            Size offset_ = 0;
+        };
+
+        bool is_valid(const BytecodeFunction& function) {
+            auto result = BytecodeValidator::validate(function);
+            if (BytecodeValidator::is_valid(result)) {
+                return true;
+            }
+            for (const auto& error : BytecodeValidator::get_errors(result)) {
+                CODEGEN_LOG_ERROR("Chunk function '{}' invalid at {}: {}",
+                                  function.name,
+                                  error.instruction_index,
+                                  error.message);
+            }
+            return false;
+        }
+
+    }  // namespace
+
+    String ChunkWriter::write(const BytecodeFunction& function) {
+        ChunkBuffer buffer;
+        for (std::uint8_t byte : CHUNK_SIGNATURE) {
+            buffer.write(byte);
+        }
+        buffer.write(CHUNK_FORMAT_VERSION);
+        buffer.write(static_cast<std::uint32_t>(OpCode::NUM_ALL_OPCODES));
+        buffer.write(static_cast<std::uint8_t>(sizeof(Instruction)));
+        buffer.write(static_cast<std::uint8_t>(sizeof(Int)));
+        buffer.write(static_cast<std::uint8_t>(sizeof(Number)));
+        buffer.write(INT_SAMPLE);
+        buffer.write(NUMBER_SAMPLE);
+
+        buffer.write_function(function);
+        buffer.write_count(function.upvalues.size());
+        for (const auto& upvalue : function.upvalues) {
+            buffer.write_string(upvalue);
+        }
+        buffer.write_count(function.prototypes.size());
+        for (const auto& prototype : function.prototypes) {
+            buffer.write_function(prototype);
+        }
+        return buffer.take();
+    }
+
+    Status ChunkWriter::write_file(const BytecodeFunction& function, const String& path) {
+        String bytes = write(function);
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!output) {
+            CODEGEN_LOG_ERROR("Cannot write chunk file '{}'", path);
+            return ErrorCode::IO_ERROR;
+        }
+        return std::monostate{};
+    }
+
+    bool ChunkLoader::has_signature(std::span<const std::uint8_t> data) noexcept {
+        return data.size() >= sizeof(CHUNK_SIGNATURE) &&
+               std::equal(std::begin(CHUNK_SIGNATURE), std::end(CHUNK_SIGNATURE), data.begin());
+    }
+
+    bool ChunkLoader::is_chunk_file(const String& path) {
+        std::ifstream input(path, std::ios::binary);
+        std::uint8_t header[sizeof(CHUNK_SIGNATURE)] = {};
+        input.read(reinterpret_cast<char*>(header), sizeof(header));
+        return input.gcount() == static_cast<std::streamsize>(sizeof(header)) &&
+               has_signature(header);
+    }
+
+    Result<BytecodeFunction> ChunkLoader::load(std::span<const std::uint8_t> data) {
+        if (!has_signature(data)) {
+            CODEGEN_LOG_ERROR("Not a precompiled chunk");
+            return ErrorCode::SYNTAX_ERROR;
+        }
+
+        ChunkReader reader(data.subspan(sizeof(CHUNK_SIGNATURE)));
+        std::uint32_t version = 0;
+        std::uint32_t opcode_count = 0;
+        std::uint8_t instruction_size = 0;
+        std::uint8_t int_size = 0;
+        std::uint8_t number_size = 0;
+        Int int_sample = 0;
+        Number number_sample = 0;
+        if (!reader.read(version) || version != CHUNK_FORMAT_VERSION) {
+            CODEGEN_LOG_ERROR("Chunk format version {} does not match {}", version, CHUNK_FORMAT_VERSION);
+            return ErrorCode::SYNTAX_ERROR;
+        }
+        if (!reader.read(opcode_count) || !reader.read(instruction_size) || !reader.read(int_size) ||
+            !reader.read(number_size) ||
+            opcode_count != static_cast<std::uint32_t>(OpCode::NUM_ALL_OPCODES) ||
+            instruction_size != sizeof(Instruction) || int_size != sizeof(Int) ||
+            number_size != sizeof(Number) || !reader.read(int_sample) || int_sample != INT_SAMPLE ||
+            !reader.read(number_sample) || number_sample != NUMBER_SAMPLE) {
+            CODEGEN_LOG_ERROR("Chunk was written for a different instruction set or platform");
+            return ErrorCode::SYNTAX_ERROR;
+        }
+
+        BytecodeFunction main;
+        Size count = 0;
+        if (!reader.read_function(main) || !reader.read_strings(main.upvalues) ||
+            !reader.read_count(count) || count > data.size()) {
+            CODEGEN_LOG_ERROR("Truncated chunk");
+            return ErrorCode::SYNTAX_ERROR;
+        }
+        if (!is_valid(main)) {
+            return ErrorCode::SYNTAX_ERROR;
+        }
+
+        main.prototypes.reserve(count);
+        for (Size i = 0; i < count; ++i) {
+            BytecodeFunction function;
+            if (!reader.read_function(function)) {
+                CODEGEN_LOG_ERROR("Truncated chunk");
+                return ErrorCode::SYNTAX_ERROR;
+            }
+            if (!is_valid(function)) {
+                return ErrorCode::SYNTAX_ERROR;
+            }
+
+            auto& prototype = main.prototypes.emplace_back();
+            prototype.name = std::move(function.name);
+            prototype.instructions = std::move(function.instructions);
+            prototype.constants = std::move(function.constants);
+            prototype.locals = std::move(function.locals);
+            prototype.upvalue_descriptors = std::move(function.upvalue_descriptors);
+            prototype.parameter_count = function.parameter_count;
+            prototype.stack_size = function.stack_size;
+            prototype.is_vararg = function.is_vararg;
+            prototype.line_info = std::move(function.line_info);
+            prototype.source_name = std::move(function.source_name);
+        }
+
+        if (!reader.at_end()) {
+            CODEGEN_LOG_ERROR("Trailing data after chunk");
+            return ErrorCode::SYNTAX_ERROR;
+        }
+        return main;
+    }
+
+    Result<BytecodeFunction> ChunkLoader::load_file(const String& path) {
+        utils::MappedFile mapping(path);
+        if (!mapping.ok()) {
+            CODEGEN_LOG_ERROR("Cannot map chunk file '{}'", path);
+            return ErrorCode::IO_ERROR;
+        }
+        return load(mapping.bytes());
+    }
+
+    ChunkCache::ChunkCache(String directory, std::uint32_t optimization_level)
+        : directory_(std::move(directory)), optimization_level_(optimization_level) {}
+
+    String ChunkCache::entry_path(StringView source) const {
+        std::uint64_t key = fnv1a(FNV_OFFSET_BASIS, config::VERSION_STRING, std::strlen(config::VERSION_STRING));
+        key = fnv1a(key, &CHUNK_FORMAT_VERSION, sizeof(CHUNK_FORMAT_VERSION));
+        key = fnv1a(key, &optimization_level_, sizeof(optimization_level_));
+        key = fnv1a(key, source.data(), source.size());
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".rlc";
+        return (std::filesystem::path(directory_) / name.str()).string();
+    }
+
+    Optional<BytecodeFunction> ChunkCache::lookup(StringView source, const String& name) {
+        const auto start = std::chrono::steady_clock::now();
+        const String path = entry_path(source);
+
+        utils::MappedFile mapping(path);
+        if (!mapping.ok()) {
+            ++statistics_["misses"];
+            return std::nullopt;
+        }
+
+        ChunkReader reader(mapping.bytes());
+        std::uint8_t signature[sizeof(CACHE_ENTRY_SIGNATURE)] = {};
+        std::uint32_t optimization_level = 0;
+        std::uint64_t source_size = 0;
+        std::uint64_t check = 0;
+        std::uint64_t compile_nanoseconds = 0;
+        for (auto& byte : signature) {
+            reader.read(byte);
+        }
+        if (!reader.read(optimization_level) || !reader.read(source_size) || !reader.read(check) ||
+            !reader.read(compile_nanoseconds) ||
+            !std::equal(std::begin(signature), std::end(signature), std::begin(CACHE_ENTRY_SIGNATURE)) ||
+            optimization_level != optimization_level_ || source_size != source.size() ||
+            check != fnv1a(CHECK_OFFSET_BASIS, source.data(), source.size())) {
+            CODEGEN_LOG_WARN("Ignoring stale cache entry '{}'", path);
+            ++statistics_["misses"];
+            return std::nullopt;
+        }
+
+        auto loaded = ChunkLoader::load(mapping.bytes().subspan(CACHE_HEADER_SIZE));
+        if (is_error(loaded)) {
+            CODEGEN_LOG_WARN("Ignoring unreadable cache entry '{}'", path);
+            ++statistics_["misses"];
+            return std::nullopt;
+        }
+
+        BytecodeFunction function = std::move(get_value(loaded));
+        function.source_name = name;
+        for (auto& prototype : function.prototypes) {
+            prototype.source_name = name;
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+        const auto load_nanoseconds = static_cast<std::uint64_t>(elapsed.count());
+        if (compile_nanoseconds > load_nanoseconds) {
+            statistics_["time_saved_us"] += (compile_nanoseconds - load_nanoseconds) / 1000;
+        }
+        ++statistics_["hits"];
+        CODEGEN_LOG_DEBUG("Loaded '{}' from cache entry '{}'", name, path);
+        return function;
+    }
+
+    void ChunkCache::store(StringView source,
+                           const BytecodeFunction& function,
+                           std::chrono::nanoseconds compile_time) {
+        // Unique per process and per store, so concurrent writers never share a temporary
+        static std::atomic<std::uint64_t> store_counter{0};
+
+        const String path = entry_path(source);
+        const String temporary = path + "." + std::to_string(::getpid()) + "." +
+                                 std::to_string(store_counter.fetch_add(1)) + ".tmp";
+
+        ChunkBuffer header;
+        for (std::uint8_t byte : CACHE_ENTRY_SIGNATURE) {
+            header.write(byte);
+        }
+        header.write(optimization_level_);
+        header.write(static_cast<std::uint64_t>(source.size()));
+        header.write(fnv1a(CHECK_OFFSET_BASIS, source.data(), source.size()));
+        header.write(static_cast<std::uint64_t>(compile_time.count()));
+        String bytes = header.take();
+        bytes += ChunkWriter::write(function);
+
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+        {
+            std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+            output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            output.close();
+            if (!output) {
+                error = std::make_error_code(std::errc::io_error);
+            }
+        }
+        if (!error) {
+            // rename() replaces the entry atomically; readers never see a partial file
+            std::filesystem::rename(temporary, path, error);
+        }
+        if (error) {
+            CODEGEN_LOG_WARN("Cannot write cache entry '{}': {}", path, error.message());
+            std::filesystem::remove(temporary, error);
+            ++statistics_["store_failures"];
+            return;
+        }
+        ++statistics_["stores"];
+    }
+
+}  // namespace rangelua::backend
@@ -6,6 +6,11 @@
 
 #include <rangelua/backend/codegen.hpp>
 #include <rangelua/utils/logger.hpp>
+#include <rangelua/utils/parallel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace rangelua::backend {
 
@@ -25,6 +30,341 @@ namespace rangelua::backend {
             }
             return get_value(result);
         }
+
+        // Compile-time evaluation of constant expressions with Lua semantics
+        using LiteralValue = frontend::LiteralExpression::Value;
+        using BinaryOperator = frontend::BinaryOpExpression::Operator;
+        using UnaryOperator = frontend::UnaryOpExpression::Operator;
+
+        bool is_numeric(const LiteralValue& value) {
+            return std::holds_alternative<Int>(value) || std::holds_alternative<Number>(value);
+        }
+
+        Number as_float(const LiteralValue& value) {
+            return std::holds_alternative<Int>(value) ? static_cast<Number>(std::get<Int>(value))
+                                                      : std::get<Number>(value);
+        }
+
+        // Integers, and floats with an exact integer value, convert for bitwise operators
+        Optional<Int> as_integer(const LiteralValue& value) {
+            if (std::holds_alternative<Int>(value)) {
+                return std::get<Int>(value);
+            }
+            if (!std::holds_alternative<Number>(value)) {
+                return std::nullopt;
+            }
+            Number number = std::get<Number>(value);
+            constexpr Number TWO_POW_63 = 9223372036854775808.0;
+            if (std::floor(number) != number || number < -TWO_POW_63 || number >= TWO_POW_63) {
+                return std::nullopt;
+            }
+            return static_cast<Int>(number);
+        }
+
+        Int wrap(UInt value) { return static_cast<Int>(value); }
+
+        Int shift_left(Int x, Int y) {
+            constexpr Int INT_BITS = std::numeric_limits<UInt>::digits;
+            if (y < 0) {
+                return y <= -INT_BITS ? 0 : wrap(static_cast<UInt>(x) >> static_cast<UInt>(-y));
+            }
+            return y >= INT_BITS ? 0 : wrap(static_cast<UInt>(x) << static_cast<UInt>(y));
+        }
+
+        Int floor_divide(Int a, Int b) {
+            if (b == -1) {
+                return wrap(0U - static_cast<UInt>(a));  // Avoids overflow of INT_MIN // -1
+            }
+            Int quotient = a / b;
+            if ((a % b != 0) && ((a ^ b) < 0)) {
+                quotient -= 1;
+            }
+            return quotient;
+        }
+
+        Int floor_modulo(Int a, Int b) {
+            if (b == -1) {
+                return 0;
+            }
+            Int remainder = a % b;
+            if (remainder != 0 && (remainder ^ b) < 0) {
+                remainder += b;
+            }
+            return remainder;
+        }
+
+        Number float_modulo(Number a, Number b) {
+            Number remainder = std::fmod(a, b);
+            if ((remainder > 0) ? b < 0 : (remainder < 0 && b != remainder)) {
+                remainder += b;
+            }
+            return remainder;
+        }
+
+        // Integer and integer-valued operands of '..' have one spelling; floats are left to the
+        // runtime, which owns their formatting
+        Optional<String> concat_piece(const LiteralValue& value) {
+            if (std::holds_alternative<String>(value)) {
+                return std::get<String>(value);
+            }
+            if (std::holds_alternative<Int>(value)) {
+                return std::to_string(std::get<Int>(value));
+            }
+            return std::nullopt;
+        }
+
+        bool is_truthy(const LiteralValue& value) {
+            if (std::holds_alternative<std::monostate>(value)) {
+                return false;
+            }
+            return !std::holds_alternative<bool>(value) || std::get<bool>(value);
+        }
+
+        bool raw_equal(const LiteralValue& a, const LiteralValue& b) {
+            if (is_numeric(a) && is_numeric(b)) {
+                if (std::holds_alternative<Int>(a) && std::holds_alternative<Int>(b)) {
+                    return std::get<Int>(a) == std::get<Int>(b);
+                }
+                auto ia = as_integer(a);
+                auto ib = as_integer(b);
+                if (ia && ib) {
+                    return *ia == *ib;
+                }
+                return as_float(a) == as_float(b);
+            }
+            return a == b;
+        }
+
+        // Ordering of two numbers or two strings; nullopt when the comparison is not exact or
+        // would raise an error at runtime
+        Optional<bool> less_than(const LiteralValue& a, const LiteralValue& b, bool or_equal) {
+            if (std::holds_alternative<String>(a) && std::holds_alternative<String>(b)) {
+                int order = std::get<String>(a).compare(std::get<String>(b));
+                return or_equal ? order <= 0 : order < 0;
+            }
+            if (!is_numeric(a) || !is_numeric(b)) {
+                return std::nullopt;
+            }
+            if (std::holds_alternative<Int>(a) && std::holds_alternative<Int>(b)) {
+                Int ia = std::get<Int>(a);
+                Int ib = std::get<Int>(b);
+                return or_equal ? ia <= ib : ia < ib;
+            }
+            // Mixed comparisons are exact only while the integer is exactly a double
+            constexpr Int EXACT_LIMIT = Int{1} << std::numeric_limits<Number>::digits;
+            for (const auto* value : {&a, &b}) {
+                if (std::holds_alternative<Int>(*value) &&
+                    (std::get<Int>(*value) > EXACT_LIMIT || std::get<Int>(*value) < -EXACT_LIMIT)) {
+                    return std::nullopt;
+                }
+            }
+            Number fa = as_float(a);
+            Number fb = as_float(b);
+            return or_equal ? fa <= fb : fa < fb;
+        }
+
+        Optional<LiteralValue> fold_arithmetic(BinaryOperator op,
+                                                const LiteralValue& a,
+                                                const LiteralValue& b) {
+            if (!is_numeric(a) || !is_numeric(b)) {
+                return std::nullopt;
+            }
+
+            bool integers = std::holds_alternative<Int>(a) && std::holds_alternative<Int>(b);
+            switch (op) {
+                case BinaryOperator::BitwiseAnd:
+                case BinaryOperator::BitwiseOr:
+                case BinaryOperator::BitwiseXor:
+                case BinaryOperator::ShiftLeft:
+                case BinaryOperator::ShiftRight: {
+                    auto ia = as_integer(a);
+                    auto ib = as_integer(b);
+                    if (!ia || !ib) {
+                        return std::nullopt;  // Runtime error: no integer representation
+                    }
+                    switch (op) {
+                        case BinaryOperator::BitwiseAnd:
+                            return LiteralValue{*ia & *ib};
+                        case BinaryOperator::BitwiseOr:
+                            return LiteralValue{*ia | *ib};
+                        case BinaryOperator::BitwiseXor:
+                            return LiteralValue{*ia ^ *ib};
+                        case BinaryOperator::ShiftLeft:
+                            return LiteralValue{shift_left(*ia, *ib)};
+                        default:
+                            return LiteralValue{shift_left(*ia, wrap(0U - static_cast<UInt>(*ib)))};
+                    }
+                }
+                default:
+                    break;
+            }
+
+            // Division and modulo by zero are left to the runtime
+            if ((op == BinaryOperator::Divide || op == BinaryOperator::IntegerDivide ||
+                 op == BinaryOperator::Modulo) &&
+                as_float(b) == 0) {
+                return std::nullopt;
+            }
+
+            if (integers && op != BinaryOperator::Divide && op != BinaryOperator::Power) {
+                auto ua = static_cast<UInt>(std::get<Int>(a));
+                auto ub = static_cast<UInt>(std::get<Int>(b));
+                switch (op) {
+                    case BinaryOperator::Add:
+                        return LiteralValue{wrap(ua + ub)};
+                    case BinaryOperator::Subtract:
+                        return LiteralValue{wrap(ua - ub)};
+                    case BinaryOperator::Multiply:
+                        return LiteralValue{wrap(ua * ub)};
+                    case BinaryOperator::IntegerDivide:
+                        return LiteralValue{floor_divide(std::get<Int>(a), std::get<Int>(b))};
+                    case BinaryOperator::Modulo:
+                        return LiteralValue{floor_modulo(std::get<Int>(a), std::get<Int>(b))};
+                    default:
+                        return std::nullopt;
+                }
+            }
+
+            Number fa = as_float(a);
+            Number fb = as_float(b);
+            Number result = 0;
+            switch (op) {
+                case BinaryOperator::Add:
+                    result = fa + fb;
+                    break;
+                case BinaryOperator::Subtract:
+                    result = fa - fb;
+                    break;
+                case BinaryOperator::Multiply:
+                    result = fa * fb;
+                    break;
+                case BinaryOperator::Divide:
+                    result = fa / fb;
+                    break;
+                case BinaryOperator::IntegerDivide:
+                    result = std::floor(fa / fb);
+                    break;
+                case BinaryOperator::Modulo:
+                    result = float_modulo(fa, fb);
+                    break;
+                case BinaryOperator::Power:
+                    result = std::pow(fa, fb);
+                    break;
+                default:
+                    return std::nullopt;
+            }
+
+            // NaN and signed zeros do not survive the constant table; keep them at runtime
+            if (std::isnan(result) || result == 0) {
+                return std::nullopt;
+            }
+            return LiteralValue{result};
+        }
+
+        Optional<LiteralValue>
+        fold_binary(BinaryOperator op, const LiteralValue& a, const LiteralValue& b) {
+            switch (op) {
+                case BinaryOperator::Equal:
+                    return LiteralValue{raw_equal(a, b)};
+                case BinaryOperator::NotEqual:
+                    return LiteralValue{!raw_equal(a, b)};
+                case BinaryOperator::Less:
+                case BinaryOperator::LessEqual: {
+                    auto result = less_than(a, b, op == BinaryOperator::LessEqual);
+                    return result ? Optional<LiteralValue>{LiteralValue{*result}} : std::nullopt;
+                }
+                case BinaryOperator::Greater:
+                case BinaryOperator::GreaterEqual: {
+                    auto result = less_than(b, a, op == BinaryOperator::GreaterEqual);
+                    return result ? Optional<LiteralValue>{LiteralValue{*result}} : std::nullopt;
+                }
+                case BinaryOperator::And:
+                    return is_truthy(a) ? b : a;
+                case BinaryOperator::Or:
+                    return is_truthy(a) ? a : b;
+                case BinaryOperator::Concat: {
+                    auto left = concat_piece(a);
+                    auto right = concat_piece(b);
+                    if (!left || !right) {
+                        return std::nullopt;
+                    }
+                    return LiteralValue{*left + *right};
+                }
+                default:
+                    return fold_arithmetic(op, a, b);
+            }
+        }
+
+        Optional<LiteralValue> fold_unary(UnaryOperator op, const LiteralValue& operand) {
+            switch (op) {
+                case UnaryOperator::Not:
+                    return LiteralValue{!is_truthy(operand)};
+                case UnaryOperator::Minus:
+                    if (std::holds_alternative<Int>(operand)) {
+                        return LiteralValue{wrap(0U - static_cast<UInt>(std::get<Int>(operand)))};
+                    }
+                    if (std::holds_alternative<Number>(operand) && std::get<Number>(operand) != 0 &&
+                        !std::isnan(std::get<Number>(operand))) {
+                        return LiteralValue{-std::get<Number>(operand)};
+                    }
+                    return std::nullopt;
+                case UnaryOperator::Length:
+                    if (std::holds_alternative<String>(operand)) {
+                        return LiteralValue{static_cast<Int>(std::get<String>(operand).size())};
+                    }
+                    return std::nullopt;
+                case UnaryOperator::BitwiseNot: {
+                    auto value = as_integer(operand);
+                    if (!value) {
+                        return std::nullopt;
+                    }
+                    return LiteralValue{wrap(~static_cast<UInt>(*value))};
+                }
+            }
+            return std::nullopt;
+        }
+
+        FunctionSignature make_signature(String name,
+                                         const frontend::FunctionExpression::ParameterList& parameters) {
+            FunctionSignature signature;
+            signature.name = std::move(name);
+            for (const auto& param : parameters) {
+                if (param.is_vararg) {
+                    signature.is_vararg = true;
+                    continue;  // Don't allocate register for vararg parameter
+                }
+                signature.parameters.emplace_back(param.name);
+            }
+            return signature;
+        }
+
+        // GETI/SETI take the key itself, and GETFIELD/SETFIELD its constant index, in an 8-bit
+        // operand; any other key goes through a register and GETTABLE/SETTABLE
+        bool is_short_int_key(const ExpressionDesc& key) {
+            return key.kind == ExpressionKind::KINT && key.u.ival >= 0 &&
+                   key.u.ival <= static_cast<Int>(InstructionEncoder::MAX_C);
+        }
+
+        bool is_short_constant_key(const ExpressionDesc& key) {
+            return (key.kind == ExpressionKind::K || key.kind == ExpressionKind::KSTR) &&
+                   key.u.info <= InstructionEncoder::MAX_C;
+        }
+
+        // Nested prototypes of a nested function are not kept
+        FunctionPrototype to_prototype(BytecodeFunction function) {
+            FunctionPrototype prototype;
+            prototype.name = std::move(function.name);
+            prototype.instructions = std::move(function.instructions);
+            prototype.constants = std::move(function.constants);
+            prototype.locals = std::move(function.locals);
+            prototype.upvalue_descriptors = std::move(function.upvalue_descriptors);
+            prototype.parameter_count = function.parameter_count;
+            prototype.stack_size = function.stack_size;
+            prototype.is_vararg = function.is_vararg;
+            prototype.line_info = std::move(function.line_info);
+            prototype.source_name = std::move(function.source_name);
+            return prototype;
+        }
     }  // anonymous namespace
 
     // RegisterAllocator implementation (Lua 5.5 style)
@@ -749,19 +1089,43 @@ namespace rangelua::backend {
         }
     }
 
-    Size ScopeManager::declare_local(String name, Register reg) {
+    Size ScopeManager::declare_local(StringView name, Register reg, bool is_const) {
         Size index = locals_.size();
 
         // Add to locals vector
-        locals_.push_back({name, reg, 0, 0, false});
+        locals_.push_back({String(name), reg, 0, 0, false, is_const});
 
         // Update name mapping
-        local_names_[name] = index;
+        local_names_.insert_or_assign(String(name), index);
+
+        return index;
+    }
 
+    Size ScopeManager::declare_constant(StringView name, frontend::LiteralExpression::Value value) {
+        Size index = declare_local(name, 0, true);
+        locals_[index].value = std::move(value);
         return index;
     }
 
-    ScopeManager::VariableResolution ScopeManager::resolve_variable(const String& name) {
+    void ScopeManager::import_constants(const ScopeManager& enclosing) {
+        // Only constants that are not shadowed in the enclosing function are visible
+        for (const auto& [name, index] : enclosing.local_names_) {
+            const auto& local = enclosing.locals_[index];
+            if (local.value) {
+                declare_constant(name, *local.value);
+            }
+        }
+    }
+
+    const ScopeManager::LocalVariable* ScopeManager::find_local(StringView name) const {
+        auto local_it = local_names_.find(name);
+        if (local_it == local_names_.end() || local_it->second >= locals_.size()) {
+            return nullptr;
+        }
+        return &locals_[local_it->second];
+    }
+
+    ScopeManager::VariableResolution ScopeManager::resolve_variable(StringView name) {
         // First check local variables (from innermost to outermost scope)
         auto local_it = local_names_.find(name);
         if (local_it != local_names_.end()) {
@@ -790,6 +1154,11 @@ namespace rangelua::backend {
         return locals_;
     }
 
+    Size ScopeManager::register_local_count() const noexcept {
+        return static_cast<Size>(std::count_if(
+            locals_.begin(), locals_.end(), [](const LocalVariable& local) { return !local.value; }));
+    }
+
     // CodeGenerator implementation
     CodeGenerator::CodeGenerator(BytecodeEmitter& emitter)
         : emitter_(emitter), register_allocator_(256), jump_manager_(), scope_manager_() {
@@ -804,21 +1173,224 @@ namespace rangelua::backend {
     void CodeGenerator::update_register_allocator_nvarstack() {
         // Synchronize register allocator with scope manager
         // This ensures proper tracking of local variables for register management
-        Size current_locals = scope_manager_.current_locals().size();
+        Size current_locals = scope_manager_.register_local_count();
         register_allocator_.set_nvarstack(current_locals);
         CODEGEN_LOG_DEBUG("Updated register allocator nvarstack to {}", current_locals);
     }
 
     Status CodeGenerator::generate(const frontend::Program& ast) {
+        // Generate code for the program
+        ast.accept(*this);
+        return make_success();
+    }
+
+    void CodeGenerator::set_deferred_source(DeferredSource source) {
+        deferred_source_ = std::move(source);
+    }
+
+    void CodeGenerator::set_compile_jobs(Size jobs) {
+        compile_jobs_ = utils::resolve_jobs(jobs);
+    }
+
+    FunctionPrototype
+    CodeGenerator::generate_function(const FunctionSignature& signature,
+                                     const frontend::Statement& body,
+                                     const Optional<frontend::SourceRange>& deferred_body) {
+        if (!deferred_body && compile_jobs_ > 1) {
+            ScopeManager constants;
+            constants.import_constants(scope_manager_);
+            // The caller adds the returned stub next, so the body fills the next slot
+            pending_functions_.push_back(PendingFunction{
+                emitter_.prototypes().size(), signature, std::move(constants), &body});
+
+            FunctionPrototype prototype;
+            prototype.name = signature.name;
+            prototype.parameter_count = signature.parameters.size();
+            prototype.is_vararg = signature.is_vararg;
+            return prototype;
+        }
+        if (!deferred_body) {
+            return to_prototype(compile_function(signature, scope_manager_, body, deferred_source_));
+        }
+        if (!deferred_source_.text) {
+            CODEGEN_LOG_ERROR("No source to compile the deferred body of '{}' from",
+                              signature.name);
+            return to_prototype(compile_function(signature, scope_manager_, body, deferred_source_));
+        }
+
+        // Only the constants are captured; other names resolve inside the body
+        ScopeManager constants;
+        constants.import_constants(scope_manager_);
+
+        FunctionPrototype prototype;
+        prototype.name = signature.name;
+        prototype.parameter_count = signature.parameters.size();
+        prototype.is_vararg = signature.is_vararg;
+        prototype.deferred = std::make_shared<DeferredFunction>(
+            signature, std::move(constants), deferred_source_, *deferred_body);
+        CODEGEN_LOG_DEBUG("Deferred function body at line {} ({} bytes)",
+                          deferred_body->begin_location.line_,
+                          deferred_body->end - deferred_body->begin);
+        return prototype;
+    }
+
+    BytecodeFunction CodeGenerator::compile_function(const FunctionSignature& signature,
+                                                     const ScopeManager& enclosing,
+                                                     const frontend::Statement& body,
+                                                     const DeferredSource& source) {
+        // Create a new bytecode emitter and a separate code generator for the nested function
+        BytecodeEmitter nested_emitter(signature.name);
+        CodeGenerator nested_generator(nested_emitter);
+        nested_generator.set_deferred_source(source);
+        nested_generator.scope_manager().import_constants(enclosing);
+
+        // Declare parameters as local variables in the nested generator
+        if (signature.parameter_scope) {
+            nested_generator.scope_manager().enter_scope();
+        }
+        Size param_count = 0;
+        for (const auto& param : signature.parameters) {
+            auto param_reg_result = nested_generator.register_allocator().allocate();
+            if (is_success(param_reg_result)) {
+                Register param_reg = get_value(param_reg_result);
+                nested_generator.scope_manager().declare_local(param, param_reg);
+                param_count++;
+            }
+        }
+
+        // Set up function metadata
+        nested_emitter.set_parameter_count(param_count);
+        nested_emitter.set_vararg(signature.is_vararg);
+
+        // If this is a vararg function, emit VARARGPREP instruction
+        if (signature.is_vararg && signature.emit_varargprep) {
+            nested_emitter.emit_abc(
+                OpCode::OP_VARARGPREP, static_cast<Register>(param_count), 0, 0);
+            CODEGEN_LOG_DEBUG("Emitted VARARGPREP for function with {} parameters", param_count);
+        }
+
+        // Generate code for function body using the nested generator
+        body.accept(nested_generator);
+
+        if (signature.parameter_scope) {
+            nested_generator.scope_manager().exit_scope();
+        }
+
+        // Ensure function ends with return instruction
+        if (nested_emitter.instruction_count() == 0 ||
+            InstructionEncoder::decode_opcode(nested_emitter.instructions().back()) !=
+                OpCode::OP_RETURN) {
+            nested_emitter.emit_abc(OpCode::OP_RETURN, 0, 1, 0);  // Return with no values
+        }
+
+        // Update stack size for nested function
+        nested_emitter.set_stack_size(nested_generator.register_allocator().high_water_mark() + 1);
+
+        return nested_emitter.get_function();
+    }
+
+    void CodeGenerator::compile_pending_functions() {
+        if (pending_functions_.empty()) {
+            return;
+        }
+        CODEGEN_LOG_DEBUG("Compiling {} function bodies on {} threads",
+                          pending_functions_.size(),
+                          compile_jobs_);
+
+        // Every body writes only its own slot; the vector is not resized meanwhile
+        auto& prototypes = emitter_.prototypes();
+        utils::parallel_for(pending_functions_.size(), compile_jobs_, [&](Size index) {
+            const auto& pending = pending_functions_[index];
+            prototypes[pending.prototype_index] = to_prototype(compile_function(
+                pending.signature, pending.constants, *pending.body, deferred_source_));
+        });
+        pending_functions_.clear();
+    }
+
+    // DeferredFunction implementation
+    DeferredFunction::DeferredFunction(FunctionSignature signature,
+                                       ScopeManager constants,
+                                       DeferredSource source,
+                                       frontend::SourceRange range)
+        : signature_(std::move(signature)),
+          constants_(std::move(constants)),
+          source_(std::move(source)),
+          range_(range) {}
+
+    Result<const FunctionPrototype*> DeferredFunction::compile() const {
+        std::call_once(compiled_, [this] { prototype_ = build(); });
+        if (is_error(prototype_)) {
+            return get_error(prototype_);
+        }
+        return &get_value(prototype_);
+    }
+
+    Result<FunctionPrototype> DeferredFunction::build() const {
+        CODEGEN_LOG_DEBUG("Compiling deferred function '{}' from line {}",
+                          signature_.name,
+                          range_.begin_location.line_);
+
+        const StringView text =
+            StringView(*source_.text).substr(range_.begin, range_.end - range_.begin);
+        frontend::Lexer lexer(text, range_.begin_location);
+        frontend::ParserConfig config;
+        config.lazy_functions = true;  // Functions nested in this one stay deferred too
+        frontend::Parser parser(lexer, config);
+        auto body = parser.parse_block();
+        if (is_error(body)) {
+            return get_error(body);
+        }
+
+        BytecodeFunction function =
+            CodeGenerator::compile_function(signature_, constants_, *get_value(body), source_);
+        // Compiled with the chunk, the body would have been optimized on its own as well
+        function.prototypes.clear();
+        if (source_.optimization_level != Optimizer::OptimizationLevel::None) {
+            Optimizer optimizer(source_.optimization_level);
+            if (auto status = optimizer.optimize_chunk(function); is_error(status)) {
+                return get_error(status);
+            }
+        }
+        return to_prototype(std::move(function));
+    }
+
+    void CodeGenerator::begin_chunk(const SourceLocation& location) {
         CODEGEN_LOG_INFO("Starting code generation for program");
 
         // Reset state for new compilation
         register_allocator_.reset();
         current_expression_.reset();
-        emitter_.set_source_name(ast.location().filename_);
+        emitter_.set_source_name(String(location.filename()));
+        emitter_.set_current_line(location.line_);
 
-        // Generate code for the program
-        ast.accept(*this);
+        // Enter global scope
+        scope_manager_.enter_scope();
+
+        // Clear any previous state
+        loop_stack_.clear();
+        labels_.clear();
+        pending_gotos_.clear();
+    }
+
+    Status CodeGenerator::consume(const frontend::Statement& statement) {
+        statement.accept(*this);
+        // The statement is released after this call, so its queued bodies cannot wait
+        compile_pending_functions();
+        return make_success();
+    }
+
+    Status CodeGenerator::end_chunk() {
+        // Resolve any pending goto statements
+        resolve_pending_gotos();
+
+        // Check for unclosed loops (should not happen with proper AST)
+        if (!loop_stack_.empty()) {
+            CODEGEN_LOG_ERROR("Program ended with {} unclosed loop contexts", loop_stack_.size());
+            loop_stack_.clear();
+        }
+
+        // Exit global scope
+        scope_manager_.exit_scope();
 
         // Emit final return instruction if not already present
         if (emitter_.instruction_count() == 0 ||
@@ -887,42 +1459,20 @@ namespace rangelua::backend {
         emitter_.set_current_line(node.location().line_);
         CODEGEN_LOG_DEBUG("Generating code for literal expression");
 
-        ExpressionDesc expr;
-
-        // Set expression type based on literal value
-        std::visit(
-            [&expr, this](const auto& value) {
-                using T = std::decay_t<decltype(value)>;
-                if constexpr (std::is_same_v<T, std::monostate>) {
-                    expr.kind = ExpressionKind::NIL;
-                } else if constexpr (std::is_same_v<T, bool>) {
-                    expr.kind = value ? ExpressionKind::TRUE : ExpressionKind::FALSE;
-                } else if constexpr (std::is_same_v<T, Int>) {
-                    expr.kind = ExpressionKind::KINT;
-                    expr.u.ival = value;
-                } else if constexpr (std::is_same_v<T, Number>) {
-                    expr.kind = ExpressionKind::KFLT;
-                    expr.u.nval = value;
-                    // Add floating-point constant to constant table
-                    expr.kind = ExpressionKind::K;
-                    expr.u.info = emitter_.add_constant(value);
-                } else if constexpr (std::is_same_v<T, String>) {
-                    expr.kind = ExpressionKind::KSTR;
-                    // For now, put string constants in constant table
-                    // In a full implementation, we'd check if it's a short string first
-                    expr.kind = ExpressionKind::K;
-                    expr.u.info = emitter_.add_constant(value);
-                }
-            },
-            node.value());
-
-        current_expression_ = expr;
+        current_expression_ = constant_expression(node.value());
     }
 
     void CodeGenerator::visit(const frontend::IdentifierExpression& node) {
         emitter_.set_current_line(node.location().line_);
         CODEGEN_LOG_DEBUG("Generating code for identifier: {}", node.name());
 
+        // Compile-time constants are replaced by their value
+        if (const auto* local = scope_manager_.find_local(node.name()); local && local->value) {
+            CODEGEN_LOG_DEBUG("Constant '{}' substituted", node.name());
+            current_expression_ = constant_expression(*local->value);
+            return;
+        }
+
         // Resolve the variable
         auto resolution = scope_manager_.resolve_variable(node.name());
 
@@ -950,7 +1500,7 @@ namespace rangelua::backend {
             case ScopeManager::VariableResolution::Type::Global:
                 // Global variable - will be loaded when discharged
                 expr.kind = ExpressionKind::GLOBAL;
-                expr.u.info = emitter_.add_constant(node.name());
+                expr.u.info = emitter_.add_constant(String(node.name()));
                 CODEGEN_LOG_DEBUG(
                     "Global variable '{}' with constant index {}", node.name(), expr.u.info);
                 break;
@@ -963,6 +1513,12 @@ namespace rangelua::backend {
         emitter_.set_current_line(node.location().line_);
         CODEGEN_LOG_DEBUG("Generating code for binary operation");
 
+        // Operations on constants are evaluated at compile time
+        if (auto folded = fold_constant(node)) {
+            current_expression_ = constant_expression(*folded);
+            return;
+        }
+
         // Handle logical operators specially for short-circuit evaluation
         if (node.operator_type() == frontend::BinaryOpExpression::Operator::And) {
             generate_logical_and_expression(node.left(), node.right());
@@ -990,12 +1546,6 @@ namespace rangelua::backend {
         }
         ExpressionDesc right_expr = current_expression_.value();
 
-        // Try constant folding first
-        if (try_constant_folding(node.operator_type(), left_expr, right_expr)) {
-            current_expression_ = left_expr;  // Result is in left_expr after folding
-            return;
-        }
-
         // Convert operands to registers
         Register left_reg = expression_to_any_register(left_expr);
         Register right_reg = expression_to_any_register(right_expr);
@@ -1362,6 +1912,11 @@ namespace rangelua::backend {
         emitter_.set_current_line(node.location().line_);
         CODEGEN_LOG_DEBUG("Generating code for unary operation");
 
+        if (auto folded = fold_constant(node)) {
+            current_expression_ = constant_expression(*folded);
+            return;
+        }
+
         // Generate code for operand
         node.operand().accept(*this);
         if (!current_expression_.has_value()) {
@@ -1571,6 +2126,10 @@ namespace rangelua::backend {
         const auto& targets = node.targets();
         const auto& values = node.values();
 
+        for (const auto& target : targets) {
+            check_assignable(*target);
+        }
+
         // Special handling for multiple targets with single function call
         if (targets.size() > 1 && values.size() == 1) {
             // Check if the single value is a function call that might return multiple values
@@ -1649,7 +2208,8 @@ namespace rangelua::backend {
                             case ScopeManager::VariableResolution::Type::Global: {
                                 // Global variable assignment using _ENV upvalue
                                 // SETTABUP: UpValue[A][K[B]] := R[C]
-                                Size const_index = emitter_.add_constant(identifier->name());
+                                Size const_index =
+                                    emitter_.add_constant(String(identifier->name()));
                                 CODEGEN_LOG_DEBUG("Emitting SETTABUP for global '{}': upvalue=0, "
                                                   "key=K[{}], value=R[{}]",
                                                   identifier->name(),
@@ -1686,15 +2246,14 @@ namespace rangelua::backend {
                         Register value_reg = result_reg;
 
                         // Emit appropriate SET instruction based on key type
-                        if (key_expr.kind == ExpressionKind::KINT) {
+                        if (is_short_int_key(key_expr)) {
                             // Use SETI for integer constants
                             emitter_.emit_abc(OpCode::OP_SETI,
                                               table_reg,
                                               static_cast<Register>(key_expr.u.ival),
                                               value_reg);
                             free_expression(key_expr);
-                        } else if (key_expr.kind == ExpressionKind::K ||
-                                   key_expr.kind == ExpressionKind::KSTR) {
+                        } else if (is_short_constant_key(key_expr)) {
                             // Use SETFIELD for string constants and floating-point constants
                             emitter_.emit_abc(OpCode::OP_SETFIELD,
                                               table_reg,
@@ -1772,7 +2331,7 @@ namespace rangelua::backend {
                             // Global variable assignment using _ENV upvalue
                             // SETTABUP: UpValue[A][K[B]] := R[C]
                             Register value_reg = expression_to_any_register(value_expr);
-                            Size const_index = emitter_.add_constant(identifier->name());
+                            Size const_index = emitter_.add_constant(String(identifier->name()));
                             CODEGEN_LOG_DEBUG("Emitting SETTABUP for global '{}': upvalue=0, "
                                               "key=K[{}], value=R[{}]",
                                               identifier->name(),
@@ -1809,15 +2368,14 @@ namespace rangelua::backend {
                     Register value_reg = expression_to_any_register(value_expr);
 
                     // Emit appropriate SET instruction based on key type
-                    if (key_expr.kind == ExpressionKind::KINT) {
+                    if (is_short_int_key(key_expr)) {
                         // Use SETI for integer constants
                         emitter_.emit_abc(OpCode::OP_SETI,
                                           table_reg,
                                           static_cast<Register>(key_expr.u.ival),
                                           value_reg);
                         free_expression(key_expr);
-                    } else if (key_expr.kind == ExpressionKind::K ||
-                               key_expr.kind == ExpressionKind::KSTR) {
+                    } else if (is_short_constant_key(key_expr)) {
                         // Use SETFIELD for string constants and floating-point constants
                         emitter_.emit_abc(OpCode::OP_SETFIELD,
                                           table_reg,
@@ -1927,64 +2485,81 @@ namespace rangelua::backend {
     }
 
     void CodeGenerator::visit(const frontend::Program& node) {
-        emitter_.set_current_line(node.location().line_);
-        CODEGEN_LOG_DEBUG("Generating code for program");
-
-        // Enter global scope
-        scope_manager_.enter_scope();
-
-        // Clear any previous state
-        loop_stack_.clear();
-        labels_.clear();
-        pending_gotos_.clear();
-
-        // Generate code for all statements
+        // The whole-tree path and single-pass parsing share one statement sequence
+        begin_chunk(node.location());
         for (const auto& stmt : node.statements()) {
             stmt->accept(*this);
         }
+        compile_pending_functions();
+        end_chunk();
+    }
 
-        // Resolve any pending goto statements
-        resolve_pending_gotos();
-
-        // Check for unclosed loops (should not happen with proper AST)
-        if (!loop_stack_.empty()) {
-            CODEGEN_LOG_ERROR("Program ended with {} unclosed loop contexts", loop_stack_.size());
-            loop_stack_.clear();
+    // Helper method implementations
+    Optional<frontend::LiteralExpression::Value>
+    CodeGenerator::fold_constant(const frontend::Expression& expr) const {
+        if (const auto* literal = dynamic_cast<const frontend::LiteralExpression*>(&expr)) {
+            return literal->value();
+        }
+        if (const auto* identifier = dynamic_cast<const frontend::IdentifierExpression*>(&expr)) {
+            const auto* local = scope_manager_.find_local(identifier->name());
+            return local ? local->value : std::nullopt;
+        }
+        if (const auto* paren = dynamic_cast<const frontend::ParenthesizedExpression*>(&expr)) {
+            return fold_constant(paren->expression());
+        }
+        if (const auto* unary = dynamic_cast<const frontend::UnaryOpExpression*>(&expr)) {
+            auto operand = fold_constant(unary->operand());
+            return operand ? fold_unary(unary->operator_type(), *operand) : std::nullopt;
+        }
+        if (const auto* binary = dynamic_cast<const frontend::BinaryOpExpression*>(&expr)) {
+            auto left = fold_constant(binary->left());
+            if (!left) {
+                return std::nullopt;
+            }
+            auto right = fold_constant(binary->right());
+            return right ? fold_binary(binary->operator_type(), *left, *right) : std::nullopt;
         }
+        return std::nullopt;
+    }
 
-        // Exit global scope
-        scope_manager_.exit_scope();
-
-        CODEGEN_LOG_DEBUG("Program code generation completed");
+    ExpressionDesc CodeGenerator::constant_expression(const frontend::LiteralExpression::Value& value) {
+        ExpressionDesc expr;
+        std::visit(
+            [&expr, this](const auto& value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, std::monostate>) {
+                    expr.kind = ExpressionKind::NIL;
+                } else if constexpr (std::is_same_v<T, bool>) {
+                    expr.kind = value ? ExpressionKind::TRUE : ExpressionKind::FALSE;
+                } else if constexpr (std::is_same_v<T, Int>) {
+                    expr.kind = ExpressionKind::KINT;
+                    expr.u.ival = value;
+                } else if constexpr (std::is_same_v<T, Number>) {
+                    // Floating-point constants live in the constant table
+                    expr.kind = ExpressionKind::K;
+                    expr.u.info = emitter_.add_constant(value);
+                } else if constexpr (std::is_same_v<T, String>) {
+                    // For now, put string constants in constant table
+                    // In a full implementation, we'd check if it's a short string first
+                    expr.kind = ExpressionKind::K;
+                    expr.u.info = emitter_.add_constant(value);
+                }
+            },
+            value);
+        return expr;
     }
 
-    // Helper method implementations
-    bool CodeGenerator::try_constant_folding(frontend::BinaryOpExpression::Operator op,
-                                             ExpressionDesc& e1,
-                                             const ExpressionDesc& e2) {
-        // For now, implement basic constant folding for integers
-        if (e1.kind == ExpressionKind::KINT && e2.kind == ExpressionKind::KINT) {
-            switch (op) {
-                case frontend::BinaryOpExpression::Operator::Add:
-                    e1.u.ival += e2.u.ival;
-                    return true;
-                case frontend::BinaryOpExpression::Operator::Subtract:
-                    e1.u.ival -= e2.u.ival;
-                    return true;
-                case frontend::BinaryOpExpression::Operator::Multiply:
-                    e1.u.ival *= e2.u.ival;
-                    return true;
-                case frontend::BinaryOpExpression::Operator::IntegerDivide:
-                    if (e2.u.ival != 0) {
-                        e1.u.ival /= e2.u.ival;
-                        return true;
-                    }
-                    break;
-                default:
-                    break;
-            }
+    void CodeGenerator::check_assignable(const frontend::Expression& target) const {
+        const auto* identifier = dynamic_cast<const frontend::IdentifierExpression*>(&target);
+        if (identifier == nullptr) {
+            return;
+        }
+        const auto* local = scope_manager_.find_local(identifier->name());
+        if (local && local->is_const) {
+            throw SyntaxError("attempt to assign to const variable '" +
+                                  String(identifier->name()) + "'",
+                              target.location());
         }
-        return false;
     }
 
     void CodeGenerator::resolve_pending_gotos() {
@@ -2024,7 +2599,7 @@ namespace rangelua::backend {
         Register object_reg = expression_to_any_register(object_expr);
 
         // Get the method from the object
-        Size method_const_index = emitter_.add_constant(node.method_name());
+        Size method_const_index = emitter_.add_constant(String(node.method_name()));
         emitter_.emit_abc(
             OpCode::OP_GETTABLE, call_base, object_reg, static_cast<Register>(method_const_index));
 
@@ -2085,7 +2660,7 @@ namespace rangelua::backend {
         result_expr.u.indexed.table = expression_to_any_register(table_expr);
 
         // Check if key is a constant
-        if (key_expr.kind == ExpressionKind::KINT) {
+        if (is_short_int_key(key_expr)) {
             // For integer constants, store the integer value directly for GETI instruction
             result_expr.u.indexed.key = static_cast<Register>(key_expr.u.ival);
             result_expr.u.indexed.is_const_key = true;
@@ -2093,7 +2668,7 @@ namespace rangelua::backend {
             result_expr.u.indexed.is_string_key = false;
             // Free the key expression since we're using the constant
             free_expression(key_expr);
-        } else if (key_expr.kind == ExpressionKind::K || key_expr.kind == ExpressionKind::KSTR) {
+        } else if (is_short_constant_key(key_expr)) {
             // For string constants, use the constant index for GETFIELD instruction
             result_expr.u.indexed.key = static_cast<Register>(key_expr.u.info);
             result_expr.u.indexed.is_const_key = true;
@@ -2314,92 +2889,10 @@ namespace rangelua::backend {
         Register result_reg = get_value(reg_result);
         current_result_register_ = result_reg;
 
-        // Create a new bytecode emitter for the nested function
-        BytecodeEmitter nested_emitter("anonymous_function");
-
-        // Save current state and switch to nested function context
-        BytecodeEmitter* saved_emitter = &emitter_;
-        RegisterAllocator saved_allocator = register_allocator_;
-        register_allocator_ = RegisterAllocator(256);  // Fresh allocator for nested function
-        jump_manager_.set_emitter(&nested_emitter);
-
-        // Enter new scope for function parameters and body
-        scope_manager_.enter_scope();
-
-        // Declare parameters as local variables
-        bool has_vararg = false;
-        Size param_count = 0;
-        for (const auto& param : node.parameters()) {
-            if (param.is_vararg) {
-                has_vararg = true;
-                continue;  // Don't allocate register for vararg parameter
-            }
-
-            auto param_reg_result = register_allocator_.allocate();
-            if (is_success(param_reg_result)) {
-                Register param_reg = get_value(param_reg_result);
-                scope_manager_.declare_local(param.name, param_reg);
-                param_count++;
-            }
-        }
-
-        // Set up function metadata
-        nested_emitter.set_parameter_count(param_count);
-        nested_emitter.set_vararg(has_vararg);
-
-        // Create a separate code generator for the nested function
-        CodeGenerator nested_generator(nested_emitter);
-
-        // Transfer parameter declarations to the nested generator's scope
-        nested_generator.scope_manager().enter_scope();
-        for (const auto& param : node.parameters()) {
-            if (param.is_vararg) {
-                continue;  // Don't allocate register for vararg parameter
-            }
-
-            auto param_reg_result = nested_generator.register_allocator().allocate();
-            if (is_success(param_reg_result)) {
-                Register param_reg = get_value(param_reg_result);
-                nested_generator.scope_manager().declare_local(param.name, param_reg);
-            }
-        }
-
-        // Generate code for function body using the nested generator
-        node.body().accept(nested_generator);
-
-        // Exit the parameter scope in nested generator
-        nested_generator.scope_manager().exit_scope();
-
-        // Ensure function ends with return instruction
-        if (nested_emitter.instruction_count() == 0 ||
-            InstructionEncoder::decode_opcode(nested_emitter.instructions().back()) !=
-                OpCode::OP_RETURN) {
-            nested_emitter.emit_abc(OpCode::OP_RETURN, 0, 1, 0);  // Return with no values
-        }
-
-        // Update stack size for nested function
-        nested_emitter.set_stack_size(nested_generator.register_allocator().high_water_mark() + 1);
-
-        // Get the generated function
-        BytecodeFunction nested_function = nested_emitter.get_function();
-
-        // Restore previous state
-        register_allocator_ = saved_allocator;
-        jump_manager_.set_emitter(saved_emitter);
-        scope_manager_.exit_scope();
-
-        // Convert BytecodeFunction to FunctionPrototype and add it
-        FunctionPrototype prototype;
-        prototype.name = nested_function.name;
-        prototype.instructions = std::move(nested_function.instructions);
-        prototype.constants = std::move(nested_function.constants);
-        prototype.locals = std::move(nested_function.locals);
-        prototype.upvalue_descriptors = std::move(nested_function.upvalue_descriptors);
-        prototype.parameter_count = nested_function.parameter_count;
-        prototype.stack_size = nested_function.stack_size;
-        prototype.is_vararg = nested_function.is_vararg;
-        prototype.line_info = std::move(nested_function.line_info);
-        prototype.source_name = std::move(nested_function.source_name);
+        FunctionSignature signature = make_signature("anonymous_function", node.parameters());
+        signature.parameter_scope = true;
+        FunctionPrototype prototype =
+            generate_function(signature, node.body(), node.deferred_body());
 
         // Add the function prototype and create closure
         Size prototype_index = emitter_.add_prototype(prototype);
@@ -2416,8 +2909,9 @@ namespace rangelua::backend {
         // For now, we'll implement a simplified upvalue system
         // In a full implementation, we'd need to track which variables are captured
         // and emit appropriate GETUPVAL or MOVE instructions for each upvalue
-        CODEGEN_LOG_DEBUG(
-            "Function expression compiled with {} parameters, vararg: {}", param_count, has_vararg);
+        CODEGEN_LOG_DEBUG("Function expression compiled with {} parameters, vararg: {}",
+                          signature.parameters.size(),
+                          signature.is_vararg);
     }
 
     void CodeGenerator::visit([[maybe_unused]] const frontend::VarargExpression& node) {
@@ -2468,6 +2962,35 @@ namespace rangelua::backend {
         const auto& names = node.names();
         const auto& values = node.values();
 
+        for (Size i = 0; i < names.size(); ++i) {
+            if (node.attribute(i) == frontend::LocalDeclarationStatement::Attribute::Close) {
+                throw SyntaxError("to-be-closed variables are not supported", node.location());
+            }
+        }
+
+        // <const> locals whose values are known at compile time occupy no register; every use
+        // is replaced by the value, including uses from nested functions
+        if (names.size() == values.size()) {
+            std::vector<frontend::LiteralExpression::Value> constants;
+            for (Size i = 0; i < names.size(); ++i) {
+                if (node.attribute(i) != frontend::LocalDeclarationStatement::Attribute::Const) {
+                    break;
+                }
+                auto value = fold_constant(*values[i]);
+                if (!value) {
+                    break;
+                }
+                constants.push_back(std::move(*value));
+            }
+            if (constants.size() == names.size()) {
+                for (Size i = 0; i < names.size(); ++i) {
+                    scope_manager_.declare_constant(names[i], std::move(constants[i]));
+                    CODEGEN_LOG_DEBUG("Local '{}' declared as a compile-time constant", names[i]);
+                }
+                return;
+            }
+        }
+
         // Special handling for multiple variables with single function call
         if (names.size() > 1 && values.size() == 1) {
             // Check if the single value is a function call that might return multiple values
@@ -2534,7 +3057,10 @@ namespace rangelua::backend {
                 // Move results to local variable registers and declare them
                 for (Size i = 0; i < names.size(); ++i) {
                     Register local_reg = local_registers[i];
-                    scope_manager_.declare_local(names[i], local_reg);
+                    scope_manager_.declare_local(
+                        names[i],
+                        local_reg,
+                        node.attribute(i) == frontend::LocalDeclarationStatement::Attribute::Const);
 
                     if (call_base + i != local_reg) {
                         emitter_.emit_abc(
@@ -2568,71 +3094,6 @@ namespace rangelua::backend {
                 // context
                 CODEGEN_LOG_DEBUG("Generating local function expression");
 
-                // Create a new bytecode emitter for the function
-                BytecodeEmitter nested_emitter("local_function");
-
-                // Create a separate code generator for the nested function
-                CodeGenerator nested_generator(nested_emitter);
-
-                // Declare parameters as local variables in the nested generator
-                bool has_vararg = false;
-                Size param_count = 0;
-                for (const auto& param : func_expr->parameters()) {
-                    if (param.is_vararg) {
-                        has_vararg = true;
-                        continue;  // Don't allocate register for vararg parameter
-                    }
-
-                    auto param_reg_result = nested_generator.register_allocator().allocate();
-                    if (is_success(param_reg_result)) {
-                        Register param_reg = get_value(param_reg_result);
-                        nested_generator.scope_manager().declare_local(param.name, param_reg);
-                        param_count++;
-                    }
-                }
-
-                // Set up function metadata
-                nested_emitter.set_parameter_count(param_count);
-                nested_emitter.set_vararg(has_vararg);
-
-                // If this is a vararg function, emit VARARGPREP instruction
-                if (has_vararg) {
-                    nested_emitter.emit_abc(
-                        OpCode::OP_VARARGPREP, static_cast<Register>(param_count), 0, 0);
-                    CODEGEN_LOG_DEBUG("Emitted VARARGPREP for function with {} parameters",
-                                      param_count);
-                }
-
-                // Generate code for function body using the nested generator
-                func_expr->body().accept(nested_generator);
-
-                // Ensure function ends with return instruction
-                if (nested_emitter.instruction_count() == 0 ||
-                    InstructionEncoder::decode_opcode(nested_emitter.instructions().back()) !=
-                        OpCode::OP_RETURN) {
-                    nested_emitter.emit_abc(OpCode::OP_RETURN, 0, 1, 0);  // Return with no values
-                }
-
-                // Update stack size for nested function
-                nested_emitter.set_stack_size(
-                    nested_generator.register_allocator().high_water_mark() + 1);
-
-                // Get the generated function
-                BytecodeFunction nested_function = nested_emitter.get_function();
-
-                // Convert BytecodeFunction to FunctionPrototype and add it
-                FunctionPrototype prototype;
-                prototype.name = nested_function.name;
-                prototype.instructions = std::move(nested_function.instructions);
-                prototype.constants = std::move(nested_function.constants);
-                prototype.locals = std::move(nested_function.locals);
-                prototype.upvalue_descriptors = std::move(nested_function.upvalue_descriptors);
-                prototype.parameter_count = nested_function.parameter_count;
-                prototype.stack_size = nested_function.stack_size;
-                prototype.is_vararg = nested_function.is_vararg;
-                prototype.line_info = std::move(nested_function.line_info);
-                prototype.source_name = std::move(nested_function.source_name);
-
                 // Allocate register for the closure
                 auto closure_reg_result = register_allocator_.allocate();
                 if (is_error(closure_reg_result)) {
@@ -2641,6 +3102,12 @@ namespace rangelua::backend {
                 }
                 Register closure_reg = get_value(closure_reg_result);
 
+                FunctionSignature signature =
+                    make_signature("local_function", func_expr->parameters());
+                signature.emit_varargprep = true;
+                FunctionPrototype prototype =
+                    generate_function(signature, func_expr->body(), func_expr->deferred_body());
+
                 // Add function prototype and create closure
                 Size prototype_index = emitter_.add_prototype(prototype);
                 emitter_.emit_abx(
@@ -2672,7 +3139,10 @@ namespace rangelua::backend {
             Register local_reg = get_value(reg_result);
 
             // Declare the local variable in scope
-            scope_manager_.declare_local(names[i], local_reg);
+            scope_manager_.declare_local(
+                names[i],
+                local_reg,
+                node.attribute(i) == frontend::LocalDeclarationStatement::Attribute::Const);
 
             // Update register allocator with new local count
             update_register_allocator_nvarstack();
@@ -2696,6 +3166,10 @@ namespace rangelua::backend {
         emitter_.set_current_line(node.location().line_);
         CODEGEN_LOG_DEBUG("Generating code for function declaration");
 
+        if (!node.is_local()) {
+            check_assignable(node.name());
+        }
+
         // Allocate register for the function closure
         auto func_reg_result = register_allocator_.allocate();
         if (is_error(func_reg_result)) {
@@ -2705,80 +3179,11 @@ namespace rangelua::backend {
 
         Register func_reg = get_value(func_reg_result);
 
-        // Create a new bytecode emitter for the function
-        BytecodeEmitter nested_emitter("declared_function");
-
-        // Count parameters for function metadata
-        bool has_vararg = false;
-        Size param_count = 0;
-        for (const auto& param : node.parameters()) {
-            if (param.is_vararg) {
-                has_vararg = true;
-                continue;  // Don't allocate register for vararg parameter
-            }
-            param_count++;
-        }
-
-        // Set up function metadata
-        nested_emitter.set_parameter_count(param_count);
-        nested_emitter.set_vararg(has_vararg);
-
-        // If this is a vararg function, emit VARARGPREP instruction
-        if (has_vararg) {
-            nested_emitter.emit_abc(
-                OpCode::OP_VARARGPREP, static_cast<Register>(param_count), 0, 0);
-            CODEGEN_LOG_DEBUG("Emitted VARARGPREP for declared function with {} parameters",
-                              param_count);
-        }
-
-        // Create a separate code generator for the nested function
-        CodeGenerator nested_generator(nested_emitter);
-
-        // Transfer parameter declarations to the nested generator's scope
-        nested_generator.scope_manager().enter_scope();
-        for (const auto& param : node.parameters()) {
-            if (param.is_vararg) {
-                continue;  // Don't allocate register for vararg parameter
-            }
-
-            auto param_reg_result = nested_generator.register_allocator().allocate();
-            if (is_success(param_reg_result)) {
-                Register param_reg = get_value(param_reg_result);
-                nested_generator.scope_manager().declare_local(param.name, param_reg);
-            }
-        }
-
-        // Generate code for function body using the nested generator
-        node.body().accept(nested_generator);
-
-        // Exit the parameter scope in nested generator
-        nested_generator.scope_manager().exit_scope();
-
-        // Ensure function ends with return instruction
-        if (nested_emitter.instruction_count() == 0 ||
-            InstructionEncoder::decode_opcode(nested_emitter.instructions().back()) !=
-                OpCode::OP_RETURN) {
-            nested_emitter.emit_abc(OpCode::OP_RETURN, 0, 1, 0);  // Return with no values
-        }
-
-        // Update stack size for nested function
-        nested_emitter.set_stack_size(nested_generator.register_allocator().high_water_mark() + 1);
-
-        // Get the generated function
-        BytecodeFunction nested_function = nested_emitter.get_function();
-
-        // Convert BytecodeFunction to FunctionPrototype and add it
-        FunctionPrototype prototype;
-        prototype.name = nested_function.name;
-        prototype.instructions = std::move(nested_function.instructions);
-        prototype.constants = std::move(nested_function.constants);
-        prototype.locals = std::move(nested_function.locals);
-        prototype.upvalue_descriptors = std::move(nested_function.upvalue_descriptors);
-        prototype.parameter_count = nested_function.parameter_count;
-        prototype.stack_size = nested_function.stack_size;
-        prototype.is_vararg = nested_function.is_vararg;
-        prototype.line_info = std::move(nested_function.line_info);
-        prototype.source_name = std::move(nested_function.source_name);
+        FunctionSignature signature = make_signature("declared_function", node.parameters());
+        signature.emit_varargprep = true;
+        signature.parameter_scope = true;
+        FunctionPrototype prototype =
+            generate_function(signature, node.body(), node.deferred_body());
 
         // Add function prototype and create closure
         Size prototype_index = emitter_.add_prototype(prototype);
@@ -2810,7 +3215,7 @@ namespace rangelua::backend {
             if (const auto* identifier =
                     dynamic_cast<const frontend::IdentifierExpression*>(&node.name())) {
                 // Global function assignment using SETTABUP: UpValue[A][K[B]] := R[C]
-                Size const_index = emitter_.add_constant(identifier->name());
+                Size const_index = emitter_.add_constant(String(identifier->name()));
                 CODEGEN_LOG_DEBUG("Emitting SETTABUP for global function '{}': upvalue=0, "
                                   "key=K[{}], value=R[{}]",
                                   identifier->name(),
@@ -2831,8 +3236,8 @@ namespace rangelua::backend {
         register_allocator_.free(func_reg);
 
         CODEGEN_LOG_DEBUG("Function declaration compiled with {} parameters, vararg: {}",
-                          param_count,
-                          has_vararg);
+                          signature.parameters.size(),
+                          signature.is_vararg);
     }
 
     void CodeGenerator::visit(const frontend::WhileStatement& node) {
@@ -3358,7 +3763,7 @@ namespace rangelua::backend {
     }
 
     // Label management implementation
-    void CodeGenerator::define_label(const String& name) {
+    void CodeGenerator::define_label(StringView name) {
         Size position = jump_manager_.current_instruction();
         Size scope_depth = scope_manager_.scope_depth();
 
@@ -3371,7 +3776,7 @@ namespace rangelua::backend {
         }
 
         // Add the label
-        labels_.push_back({name, position, scope_depth});
+        labels_.push_back({String(name), position, scope_depth});
         CODEGEN_LOG_DEBUG(
             "Defined label '{}' at instruction {}, scope depth {}", name, position, scope_depth);
 
@@ -3389,7 +3794,7 @@ namespace rangelua::backend {
         }
     }
 
-    void CodeGenerator::emit_goto(const String& label) {
+    void CodeGenerator::emit_goto(StringView label) {
         Size current_scope = scope_manager_.scope_depth();
 
         // Look for the label in accessible scopes (current and outer scopes)
@@ -5,9 +5,13 @@
  */
 
 #include <rangelua/backend/optimizer.hpp>
+#include <rangelua/backend/ssa.hpp>
+#include <rangelua/core/config.hpp>
 #include <rangelua/utils/logger.hpp>
+#include <rangelua/utils/parallel.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <ranges>
 #include <unordered_set>
 #include <queue>
@@ -16,46 +20,107 @@
 
 namespace rangelua::backend {
 
+    namespace {
+
+        // Registers are 8-bit operands, so no range extends past this
+        constexpr Size FRAME_LIMIT = static_cast<Size>(config::MAX_REGISTERS) + 1;
+
+    }  // namespace
+
     // ConstantFoldingPass Implementation
     Status ConstantFoldingPass::optimize(BytecodeFunction& function) {
         OPTIMIZER_LOG_DEBUG("Starting constant folding optimization");
 
+        auto captured = optimization_analysis::captured_registers(function);
+        if (!captured) {
+            OPTIMIZER_LOG_DEBUG("Constant folding skipped: closures with unknown captures");
+            return std::monostate{};
+        }
+
         bool changed = false;
         auto& instructions = function.instructions;
+        auto leaders = optimization_analysis::find_block_leaders(instructions);
 
-        // Track constant values for each register
+        // Known register contents, valid from the start of the current basic block
         std::unordered_map<Register, ConstantValue> constants;
+        auto record = [&](Register reg, ConstantValue value) {
+            if (captured->contains(reg)) {
+                constants.erase(reg);
+            } else {
+                constants[reg] = std::move(value);
+            }
+        };
 
         for (Size i = 0; i < instructions.size(); ++i) {
+            if (leaders[i]) {
+                constants.clear();
+            }
+
             Instruction instr = instructions[i];
             OpCode op = InstructionEncoder::decode_opcode(instr);
             Register a = InstructionEncoder::decode_a(instr);
 
+            // Forget everything the instruction overwrites before learning its result
+            auto effects = optimization_analysis::register_effects(instr);
+            if (!effects) {
+                constants.clear();
+                continue;
+            }
+            for (Size w = 0; w < effects->write_count; ++w) {
+                const auto& range = effects->writes[w];
+                std::erase_if(constants, [&](const auto& entry) {
+                    return entry.first >= range.first && entry.first < range.end(FRAME_LIMIT);
+                });
+            }
+
             switch (op) {
-                case OpCode::OP_LOADI: {
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF: {
                     std::int32_t value = InstructionEncoder::decode_sbx(instr);
-                    constants[a] = ConstantValue{static_cast<Int>(value)};
+                    record(a, ConstantValue{static_cast<Number>(value)});
                     break;
                 }
 
-                case OpCode::OP_LOADF: {
-                    std::int32_t value = InstructionEncoder::decode_sbx(instr);
-                    constants[a] = ConstantValue{static_cast<Number>(value)};
+                case OpCode::OP_LOADK: {
+                    std::uint32_t index = InstructionEncoder::decode_bx(instr);
+                    if (index < function.constants.size()) {
+                        std::visit(
+                            [&](const auto& value) {
+                                using T = std::decay_t<decltype(value)>;
+                                if constexpr (std::is_same_v<T, Int>) {
+                                    record(a, ConstantValue{static_cast<Number>(value)});
+                                } else if constexpr (std::is_same_v<T, Number> ||
+                                                     std::is_same_v<T, String> ||
+                                                     std::is_same_v<T, bool>) {
+                                    record(a, ConstantValue{value});
+                                } else {
+                                    record(a, ConstantValue{});
+                                }
+                            },
+                            function.constants[index]);
+                    }
                     break;
                 }
 
-                case OpCode::OP_LOADTRUE: {
-                    constants[a] = ConstantValue{true};
+                case OpCode::OP_LOADTRUE:
+                    record(a, ConstantValue{true});
                     break;
-                }
 
-                case OpCode::OP_LOADFALSE: {
-                    constants[a] = ConstantValue{false};
+                case OpCode::OP_LOADFALSE:
+                    record(a, ConstantValue{false});
                     break;
-                }
 
-                case OpCode::OP_LOADNIL: {
-                    constants[a] = ConstantValue{};
+                case OpCode::OP_LOADNIL:
+                    for (Size r = a; r < effects->writes[0].end(FRAME_LIMIT); ++r) {
+                        record(static_cast<Register>(r), ConstantValue{});
+                    }
+                    break;
+
+                case OpCode::OP_MOVE: {
+                    auto source = constants.find(InstructionEncoder::decode_b(instr));
+                    if (source != constants.end()) {
+                        record(a, source->second);
+                    }
                     break;
                 }
 
@@ -65,182 +130,106 @@ namespace rangelua::backend {
                 case OpCode::OP_DIV:
                 case OpCode::OP_MOD:
                 case OpCode::OP_POW: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    Register c = InstructionEncoder::decode_c(instr);
-
-                    auto b_const = constants.find(b);
-                    auto c_const = constants.find(c);
-
-                    if (b_const != constants.end() && c_const != constants.end()) {
-                        auto result = evaluate_binary_op(op, b_const->second, c_const->second);
-                        if (result.has_value()) {
-                            constants[a] = result.value();
-
-                            // Replace with appropriate load instruction
-                            if (result->is_integer()) {
-                                Int int_val = result->get<Int>();
-                                if (int_val >= -32768 && int_val <= 32767) {
-                                    instructions[i] = InstructionEncoder::encode_asbx(
-                                        OpCode::OP_LOADI, a, static_cast<std::int32_t>(int_val));
-                                    changed = true;
-                                    OPTIMIZER_LOG_DEBUG("Folded integer arithmetic to LOADI");
-                                }
-                            } else if (result->is_number()) {
-                                Number num_val = result->get<Number>();
-                                auto int_val = static_cast<std::int32_t>(num_val);
-                                if (static_cast<Number>(int_val) == num_val &&
-                                    int_val >= -32768 && int_val <= 32767) {
-                                    instructions[i] = InstructionEncoder::encode_asbx(
-                                        OpCode::OP_LOADF, a, int_val);
-                                    changed = true;
-                                    OPTIMIZER_LOG_DEBUG("Folded float arithmetic to LOADF");
-                                }
-                            }
-                        }
-                    } else {
-                        constants.erase(a);
+                    auto b_const = constants.find(InstructionEncoder::decode_b(instr));
+                    auto c_const = constants.find(InstructionEncoder::decode_c(instr));
+                    if (b_const == constants.end() || c_const == constants.end()) {
+                        break;
+                    }
+                    auto result = evaluate_binary_op(op, b_const->second, c_const->second);
+                    if (!result || !result->is_number()) {
+                        break;
+                    }
+                    if (auto load = optimization_analysis::load_constant(
+                            function.constants, a, backend::ConstantValue{result->get<Number>()})) {
+                        instructions[i] = *load;
+                        record(a, *result);
+                        changed = true;
+                        OPTIMIZER_LOG_DEBUG("Folded arithmetic at instruction {}", i);
                     }
                     break;
                 }
 
                 case OpCode::OP_UNM:
-                case OpCode::OP_NOT:
-                case OpCode::OP_BNOT: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    auto b_const = constants.find(b);
-
-                    if (b_const != constants.end()) {
-                        auto result = evaluate_unary_op(op, b_const->second);
-                        if (result.has_value()) {
-                            constants[a] = result.value();
-
-                            // Replace with appropriate load instruction
-                            if (result->is_boolean()) {
-                                bool bool_val = result->get<bool>();
-                                instructions[i] = InstructionEncoder::encode_abc(
-                                    bool_val ? OpCode::OP_LOADTRUE : OpCode::OP_LOADFALSE, a, 0, 0);
-                                changed = true;
-                                OPTIMIZER_LOG_DEBUG("Folded unary operation to boolean load");
-                            }
-                        }
-                    } else {
-                        constants.erase(a);
+                case OpCode::OP_NOT: {
+                    auto b_const = constants.find(InstructionEncoder::decode_b(instr));
+                    if (b_const == constants.end()) {
+                        break;
+                    }
+                    auto result = evaluate_unary_op(op, b_const->second);
+                    if (!result) {
+                        break;
+                    }
+
+                    Optional<Instruction> load;
+                    if (result->is_boolean()) {
+                        load = InstructionEncoder::encode_abc(
+                            result->get<bool>() ? OpCode::OP_LOADTRUE : OpCode::OP_LOADFALSE, a, 0, 0);
+                    } else if (result->is_number()) {
+                        load = optimization_analysis::load_constant(
+                            function.constants, a, backend::ConstantValue{result->get<Number>()});
+                    }
+                    if (load) {
+                        instructions[i] = *load;
+                        record(a, *result);
+                        changed = true;
+                        OPTIMIZER_LOG_DEBUG("Folded unary operation at instruction {}", i);
                     }
                     break;
                 }
 
                 default:
-                    // For other instructions, invalidate the target register
-                    if (InstructionEncoder::decode_a(instr) < 255) {
-                        constants.erase(a);
-                    }
                     break;
             }
         }
 
         OPTIMIZER_LOG_INFO("Constant folding completed, changed: {}", changed);
-        return changed ? std::monostate{} : std::monostate{};
+        return std::monostate{};
     }
 
     Optional<ConstantFoldingPass::ConstantValue>
     ConstantFoldingPass::evaluate_binary_op(OpCode op, const ConstantValue& left, const ConstantValue& right) {
-        try {
-            switch (op) {
-                case OpCode::OP_ADD:
-                    if (left.is_integer() && right.is_integer()) {
-                        return ConstantValue{left.get<Int>() + right.get<Int>()};
-                    } else if (left.is_number() && right.is_number()) {
-                        return ConstantValue{left.get<Number>() + right.get<Number>()};
-                    } else if (left.is_integer() && right.is_number()) {
-                        return ConstantValue{static_cast<Number>(left.get<Int>()) + right.get<Number>()};
-                    } else if (left.is_number() && right.is_integer()) {
-                        return ConstantValue{left.get<Number>() + static_cast<Number>(right.get<Int>())};
-                    }
-                    break;
-
-                case OpCode::OP_SUB:
-                    if (left.is_integer() && right.is_integer()) {
-                        return ConstantValue{left.get<Int>() - right.get<Int>()};
-                    } else if (left.is_number() && right.is_number()) {
-                        return ConstantValue{left.get<Number>() - right.get<Number>()};
-                    } else if (left.is_integer() && right.is_number()) {
-                        return ConstantValue{static_cast<Number>(left.get<Int>()) - right.get<Number>()};
-                    } else if (left.is_number() && right.is_integer()) {
-                        return ConstantValue{left.get<Number>() - static_cast<Number>(right.get<Int>())};
-                    }
-                    break;
-
-                case OpCode::OP_MUL:
-                    if (left.is_integer() && right.is_integer()) {
-                        return ConstantValue{left.get<Int>() * right.get<Int>()};
-                    } else if (left.is_number() && right.is_number()) {
-                        return ConstantValue{left.get<Number>() * right.get<Number>()};
-                    } else if (left.is_integer() && right.is_number()) {
-                        return ConstantValue{static_cast<Number>(left.get<Int>()) * right.get<Number>()};
-                    } else if (left.is_number() && right.is_integer()) {
-                        return ConstantValue{left.get<Number>() * static_cast<Number>(right.get<Int>())};
-                    }
-                    break;
-
-                case OpCode::OP_DIV:
-                    if (right.is_integer() && right.get<Int>() == 0) return std::nullopt;
-                    if (right.is_number() && right.get<Number>() == 0.0) return std::nullopt;
-
-                    if (left.is_integer() && right.is_integer()) {
-                        return ConstantValue{static_cast<Number>(left.get<Int>()) / static_cast<Number>(right.get<Int>())};
-                    } else if (left.is_number() && right.is_number()) {
-                        return ConstantValue{left.get<Number>() / right.get<Number>()};
-                    } else if (left.is_integer() && right.is_number()) {
-                        return ConstantValue{static_cast<Number>(left.get<Int>()) / right.get<Number>()};
-                    } else if (left.is_number() && right.is_integer()) {
-                        return ConstantValue{left.get<Number>() / static_cast<Number>(right.get<Int>())};
-                    }
-                    break;
-
-                default:
-                    break;
-            }
-        } catch (...) {
-            // Arithmetic overflow or other errors
+        // The VM keeps every number as a double, so fold in double precision;
+        // strings are left alone because coercion can fail at runtime
+        if (!left.is_number() || !right.is_number()) {
             return std::nullopt;
         }
+        Number x = left.get<Number>();
+        Number y = right.get<Number>();
 
-        return std::nullopt;
+        switch (op) {
+            case OpCode::OP_ADD:
+                return ConstantValue{x + y};
+            case OpCode::OP_SUB:
+                return ConstantValue{x - y};
+            case OpCode::OP_MUL:
+                return ConstantValue{x * y};
+            case OpCode::OP_DIV:
+                if (y == 0.0) {
+                    return std::nullopt;
+                }
+                return ConstantValue{x / y};
+            default:
+                return std::nullopt;
+        }
     }
 
     Optional<ConstantFoldingPass::ConstantValue>
     ConstantFoldingPass::evaluate_unary_op(OpCode op, const ConstantValue& operand) {
-        try {
-            switch (op) {
-                case OpCode::OP_UNM:
-                    if (operand.is_integer()) {
-                        return ConstantValue{-operand.get<Int>()};
-                    } else if (operand.is_number()) {
-                        return ConstantValue{-operand.get<Number>()};
-                    }
-                    break;
-
-                case OpCode::OP_NOT:
-                    if (operand.is_boolean()) {
-                        return ConstantValue{!operand.get<bool>()};
-                    } else if (operand.is_nil()) {
-                        return ConstantValue{true};
-                    } else {
-                        return ConstantValue{false};
-                    }
-                    break;
+        switch (op) {
+            case OpCode::OP_UNM:
+                if (operand.is_number()) {
+                    return ConstantValue{-operand.get<Number>()};
+                }
+                break;
 
-                case OpCode::OP_BNOT:
-                    if (operand.is_integer()) {
-                        return ConstantValue{~operand.get<Int>()};
-                    }
-                    break;
+            case OpCode::OP_NOT:
+                if (operand.is_boolean()) {
+                    return ConstantValue{!operand.get<bool>()};
+                }
+                return ConstantValue{operand.is_nil()};
 
-                default:
-                    break;
-            }
-        } catch (...) {
-            return std::nullopt;
+            default:
+                break;
         }
 
         return std::nullopt;
@@ -273,199 +262,55 @@ namespace rangelua::backend {
         OPTIMIZER_LOG_DEBUG("Starting dead code elimination optimization");
 
         auto reachable = find_reachable_instructions(function);
-        auto live_registers = find_live_registers(function);
-
+        std::vector<bool> to_remove(function.instructions.size(), false);
         bool changed = false;
-        auto& instructions = function.instructions;
 
-        // Mark instructions for removal
-        std::vector<bool> to_remove(instructions.size(), false);
-
-        for (Size i = 0; i < instructions.size(); ++i) {
-            if (reachable.find(i) == reachable.end()) {
-                // Unreachable instruction
+        for (Size i = 0; i < function.instructions.size(); ++i) {
+            if (!reachable[i]) {
                 to_remove[i] = true;
                 changed = true;
                 OPTIMIZER_LOG_DEBUG("Marking unreachable instruction {} for removal", i);
-                continue;
-            }
-
-            Instruction instr = instructions[i];
-            OpCode op = InstructionEncoder::decode_opcode(instr);
-            Register a = InstructionEncoder::decode_a(instr);
-
-            // Check if instruction writes to a dead register
-            if (is_side_effect_free(op) && live_registers.find(a) == live_registers.end()) {
-                to_remove[i] = true;
-                changed = true;
-                OPTIMIZER_LOG_DEBUG("Marking dead instruction {} for removal (writes to dead register {})", i, a);
             }
         }
 
-        // Remove marked instructions (in reverse order to maintain indices)
-        for (Size i = instructions.size(); i > 0; --i) {
-            if (to_remove[i - 1]) {
-                instructions.erase(instructions.begin() + (i - 1));
-            }
+        if (changed) {
+            optimization_analysis::remove_instructions(function, to_remove);
         }
 
         OPTIMIZER_LOG_INFO("Dead code elimination completed, changed: {}", changed);
-        return changed ? std::monostate{} : std::monostate{};
+        return std::monostate{};
     }
 
-    std::unordered_set<Size> DeadCodeEliminationPass::find_reachable_instructions(const BytecodeFunction& function) {
-        std::unordered_set<Size> reachable;
+    std::vector<bool> DeadCodeEliminationPass::find_reachable_instructions(const BytecodeFunction& function) {
+        const auto& code = function.instructions;
+        std::vector<bool> reachable(code.size(), false);
         std::queue<Size> worklist;
 
-        // Start from entry point
-        if (!function.instructions.empty()) {
-            worklist.push(0);
-            reachable.insert(0);
-        }
+        auto visit = [&](Size pc) {
+            if (pc < code.size() && !reachable[pc]) {
+                reachable[pc] = true;
+                worklist.push(pc);
+            }
+        };
 
+        visit(0);
         while (!worklist.empty()) {
             Size current = worklist.front();
             worklist.pop();
 
-            if (current >= function.instructions.size()) continue;
-
-            Instruction instr = function.instructions[current];
-            OpCode op = InstructionEncoder::decode_opcode(instr);
-
-            // Add next instruction (if not a jump)
-            if (!is_control_flow_instruction(op) || op == OpCode::OP_TEST || op == OpCode::OP_TESTSET) {
-                Size next = current + 1;
-                if (next < function.instructions.size() && reachable.find(next) == reachable.end()) {
-                    reachable.insert(next);
-                    worklist.push(next);
-                }
+            OpCode op = InstructionEncoder::decode_opcode(code[current]);
+            if (!optimization_analysis::ends_block(op)) {
+                visit(current + 1);
             }
-
-            // Add jump targets
-            if (op == OpCode::OP_JMP) {
-                std::int32_t offset = InstructionEncoder::decode_sbx(instr);
-                Size target = current + 1 + offset;
-                if (target < function.instructions.size() && reachable.find(target) == reachable.end()) {
-                    reachable.insert(target);
-                    worklist.push(target);
-                }
-            } else if (op == OpCode::OP_FORLOOP || op == OpCode::OP_FORPREP || op == OpCode::OP_TFORLOOP) {
-                std::uint32_t offset = InstructionEncoder::decode_bx(instr);
-                Size target = current + 1 + offset;
-                if (target < function.instructions.size() && reachable.find(target) == reachable.end()) {
-                    reachable.insert(target);
-                    worklist.push(target);
-                }
+            if (optimization_analysis::skips_next(op)) {
+                visit(current + 2);
             }
-        }
-
-        return reachable;
-    }
-
-    std::unordered_set<Register> DeadCodeEliminationPass::find_live_registers(const BytecodeFunction& function) {
-        std::unordered_set<Register> live;
-
-        // Simple backward analysis - mark all used registers as live
-        for (const auto& instr : function.instructions) {
-            OpCode op = InstructionEncoder::decode_opcode(instr);
-
-            // Mark source registers as live
-            switch (op) {
-                case OpCode::OP_MOVE:
-                case OpCode::OP_UNM:
-                case OpCode::OP_NOT:
-                case OpCode::OP_LEN:
-                case OpCode::OP_BNOT: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    live.insert(b);
-                    break;
-                }
-
-                case OpCode::OP_ADD:
-                case OpCode::OP_SUB:
-                case OpCode::OP_MUL:
-                case OpCode::OP_DIV:
-                case OpCode::OP_MOD:
-                case OpCode::OP_POW:
-                case OpCode::OP_BAND:
-                case OpCode::OP_BOR:
-                case OpCode::OP_BXOR:
-                case OpCode::OP_SHL:
-                case OpCode::OP_SHR:
-                case OpCode::OP_GETTABLE:
-                case OpCode::OP_SETTABLE: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    Register c = InstructionEncoder::decode_c(instr);
-                    live.insert(b);
-                    live.insert(c);
-                    break;
-                }
-
-                case OpCode::OP_RETURN:
-                case OpCode::OP_RETURN1: {
-                    Register a = InstructionEncoder::decode_a(instr);
-                    live.insert(a);
-                    break;
-                }
-
-                default:
-                    break;
+            if (auto target = optimization_analysis::branch_target(code, current)) {
+                visit(*target);
             }
         }
 
-        return live;
-    }
-
-    bool DeadCodeEliminationPass::is_side_effect_free(OpCode op) const noexcept {
-        switch (op) {
-            case OpCode::OP_MOVE:
-            case OpCode::OP_LOADI:
-            case OpCode::OP_LOADF:
-            case OpCode::OP_LOADK:
-            case OpCode::OP_LOADKX:
-            case OpCode::OP_LOADTRUE:
-            case OpCode::OP_LOADFALSE:
-            case OpCode::OP_LOADNIL:
-            case OpCode::OP_ADD:
-            case OpCode::OP_SUB:
-            case OpCode::OP_MUL:
-            case OpCode::OP_DIV:
-            case OpCode::OP_MOD:
-            case OpCode::OP_POW:
-            case OpCode::OP_BAND:
-            case OpCode::OP_BOR:
-            case OpCode::OP_BXOR:
-            case OpCode::OP_SHL:
-            case OpCode::OP_SHR:
-            case OpCode::OP_UNM:
-            case OpCode::OP_NOT:
-            case OpCode::OP_BNOT:
-            case OpCode::OP_LEN:
-                return true;
-            default:
-                return false;
-        }
-    }
-
-    bool DeadCodeEliminationPass::is_control_flow_instruction(OpCode op) const noexcept {
-        switch (op) {
-            case OpCode::OP_JMP:
-            case OpCode::OP_FORLOOP:
-            case OpCode::OP_FORPREP:
-            case OpCode::OP_TFORLOOP:
-            case OpCode::OP_EQ:
-            case OpCode::OP_LT:
-            case OpCode::OP_LE:
-            case OpCode::OP_TEST:
-            case OpCode::OP_TESTSET:
-            case OpCode::OP_RETURN:
-            case OpCode::OP_RETURN0:
-            case OpCode::OP_RETURN1:
-            case OpCode::OP_TAILCALL:
-                return true;
-            default:
-                return false;
-        }
+        return reachable;
     }
 
     // PeepholeOptimizationPass Implementation
@@ -478,23 +323,23 @@ namespace rangelua::backend {
 
         bool changed = false;
         auto& instructions = function.instructions;
+        auto leaders = optimization_analysis::find_block_leaders(instructions);
+        std::vector<bool> removed(instructions.size(), false);
 
-        // Apply patterns repeatedly until no more changes
-        bool pattern_applied;
-        do {
-            pattern_applied = false;
-
-            for (Size i = 0; i < instructions.size(); ++i) {
-                for (const auto& pattern : patterns_) {
-                    if (apply_pattern(instructions, i, pattern)) {
-                        pattern_applied = true;
-                        changed = true;
-                        break; // Start over after any change
-                    }
+        // One sweep per run; the optimizer repeats passes until nothing changes
+        for (Size i = 0; i < instructions.size(); ++i) {
+            for (const auto& pattern : patterns_) {
+                if (apply_pattern(instructions, i, pattern, leaders, removed)) {
+                    changed = true;
+                    i += pattern.opcodes.size() - 1;
+                    break;
                 }
-                if (pattern_applied) break;
             }
-        } while (pattern_applied);
+        }
+
+        if (changed) {
+            optimization_analysis::remove_instructions(function, removed);
+        }
 
         OPTIMIZER_LOG_INFO("Peephole optimization completed, changed: {}", changed);
         return std::monostate{};
@@ -503,101 +348,73 @@ namespace rangelua::backend {
     void PeepholeOptimizationPass::initialize_patterns() {
         patterns_.clear();
 
-        // Pattern: MOVE R[A], R[B]; MOVE R[C], R[A] -> MOVE R[C], R[B] (if A is not used elsewhere)
+        // Pattern: MOVE R[A], R[B]; MOVE R[C], R[A] -> MOVE R[A], R[B]; MOVE R[C], R[B]
+        // The second copy no longer depends on the first, which may then become dead
         patterns_.push_back({
             {OpCode::OP_MOVE, OpCode::OP_MOVE},
             [](const std::vector<Instruction>& instrs) -> bool {
-                if (instrs.size() < 2) return false;
-
                 Register a1 = InstructionEncoder::decode_a(instrs[0]);
-                [[maybe_unused]] Register b1 = InstructionEncoder::decode_b(instrs[0]);
-                [[maybe_unused]] Register a2 = InstructionEncoder::decode_a(instrs[1]);
+                Register b1 = InstructionEncoder::decode_b(instrs[0]);
                 Register b2 = InstructionEncoder::decode_b(instrs[1]);
 
-                return a1 == b2; // Second move uses result of first move
+                return a1 == b2 && a1 != b1;
             },
             [](const std::vector<Instruction>& instrs) -> std::vector<Instruction> {
                 Register b1 = InstructionEncoder::decode_b(instrs[0]);
                 Register a2 = InstructionEncoder::decode_a(instrs[1]);
 
-                // Replace with single move: MOVE R[a2], R[b1]
-                return {InstructionEncoder::encode_abc(OpCode::OP_MOVE, a2, b1, 0)};
+                return {instrs[0], InstructionEncoder::encode_abc(OpCode::OP_MOVE, a2, b1, 0)};
             }
         });
 
-        // Pattern: LOADI R[A], 0; ADD R[B], R[C], R[A] -> MOVE R[B], R[C]
+        // Pattern: MOVE R[A], R[A] -> (nothing)
         patterns_.push_back({
-            {OpCode::OP_LOADI, OpCode::OP_ADD},
+            {OpCode::OP_MOVE},
             [](const std::vector<Instruction>& instrs) -> bool {
-                if (instrs.size() < 2) return false;
-
-                std::int32_t value = InstructionEncoder::decode_sbx(instrs[0]);
-                Register a1 = InstructionEncoder::decode_a(instrs[0]);
-                Register c2 = InstructionEncoder::decode_c(instrs[1]);
-
-                return value == 0 && a1 == c2;
+                return InstructionEncoder::decode_a(instrs[0]) ==
+                       InstructionEncoder::decode_b(instrs[0]);
             },
-            [](const std::vector<Instruction>& instrs) -> std::vector<Instruction> {
-                Register a2 = InstructionEncoder::decode_a(instrs[1]);
-                Register b2 = InstructionEncoder::decode_b(instrs[1]);
-
-                return {InstructionEncoder::encode_abc(OpCode::OP_MOVE, a2, b2, 0)};
-            }
+            [](const std::vector<Instruction>&) -> std::vector<Instruction> { return {}; }
         });
 
-        // Pattern: LOADI R[A], 1; MUL R[B], R[C], R[A] -> MOVE R[B], R[C]
+        // Pattern: LOADNIL R[A], n; LOADNIL R[A+n+1], m -> LOADNIL R[A], n+m+1
         patterns_.push_back({
-            {OpCode::OP_LOADI, OpCode::OP_MUL},
+            {OpCode::OP_LOADNIL, OpCode::OP_LOADNIL},
             [](const std::vector<Instruction>& instrs) -> bool {
-                if (instrs.size() < 2) return false;
-
-                std::int32_t value = InstructionEncoder::decode_sbx(instrs[0]);
-                Register a1 = InstructionEncoder::decode_a(instrs[0]);
-                Register c2 = InstructionEncoder::decode_c(instrs[1]);
+                Size a1 = InstructionEncoder::decode_a(instrs[0]);
+                Size b1 = InstructionEncoder::decode_b(instrs[0]);
+                Size a2 = InstructionEncoder::decode_a(instrs[1]);
+                Size b2 = InstructionEncoder::decode_b(instrs[1]);
 
-                return value == 1 && a1 == c2;
+                return a2 == a1 + b1 + 1 && b1 + b2 + 1 <= InstructionEncoder::MAX_B;
             },
             [](const std::vector<Instruction>& instrs) -> std::vector<Instruction> {
-                Register a2 = InstructionEncoder::decode_a(instrs[1]);
-                Register b2 = InstructionEncoder::decode_b(instrs[1]);
-
-                return {InstructionEncoder::encode_abc(OpCode::OP_MOVE, a2, b2, 0)};
-            }
-        });
-
-        // Pattern: NOT R[A], R[B]; NOT R[C], R[A] -> MOVE R[C], R[B]
-        patterns_.push_back({
-            {OpCode::OP_NOT, OpCode::OP_NOT},
-            [](const std::vector<Instruction>& instrs) -> bool {
-                if (instrs.size() < 2) return false;
-
                 Register a1 = InstructionEncoder::decode_a(instrs[0]);
-                Register b2 = InstructionEncoder::decode_b(instrs[1]);
-
-                return a1 == b2;
-            },
-            [](const std::vector<Instruction>& instrs) -> std::vector<Instruction> {
                 Register b1 = InstructionEncoder::decode_b(instrs[0]);
-                Register a2 = InstructionEncoder::decode_a(instrs[1]);
+                Register b2 = InstructionEncoder::decode_b(instrs[1]);
 
-                return {InstructionEncoder::encode_abc(OpCode::OP_MOVE, a2, b1, 0)};
+                return {InstructionEncoder::encode_abc(
+                    OpCode::OP_LOADNIL, a1, static_cast<Register>(b1 + b2 + 1), 0)};
             }
         });
     }
 
     bool PeepholeOptimizationPass::apply_pattern(std::vector<Instruction>& instructions,
-                                                 Size start, const Pattern& pattern) {
+                                                 Size start,
+                                                 const Pattern& pattern,
+                                                 const std::vector<bool>& leaders,
+                                                 std::vector<bool>& removed) {
         if (start + pattern.opcodes.size() > instructions.size()) {
             return false;
         }
 
-        // Check if pattern matches
+        // Check if pattern matches; only the first instruction may be entered from elsewhere
         std::vector<Instruction> window;
         for (Size i = 0; i < pattern.opcodes.size(); ++i) {
             Instruction instr = instructions[start + i];
             OpCode op = InstructionEncoder::decode_opcode(instr);
 
-            if (op != pattern.opcodes[i]) {
+            if (op != pattern.opcodes[i] || removed[start + i] || (i > 0 && leaders[start + i])) {
                 return false;
             }
 
@@ -609,13 +426,24 @@ namespace rangelua::backend {
             return false;
         }
 
-        // Apply replacement
         auto replacement = pattern.replacement(window);
+        if (replacement.size() > window.size() || replacement == window) {
+            return false;
+        }
 
-        // Replace instructions
-        auto it = instructions.begin() + start;
-        instructions.erase(it, it + pattern.opcodes.size());
-        instructions.insert(instructions.begin() + start, replacement.begin(), replacement.end());
+        // A skip instruction right before the window must keep covering exactly one instruction
+        if (replacement.size() < window.size() && start > 0 &&
+            optimization_analysis::skips_next(InstructionEncoder::decode_opcode(instructions[start - 1]))) {
+            return false;
+        }
+
+        for (Size i = 0; i < window.size(); ++i) {
+            if (i < replacement.size()) {
+                instructions[start + i] = replacement[i];
+            } else {
+                removed[start + i] = true;
+            }
+        }
 
         OPTIMIZER_LOG_DEBUG("Applied peephole pattern at instruction {}", start);
         return true;
@@ -645,16 +473,19 @@ namespace rangelua::backend {
             OpCode op = InstructionEncoder::decode_opcode(instr);
 
             if (op == OpCode::OP_JMP) {
-                std::int32_t offset = InstructionEncoder::decode_sbx(instr);
-                Size target = i + 1 + offset;
+                std::int64_t target = static_cast<std::int64_t>(i) + 1 + InstructionEncoder::decode_sbx(instr);
+                if (target < 0 || target >= static_cast<std::int64_t>(instructions.size())) {
+                    continue;
+                }
 
                 // Follow jump chain
-                Size final_target = follow_jump_chain(function, target);
+                Size final_target = follow_jump_chain(function, static_cast<Size>(target));
 
-                if (final_target != target && final_target < instructions.size()) {
+                if (final_target != static_cast<Size>(target) && final_target <= instructions.size()) {
                     // Update jump to point to final target
                     std::int32_t new_offset = static_cast<std::int32_t>(final_target) - static_cast<std::int32_t>(i + 1);
-                    instructions[i] = InstructionEncoder::encode_asbx(OpCode::OP_JMP, 0, new_offset);
+                    instructions[i] = InstructionEncoder::encode_asbx(
+                        OpCode::OP_JMP, InstructionEncoder::decode_a(instr), new_offset);
                     changed = true;
                     OPTIMIZER_LOG_DEBUG("Optimized jump chain at instruction {}", i);
                 }
@@ -665,27 +496,27 @@ namespace rangelua::backend {
     }
 
     bool JumpOptimizationPass::eliminate_redundant_jumps(BytecodeFunction& function) {
+        const auto& instructions = function.instructions;
+        std::vector<bool> removed(instructions.size(), false);
         bool changed = false;
-        auto& instructions = function.instructions;
 
         for (Size i = 0; i < instructions.size(); ++i) {
             Instruction instr = instructions[i];
             OpCode op = InstructionEncoder::decode_opcode(instr);
 
-            if (op == OpCode::OP_JMP) {
-                std::int32_t offset = InstructionEncoder::decode_sbx(instr);
-
-                // Check for jump to next instruction (redundant jump)
-                if (offset == 0) {
-                    // Remove this instruction
-                    instructions.erase(instructions.begin() + static_cast<std::ptrdiff_t>(i));
-                    changed = true;
-                    OPTIMIZER_LOG_DEBUG("Eliminated redundant jump at instruction {}", i);
-                    --i; // Adjust index after removal
-                }
+            // A jump to the next instruction is a no-op, unless a skip instruction depends on it
+            if (op == OpCode::OP_JMP && InstructionEncoder::decode_sbx(instr) == 0 &&
+                (i == 0 || !optimization_analysis::skips_next(
+                               InstructionEncoder::decode_opcode(instructions[i - 1])))) {
+                removed[i] = true;
+                changed = true;
+                OPTIMIZER_LOG_DEBUG("Eliminated redundant jump at instruction {}", i);
             }
         }
 
+        if (changed) {
+            optimization_analysis::remove_instructions(function, removed);
+        }
         return changed;
     }
 
@@ -705,12 +536,14 @@ namespace rangelua::backend {
             Instruction instr = function.instructions[current];
             OpCode op = InstructionEncoder::decode_opcode(instr);
 
-            if (op == OpCode::OP_JMP) {
-                std::int32_t offset = InstructionEncoder::decode_sbx(instr);
-                current = current + 1 + offset;
-            } else {
+            if (op != OpCode::OP_JMP) {
+                break;
+            }
+            std::int64_t next = static_cast<std::int64_t>(current) + 1 + InstructionEncoder::decode_sbx(instr);
+            if (next < 0 || next > static_cast<std::int64_t>(function.instructions.size())) {
                 break;
             }
+            current = static_cast<Size>(next);
         }
 
         return current;
@@ -739,22 +572,26 @@ namespace rangelua::backend {
     }
 
     bool TailCallOptimizationPass::is_tail_position(const BytecodeFunction& function, Size instruction_index) {
-        // Check if the call is followed immediately by a return
+        // The call must be followed by a return of exactly its results
         if (instruction_index + 1 >= function.instructions.size()) {
             return false;
         }
 
+        Instruction call_instr = function.instructions[instruction_index];
         Instruction next_instr = function.instructions[instruction_index + 1];
-        OpCode next_op = InstructionEncoder::decode_opcode(next_instr);
+        if (InstructionEncoder::decode_opcode(next_instr) != OpCode::OP_RETURN) {
+            return false;
+        }
 
-        return next_op == OpCode::OP_RETURN || next_op == OpCode::OP_RETURN0 || next_op == OpCode::OP_RETURN1;
+        return InstructionEncoder::decode_a(next_instr) == InstructionEncoder::decode_a(call_instr) &&
+               InstructionEncoder::decode_b(next_instr) == InstructionEncoder::decode_c(call_instr);
     }
 
-    bool TailCallOptimizationPass::can_optimize_call([[maybe_unused]] const BytecodeFunction& function,
-                                                     [[maybe_unused]] Size call_index) {
-        // TODO: Add more sophisticated analysis
-        // For now, assume all tail position calls can be optimized
-        return true;
+    bool TailCallOptimizationPass::can_optimize_call(const BytecodeFunction& function, Size call_index) {
+        // A skipped call would turn the skip into an unconditional return
+        return call_index == 0 ||
+               !optimization_analysis::skips_next(
+                   InstructionEncoder::decode_opcode(function.instructions[call_index - 1]));
     }
 
     void TailCallOptimizationPass::convert_to_tail_call(BytecodeFunction& function, Size call_index) {
@@ -763,193 +600,990 @@ namespace rangelua::backend {
 
         Register a = InstructionEncoder::decode_a(call_instr);
         Register b = InstructionEncoder::decode_b(call_instr);
+        Register c = InstructionEncoder::decode_c(call_instr);
 
-        // Replace CALL with TAILCALL
-        instructions[call_index] = InstructionEncoder::encode_abc(OpCode::OP_TAILCALL, a, b, 0);
+        // Replace CALL with TAILCALL; the RETURN after it stays for other paths that reach it
+        instructions[call_index] = InstructionEncoder::encode_abc(OpCode::OP_TAILCALL, a, b, c);
+    }
 
-        // Remove the following RETURN instruction if present
-        if (call_index + 1 < instructions.size()) {
-            Instruction next_instr = instructions[call_index + 1];
-            OpCode next_op = InstructionEncoder::decode_opcode(next_instr);
+    // SsaOptimizationPass Implementation
+    Status SsaOptimizationPass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting SSA optimization");
 
-            if (next_op == OpCode::OP_RETURN || next_op == OpCode::OP_RETURN0 || next_op == OpCode::OP_RETURN1) {
-                instructions.erase(instructions.begin() + static_cast<std::ptrdiff_t>(call_index + 1));
-            }
+        auto ssa_form = ssa::Function::build(function);
+        if (!ssa_form) {
+            OPTIMIZER_LOG_DEBUG("SSA optimization skipped: function has no SSA form");
+            return std::monostate{};
         }
+
+        auto manager = ssa::PassManager::create_default();
+        Size changes = manager.run(*ssa_form);
+        if (changes > 0) {
+            ssa_form->lower(function);
+        }
+
+        OPTIMIZER_LOG_INFO("SSA optimization completed, changes: {}", changes);
+        return std::monostate{};
     }
 
-    // RegisterOptimizationPass Implementation
-    Status RegisterOptimizationPass::optimize(BytecodeFunction& function) {
-        OPTIMIZER_LOG_DEBUG("Starting register optimization");
+    // ScalarReplacementPass Implementation
+    namespace {
+
+        // Fields of one table that are given registers of their own
+        constexpr Size MAX_REPLACED_FIELDS = 16;
 
-        auto usage = analyze_register_usage(function);
-        auto mapping = compute_register_mapping(usage);
+        /**
+         * @brief A table built by OP_NEWTABLE and the field accesses made through it
+         */
+        struct TableCandidate {
+            Size node = 0;
+            bool escapes = false;
+            std::vector<String> keys;                     // Field names, in order of first access
+            std::vector<std::pair<Size, Size>> accesses;  // Node, field
+        };
 
-        if (!mapping.empty()) {
-            remap_registers(function, mapping);
-            OPTIMIZER_LOG_INFO("Register optimization completed, remapped {} registers", mapping.size());
-        } else {
-            OPTIMIZER_LOG_INFO("Register optimization completed, no changes needed");
+        const String* string_constant(const std::vector<ConstantValue>& constants, Size index) {
+            return index < constants.size() ? std::get_if<String>(&constants[index]) : nullptr;
         }
 
-        return std::monostate{};
+        /**
+         * @brief Name of the field a node accesses through the table in register table
+         * @return nullptr if the node uses the table any other way
+         */
+        const String* accessed_field(const ssa::Function& function,
+                                     const std::vector<ConstantValue>& constants,
+                                     const ssa::Node& node,
+                                     Register table) {
+            Instruction instr = node.instruction;
+            Register a = InstructionEncoder::decode_a(instr);
+            Register b = InstructionEncoder::decode_b(instr);
+            Register c = InstructionEncoder::decode_c(instr);
+
+            // A key register counts when it holds a string loaded by OP_LOADK
+            auto key_in = [&](Register key) -> const String* {
+                for (Size i = 0; i < node.use_registers.size(); ++i) {
+                    if (node.use_registers[i] != key) {
+                        continue;
+                    }
+                    const auto& value = function.value(function.resolve(node.uses[i]));
+                    if (value.kind != ssa::ValueKind::Def) {
+                        return nullptr;
+                    }
+                    Instruction load = function.nodes()[value.node].instruction;
+                    if (InstructionEncoder::decode_opcode(load) != OpCode::OP_LOADK) {
+                        return nullptr;
+                    }
+                    return string_constant(constants, InstructionEncoder::decode_bx(load));
+                }
+                return nullptr;
+            };
+
+            switch (InstructionEncoder::decode_opcode(instr)) {
+                case OpCode::OP_GETFIELD:
+                    return b == table ? string_constant(constants, c) : nullptr;
+                case OpCode::OP_SETFIELD:
+                    return a == table && c != table ? string_constant(constants, b) : nullptr;
+                case OpCode::OP_GETTABLE:
+                    return b == table && c != table ? key_in(c) : nullptr;
+                case OpCode::OP_SETTABLE:
+                    return a == table && b != table && c != table ? key_in(b) : nullptr;
+                default:
+                    return nullptr;
+            }
+        }
+
+    }  // namespace
+
+    std::unordered_map<String, Size> ScalarReplacementPass::take_counters() {
+        return std::exchange(counters_, {});
     }
 
-    std::unordered_map<Register, RegisterOptimizationPass::RegisterInfo>
-    RegisterOptimizationPass::analyze_register_usage(const BytecodeFunction& function) {
-        std::unordered_map<Register, RegisterInfo> usage;
+    // Runs on the first iteration only, ahead of loop-invariant code motion: a
+    // field load that pass caches is guarded by table writes, which a field
+    // register would no longer make
+    Status ScalarReplacementPass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting scalar replacement");
 
-        for (Size i = 0; i < function.instructions.size(); ++i) {
-            Instruction instr = function.instructions[i];
-            OpCode op = InstructionEncoder::decode_opcode(instr);
+        auto& code = function.instructions;
+        const bool has_tables = std::ranges::any_of(code, [](Instruction instr) {
+            return InstructionEncoder::decode_opcode(instr) == OpCode::OP_NEWTABLE;
+        });
+        if (!has_tables) {
+            return std::monostate{};
+        }
+        auto ssa_form = ssa::Function::build(function);
+        if (!ssa_form) {
+            OPTIMIZER_LOG_DEBUG("Scalar replacement skipped: function has no SSA form");
+            return std::monostate{};
+        }
+        const auto& nodes = ssa_form->nodes();
+
+        // The table each value may hold, starting from the constructors
+        std::vector<TableCandidate> tables;
+        std::unordered_map<ssa::ValueId, Size> table_of;
+        for (Size pc = 0; pc < code.size(); ++pc) {
+            const auto& node = nodes[pc];
+            if (InstructionEncoder::decode_opcode(code[pc]) == OpCode::OP_NEWTABLE &&
+                node.pc == pc && node.defs.size() == 1) {
+                table_of[ssa_form->resolve(node.defs[0])] = tables.size();
+                tables.push_back(TableCandidate{pc});
+            }
+        }
+        if (tables.empty()) {
+            return std::monostate{};
+        }
+        auto owner = [&](ssa::ValueId value) -> Optional<Size> {
+            auto it = table_of.find(ssa_form->resolve(value));
+            return it != table_of.end() ? Optional<Size>{it->second} : std::nullopt;
+        };
+
+        // Copies hold the same table; copies of copies may come earlier in the code
+        for (bool grew = true; grew;) {
+            grew = false;
+            for (const auto& node : nodes) {
+                if (InstructionEncoder::decode_opcode(node.instruction) != OpCode::OP_MOVE ||
+                    node.uses.size() != 1 || node.defs.size() != 1) {
+                    continue;
+                }
+                auto table = owner(node.uses[0]);
+                if (table && table_of.emplace(ssa_form->resolve(node.defs[0]), *table).second) {
+                    grew = true;
+                }
+            }
+        }
 
-            // Track register usage based on instruction type
-            Register a = InstructionEncoder::decode_a(instr);
-            if (a < 255) {  // Valid register
-                auto& info = usage[a];
-                if (info.first_use == SIZE_MAX) {
-                    info.first_use = i;
+        for (Size pc = 0; pc < nodes.size(); ++pc) {
+            const auto& node = nodes[pc];
+            for (Size i = 0; i < node.uses.size(); ++i) {
+                auto table = owner(node.uses[i]);
+                if (!table) {
+                    continue;
+                }
+                auto& candidate = tables[*table];
+                OpCode op = InstructionEncoder::decode_opcode(node.instruction);
+                if (op == OpCode::OP_MOVE) {
+                    // A copy into a captured register is out of sight
+                    candidate.escapes = candidate.escapes || node.defs.size() != 1;
+                    continue;
+                }
+
+                const String* key = accessed_field(*ssa_form, function.constants, node, node.use_registers[i]);
+                if (key == nullptr) {
+                    candidate.escapes = true;
+                    continue;
+                }
+                auto field = std::ranges::find(candidate.keys, *key);
+                candidate.accesses.emplace_back(pc, static_cast<Size>(field - candidate.keys.begin()));
+                if (field == candidate.keys.end()) {
+                    candidate.keys.push_back(*key);
                 }
-                info.last_use = i;
-                info.uses.push_back(i);
             }
+        }
+
+        // A phi merging a table with anything would need its fields on every path.
+        // Only phis some instruction reads count; the others merely record the
+        // value a register held before it was overwritten.
+        std::vector<ssa::ValueId> worklist;
+        std::unordered_set<ssa::ValueId> read_phis;
+        auto visit = [&](ssa::ValueId value) {
+            value = ssa_form->resolve(value);
+            if (ssa_form->value(value).kind == ssa::ValueKind::Phi && read_phis.insert(value).second) {
+                worklist.push_back(value);
+            }
+        };
+        for (const auto& node : nodes) {
+            std::ranges::for_each(node.uses, visit);
+        }
+        while (!worklist.empty()) {
+            ssa::ValueId phi = worklist.back();
+            worklist.pop_back();
+            for (ssa::ValueId operand : ssa_form->value(phi).operands) {
+                if (auto table = owner(operand)) {
+                    tables[*table].escapes = true;
+                }
+                visit(operand);
+            }
+        }
+
+        // Field registers go above every register the function names
+        Size next = optimization_analysis::frame_register_count(function);
+        Size replaced = 0;
+        for (const auto& table : tables) {
+            const Size fields = table.keys.size();
+            if (table.escapes || fields > MAX_REPLACED_FIELDS || next + fields > FRAME_LIMIT) {
+                ++counters_["escaped"];
+                continue;
+            }
+
+            Register target = InstructionEncoder::decode_a(code[table.node]);
+            code[table.node] =
+                fields == 0 ? InstructionEncoder::encode_abc(OpCode::OP_LOADNIL, target, 0, 0)
+                            : InstructionEncoder::encode_abc(OpCode::OP_LOADNIL, static_cast<Register>(next),
+                                                             static_cast<Register>(fields - 1), 0);
+            for (auto [pc, field] : table.accesses) {
+                Instruction instr = code[pc];
+                auto slot = static_cast<Register>(next + field);
+                switch (InstructionEncoder::decode_opcode(instr)) {
+                    case OpCode::OP_GETFIELD:
+                    case OpCode::OP_GETTABLE:
+                        code[pc] = InstructionEncoder::encode_abc(
+                            OpCode::OP_MOVE, InstructionEncoder::decode_a(instr), slot, 0);
+                        break;
+                    default:  // SETFIELD, SETTABLE
+                        code[pc] = InstructionEncoder::encode_abc(
+                            OpCode::OP_MOVE, slot, InstructionEncoder::decode_c(instr), 0);
+                        break;
+                }
+            }
+
+            next += fields;
+            counters_["fields"] += fields;
+            ++replaced;
+        }
+        counters_["replaced"] += replaced;
+        function.stack_size = std::max(function.stack_size, next);
+
+        OPTIMIZER_LOG_INFO("Scalar replacement completed, tables replaced: {}", replaced);
+        return std::monostate{};
+    }
+
+    // RegisterOptimizationPass Implementation
+    namespace {
+
+        constexpr std::uint8_t FIELD_A = 1;
+        constexpr std::uint8_t FIELD_B = 2;
+        constexpr std::uint8_t FIELD_C = 4;
+
+        /**
+         * @brief Operand fields naming registers, or nullopt if they cannot be renamed
+         */
+        Optional<std::uint8_t> register_fields(OpCode op) noexcept {
+            switch (instruction_utils::generic_opcode(op)) {
+                case OpCode::OP_JMP:
+                case OpCode::OP_CLOSE:  // Nothing is captured, so it closes nothing
+                case OpCode::OP_RETURN0:
+                case OpCode::OP_VARARGPREP:
+                case OpCode::OP_EXTRAARG:
+                case OpCode::OP_HOISTCLEAR:
+                    return 0;
+
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                case OpCode::OP_LOADK:
+                case OpCode::OP_LOADKX:
+                case OpCode::OP_LOADFALSE:
+                case OpCode::OP_LFALSESKIP:
+                case OpCode::OP_LOADTRUE:
+                case OpCode::OP_LOADNIL:
+                case OpCode::OP_GETUPVAL:
+                case OpCode::OP_SETUPVAL:
+                case OpCode::OP_GETTABUP:
+                case OpCode::OP_NEWTABLE:
+                case OpCode::OP_CLOSURE:
+                case OpCode::OP_CONCAT:
+                case OpCode::OP_SETLIST:
+                case OpCode::OP_TEST:
+                case OpCode::OP_EQK:
+                case OpCode::OP_EQI:
+                case OpCode::OP_LTI:
+                case OpCode::OP_LEI:
+                case OpCode::OP_GTI:
+                case OpCode::OP_GEI:
+                case OpCode::OP_CALL:
+                case OpCode::OP_TAILCALL:
+                case OpCode::OP_RETURN:
+                case OpCode::OP_RETURN1:
+                case OpCode::OP_FORLOOP:
+                case OpCode::OP_FORPREP:
+                case OpCode::OP_TFORPREP:
+                case OpCode::OP_TFORCALL:
+                case OpCode::OP_TFORLOOP:
+                case OpCode::OP_HOISTGET:
+                case OpCode::OP_HOISTSET:
+                    return FIELD_A;
 
-            // Track source registers
-            switch (op) {
                 case OpCode::OP_MOVE:
+                case OpCode::OP_GETI:
+                case OpCode::OP_GETFIELD:
+                case OpCode::OP_SELF:
+                case OpCode::OP_ADDI:
+                case OpCode::OP_ADDK:
+                case OpCode::OP_SUBK:
+                case OpCode::OP_MULK:
+                case OpCode::OP_MODK:
+                case OpCode::OP_POWK:
+                case OpCode::OP_DIVK:
+                case OpCode::OP_IDIVK:
+                case OpCode::OP_BANDK:
+                case OpCode::OP_BORK:
+                case OpCode::OP_BXORK:
+                case OpCode::OP_SHRI:
+                case OpCode::OP_SHLI:
                 case OpCode::OP_UNM:
+                case OpCode::OP_BNOT:
                 case OpCode::OP_NOT:
                 case OpCode::OP_LEN:
-                case OpCode::OP_BNOT: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    if (b < 255) {
-                        auto& info = usage[b];
-                        if (info.first_use == SIZE_MAX) {
-                            info.first_use = i;
-                        }
-                        info.last_use = i;
-                        info.uses.push_back(i);
-                    }
-                    break;
-                }
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                case OpCode::OP_TESTSET:
+                    return FIELD_A | FIELD_B;
 
+                case OpCode::OP_GETTABLE:
+                case OpCode::OP_SETTABLE:
                 case OpCode::OP_ADD:
                 case OpCode::OP_SUB:
                 case OpCode::OP_MUL:
-                case OpCode::OP_DIV:
                 case OpCode::OP_MOD:
                 case OpCode::OP_POW:
+                case OpCode::OP_DIV:
+                case OpCode::OP_IDIV:
                 case OpCode::OP_BAND:
                 case OpCode::OP_BOR:
                 case OpCode::OP_BXOR:
                 case OpCode::OP_SHL:
-                case OpCode::OP_SHR: {
-                    Register b = InstructionEncoder::decode_b(instr);
-                    Register c = InstructionEncoder::decode_c(instr);
-
-                    if (b < 255) {
-                        auto& info = usage[b];
-                        if (info.first_use == SIZE_MAX) {
-                            info.first_use = i;
-                        }
-                        info.last_use = i;
-                        info.uses.push_back(i);
-                    }
+                case OpCode::OP_SHR:
+                    return FIELD_A | FIELD_B | FIELD_C;
 
-                    if (c < 255) {
-                        auto& info = usage[c];
-                        if (info.first_use == SIZE_MAX) {
-                            info.first_use = i;
-                        }
-                        info.last_use = i;
-                        info.uses.push_back(i);
-                    }
-                    break;
-                }
+                case OpCode::OP_SETI:
+                case OpCode::OP_SETFIELD:
+                    return FIELD_A | FIELD_C;
+
+                case OpCode::OP_SETTABUP:
+                    return FIELD_C;
 
                 default:
-                    break;
+                    // Varargs and to-be-closed variables depend on the frame layout
+                    return std::nullopt;
             }
         }
 
-        return usage;
-    }
-
-    std::unordered_map<Register, Register>
-    RegisterOptimizationPass::compute_register_mapping(const std::unordered_map<Register, RegisterInfo>& usage) {
-        std::unordered_map<Register, Register> mapping;
+        /**
+         * @brief Number of consecutive registers from R[A] an instruction addresses as a block
+         */
+        Size register_window(Instruction instr) noexcept {
+            Size b = InstructionEncoder::decode_b(instr);
+            Size c = InstructionEncoder::decode_c(instr);
+            switch (instruction_utils::generic_opcode(InstructionEncoder::decode_opcode(instr))) {
+                case OpCode::OP_CALL:
+                    return std::max(b, c - 1);
+                case OpCode::OP_TAILCALL:
+                case OpCode::OP_CONCAT:
+                    return b;
+                case OpCode::OP_RETURN:
+                    return b - 1;
+                case OpCode::OP_SETLIST:
+                case OpCode::OP_LOADNIL:
+                    return b + 1;
+                case OpCode::OP_SELF:
+                    return 2;
+                case OpCode::OP_FORLOOP:
+                case OpCode::OP_FORPREP:
+                    return 4;
+                case OpCode::OP_TFORPREP:
+                case OpCode::OP_TFORLOOP:
+                    return 5;
+                case OpCode::OP_TFORCALL:
+                    return 4 + c;
+                default:
+                    return 1;
+            }
+        }
 
-        // Simple register compaction - assign consecutive register numbers
-        std::vector<std::pair<Register, RegisterInfo>> sorted_usage;
-        for (const auto& [reg, info] : usage) {
-            sorted_usage.emplace_back(reg, info);
+        Instruction with_register(Instruction instr, std::uint8_t field, Size reg) noexcept {
+            Size shift = LuaInstruction::OPCODE_BITS;
+            if (field != FIELD_A) {
+                shift += LuaInstruction::A_BITS;
+            }
+            if (field == FIELD_C) {
+                shift += LuaInstruction::B_BITS;
+            }
+            const auto mask = static_cast<Instruction>(LuaInstruction::MAX_A << shift);
+            return (instr & ~mask) | static_cast<Instruction>(reg << shift);
         }
 
-        // Sort by first use to maintain program order
-        std::sort(sorted_usage.begin(), sorted_usage.end(),
-                  [](const auto& a, const auto& b) {
-                      return a.second.first_use < b.second.first_use;
-                  });
+        /**
+         * @brief Colours the webs of an SSA function onto as few registers as possible
+         *
+         * A web is the set of values of one register joined through phis and
+         * through instructions that read and write the same register. Webs an
+         * instruction addresses as a block form a cluster with fixed distances
+         * between its webs, which is placed as a unit.
+         */
+        class LiveRangeAllocator {
+        public:
+            LiveRangeAllocator(const ssa::Function& function, Size parameter_count)
+                : f_(function), registers_(function.register_count()), parameter_count_(parameter_count) {}
+
+            /**
+             * @brief Assign a register below limit to every web
+             * @return false if the code's constraints cannot be met
+             */
+            bool allocate(Size limit) {
+                if (!build_webs()) {
+                    return false;
+                }
+                for (auto [target, source] : copies_) {
+                    Size a = web_of_[f_.resolve(target)];
+                    Size b = web_of_[f_.resolve(source)];
+                    webs_[a].partners.push_back(b);
+                    webs_[b].partners.push_back(a);
+                }
+                return build_interference() && place(limit);
+            }
 
-        Register next_reg = 0;
-        for (const auto& [original_reg, info] : sorted_usage) {
-            if (original_reg != next_reg) {
-                mapping[original_reg] = next_reg;
+            /**
+             * @brief Register assigned to a value
+             */
+            [[nodiscard]] Size slot(ssa::ValueId id) const {
+                return static_cast<Size>(webs_[web_of_[f_.resolve(id)]].slot);
             }
-            ++next_reg;
-        }
 
-        return mapping;
-    }
+            /**
+             * @brief Record a MOVE, whose target and source should share a register
+             */
+            void add_copy(ssa::ValueId target, ssa::ValueId source) { copies_.emplace_back(target, source); }
+
+        private:
+            struct Web {
+                ssa::ValueId root = 0;
+                std::int64_t offset = 0;  // Distance from the cluster root
+                Size first_pc = SIZE_MAX;
+                std::int64_t slot = -1;
+                std::vector<Size> neighbours;
+                std::vector<Size> partners;
+            };
+
+            const ssa::Function& f_;
+            Size registers_;
+            Size parameter_count_;
+            std::vector<ssa::ValueId> parent_;
+            std::vector<std::int64_t> distance_;  // slot(value) - slot(parent)
+            std::vector<Size> web_of_;
+            std::vector<Web> webs_;
+            std::unordered_map<ssa::ValueId, std::int64_t> pinned_;  // Cluster root -> its register
+            std::vector<std::pair<ssa::ValueId, ssa::ValueId>> copies_;
+            std::vector<bool> used_;
+
+            std::pair<ssa::ValueId, std::int64_t> find(ssa::ValueId id) {
+                ssa::ValueId root = id;
+                std::int64_t total = 0;
+                while (parent_[root] != root) {
+                    total += distance_[root];
+                    root = parent_[root];
+                }
+                // Path compression keeps each value's distance to the root
+                std::int64_t remaining = total;
+                while (parent_[id] != root && id != root) {
+                    ssa::ValueId next = parent_[id];
+                    std::int64_t step = distance_[id];
+                    parent_[id] = root;
+                    distance_[id] = remaining;
+                    remaining -= step;
+                    id = next;
+                }
+                return {root, total};
+            }
 
-    void RegisterOptimizationPass::remap_registers(BytecodeFunction& function,
-                                                   const std::unordered_map<Register, Register>& mapping) {
-        auto& instructions = function.instructions;
+            // Require slot(a) - slot(b) == distance
+            bool unite(ssa::ValueId a, ssa::ValueId b, std::int64_t distance) {
+                auto [root_a, offset_a] = find(f_.resolve(a));
+                auto [root_b, offset_b] = find(f_.resolve(b));
+                if (root_a == root_b) {
+                    return offset_a - offset_b == distance;
+                }
+                parent_[root_a] = root_b;
+                distance_[root_a] = distance + offset_b - offset_a;
+                return true;
+            }
 
-        for (auto& instr : instructions) {
-            OpCode op = InstructionEncoder::decode_opcode(instr);
+            bool reachable(const ssa::Node& node) const { return f_.blocks()[node.block].reachable; }
 
-            // Remap register A
-            Register a = InstructionEncoder::decode_a(instr);
-            auto a_it = mapping.find(a);
-            if (a_it != mapping.end()) {
-                // Reconstruct instruction with new register
-                switch (op) {
-                    case OpCode::OP_LOADI:
-                    case OpCode::OP_LOADF: {
-                        std::int32_t sbx = InstructionEncoder::decode_sbx(instr);
-                        instr = InstructionEncoder::encode_asbx(op, a_it->second, sbx);
-                        break;
+            bool build_webs() {
+                const Size count = f_.value_count();
+                parent_.resize(count);
+                distance_.assign(count, 0);
+                for (ssa::ValueId id = 0; id < count; ++id) {
+                    parent_[id] = id;
+                }
+
+                // Values some instruction reads, directly or through phis. The builder also
+                // looks up the values instructions overwrite, and those need no register.
+                used_.assign(count, false);
+                std::vector<ssa::ValueId> work;
+                for (const auto& node : f_.nodes()) {
+                    for (ssa::ValueId id : node.uses) {
+                        work.push_back(f_.resolve(id));
+                    }
+                }
+                while (!work.empty()) {
+                    ssa::ValueId id = work.back();
+                    work.pop_back();
+                    if (used_[id]) {
+                        continue;
                     }
+                    used_[id] = true;
+                    for (ssa::ValueId operand : f_.value(id).operands) {
+                        work.push_back(f_.resolve(operand));
+                    }
+                }
 
-                    case OpCode::OP_LOADK: {
-                        std::uint32_t bx = InstructionEncoder::decode_bx(instr);
-                        instr = InstructionEncoder::encode_abx(op, a_it->second, bx);
-                        break;
+                for (ssa::ValueId id = 0; id < count; ++id) {
+                    const auto& value = f_.value(id);
+                    if (value.kind != ssa::ValueKind::Phi || !used_[id]) {
+                        continue;
+                    }
+                    for (ssa::ValueId operand : value.operands) {
+                        if (!unite(id, operand, 0)) {
+                            return false;
+                        }
+                    }
+                }
+
+                for (const auto& node : f_.nodes()) {
+                    if (!reachable(node)) {
+                        continue;
+                    }
+                    // A register both read and written keeps one register across the instruction
+                    for (Size i = 0; i < node.defs.size(); ++i) {
+                        for (Size j = 0; j < node.uses.size(); ++j) {
+                            if (node.use_registers[j] == node.def_registers[i] &&
+                                !unite(node.defs[i], node.uses[j], 0)) {
+                                return false;
+                            }
+                        }
+                    }
+
+                    const Size window = register_window(node.instruction);
+                    if (window <= 1) {
+                        continue;
+                    }
+                    const Size a = InstructionEncoder::decode_a(node.instruction);
+                    Optional<std::pair<ssa::ValueId, Size>> anchor;
+                    auto tie = [&](ssa::ValueId id, Size reg) {
+                        if (reg < a || reg >= a + window) {
+                            return true;
+                        }
+                        if (!anchor) {
+                            anchor = std::make_pair(id, reg);
+                            return true;
+                        }
+                        return unite(id, anchor->first,
+                                     static_cast<std::int64_t>(reg) - static_cast<std::int64_t>(anchor->second));
+                    };
+                    for (Size j = 0; j < node.uses.size(); ++j) {
+                        if (!tie(node.uses[j], node.use_registers[j])) {
+                            return false;
+                        }
+                    }
+                    for (Size i = 0; i < node.defs.size(); ++i) {
+                        if (!tie(node.defs[i], node.def_registers[i])) {
+                            return false;
+                        }
                     }
+                }
 
-                    default: {
-                        Register b = InstructionEncoder::decode_b(instr);
-                        Register c = InstructionEncoder::decode_c(instr);
+                // One web per distinct (cluster, distance) pair
+                std::unordered_map<std::uint64_t, Size> web_ids;
+                web_of_.assign(count, SIZE_MAX);
+                for (ssa::ValueId id = 0; id < count; ++id) {
+                    if (f_.resolve(id) != id || (!used_[id] && f_.value(id).kind != ssa::ValueKind::Def)) {
+                        continue;
+                    }
+                    auto [root, offset] = find(id);
+                    const auto key = (static_cast<std::uint64_t>(root) << 32) |
+                                     static_cast<std::uint32_t>(static_cast<std::int32_t>(offset));
+                    auto [it, inserted] = web_ids.try_emplace(key, webs_.size());
+                    if (inserted) {
+                        webs_.push_back(Web{root, offset});
+                    }
+                    web_of_[id] = it->second;
+
+                    const auto& value = f_.value(id);
+                    Size pc = 0;
+                    if (value.kind == ssa::ValueKind::Def) {
+                        pc = value.node;
+                    } else if (value.kind == ssa::ValueKind::Phi) {
+                        pc = f_.blocks()[value.block].first;
+                    }
+                    webs_[it->second].first_pc = std::min(webs_[it->second].first_pc, pc);
+
+                    // Parameters stay where the caller puts them. Other registers read before
+                    // being written (a loop variable FORPREP may not set) hold nothing useful.
+                    if (value.kind == ssa::ValueKind::Entry && value.reg < parameter_count_) {
+                        std::int64_t base = static_cast<std::int64_t>(value.reg) - offset;
+                        auto [pin, fresh] = pinned_.try_emplace(root, base);
+                        if (!fresh && pin->second != base) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
 
-                        // Remap register B if needed
-                        auto b_it = mapping.find(b);
-                        if (b_it != mapping.end()) {
-                            b = b_it->second;
+            bool build_interference() {
+                const auto& blocks = f_.blocks();
+                const auto& nodes = f_.nodes();
+                const Size stride = registers_;
+                constexpr ssa::ValueId NONE = ssa::NO_VALUE;
+                std::vector<ssa::ValueId> live_in(blocks.size() * stride, NONE);
+                std::vector<ssa::ValueId> live_out(blocks.size() * stride, NONE);
+
+                auto defined_in = [&](ssa::ValueId id, Size block) {
+                    const auto& value = f_.value(id);
+                    return value.kind != ssa::ValueKind::Entry && value.block == block;
+                };
+
+                // Walks back from a use to the definition, one register of one block at a time
+                std::vector<Size> work;
+                auto mark_live_in = [&](ssa::ValueId id, Register reg, Size block) {
+                    work.assign(1, block);
+                    while (!work.empty()) {
+                        Size b = work.back();
+                        work.pop_back();
+                        ssa::ValueId& in = live_in[b * stride + reg];
+                        if (in == id) {
+                            continue;
+                        }
+                        if (in != NONE) {
+                            return false;  // Two values of one register live at once
+                        }
+                        in = id;
+                        if (f_.value(id).kind == ssa::ValueKind::Phi && f_.value(id).block == b) {
+                            continue;
+                        }
+                        for (Size p : blocks[b].predecessors) {
+                            ssa::ValueId& out = live_out[p * stride + reg];
+                            if (out != NONE && out != id) {
+                                return false;
+                            }
+                            out = id;
+                            if (!defined_in(id, p)) {
+                                work.push_back(p);
+                            }
                         }
+                    }
+                    return true;
+                };
 
-                        // Remap register C if needed
-                        auto c_it = mapping.find(c);
-                        if (c_it != mapping.end()) {
-                            c = c_it->second;
+                for (Size b = 0; b < blocks.size(); ++b) {
+                    if (!blocks[b].reachable) {
+                        continue;
+                    }
+                    for (Size pc = blocks[b].first; pc < blocks[b].last; ++pc) {
+                        const auto& node = nodes[pc];
+                        for (Size j = 0; j < node.uses.size(); ++j) {
+                            ssa::ValueId id = f_.resolve(node.uses[j]);
+                            const auto& value = f_.value(id);
+                            const bool local = value.block == b &&
+                                               ((value.kind == ssa::ValueKind::Def && value.node < pc) ||
+                                                value.kind == ssa::ValueKind::Phi);
+                            if (!local && !mark_live_in(id, node.use_registers[j], b)) {
+                                return false;
+                            }
+                        }
+                    }
+                    // Phi operands are read at the end of each predecessor
+                    const Size skip = b == 0 ? 1 : 0;
+                    for (ssa::ValueId phi : blocks[b].phis) {
+                        if (f_.resolve(phi) != phi || !used_[phi]) {
+                            continue;
+                        }
+                        const auto& value = f_.value(phi);
+                        for (Size i = 0; i < blocks[b].predecessors.size(); ++i) {
+                            Size p = blocks[b].predecessors[i];
+                            ssa::ValueId operand = f_.resolve(value.operands[i + skip]);
+                            ssa::ValueId& out = live_out[p * stride + value.reg];
+                            if (out != NONE && out != operand) {
+                                return false;
+                            }
+                            out = operand;
+                            if (!defined_in(operand, p) && !mark_live_in(operand, value.reg, p)) {
+                                return false;
+                            }
                         }
+                    }
+                }
 
-                        instr = InstructionEncoder::encode_abc(op, a_it->second, b, c);
-                        break;
+                bool consistent = true;
+                auto interfere = [&](ssa::ValueId a, ssa::ValueId b) {
+                    Size web_a = web_of_[f_.resolve(a)];
+                    Size web_b = web_of_[f_.resolve(b)];
+                    if (web_a == web_b) {
+                        consistent = false;
+                        return;
+                    }
+                    webs_[web_a].neighbours.push_back(web_b);
+                    webs_[web_b].neighbours.push_back(web_a);
+                };
+
+                std::vector<ssa::ValueId> live(stride);
+                for (Size b = 0; b < blocks.size(); ++b) {
+                    if (!blocks[b].reachable) {
+                        continue;
+                    }
+                    std::copy_n(live_out.begin() + static_cast<std::ptrdiff_t>(b * stride), stride, live.begin());
+                    for (Size pc = blocks[b].last; pc-- > blocks[b].first;) {
+                        const auto& node = nodes[pc];
+                        // A copy's target may share its source's register
+                        ssa::ValueId copied = NONE;
+                        if (instruction_utils::generic_opcode(InstructionEncoder::decode_opcode(
+                                node.instruction)) == OpCode::OP_MOVE &&
+                            !node.uses.empty()) {
+                            copied = f_.resolve(node.uses[0]);
+                        }
+                        for (Size i = 0; i < node.defs.size(); ++i) {
+                            for (Size r = 0; r < stride; ++r) {
+                                if (live[r] != NONE && r != node.def_registers[i] && live[r] != copied) {
+                                    interfere(node.defs[i], live[r]);
+                                }
+                            }
+                            for (Size k = i + 1; k < node.defs.size(); ++k) {
+                                interfere(node.defs[i], node.defs[k]);
+                            }
+                        }
+                        for (Register reg : node.def_registers) {
+                            live[reg] = NONE;
+                        }
+                        for (Size j = 0; j < node.uses.size(); ++j) {
+                            live[node.use_registers[j]] = f_.resolve(node.uses[j]);
+                        }
+                    }
+                    // Phis are written together on entry
+                    for (Size r = 0; r < stride; ++r) {
+                        if (live[r] == NONE || f_.value(live[r]).kind != ssa::ValueKind::Phi ||
+                            f_.value(live[r]).block != b) {
+                            continue;
+                        }
+                        for (Size s = 0; s < stride; ++s) {
+                            if (s != r && live[s] != NONE) {
+                                interfere(live[r], live[s]);
+                            }
+                        }
+                    }
+                }
+                return consistent;
+            }
+
+            bool place(Size limit) {
+                std::unordered_map<ssa::ValueId, std::vector<Size>> clusters;
+                for (Size w = 0; w < webs_.size(); ++w) {
+                    clusters[webs_[w].root].push_back(w);
+                }
+
+                struct Cluster {
+                    ssa::ValueId root;
+                    bool pinned;
+                    Size first_pc;
+                };
+                std::vector<Cluster> order;
+                order.reserve(clusters.size());
+                for (const auto& [root, members] : clusters) {
+                    Size first_pc = SIZE_MAX;
+                    for (Size w : members) {
+                        first_pc = std::min(first_pc, webs_[w].first_pc);
+                    }
+                    order.push_back(Cluster{root, pinned_.contains(root), first_pc});
+                }
+                // Pinned clusters first, then program order
+                std::ranges::sort(order, [](const Cluster& a, const Cluster& b) {
+                    if (a.pinned != b.pinned) {
+                        return a.pinned;
+                    }
+                    return a.first_pc != b.first_pc ? a.first_pc < b.first_pc : a.root < b.root;
+                });
+
+                std::vector<bool> forbidden;
+                for (const auto& cluster : order) {
+                    const auto& members = clusters[cluster.root];
+                    std::int64_t low = 0;
+                    std::int64_t high = 0;
+                    for (Size w : members) {
+                        low = std::min(low, webs_[w].offset);
+                        high = std::max(high, webs_[w].offset);
+                    }
+                    // Candidate root registers: first .. last
+                    const std::int64_t first = -low;
+                    const std::int64_t last = static_cast<std::int64_t>(limit) - 1 - high;
+                    if (first > last) {
+                        return false;
+                    }
+
+                    forbidden.assign(static_cast<Size>(last - first + 1), false);
+                    for (Size w : members) {
+                        for (Size n : webs_[w].neighbours) {
+                            std::int64_t root_slot = webs_[n].slot - webs_[w].offset;
+                            if (webs_[n].slot >= 0 && root_slot >= first && root_slot <= last) {
+                                forbidden[static_cast<Size>(root_slot - first)] = true;
+                            }
+                        }
+                    }
+                    auto allowed = [&](std::int64_t root_slot) {
+                        return root_slot >= first && root_slot <= last &&
+                               !forbidden[static_cast<Size>(root_slot - first)];
+                    };
+
+                    Optional<std::int64_t> chosen;
+                    if (auto pin = pinned_.find(cluster.root); pin != pinned_.end()) {
+                        if (!allowed(pin->second)) {
+                            return false;
+                        }
+                        chosen = pin->second;
+                    }
+                    // A copy's partner already placed is the first choice
+                    for (Size w : members) {
+                        for (Size partner : webs_[w].partners) {
+                            std::int64_t root_slot = webs_[partner].slot - webs_[w].offset;
+                            if (!chosen && webs_[partner].slot >= 0 && allowed(root_slot)) {
+                                chosen = root_slot;
+                            }
+                        }
+                    }
+                    for (std::int64_t root_slot = first; !chosen && root_slot <= last; ++root_slot) {
+                        if (allowed(root_slot)) {
+                            chosen = root_slot;
+                        }
+                    }
+                    if (!chosen) {
+                        return false;
+                    }
+                    for (Size w : members) {
+                        webs_[w].slot = *chosen + webs_[w].offset;
                     }
                 }
+                return true;
+            }
+        };
+
+    }  // namespace
+
+    std::unordered_map<String, Size> RegisterOptimizationPass::take_counters() {
+        return std::exchange(counters_, {});
+    }
+
+    Status RegisterOptimizationPass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting register optimization");
+
+        auto& code = function.instructions;
+        for (Instruction instr : code) {
+            auto effects = optimization_analysis::register_effects(instr);
+            if (!effects || !register_fields(InstructionEncoder::decode_opcode(instr))) {
+                return std::monostate{};
+            }
+            // Open ranges run to whatever the previous instruction left on the stack
+            for (Size i = 0; i < effects->read_count; ++i) {
+                if (effects->reads[i].count == optimization_analysis::RegisterRange::TO_TOP) {
+                    return std::monostate{};
+                }
+            }
+            for (Size i = 0; i < effects->write_count; ++i) {
+                if (effects->writes[i].count == optimization_analysis::RegisterRange::TO_TOP) {
+                    return std::monostate{};
+                }
+            }
+        }
+        auto captured = optimization_analysis::captured_registers(function);
+        if (!captured || !captured->empty()) {
+            OPTIMIZER_LOG_DEBUG("Register optimization skipped: registers are captured by closures");
+            return std::monostate{};
+        }
+        auto ssa_form = ssa::Function::build(function);
+        if (!ssa_form) {
+            OPTIMIZER_LOG_DEBUG("Register optimization skipped: function has no SSA form");
+            return std::monostate{};
+        }
+
+        LiveRangeAllocator allocator(*ssa_form, function.parameter_count);
+        for (const auto& node : ssa_form->nodes()) {
+            if (ssa_form->blocks()[node.block].reachable && !node.defs.empty() && !node.uses.empty() &&
+                instruction_utils::generic_opcode(InstructionEncoder::decode_opcode(node.instruction)) ==
+                    OpCode::OP_MOVE) {
+                allocator.add_copy(node.defs[0], node.uses[0]);
+            }
+        }
+        const Size frame_before = optimization_analysis::frame_register_count(function);
+        if (!allocator.allocate(frame_before)) {
+            OPTIMIZER_LOG_DEBUG("Register optimization skipped: register constraints conflict");
+            return std::monostate{};
+        }
+
+        std::vector<Instruction> allocated = code;
+        for (const auto& node : ssa_form->nodes()) {
+            if (!ssa_form->blocks()[node.block].reachable) {
+                continue;
+            }
+            auto slot_of = [&](Size reg, bool written) -> Optional<Size> {
+                for (int pass = 0; pass < 2; ++pass) {
+                    const bool defs = (pass == 0) == written;
+                    const auto& registers = defs ? node.def_registers : node.use_registers;
+                    const auto& values = defs ? node.defs : node.uses;
+                    for (Size i = 0; i < registers.size(); ++i) {
+                        if (registers[i] == reg) {
+                            return allocator.slot(values[i]);
+                        }
+                    }
+                }
+                return std::nullopt;
+            };
+
+            Instruction instr = node.instruction;
+            const std::uint8_t fields = *register_fields(InstructionEncoder::decode_opcode(instr));
+            const Size window = register_window(instr);
+            const std::array<Size, 3> operands = {InstructionEncoder::decode_a(instr),
+                                                  InstructionEncoder::decode_b(instr),
+                                                  InstructionEncoder::decode_c(instr)};
+            for (Size f = 0; f < 3; ++f) {
+                const auto field = static_cast<std::uint8_t>(1U << f);
+                if ((fields & field) == 0) {
+                    continue;
+                }
+                Optional<Size> slot;
+                if (field == FIELD_A && window > 1) {
+                    // A block moves as a whole; any register of it that the instruction touches gives its base
+                    for (Size k = 0; k < window && !slot; ++k) {
+                        if (auto member = slot_of(operands[0] + k, true); member && *member >= k) {
+                            slot = *member - k;
+                        }
+                    }
+                } else {
+                    slot = slot_of(operands[f], field == FIELD_A);
+                }
+                if (slot) {
+                    instr = with_register(instr, field, *slot);
+                }  // Otherwise the instruction does not access the register (RETURN R[A] 1)
+            }
+            allocated[node.pc] = instr;
+        }
+
+        // Copies whose source and target now coincide do nothing
+        std::vector<bool> removed(code.size(), false);
+        Size moves = 0;
+        for (Size pc = 0; pc < code.size(); ++pc) {
+            Instruction instr = allocated[pc];
+            if (InstructionEncoder::decode_opcode(instr) == OpCode::OP_MOVE &&
+                InstructionEncoder::decode_a(instr) == InstructionEncoder::decode_b(instr) &&
+                (pc == 0 || !optimization_analysis::skips_next(InstructionEncoder::decode_opcode(code[pc - 1])))) {
+                removed[pc] = true;
+                ++moves;
             }
         }
+
+        const Size stack_before = function.stack_size;
+        code = std::move(allocated);
+        // Keep at least one register so a function that uses none still has a frame
+        function.stack_size = std::max<Size>(1, optimization_analysis::frame_register_count(function));
+        if (moves > 0) {
+            optimization_analysis::remove_instructions(function, removed);
+        }
+
+        const Size saved = stack_before > function.stack_size ? stack_before - function.stack_size : 0;
+        counters_["registers_saved"] += saved;
+        counters_["moves_removed"] += moves;
+        OPTIMIZER_LOG_INFO("Register optimization completed, frame {} -> {} registers, moves removed: {}",
+                           stack_before,
+                           function.stack_size,
+                           moves);
+        return std::monostate{};
     }
 
     // Main Optimizer class implementation
@@ -959,9 +1593,18 @@ namespace rangelua::backend {
     }
 
     Status Optimizer::optimize(BytecodeFunction& function) {
+        Status result = optimize_function(function);
+        if (is_error(result)) {
+            return result;
+        }
+        return lower_function(function);
+    }
+
+    Status Optimizer::optimize_function(BytecodeFunction& function) {
         OPTIMIZER_LOG_INFO("Starting optimization with level {}", static_cast<int>(level_));
 
-        reset_statistics();
+        statistics_["functions"]++;
+        statistics_["instructions_before"] += function.instructions.size();
 
         bool any_changes = false;
         Size iteration = 0;
@@ -974,32 +1617,18 @@ namespace rangelua::backend {
             OPTIMIZER_LOG_DEBUG("Optimization iteration {}", iteration);
 
             for (const auto& pass : passes_) {
-                if (!is_pass_enabled(pass->name())) {
+                if (!is_pass_enabled(pass->name()) || pass->is_final() || pass->is_lowering() ||
+                    (iteration > 1 && !pass->is_iterative())) {
                     continue;
                 }
 
-                OPTIMIZER_LOG_DEBUG("Running pass: {}", pass->name());
-
-                auto start_time = std::chrono::high_resolution_clock::now();
-                Status result = pass->optimize(function);
-                auto end_time = std::chrono::high_resolution_clock::now();
-
-                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-
-                // Update statistics
-                String pass_name{pass->name()};
-                statistics_[pass_name + "_runs"]++;
-                statistics_[pass_name + "_time_us"] += duration.count();
-
-                if (is_success(result)) {
-                    if (pass->is_transformative()) {
-                        iteration_changes = true;
-                        any_changes = true;
-                        statistics_[pass_name + "_changes"]++;
-                    }
-                } else {
-                    OPTIMIZER_LOG_ERROR("Pass {} failed", pass->name());
-                    return get_error(result);
+                auto changed = run_pass(*pass, function);
+                if (is_error(changed)) {
+                    return get_error(changed);
+                }
+                if (get_value(changed)) {
+                    iteration_changes = true;
+                    any_changes = true;
                 }
             }
 
@@ -1009,16 +1638,183 @@ namespace rangelua::backend {
 
         } while (true);
 
-        OPTIMIZER_LOG_INFO("Optimization completed after {} iterations, changes: {}", iteration, any_changes);
+        for (const auto& pass : passes_) {
+            if (!is_pass_enabled(pass->name()) || !pass->is_final()) {
+                continue;
+            }
+
+            auto changed = run_pass(*pass, function);
+            if (is_error(changed)) {
+                return get_error(changed);
+            }
+            any_changes = any_changes || get_value(changed);
+        }
 
+        OPTIMIZER_LOG_INFO("Optimization completed after {} iterations, changes: {}", iteration, any_changes);
         return std::monostate{};
     }
 
-    void Optimizer::add_pass(UniquePtr<OptimizationPass> pass) {
-        String name{pass->name()};
-        passes_.push_back(std::move(pass));
-        pass_enabled_[name] = true;
-    }
+    Status Optimizer::lower_function(BytecodeFunction& function) {
+        for (const auto& pass : passes_) {
+            if (!is_pass_enabled(pass->name()) || !pass->is_lowering()) {
+                continue;
+            }
+
+            auto changed = run_pass(*pass, function);
+            if (is_error(changed)) {
+                return get_error(changed);
+            }
+        }
+
+        statistics_["instructions_after"] += function.instructions.size();
+        return std::monostate{};
+    }
+
+    Result<bool> Optimizer::run_pass(OptimizationPass& pass, BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Running pass: {}", pass.name());
+
+        const auto before = function.instructions;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        Status result = pass.optimize(function);
+        auto end_time = std::chrono::high_resolution_clock::now();
+
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+        // Update statistics
+        String pass_name{pass.name()};
+        statistics_[pass_name + "_runs"]++;
+        statistics_[pass_name + "_time_us"] += static_cast<Size>(duration.count());
+        for (const auto& [counter, value] : pass.take_counters()) {
+            statistics_[pass_name + "_" + counter] += value;
+        }
+
+        if (is_error(result)) {
+            OPTIMIZER_LOG_ERROR("Pass {} failed", pass.name());
+            return get_error(result);
+        }
+        if (function.instructions == before) {
+            return false;
+        }
+
+        statistics_[pass_name + "_changes"]++;
+        if (before.size() > function.instructions.size()) {
+            statistics_[pass_name + "_removed"] += before.size() - function.instructions.size();
+        }
+        return true;
+    }
+
+    namespace {
+
+        /**
+         * @brief Run step on a nested prototype viewed as a bytecode function
+         */
+        Status on_prototype(FunctionPrototype& prototype,
+                            const std::function<Status(BytecodeFunction&)>& step) {
+            BytecodeFunction function;
+            function.name = std::move(prototype.name);
+            function.instructions = std::move(prototype.instructions);
+            function.constants = std::move(prototype.constants);
+            function.locals = std::move(prototype.locals);
+            function.upvalue_descriptors = std::move(prototype.upvalue_descriptors);
+            function.parameter_count = prototype.parameter_count;
+            function.stack_size = prototype.stack_size;
+            function.is_vararg = prototype.is_vararg;
+            function.line_info = std::move(prototype.line_info);
+            function.source_name = std::move(prototype.source_name);
+
+            Status result = step(function);
+
+            prototype.name = std::move(function.name);
+            prototype.instructions = std::move(function.instructions);
+            prototype.constants = std::move(function.constants);
+            prototype.locals = std::move(function.locals);
+            prototype.upvalue_descriptors = std::move(function.upvalue_descriptors);
+            prototype.stack_size = function.stack_size;
+            prototype.line_info = std::move(function.line_info);
+            prototype.source_name = std::move(function.source_name);
+            return result;
+        }
+
+    }  // namespace
+
+    Status Optimizer::process_prototypes(std::vector<FunctionPrototype>& prototypes,
+                                         bool lowering) {
+        // Deferred prototypes are optimized when their body is compiled.
+        if (jobs_ <= 1 || custom_passes_ || prototypes.size() < 2) {
+            for (auto& prototype : prototypes) {
+                if (prototype.deferred) {
+                    continue;
+                }
+                Status result = on_prototype(prototype, [&](BytecodeFunction& function) {
+                    return lowering ? lower_function(function) : optimize_function(function);
+                });
+                if (is_error(result)) {
+                    return result;
+                }
+            }
+            return make_success();
+        }
+
+        // The passes keep no state between functions, so a fresh optimizer per batch of
+        // prototypes produces the same bytecode as this one. A few batches per thread keep
+        // the threads evenly loaded.
+        const Size batches = std::min(prototypes.size(), jobs_ * 8);
+        std::vector<Status> results(batches);
+        std::vector<std::unordered_map<String, Size>> statistics(batches);
+        utils::parallel_for(batches, jobs_, [&](Size batch) {
+            Optimizer worker(level_);
+            worker.pass_enabled_ = pass_enabled_;
+            const Size begin = prototypes.size() * batch / batches;
+            const Size end = prototypes.size() * (batch + 1) / batches;
+            for (Size index = begin; index < end && !is_error(results[batch]); ++index) {
+                if (prototypes[index].deferred) {
+                    continue;
+                }
+                results[batch] = on_prototype(prototypes[index], [&](BytecodeFunction& function) {
+                    return lowering ? worker.lower_function(function)
+                                    : worker.optimize_function(function);
+                });
+            }
+            statistics[batch] = std::move(worker.statistics_);
+        });
+
+        for (Size batch = 0; batch < batches; ++batch) {
+            for (const auto& [key, value] : statistics[batch]) {
+                statistics_[key] += value;
+            }
+            if (is_error(results[batch])) {
+                return results[batch];
+            }
+        }
+        return make_success();
+    }
+
+    Status Optimizer::optimize_chunk(BytecodeFunction& chunk) {
+        // Nested prototypes share the pass pipeline; they carry no prototypes of their own.
+        // They go first, so the bodies inlined into the main function are already optimized.
+        // Lowering waits until inlining is done: its output cannot be copied into a caller.
+        if (Status result = process_prototypes(chunk.prototypes, false); is_error(result)) {
+            return result;
+        }
+        if (Status result = optimize_function(chunk); is_error(result)) {
+            return result;
+        }
+        if (Status result = process_prototypes(chunk.prototypes, true); is_error(result)) {
+            return result;
+        }
+        return lower_function(chunk);
+    }
+
+    void Optimizer::set_jobs(Size jobs) {
+        jobs_ = utils::resolve_jobs(jobs);
+    }
+
+    void Optimizer::add_pass(UniquePtr<OptimizationPass> pass) {
+        String name{pass->name()};
+        passes_.push_back(std::move(pass));
+        pass_enabled_[name] = true;
+        custom_passes_ = true;
+    }
 
     void Optimizer::remove_pass(StringView name) {
         String name_str{name};
@@ -1029,6 +1825,7 @@ namespace rangelua::backend {
                           }),
             passes_.end());
         pass_enabled_.erase(name_str);
+        custom_passes_ = true;
     }
 
     void Optimizer::set_optimization_level(OptimizationLevel level) {
@@ -1063,12 +1860,19 @@ namespace rangelua::backend {
         pass_enabled_.clear();
 
         // Add all optimization passes
+        add_pass(std::make_unique<FunctionInliningPass>());
         add_pass(std::make_unique<ConstantFoldingPass>());
+        add_pass(std::make_unique<SsaOptimizationPass>());
+        add_pass(std::make_unique<ScalarReplacementPass>());
         add_pass(std::make_unique<DeadCodeEliminationPass>());
         add_pass(std::make_unique<PeepholeOptimizationPass>());
         add_pass(std::make_unique<RegisterOptimizationPass>());
         add_pass(std::make_unique<JumpOptimizationPass>());
         add_pass(std::make_unique<TailCallOptimizationPass>());
+        add_pass(std::make_unique<LoopInvariantCodeMotionPass>());
+        add_pass(std::make_unique<NumericTypeInferencePass>());
+        add_pass(std::make_unique<SuperinstructionFusionPass>());
+        custom_passes_ = false;
     }
 
     void Optimizer::configure_passes_for_level(OptimizationLevel level) {
@@ -1081,414 +1885,2251 @@ namespace rangelua::backend {
                 break;
 
             case OptimizationLevel::Basic:
+                set_pass_enabled("function-inlining", false);
                 set_pass_enabled("constant-folding", true);
+                set_pass_enabled("ssa-optimization", false);
+                set_pass_enabled("scalar-replacement", false);
                 set_pass_enabled("dead-code-elimination", false);
                 set_pass_enabled("peephole-optimization", true);
                 set_pass_enabled("register-optimization", false);
                 set_pass_enabled("jump-optimization", true);
                 set_pass_enabled("tail-call-optimization", false);
+                set_pass_enabled("loop-invariant-code-motion", false);
+                set_pass_enabled("numeric-type-inference", false);
+                set_pass_enabled("superinstruction-fusion", false);
                 break;
 
             case OptimizationLevel::Standard:
+                set_pass_enabled("function-inlining", true);
                 set_pass_enabled("constant-folding", true);
+                set_pass_enabled("ssa-optimization", true);
+                set_pass_enabled("scalar-replacement", true);
                 set_pass_enabled("dead-code-elimination", true);
                 set_pass_enabled("peephole-optimization", true);
                 set_pass_enabled("register-optimization", true);
                 set_pass_enabled("jump-optimization", true);
                 set_pass_enabled("tail-call-optimization", true);
+                set_pass_enabled("loop-invariant-code-motion", true);
+                set_pass_enabled("numeric-type-inference", true);
+                set_pass_enabled("superinstruction-fusion", true);
                 break;
 
-            case OptimizationLevel::Aggressive:
-                // Enable all passes for aggressive optimization
-                for (auto& [name, enabled] : pass_enabled_) {
-                    enabled = true;
+            case OptimizationLevel::Aggressive:
+                // Enable all sound passes for aggressive optimization
+                for (auto& [name, enabled] : pass_enabled_) {
+                    enabled = true;
+                }
+                break;
+        }
+    }
+
+    // Control Flow Graph implementation
+    namespace optimization_analysis {
+
+        bool skips_next(OpCode op) noexcept {
+            switch (instruction_utils::generic_opcode(op)) {
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                case OpCode::OP_EQK:
+                case OpCode::OP_EQI:
+                case OpCode::OP_LTI:
+                case OpCode::OP_LEI:
+                case OpCode::OP_GTI:
+                case OpCode::OP_GEI:
+                case OpCode::OP_TEST:
+                case OpCode::OP_TESTSET:
+                case OpCode::OP_LFALSESKIP:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool ends_block(OpCode op) noexcept {
+            switch (op) {
+                case OpCode::OP_JMP:
+                case OpCode::OP_RETURN:
+                case OpCode::OP_RETURN0:
+                case OpCode::OP_RETURN1:
+                case OpCode::OP_TAILCALL:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        Optional<Size> branch_target(const std::vector<Instruction>& code, Size pc) {
+            Instruction instr = code[pc];
+            OpCode op = InstructionEncoder::decode_opcode(instr);
+            auto base = static_cast<std::int64_t>(pc);
+            std::int64_t target = 0;
+
+            switch (op) {
+                case OpCode::OP_JMP:
+                case OpCode::OP_FORLOOP:
+                case OpCode::OP_FORPREP:
+                    target = base + 1 + InstructionEncoder::decode_sbx(instr);
+                    break;
+                case OpCode::OP_TFORPREP:
+                    target = base + 2 + InstructionEncoder::decode_bx(instr);
+                    break;
+                case OpCode::OP_TFORLOOP:
+                    target = base + 1 - static_cast<std::int64_t>(InstructionEncoder::decode_bx(instr));
+                    break;
+                case OpCode::OP_HOISTGET:
+                case OpCode::OP_EQJMP:
+                case OpCode::OP_LTJMP:
+                case OpCode::OP_LEJMP:
+                    target = base + 1 + InstructionEncoder::decode_c(instr);
+                    break;
+                case OpCode::OP_TFORCALL: {
+                    // The VM scans forward for the loop instruction of the same iterator
+                    Register a = InstructionEncoder::decode_a(instr);
+                    for (Size i = pc + 1; i < code.size(); ++i) {
+                        if (InstructionEncoder::decode_opcode(code[i]) == OpCode::OP_TFORLOOP &&
+                            InstructionEncoder::decode_a(code[i]) == a) {
+                            return i;
+                        }
+                    }
+                    return std::nullopt;
+                }
+                default:
+                    return std::nullopt;
+            }
+
+            if (target < 0 || target > static_cast<std::int64_t>(code.size())) {
+                return std::nullopt;
+            }
+            return static_cast<Size>(target);
+        }
+
+        std::vector<bool> find_block_leaders(const std::vector<Instruction>& code) {
+            std::vector<bool> leaders(code.size() + 1, false);
+            leaders[0] = true;
+            leaders[code.size()] = true;
+
+            for (Size pc = 0; pc < code.size(); ++pc) {
+                OpCode op = InstructionEncoder::decode_opcode(code[pc]);
+                auto target = branch_target(code, pc);
+                if (target) {
+                    leaders[*target] = true;
+                }
+                if (target || ends_block(op)) {
+                    leaders[pc + 1] = true;
+                }
+                if (skips_next(op)) {
+                    leaders[pc + 1] = true;
+                    leaders[std::min(pc + 2, code.size())] = true;
+                }
+            }
+            return leaders;
+        }
+
+        namespace {
+
+            /**
+             * @brief Re-encode a branch at pc so that it transfers to target
+             */
+            Instruction retarget(Instruction instr, Size pc, Size target) {
+                OpCode op = InstructionEncoder::decode_opcode(instr);
+                Register a = InstructionEncoder::decode_a(instr);
+                auto from = static_cast<std::int64_t>(pc);
+                auto to = static_cast<std::int64_t>(target);
+
+                switch (op) {
+                    case OpCode::OP_TFORPREP:
+                        return InstructionEncoder::encode_abx(
+                            op, a, static_cast<std::uint32_t>(to - from - 2));
+                    case OpCode::OP_TFORLOOP:
+                        return InstructionEncoder::encode_abx(
+                            op, a, static_cast<std::uint32_t>(from + 1 - to));
+                    case OpCode::OP_HOISTGET:
+                    case OpCode::OP_EQJMP:
+                    case OpCode::OP_LTJMP:
+                    case OpCode::OP_LEJMP:
+                        return InstructionEncoder::encode_abc(
+                            op, a, InstructionEncoder::decode_b(instr),
+                            static_cast<Register>(to - from - 1));
+                    default:
+                        return InstructionEncoder::encode_asbx(
+                            op, a, static_cast<std::int32_t>(to - from - 1));
+                }
+            }
+
+        }  // namespace
+
+        Size remove_instructions(BytecodeFunction& function, const std::vector<bool>& removed) {
+            auto& code = function.instructions;
+            const Size old_size = code.size();
+
+            // new_index[i]: position of the first surviving instruction at or after i
+            std::vector<Size> new_index(old_size + 1, 0);
+            Size kept = 0;
+            for (Size i = 0; i < old_size; ++i) {
+                new_index[i] = kept;
+                if (!removed[i]) {
+                    ++kept;
+                }
+            }
+            new_index[old_size] = kept;
+            if (kept == old_size) {
+                return 0;
+            }
+
+            // Resolve targets against the old layout before anything moves
+            std::vector<Optional<Size>> targets(old_size);
+            for (Size i = 0; i < old_size; ++i) {
+                if (!removed[i] && InstructionEncoder::decode_opcode(code[i]) != OpCode::OP_TFORCALL) {
+                    targets[i] = branch_target(code, i);
+                }
+            }
+
+            const bool has_lines = function.line_info.size() == old_size;
+            Size out = 0;
+            for (Size i = 0; i < old_size; ++i) {
+                if (removed[i]) {
+                    continue;
+                }
+
+                Instruction instr = code[i];
+                if (targets[i]) {
+                    instr = retarget(instr, out, new_index[*targets[i]]);
+                }
+
+                code[out] = instr;
+                if (has_lines) {
+                    function.line_info[out] = function.line_info[i];
+                }
+                ++out;
+            }
+
+            code.resize(out);
+            if (has_lines) {
+                function.line_info.resize(out);
+            }
+            return old_size - out;
+        }
+
+        Size insert_instructions(BytecodeFunction& function,
+                                 const std::vector<Insertion>& insertions,
+                                 const std::function<Size(Size source, Size pc)>& landing) {
+            auto& code = function.instructions;
+            const Size old_size = code.size();
+
+            // before[i]: new position of the code inserted ahead of i; at[i]: of i itself
+            std::vector<Size> before(old_size + 1, 0);
+            std::vector<Size> at(old_size + 1, 0);
+            std::vector<const Insertion*> inserted(old_size + 1, nullptr);
+            Size added = 0;
+            for (const auto& insertion : insertions) {
+                inserted[insertion.pc] = &insertion;
+            }
+            for (Size i = 0; i <= old_size; ++i) {
+                before[i] = i + added;
+                if (inserted[i] != nullptr) {
+                    added += inserted[i]->code.size();
+                }
+                at[i] = i + added;
+            }
+            if (added == 0) {
+                return 0;
+            }
+
+            const bool has_lines = function.line_info.size() == old_size;
+            std::vector<Instruction> result;
+            std::vector<Size> lines;
+            result.reserve(old_size + added);
+            for (Size i = 0; i <= old_size; ++i) {
+                if (inserted[i] != nullptr) {
+                    Size line = 0;
+                    if (has_lines && old_size > 0) {
+                        line = function.line_info[std::min(i, old_size - 1)];
+                    }
+                    for (Instruction instr : inserted[i]->code) {
+                        result.push_back(instr);
+                        lines.push_back(line);
+                    }
+                }
+                if (i == old_size) {
+                    break;
+                }
+
+                Instruction instr = code[i];
+                if (InstructionEncoder::decode_opcode(instr) != OpCode::OP_TFORCALL) {
+                    if (auto target = branch_target(code, i)) {
+                        Size position = at[*target];
+                        if (inserted[*target] != nullptr) {
+                            position = before[*target] + std::min(landing(i, *target),
+                                                                  inserted[*target]->code.size());
+                        }
+                        instr = retarget(instr, at[i], position);
+                    }
+                }
+                result.push_back(instr);
+                lines.push_back(has_lines ? function.line_info[i] : 0);
+            }
+
+            code = std::move(result);
+            if (has_lines) {
+                function.line_info = std::move(lines);
+            }
+            return added;
+        }
+
+        Optional<RegisterEffects> register_effects(Instruction instr) noexcept {
+            OpCode op = instruction_utils::generic_opcode(InstructionEncoder::decode_opcode(instr));
+            Register a = InstructionEncoder::decode_a(instr);
+            Register b = InstructionEncoder::decode_b(instr);
+            Register c = InstructionEncoder::decode_c(instr);
+            constexpr Size TO_TOP = RegisterRange::TO_TOP;
+            RegisterEffects effects;
+
+            switch (op) {
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                case OpCode::OP_LOADK:
+                case OpCode::OP_LOADKX:
+                case OpCode::OP_LOADFALSE:
+                case OpCode::OP_LFALSESKIP:
+                case OpCode::OP_LOADTRUE:
+                case OpCode::OP_GETUPVAL:
+                case OpCode::OP_GETTABUP:
+                case OpCode::OP_NEWTABLE:
+                case OpCode::OP_CLOSURE:
+                    effects.write(a);
+                    break;
+
+                case OpCode::OP_LOADNIL:
+                    effects.write(a, static_cast<Size>(b) + 1);
+                    break;
+
+                case OpCode::OP_MOVE:
+                case OpCode::OP_GETI:
+                case OpCode::OP_GETFIELD:
+                case OpCode::OP_ADDI:
+                case OpCode::OP_ADDK:
+                case OpCode::OP_SUBK:
+                case OpCode::OP_MULK:
+                case OpCode::OP_MODK:
+                case OpCode::OP_POWK:
+                case OpCode::OP_DIVK:
+                case OpCode::OP_IDIVK:
+                case OpCode::OP_BANDK:
+                case OpCode::OP_BORK:
+                case OpCode::OP_BXORK:
+                case OpCode::OP_SHRI:
+                case OpCode::OP_SHLI:
+                case OpCode::OP_UNM:
+                case OpCode::OP_BNOT:
+                case OpCode::OP_NOT:
+                case OpCode::OP_LEN:
+                    effects.read(b);
+                    effects.write(a);
+                    break;
+
+                case OpCode::OP_GETTABLE:
+                case OpCode::OP_ADD:
+                case OpCode::OP_SUB:
+                case OpCode::OP_MUL:
+                case OpCode::OP_MOD:
+                case OpCode::OP_POW:
+                case OpCode::OP_DIV:
+                case OpCode::OP_IDIV:
+                case OpCode::OP_BAND:
+                case OpCode::OP_BOR:
+                case OpCode::OP_BXOR:
+                case OpCode::OP_SHL:
+                case OpCode::OP_SHR:
+                    effects.read(b);
+                    effects.read(c);
+                    effects.write(a);
+                    break;
+
+                case OpCode::OP_SELF:
+                    effects.read(b);
+                    effects.write(a, 2);
+                    break;
+
+                case OpCode::OP_SETUPVAL:
+                case OpCode::OP_TBC:
+                case OpCode::OP_EQK:
+                case OpCode::OP_EQI:
+                case OpCode::OP_LTI:
+                case OpCode::OP_LEI:
+                case OpCode::OP_GTI:
+                case OpCode::OP_GEI:
+                case OpCode::OP_TEST:
+                case OpCode::OP_RETURN1:
+                case OpCode::OP_TFORPREP:
+                    effects.read(a);
+                    break;
+
+                case OpCode::OP_SETTABUP:
+                    effects.read(c);
+                    break;
+
+                case OpCode::OP_SETTABLE:
+                    effects.read(a);
+                    effects.read(b);
+                    effects.read(c);
+                    break;
+
+                case OpCode::OP_SETI:
+                case OpCode::OP_SETFIELD:
+                    effects.read(a);
+                    effects.read(c);
+                    break;
+
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                    effects.read(a);
+                    effects.read(b);
+                    break;
+
+                case OpCode::OP_TESTSET:
+                    effects.read(b);
+                    effects.read(a);  // Only written when the test passes
+                    effects.write(a);
+                    break;
+
+                case OpCode::OP_CONCAT:
+                    effects.read(a, b);
+                    effects.write(a);
+                    break;
+
+                case OpCode::OP_CALL:
+                    effects.read(a, b == 0 ? TO_TOP : b);
+                    if (c != 1) {
+                        effects.write(a, c == 0 ? TO_TOP : static_cast<Size>(c) - 1);
+                    }
+                    break;
+
+                case OpCode::OP_TAILCALL:
+                    effects.read(a, b == 0 ? TO_TOP : b);
+                    break;
+
+                case OpCode::OP_RETURN:
+                    if (b != 1) {
+                        effects.read(a, b == 0 ? TO_TOP : static_cast<Size>(b) - 1);
+                    }
+                    break;
+
+                case OpCode::OP_FORLOOP:
+                    effects.read(a, 4);  // The loop variable is only written when looping
+                    effects.write(a);
+                    effects.write(static_cast<Register>(a + 3));
+                    break;
+
+                case OpCode::OP_FORPREP:
+                    effects.read(a, 4);  // The loop variable is not written when skipping
+                    effects.write(static_cast<Register>(a + 3));
+                    break;
+
+                case OpCode::OP_TFORCALL:
+                    effects.read(a, 3);  // The control variable is only updated on a non-nil result
+                    effects.write(static_cast<Register>(a + 4), c);
+                    effects.write(static_cast<Register>(a + 2));
+                    break;
+
+                case OpCode::OP_TFORLOOP:
+                    effects.read(static_cast<Register>(a + 4));
+                    effects.read(static_cast<Register>(a + 2));
+                    effects.write(static_cast<Register>(a + 2));
+                    break;
+
+                case OpCode::OP_SETLIST:
+                    effects.read(a, b == 0 ? TO_TOP : static_cast<Size>(b) + 1);
+                    break;
+
+                case OpCode::OP_VARARG:
+                    if (c != 1) {
+                        effects.write(a, c == 0 ? TO_TOP : static_cast<Size>(c) - 1);
+                    }
+                    break;
+
+                case OpCode::OP_HOISTGET:
+                    effects.read(a);  // Only written when the cached value is current
+                    effects.write(a);
+                    break;
+
+                case OpCode::OP_HOISTSET:
+                    effects.read(a);
+                    break;
+
+                case OpCode::OP_CLOSE:
+                case OpCode::OP_JMP:
+                case OpCode::OP_RETURN0:
+                case OpCode::OP_VARARGPREP:
+                case OpCode::OP_EXTRAARG:
+                case OpCode::OP_HOISTCLEAR:
+                    break;
+
+                default:
+                    return std::nullopt;
+            }
+
+            return effects;
+        }
+
+        Size frame_register_count(const BytecodeFunction& function) {
+            constexpr Size limit = static_cast<Size>(config::MAX_REGISTERS) + 1;
+            Size count = std::min(function.stack_size, limit);
+
+            for (Instruction instr : function.instructions) {
+                auto effects = register_effects(instr);
+                if (!effects) {
+                    // Unknown instructions may name any register
+                    return limit;
+                }
+                for (Size i = 0; i < effects->read_count; ++i) {
+                    count = std::max(count, effects->reads[i].end(limit));
+                    count = std::max<Size>(count, effects->reads[i].first + 1);
+                }
+                for (Size i = 0; i < effects->write_count; ++i) {
+                    count = std::max(count, effects->writes[i].end(limit));
+                    count = std::max<Size>(count, effects->writes[i].first + 1);
+                }
+            }
+            return std::min(count, limit);
+        }
+
+        Optional<std::unordered_set<Register>> captured_registers(const BytecodeFunction& function) {
+            std::unordered_set<Register> captured;
+            for (Instruction instr : function.instructions) {
+                if (InstructionEncoder::decode_opcode(instr) != OpCode::OP_CLOSURE) {
+                    continue;
+                }
+                Size index = InstructionEncoder::decode_bx(instr);
+                if (index >= function.prototypes.size()) {
+                    return std::nullopt;
+                }
+                for (const auto& upvalue : function.prototypes[index].upvalue_descriptors) {
+                    if (upvalue.in_stack) {
+                        captured.insert(static_cast<Register>(upvalue.index));
+                    }
+                }
+            }
+            return captured;
+        }
+
+        Optional<Instruction>
+        load_constant(std::vector<ConstantValue>& constants, Register target, const ConstantValue& value) {
+            if (std::holds_alternative<std::monostate>(value)) {
+                return InstructionEncoder::encode_abc(OpCode::OP_LOADNIL, target, 0, 0);
+            }
+            if (const auto* flag = std::get_if<bool>(&value)) {
+                return InstructionEncoder::encode_abc(
+                    *flag ? OpCode::OP_LOADTRUE : OpCode::OP_LOADFALSE, target, 0, 0);
+            }
+
+            ConstantValue constant = value;
+            if (const auto* integer = std::get_if<Int>(&value)) {
+                constant = static_cast<Number>(*integer);
+            }
+            if (const auto* number = std::get_if<Number>(&constant)) {
+                // -0.0 and non-finite values print differently from any LOADI operand
+                if (!std::isfinite(*number) || (*number == 0.0 && std::signbit(*number))) {
+                    return std::nullopt;
+                }
+                if (*number == std::floor(*number) && *number >= -32768.0 && *number <= 32767.0) {
+                    return InstructionEncoder::encode_asbx(
+                        OpCode::OP_LOADI, target, static_cast<std::int32_t>(*number));
+                }
+            }
+
+            for (Size i = 0; i < constants.size(); ++i) {
+                if (constants[i] == constant) {
+                    return InstructionEncoder::encode_abx(
+                        OpCode::OP_LOADK, target, static_cast<std::uint32_t>(i));
+                }
+            }
+            if (constants.size() > InstructionEncoder::MAX_BX) {
+                return std::nullopt;
+            }
+            constants.push_back(std::move(constant));
+            return InstructionEncoder::encode_abx(
+                OpCode::OP_LOADK, target, static_cast<std::uint32_t>(constants.size() - 1));
+        }
+
+        namespace {
+
+            /**
+             * @brief Writes that happen only on one outcome of the instruction's test
+             */
+            bool writes_conditionally(OpCode op) noexcept {
+                return op == OpCode::OP_TESTSET || op == OpCode::OP_FORLOOP ||
+                       op == OpCode::OP_TFORLOOP || op == OpCode::OP_HOISTGET;
+            }
+
+            /**
+             * @brief Registers an instruction reads and writes, clamped to the frame
+             * @return false for instructions without a register model
+             */
+            bool instruction_registers(Instruction instr,
+                                       Size frame_size,
+                                       RegisterSet& reads,
+                                       RegisterSet& writes) {
+                auto effects = register_effects(instr);
+                if (!effects) {
+                    return false;
+                }
+                const Size limit = std::min(frame_size, reads.capacity());
+                for (Size i = 0; i < effects->read_count; ++i) {
+                    const auto& range = effects->reads[i];
+                    reads.insert_range(range.first, std::min(range.end(frame_size), limit));
+                }
+                for (Size i = 0; i < effects->write_count; ++i) {
+                    const auto& range = effects->writes[i];
+                    writes.insert_range(range.first, std::min(range.end(frame_size), limit));
+                }
+                return true;
+            }
+
+        }  // namespace
+
+        ControlFlowGraph::ControlFlowGraph(const BytecodeFunction& function) {
+            build_cfg(function);
+            compute_def_use_sets(function);
+        }
+
+        void ControlFlowGraph::compute_liveness() {
+            // Backward: live_in = use | (live_out - def), live_out = union of successors' live_in
+            const Size count = nodes_.size();
+            std::vector<RegisterSet> entry(count);
+            std::vector<RegisterSet> exit(count);
+            solve_data_flow(
+                *this,
+                DataFlowDirection::Backward,
+                entry,
+                exit,
+                [](RegisterSet& into, const RegisterSet& from) { into.unite(from); },
+                [this](Size block, const RegisterSet& live_out) {
+                    RegisterSet live = live_out;
+                    live.subtract(nodes_[block].def);
+                    live.unite(nodes_[block].use);
+                    return live;
+                });
+
+            for (Size block = 0; block < count; ++block) {
+                nodes_[block].live_in = entry[block];
+                nodes_[block].live_out = exit[block];
+            }
+        }
+
+        void ControlFlowGraph::compute_dominators() {
+            const Size count = nodes_.size();
+            dominators_.assign(count, SIZE_MAX);
+            dominator_tree_.assign(count, {});
+            tree_entry_.assign(count, 0);
+            tree_exit_.assign(count, 0);
+            if (count == 0) {
+                return;
+            }
+
+            // Cooper, Harvey and Kennedy: iterate in reverse postorder, intersecting
+            // the processed predecessors along the partially built tree
+            dominators_[0] = 0;
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (Size block : reverse_postorder_) {
+                    if (block == 0) {
+                        continue;
+                    }
+                    Size idom = SIZE_MAX;
+                    for (Size pred : nodes_[block].predecessors) {
+                        if (dominators_[pred] == SIZE_MAX) {
+                            continue;
+                        }
+                        idom = idom == SIZE_MAX ? pred : intersect_dominators(pred, idom);
+                    }
+                    if (dominators_[block] != idom) {
+                        dominators_[block] = idom;
+                        changed = true;
+                    }
+                }
+            }
+
+            for (Size block : reverse_postorder_) {
+                if (block != 0) {
+                    dominator_tree_[dominators_[block]].push_back(block);
+                }
+            }
+
+            // Number the tree depth-first so dominates() is two comparisons
+            Size clock = 0;
+            std::vector<std::pair<Size, Size>> stack{{0, 0}};
+            tree_entry_[0] = clock++;
+            while (!stack.empty()) {
+                auto& [block, next] = stack.back();
+                if (next < dominator_tree_[block].size()) {
+                    Size child = dominator_tree_[block][next++];
+                    tree_entry_[child] = clock++;
+                    stack.emplace_back(child, 0);
+                } else {
+                    tree_exit_[block] = clock++;
+                    stack.pop_back();
+                }
+            }
+        }
+
+        bool ControlFlowGraph::dominates(Size a, Size b) const noexcept {
+            if (tree_exit_.empty() || !is_reachable(a) || !is_reachable(b)) {
+                return false;
+            }
+            return tree_entry_[a] <= tree_entry_[b] && tree_exit_[b] <= tree_exit_[a];
+        }
+
+        void ControlFlowGraph::build_cfg(const BytecodeFunction& function) {
+            const auto& code = function.instructions;
+            nodes_.clear();
+            block_of_.assign(code.size(), 0);
+            reverse_postorder_.clear();
+            rpo_index_.clear();
+            if (code.empty()) {
+                return;
+            }
+
+            // Basic blocks
+            auto leaders = find_block_leaders(code);
+            for (Size pc = 0; pc < code.size(); ++pc) {
+                if (leaders[pc]) {
+                    CFGNode node{};
+                    node.start_instruction = pc;
+                    nodes_.push_back(std::move(node));
+                }
+                nodes_.back().end_instruction = pc;
+                block_of_[pc] = nodes_.size() - 1;
+            }
+
+            // Edges: fall-through, skip and branch
+            auto add_edge = [&](Size from, Size to_pc) {
+                if (to_pc >= code.size()) {
+                    return;
+                }
+                Size to = block_of_[to_pc];
+                auto& successors = nodes_[from].successors;
+                if (std::find(successors.begin(), successors.end(), to) == successors.end()) {
+                    successors.push_back(to);
+                    nodes_[to].predecessors.push_back(from);
+                }
+            };
+            for (Size block = 0; block < nodes_.size(); ++block) {
+                Size pc = nodes_[block].end_instruction;
+                OpCode op = InstructionEncoder::decode_opcode(code[pc]);
+                if (!ends_block(op)) {
+                    add_edge(block, pc + 1);
+                }
+                if (skips_next(op)) {
+                    add_edge(block, pc + 2);
+                }
+                if (auto target = branch_target(code, pc)) {
+                    add_edge(block, *target);
+                }
+            }
+
+            // Reverse postorder of the blocks reachable from the entry
+            std::vector<Size> postorder;
+            std::vector<bool> visited(nodes_.size(), false);
+            std::vector<std::pair<Size, Size>> stack{{0, 0}};
+            visited[0] = true;
+            while (!stack.empty()) {
+                auto& [block, next] = stack.back();
+                if (next < nodes_[block].successors.size()) {
+                    Size successor = nodes_[block].successors[next++];
+                    if (!visited[successor]) {
+                        visited[successor] = true;
+                        stack.emplace_back(successor, 0);
+                    }
+                } else {
+                    postorder.push_back(block);
+                    stack.pop_back();
+                }
+            }
+            reverse_postorder_.assign(postorder.rbegin(), postorder.rend());
+            rpo_index_.assign(nodes_.size(), UNREACHABLE);
+            for (Size i = 0; i < reverse_postorder_.size(); ++i) {
+                rpo_index_[reverse_postorder_[i]] = i;
+            }
+        }
+
+        void ControlFlowGraph::compute_def_use_sets(const BytecodeFunction& function) {
+            const auto& code = function.instructions;
+            frame_size_ = frame_register_count(function);
+
+            // Open upvalues can be read by any call, so they are live throughout
+            captured_.clear();
+            if (auto captured = captured_registers(function)) {
+                for (Register reg : *captured) {
+                    captured_.insert(reg);
+                }
+            } else {
+                captured_.insert_range(0, std::min(frame_size_, captured_.capacity()));
+            }
+
+            for (auto& node : nodes_) {
+                for (Size pc = node.start_instruction; pc <= node.end_instruction; ++pc) {
+                    RegisterSet reads;
+                    RegisterSet writes;
+                    if (!instruction_registers(code[pc], frame_size_, reads, writes)) {
+                        // Unknown instructions may read any register
+                        reads.insert_range(0, std::min(frame_size_, reads.capacity()));
+                    }
+                    reads.subtract(node.def);
+                    node.use.unite(reads);
+                    if (!writes_conditionally(InstructionEncoder::decode_opcode(code[pc]))) {
+                        node.def.unite(writes);
+                    }
+                }
+                node.use.unite(captured_);
+            }
+        }
+
+        Size ControlFlowGraph::intersect_dominators(Size b1, Size b2) {
+            while (b1 != b2) {
+                while (rpo_index_[b1] > rpo_index_[b2]) {
+                    b1 = dominators_[b1];
+                }
+                while (rpo_index_[b2] > rpo_index_[b1]) {
+                    b2 = dominators_[b2];
+                }
+            }
+            return b1;
+        }
+
+        // DataFlowAnalysis implementation
+        ReachingDefinitions
+        DataFlowAnalysis::compute_reaching_definitions(const ControlFlowGraph& cfg,
+                                                       const BytecodeFunction& function) {
+            const auto& code = function.instructions;
+            const Size count = cfg.node_count();
+            ReachingDefinitions result;
+
+            // One definition per register written by each instruction
+            for (Size pc = 0; pc < code.size(); ++pc) {
+                RegisterSet reads;
+                RegisterSet writes;
+                if (instruction_registers(code[pc], cfg.frame_size(), reads, writes)) {
+                    writes.for_each([&](Size reg) {
+                        result.definitions.push_back({pc, static_cast<Register>(reg)});
+                    });
+                }
+            }
+            const Size total = result.definitions.size();
+            std::vector<BitVector> definitions_of(RegisterSet{}.capacity(), BitVector(total));
+            for (Size id = 0; id < total; ++id) {
+                definitions_of[result.definitions[id].reg].insert(id);
+            }
+
+            // Per block: registers always overwritten, and definitions surviving to the end
+            std::vector<RegisterSet> kill(count);
+            std::vector<std::vector<Size>> gen(count);
+            Size id = 0;
+            for (Size block = 0; block < count; ++block) {
+                const auto& node = cfg.nodes()[block];
+                while (id < total && result.definitions[id].pc < node.start_instruction) {
+                    ++id;
+                }
+                for (; id < total && result.definitions[id].pc <= node.end_instruction; ++id) {
+                    const auto& definition = result.definitions[id];
+                    if (!writes_conditionally(InstructionEncoder::decode_opcode(code[definition.pc]))) {
+                        kill[block].insert(definition.reg);
+                        std::erase_if(gen[block], [&](Size earlier) {
+                            return result.definitions[earlier].reg == definition.reg;
+                        });
+                    }
+                    gen[block].push_back(id);
+                }
+            }
+
+            result.block_in.assign(count, BitVector(total));
+            result.block_out.assign(count, BitVector(total));
+            solve_data_flow(
+                cfg,
+                DataFlowDirection::Forward,
+                result.block_in,
+                result.block_out,
+                [](BitVector& into, const BitVector& from) { into.unite(from); },
+                [&](Size block, const BitVector& in) {
+                    BitVector out = in;
+                    kill[block].for_each([&](Size reg) { out.subtract(definitions_of[reg]); });
+                    for (Size definition : gen[block]) {
+                        out.insert(definition);
+                    }
+                    return out;
+                });
+            return result;
+        }
+
+        RegisterSet DataFlowAnalysis::compute_live_variables(const ControlFlowGraph& cfg,
+                                                             const BytecodeFunction& function,
+                                                             Size instruction) {
+            const auto& code = function.instructions;
+            const auto& node = cfg.nodes()[cfg.block_of(instruction)];
+            const Size frame = std::min(cfg.frame_size(), RegisterSet{}.capacity());
+
+            RegisterSet live = node.live_out;
+            for (Size pc = node.end_instruction + 1; pc-- > instruction;) {
+                RegisterSet reads;
+                RegisterSet writes;
+                if (!instruction_registers(code[pc], cfg.frame_size(), reads, writes)) {
+                    live.insert_range(0, frame);
+                    continue;
+                }
+                if (!writes_conditionally(InstructionEncoder::decode_opcode(code[pc]))) {
+                    live.subtract(writes);
+                }
+                live.unite(reads);
+            }
+            live.unite(cfg.captured());
+            return live;
+        }
+
+        std::vector<Size> DataFlowAnalysis::compute_use_def_chain(const ControlFlowGraph& cfg,
+                                                                  const ReachingDefinitions& reaching,
+                                                                  const BytecodeFunction& function,
+                                                                  Size instruction) {
+            const auto& code = function.instructions;
+            const auto& definitions = reaching.definitions;
+            const Size block = cfg.block_of(instruction);
+
+            // Definitions reaching the block, then the block's own instructions before this one
+            BitVector current = reaching.block_in[block];
+            auto id = static_cast<Size>(
+                std::lower_bound(definitions.begin(),
+                                 definitions.end(),
+                                 cfg.nodes()[block].start_instruction,
+                                 [](const auto& definition, Size pc) { return definition.pc < pc; }) -
+                definitions.begin());
+            for (; id < definitions.size() && definitions[id].pc < instruction; ++id) {
+                const auto& definition = definitions[id];
+                if (!writes_conditionally(InstructionEncoder::decode_opcode(code[definition.pc]))) {
+                    std::vector<Size> overwritten;
+                    current.for_each([&](Size earlier) {
+                        if (definitions[earlier].reg == definition.reg) {
+                            overwritten.push_back(earlier);
+                        }
+                    });
+                    for (Size earlier : overwritten) {
+                        current.erase(earlier);
+                    }
+                }
+                current.insert(id);
+            }
+
+            RegisterSet reads;
+            RegisterSet writes;
+            if (!instruction_registers(code[instruction], cfg.frame_size(), reads, writes)) {
+                reads.fill();
+            }
+            std::vector<Size> chain;
+            current.for_each([&](Size definition) {
+                if (reads.contains(definitions[definition].reg)) {
+                    chain.push_back(definition);
+                }
+            });
+            return chain;
+        }
+
+    }  // namespace optimization_analysis
+
+    // LoopInvariantCodeMotionPass Implementation
+    namespace {
+
+        using optimization_analysis::BitVector;
+        using optimization_analysis::CFGNode;
+        using optimization_analysis::ControlFlowGraph;
+        using optimization_analysis::RegisterSet;
+
+        // Longest run of instructions one HOISTGET skips
+        constexpr Size MAX_RUN_LENGTH = 16;
+
+        // Slot numbers and HOISTCLEAR ranges are 8-bit operands
+        constexpr Size MAX_SLOTS = InstructionEncoder::MAX_B;
+
+        struct NaturalLoop {
+            Size header = 0;  // Header block
+            BitVector blocks;  // Loop body, header included
+            Size block_count = 0;
+            RegisterSet written;  // Registers any instruction in the loop may write
+            bool usable = true;   // A preheader can be inserted ahead of the header
+            Size first_slot = 0;
+            Size slot_count = 0;
+        };
+
+        struct CachedRun {
+            Size first = 0;  // First and last instruction
+            Size last = 0;
+            Register output = 0;  // The only register written by the run that is read later
+            Size loop = 0;
+            Size slot = 0;
+        };
+
+        bool is_hoist_opcode(OpCode op) noexcept {
+            return op == OpCode::OP_HOISTCLEAR || op == OpCode::OP_HOISTGET ||
+                   op == OpCode::OP_HOISTSET;
+        }
+
+        /**
+         * @brief Constant-keyed loads from tables (globals and fields)
+         */
+        bool is_table_load(Instruction instr, const std::vector<ConstantValue>& constants) {
+            OpCode op = InstructionEncoder::decode_opcode(instr);
+            if (op != OpCode::OP_GETTABUP && op != OpCode::OP_GETFIELD) {
+                return false;
+            }
+            Size key = InstructionEncoder::decode_c(instr);
+            return key < constants.size() && std::holds_alternative<String>(constants[key]);
+        }
+
+        /**
+         * @brief Instructions whose result depends only on their operands and the mutation epoch
+         *
+         * Metamethods they trigger bump the epoch themselves. Integer-keyed reads
+         * (GETTABLE, GETI), LEN and CONCAT are left out: array-part writes do not
+         * bump the epoch.
+         */
+        bool is_cacheable(Instruction instr, const std::vector<ConstantValue>& constants) {
+            switch (InstructionEncoder::decode_opcode(instr)) {
+                case OpCode::OP_MOVE:
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                case OpCode::OP_LOADK:
+                case OpCode::OP_LOADFALSE:
+                case OpCode::OP_LOADTRUE:
+                case OpCode::OP_GETUPVAL:
+                case OpCode::OP_ADD:
+                case OpCode::OP_SUB:
+                case OpCode::OP_MUL:
+                case OpCode::OP_MOD:
+                case OpCode::OP_POW:
+                case OpCode::OP_DIV:
+                case OpCode::OP_IDIV:
+                case OpCode::OP_BAND:
+                case OpCode::OP_BOR:
+                case OpCode::OP_BXOR:
+                case OpCode::OP_SHL:
+                case OpCode::OP_SHR:
+                case OpCode::OP_ADDI:
+                case OpCode::OP_ADDK:
+                case OpCode::OP_SUBK:
+                case OpCode::OP_MULK:
+                case OpCode::OP_MODK:
+                case OpCode::OP_POWK:
+                case OpCode::OP_DIVK:
+                case OpCode::OP_IDIVK:
+                case OpCode::OP_BANDK:
+                case OpCode::OP_BORK:
+                case OpCode::OP_BXORK:
+                case OpCode::OP_SHRI:
+                case OpCode::OP_SHLI:
+                case OpCode::OP_UNM:
+                case OpCode::OP_BNOT:
+                case OpCode::OP_NOT:
+                    return true;
+                case OpCode::OP_GETTABUP:
+                case OpCode::OP_GETFIELD:
+                    return is_table_load(instr, constants);
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * @brief Natural loops of the reachable blocks, outermost first
+         *
+         * Loops sharing a header are merged, so any two loops are either nested
+         * or disjoint.
+         */
+        std::vector<NaturalLoop> find_natural_loops(const ControlFlowGraph& cfg) {
+            const Size count = cfg.node_count();
+            std::vector<NaturalLoop> loops;
+            std::vector<Size> loop_of(count, SIZE_MAX);  // By header block
+            std::vector<Size> worklist;
+
+            for (Size block : cfg.reverse_postorder()) {
+                for (Size header : cfg.nodes()[block].successors) {
+                    if (!cfg.dominates(header, block)) {
+                        continue;
+                    }
+                    if (loop_of[header] == SIZE_MAX) {
+                        loop_of[header] = loops.size();
+                        NaturalLoop loop;
+                        loop.header = header;
+                        loop.blocks = BitVector(count);
+                        loop.blocks.insert(header);
+                        loops.push_back(std::move(loop));
+                    }
+
+                    // Everything that reaches the back edge without passing the header
+                    auto& body = loops[loop_of[header]].blocks;
+                    if (!body.contains(block)) {
+                        body.insert(block);
+                        worklist.push_back(block);
+                    }
+                    while (!worklist.empty()) {
+                        Size current = worklist.back();
+                        worklist.pop_back();
+                        for (Size predecessor : cfg.nodes()[current].predecessors) {
+                            if (cfg.is_reachable(predecessor) && !body.contains(predecessor)) {
+                                body.insert(predecessor);
+                                worklist.push_back(predecessor);
+                            }
+                        }
+                    }
+                }
+            }
+
+            for (auto& loop : loops) {
+                loop.block_count = loop.blocks.count();
+            }
+            std::ranges::stable_sort(loops, std::greater{}, &NaturalLoop::block_count);
+            return loops;
+        }
+
+        /**
+         * @brief Registers live before each instruction of a block, plus its live-out set
+         */
+        std::vector<RegisterSet> block_liveness(const ControlFlowGraph& cfg,
+                                                const BytecodeFunction& function,
+                                                const CFGNode& node) {
+            const Size frame = std::min(cfg.frame_size(), RegisterSet{}.capacity());
+            const Size length = node.end_instruction - node.start_instruction + 1;
+
+            std::vector<RegisterSet> live(length + 1);
+            live[length] = node.live_out;
+            live[length].unite(cfg.captured());
+            for (Size i = length; i-- > 0;) {
+                Instruction instr = function.instructions[node.start_instruction + i];
+                RegisterSet current = live[i + 1];
+                RegisterSet reads;
+                RegisterSet writes;
+                if (!optimization_analysis::instruction_registers(instr, cfg.frame_size(), reads, writes)) {
+                    current.insert_range(0, frame);
+                } else {
+                    if (!optimization_analysis::writes_conditionally(
+                            InstructionEncoder::decode_opcode(instr))) {
+                        current.subtract(writes);
+                    }
+                    current.unite(reads);
+                }
+                current.unite(cfg.captured());
+                live[i] = current;
+            }
+            return live;
+        }
+
+        /**
+         * @brief Longest cacheable run starting at first that is invariant in the loop
+         *
+         * Every operand must be written before the loop or earlier in the run, the
+         * run must contain a table load, and exactly one register it writes may be
+         * read afterwards: when HOISTGET skips the run, only that register is set.
+         */
+        Optional<CachedRun> find_cached_run(const BytecodeFunction& function,
+                                            const ControlFlowGraph& cfg,
+                                            const CFGNode& node,
+                                            const std::vector<RegisterSet>& live,
+                                            const NaturalLoop& loop,
+                                            Size first) {
+            const auto& code = function.instructions;
+            const Size last = std::min(node.end_instruction, first + MAX_RUN_LENGTH - 1);
+
+            RegisterSet defined;
+            bool loads = false;
+            Optional<CachedRun> best;
+            for (Size pc = first; pc <= last; ++pc) {
+                if (!is_cacheable(code[pc], function.constants)) {
+                    break;
+                }
+                RegisterSet reads;
+                RegisterSet writes;
+                optimization_analysis::instruction_registers(code[pc], cfg.frame_size(), reads, writes);
+                reads.subtract(defined);
+                reads.intersect(loop.written);
+                if (!reads.empty()) {
+                    break;
+                }
+                defined.unite(writes);
+                loads = loads || is_table_load(code[pc], function.constants);
+
+                RegisterSet results = live[pc + 1 - node.start_instruction];
+                results.intersect(defined);
+                if (loads && results.count() == 1) {
+                    results.for_each([&](Size reg) {
+                        best = CachedRun{first, pc, static_cast<Register>(reg)};
+                    });
+                }
+            }
+            return best;
+        }
+
+    }  // namespace
+
+    Status LoopInvariantCodeMotionPass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting loop-invariant code motion");
+
+        const auto& code = function.instructions;
+        const bool transformed = std::ranges::any_of(code, [](Instruction instr) {
+            return is_hoist_opcode(InstructionEncoder::decode_opcode(instr));
+        });
+        if (code.empty() || transformed) {
+            return std::monostate{};  // Already done on an earlier iteration
+        }
+
+        ControlFlowGraph cfg(function);
+        cfg.compute_dominators();
+        auto loops = find_natural_loops(cfg);
+        if (loops.empty()) {
+            return std::monostate{};
+        }
+        cfg.compute_liveness();
+
+        for (auto& loop : loops) {
+            // A skip ahead of the header would jump over the preheader instead
+            Size header = cfg.nodes()[loop.header].start_instruction;
+            loop.usable = header == 0 || !optimization_analysis::skips_next(
+                                             InstructionEncoder::decode_opcode(code[header - 1]));
+            loop.blocks.for_each([&](Size block) {
+                const auto& node = cfg.nodes()[block];
+                for (Size pc = node.start_instruction; pc <= node.end_instruction; ++pc) {
+                    RegisterSet reads;
+                    if (!optimization_analysis::instruction_registers(
+                            code[pc], cfg.frame_size(), reads, loop.written)) {
+                        loop.written.fill();
+                    }
+                }
+            });
+        }
+
+        // Runs are assigned to the outermost loop they are invariant in
+        std::vector<CachedRun> runs;
+        for (Size block : cfg.reverse_postorder()) {
+            std::vector<Size> enclosing;
+            for (Size index = 0; index < loops.size(); ++index) {
+                if (loops[index].usable && loops[index].blocks.contains(block)) {
+                    enclosing.push_back(index);
+                }
+            }
+            if (enclosing.empty()) {
+                continue;
+            }
+
+            const auto& node = cfg.nodes()[block];
+            auto live = block_liveness(cfg, function, node);
+            Size pc = node.start_instruction;
+            if (pc > 0 && optimization_analysis::skips_next(InstructionEncoder::decode_opcode(code[pc - 1]))) {
+                ++pc;  // The skip would jump over the HOISTGET instead
+            }
+            while (pc <= node.end_instruction && runs.size() < MAX_SLOTS) {
+                Optional<CachedRun> run;
+                for (Size index : enclosing) {
+                    run = find_cached_run(function, cfg, node, live, loops[index], pc);
+                    if (run) {
+                        run->loop = index;
+                        break;
+                    }
+                }
+                if (!run) {
+                    ++pc;
+                    continue;
+                }
+                runs.push_back(*run);
+                pc = run->last + 1;
+            }
+        }
+        if (runs.empty()) {
+            OPTIMIZER_LOG_DEBUG("Loop-invariant code motion found nothing to cache");
+            return std::monostate{};
+        }
+
+        // Each loop's slots are consecutive, so its preheader clears a single range
+        Size slots = 0;
+        for (Size index = 0; index < loops.size(); ++index) {
+            loops[index].first_slot = slots;
+            for (auto& run : runs) {
+                if (run.loop == index) {
+                    run.slot = slots++;
                 }
-                break;
+            }
+            loops[index].slot_count = slots - loops[index].first_slot;
         }
-    }
 
-    // Control Flow Graph implementation
-    namespace optimization_analysis {
+        // At one pc: the HOISTSET ending a run, then a preheader, then the HOISTGET starting a run
+        struct Inserted {
+            Instruction instruction = 0;
+            Size loop = SIZE_MAX;  // Loop a HOISTCLEAR is the preheader of
+        };
+        std::vector<std::vector<Inserted>> pending(code.size() + 1);
+        for (const auto& run : runs) {
+            pending[run.last + 1].push_back(
+                {InstructionEncoder::encode_abc(OpCode::OP_HOISTSET, run.output,
+                                                static_cast<Register>(run.slot), 0)});
+        }
+        for (Size index = 0; index < loops.size(); ++index) {
+            const auto& loop = loops[index];
+            if (loop.slot_count > 0) {
+                pending[cfg.nodes()[loop.header].start_instruction].push_back(
+                    {InstructionEncoder::encode_abc(OpCode::OP_HOISTCLEAR,
+                                                    static_cast<Register>(loop.first_slot),
+                                                    static_cast<Register>(loop.slot_count), 0),
+                     index});
+            }
+        }
+        for (const auto& run : runs) {
+            // Skip the run and its HOISTSET
+            auto skipped = static_cast<Register>(run.last - run.first + 2);
+            pending[run.first].push_back(
+                {InstructionEncoder::encode_abc(OpCode::OP_HOISTGET, run.output,
+                                                static_cast<Register>(run.slot), skipped)});
+        }
 
-        ControlFlowGraph::ControlFlowGraph(const BytecodeFunction& function) {
-            build_cfg(function);
-            compute_def_use_sets(function);
+        std::vector<optimization_analysis::Insertion> insertions;
+        for (Size pc = 0; pc < pending.size(); ++pc) {
+            if (!pending[pc].empty()) {
+                optimization_analysis::Insertion insertion;
+                insertion.pc = pc;
+                for (const auto& item : pending[pc]) {
+                    insertion.code.push_back(item.instruction);
+                }
+                insertions.push_back(std::move(insertion));
+            }
         }
 
-        void ControlFlowGraph::compute_liveness() {
-            // Backward data flow analysis for liveness
-            bool changed = true;
+        // Branches never land on a HOISTSET, and only enter a preheader from outside its loop
+        auto landing = [&](Size source, Size pc) {
+            Size skipped = 0;
+            for (const auto& item : pending[pc]) {
+                OpCode op = InstructionEncoder::decode_opcode(item.instruction);
+                bool inside = op == OpCode::OP_HOISTCLEAR &&
+                              loops[item.loop].blocks.contains(cfg.block_of(source));
+                if (op != OpCode::OP_HOISTSET && !inside) {
+                    break;
+                }
+                ++skipped;
+            }
+            return skipped;
+        };
+        optimization_analysis::insert_instructions(function, insertions, landing);
 
-            while (changed) {
-                changed = false;
+        OPTIMIZER_LOG_INFO("Loop-invariant code motion completed, cached runs: {}", runs.size());
+        return std::monostate{};
+    }
 
-                // Process nodes in reverse order
-                for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it) {
-                    auto& node = *it;
+    // FunctionInliningPass Implementation
+    namespace {
+
+        // Largest callee body, in instructions, that is inlined
+        constexpr Size MAX_INLINE_SIZE = 24;
+
+        // Calls in inlined code are inlined in turn up to this nesting depth
+        constexpr Size MAX_INLINE_DEPTH = 3;
+
+        // Instructions a function may grow by through inlining
+        constexpr Size MAX_INLINE_GROWTH = 512;
+
+        // MOVE copies followed back from a call to the CLOSURE of its callee
+        constexpr Size MAX_COPY_CHAIN = 8;
+
+        /**
+         * @brief How a callee's operands are renumbered into the caller
+         */
+        struct Relocation {
+            Size base = 0;                         // Caller register holding callee R0
+            std::vector<Size> constants;           // Caller index of each callee constant
+            std::vector<Optional<Size>> upvalues;  // Caller upvalue of each callee upvalue
+        };
+
+        /**
+         * @brief A prototype body that can be inlined
+         */
+        struct InlineBody {
+            const FunctionPrototype* prototype = nullptr;
+            Relocation relocation;  // Constants unchanged and upvalues as seen by the caller; base 0
+            Size frame = 0;         // Registers the body names
+            Size live_in_end = 0;  // One past the highest register read before it is written
+        };
+
+        /**
+         * @brief Callee instruction renumbered into the caller
+         * @return nullopt for instructions that cannot be inlined or operands that do not fit
+         */
+        Optional<Instruction> relocate(Instruction instr, const Relocation& relocation) {
+            // Typed opcodes from the callee's own optimization become generic again; the
+            // caller's type inference decides them for the inlined code
+            OpCode op = instruction_utils::generic_opcode(InstructionEncoder::decode_opcode(instr));
+            Size a = InstructionEncoder::decode_a(instr);
+            Size b = InstructionEncoder::decode_b(instr);
+            Size c = InstructionEncoder::decode_c(instr);
+
+            bool fits = true;
+            auto reg = [&](Size r) {
+                Size result = relocation.base + r;
+                fits = fits && result <= InstructionEncoder::MAX_A;
+                return static_cast<Register>(result);
+            };
+            auto constant = [&](Size k) {
+                Size result = k < relocation.constants.size() ? relocation.constants[k] : SIZE_MAX;
+                fits = fits && result <= InstructionEncoder::MAX_C;
+                return static_cast<Register>(result);
+            };
+            auto upvalue = [&](Size u) {
+                Size result = u < relocation.upvalues.size() && relocation.upvalues[u]
+                                  ? *relocation.upvalues[u]
+                                  : SIZE_MAX;
+                fits = fits && result <= InstructionEncoder::MAX_B;
+                return static_cast<Register>(result);
+            };
+
+            Instruction result = 0;
+            switch (op) {
+                case OpCode::OP_JMP:
+                    return instr;
+
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                case OpCode::OP_FORLOOP:
+                case OpCode::OP_FORPREP:
+                    result = InstructionEncoder::encode_asbx(op, reg(a), InstructionEncoder::decode_sbx(instr));
+                    break;
 
-                    // live_out[n] = union of live_in[s] for all successors s of n
-                    std::unordered_set<Register> new_live_out;
-                    for (Size successor : node.successors) {
-                        if (successor < nodes_.size()) {
-                            const auto& succ_live_in = nodes_[successor].live_in;
-                            new_live_out.insert(succ_live_in.begin(), succ_live_in.end());
-                        }
-                    }
+                case OpCode::OP_LOADK: {
+                    Size k = InstructionEncoder::decode_bx(instr);
+                    Size index = k < relocation.constants.size() ? relocation.constants[k] : SIZE_MAX;
+                    fits = index <= InstructionEncoder::MAX_BX;
+                    result = InstructionEncoder::encode_abx(op, reg(a), static_cast<std::uint32_t>(index));
+                    break;
+                }
 
-                    // live_in[n] = use[n] union (live_out[n] - def[n])
-                    std::unordered_set<Register> new_live_in = node.use;
-                    for (Register reg : new_live_out) {
-                        if (node.def.find(reg) == node.def.end()) {
-                            new_live_in.insert(reg);
-                        }
+                case OpCode::OP_CALL:
+                    if (b == 0 || c == 0) {
+                        return std::nullopt;  // Open ranges run to the frame top
                     }
+                    [[fallthrough]];
+                case OpCode::OP_LOADFALSE:
+                case OpCode::OP_LFALSESKIP:
+                case OpCode::OP_LOADTRUE:
+                case OpCode::OP_LOADNIL:
+                case OpCode::OP_NEWTABLE:
+                case OpCode::OP_CONCAT:
+                case OpCode::OP_SETLIST:
+                case OpCode::OP_TEST:
+                case OpCode::OP_EQI:
+                case OpCode::OP_LTI:
+                case OpCode::OP_LEI:
+                case OpCode::OP_GTI:
+                case OpCode::OP_GEI:
+                    result = InstructionEncoder::encode_abc(op, reg(a), static_cast<Register>(b),
+                                                            static_cast<Register>(c));
+                    break;
 
-                    // Check for changes
-                    if (new_live_in != node.live_in || new_live_out != node.live_out) {
-                        node.live_in = std::move(new_live_in);
-                        node.live_out = std::move(new_live_out);
-                        changed = true;
-                    }
-                }
+                case OpCode::OP_MOVE:
+                case OpCode::OP_UNM:
+                case OpCode::OP_BNOT:
+                case OpCode::OP_NOT:
+                case OpCode::OP_LEN:
+                case OpCode::OP_GETI:
+                case OpCode::OP_ADDI:
+                case OpCode::OP_SHRI:
+                case OpCode::OP_SHLI:
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                case OpCode::OP_TESTSET:
+                    result = InstructionEncoder::encode_abc(op, reg(a), reg(b), static_cast<Register>(c));
+                    break;
+
+                case OpCode::OP_GETFIELD:
+                case OpCode::OP_SELF:
+                case OpCode::OP_ADDK:
+                case OpCode::OP_SUBK:
+                case OpCode::OP_MULK:
+                case OpCode::OP_MODK:
+                case OpCode::OP_POWK:
+                case OpCode::OP_DIVK:
+                case OpCode::OP_IDIVK:
+                case OpCode::OP_BANDK:
+                case OpCode::OP_BORK:
+                case OpCode::OP_BXORK:
+                    result = InstructionEncoder::encode_abc(op, reg(a), reg(b), constant(c));
+                    break;
+
+                case OpCode::OP_GETTABLE:
+                case OpCode::OP_SETTABLE:
+                case OpCode::OP_ADD:
+                case OpCode::OP_SUB:
+                case OpCode::OP_MUL:
+                case OpCode::OP_MOD:
+                case OpCode::OP_POW:
+                case OpCode::OP_DIV:
+                case OpCode::OP_IDIV:
+                case OpCode::OP_BAND:
+                case OpCode::OP_BOR:
+                case OpCode::OP_BXOR:
+                case OpCode::OP_SHL:
+                case OpCode::OP_SHR:
+                    result = InstructionEncoder::encode_abc(op, reg(a), reg(b), reg(c));
+                    break;
+
+                case OpCode::OP_SETI:
+                    result = InstructionEncoder::encode_abc(op, reg(a), static_cast<Register>(b), reg(c));
+                    break;
+
+                case OpCode::OP_SETFIELD:
+                    result = InstructionEncoder::encode_abc(op, reg(a), constant(b), reg(c));
+                    break;
+
+                case OpCode::OP_EQK:
+                    result = InstructionEncoder::encode_abc(op, reg(a), constant(b), static_cast<Register>(c));
+                    break;
+
+                case OpCode::OP_GETUPVAL:
+                    result = InstructionEncoder::encode_abc(op, reg(a), upvalue(b), static_cast<Register>(c));
+                    break;
+
+                case OpCode::OP_GETTABUP:
+                    result = InstructionEncoder::encode_abc(op, reg(a), upvalue(b), constant(c));
+                    break;
+
+                case OpCode::OP_SETTABUP:
+                    result = InstructionEncoder::encode_abc(op, upvalue(a), constant(b), reg(c));
+                    break;
+
+                default:
+                    // Returns are rewritten by the caller; closures, varargs, upvalue
+                    // writes, tail calls and generic loops are not inlined
+                    return std::nullopt;
             }
-        }
 
-        void ControlFlowGraph::compute_dominators() {
-            if (nodes_.empty()) return;
+            if (!fits) {
+                return std::nullopt;
+            }
+            return result;
+        }
 
-            // Initialize dominators
-            dominators_.resize(nodes_.size());
-            dominator_tree_.resize(nodes_.size());
+        bool is_return(OpCode op) noexcept {
+            return op == OpCode::OP_RETURN || op == OpCode::OP_RETURN0 || op == OpCode::OP_RETURN1;
+        }
 
-            // Entry node dominates itself
-            dominators_[0] = 0;
+        /**
+         * @brief Check that a prototype can be inlined and measure its frame
+         */
+        Optional<InlineBody> analyze_body(const FunctionPrototype& prototype) {
+            const auto& code = prototype.instructions;
+            if (prototype.is_vararg || code.empty() || code.size() > MAX_INLINE_SIZE ||
+                !is_return(InstructionEncoder::decode_opcode(code.back()))) {
+                return std::nullopt;
+            }
 
-            // All other nodes initially dominated by all nodes
-            for (Size i = 1; i < nodes_.size(); ++i) {
-                dominators_[i] = SIZE_MAX; // Undefined initially
+            InlineBody body;
+            body.prototype = &prototype;
+            for (Size k = 0; k < prototype.constants.size(); ++k) {
+                body.relocation.constants.push_back(k);
+            }
+            // Upvalues of the enclosing function carry over; upvalue 0 without a
+            // descriptor is the globals fallback in both functions
+            const Size upvalue_count = std::max<Size>(prototype.upvalue_descriptors.size(), 1);
+            for (Size u = 0; u < upvalue_count; ++u) {
+                if (u >= prototype.upvalue_descriptors.size()) {
+                    body.relocation.upvalues.push_back(u);
+                } else if (!prototype.upvalue_descriptors[u].in_stack) {
+                    body.relocation.upvalues.push_back(prototype.upvalue_descriptors[u].index);
+                } else {
+                    body.relocation.upvalues.push_back(std::nullopt);
+                }
             }
 
-            // Iterative algorithm
-            bool changed = true;
-            while (changed) {
-                changed = false;
+            for (Instruction instr : code) {
+                OpCode op = InstructionEncoder::decode_opcode(instr);
+                if (op == OpCode::OP_RETURN && InstructionEncoder::decode_b(instr) == 0) {
+                    return std::nullopt;  // Open result lists run to the frame top
+                }
+                if (!is_return(op) && !relocate(instr, body.relocation)) {
+                    return std::nullopt;
+                }
+            }
 
-                for (Size i = 1; i < nodes_.size(); ++i) {
-                    Size new_dom = SIZE_MAX;
+            BytecodeFunction function;
+            function.instructions = code;
+            function.constants = prototype.constants;
+            function.upvalue_descriptors = prototype.upvalue_descriptors;
+            function.parameter_count = prototype.parameter_count;
+            function.stack_size = prototype.stack_size;
+
+            ControlFlowGraph cfg(function);
+            cfg.compute_liveness();
+            cfg.nodes()[cfg.block_of(0)].live_in.for_each(
+                [&](Size reg) { body.live_in_end = std::max(body.live_in_end, reg + 1); });
+            body.frame = std::max({optimization_analysis::frame_register_count(function),
+                                   prototype.parameter_count, body.live_in_end});
+            return body;
+        }
 
-                    // Find first processed predecessor
-                    for (Size pred : nodes_[i].predecessors) {
-                        if (dominators_[pred] != SIZE_MAX) {
-                            new_dom = pred;
-                            break;
-                        }
+        /**
+         * @brief Layout of one inlined call: the code and the line of each instruction
+         */
+        struct InlinedCall {
+            std::vector<Instruction> code;
+            std::vector<Size> lines;
+        };
+
+        /**
+         * @brief Build the code replacing CALL A B C by an inlined body
+         *
+         * Arguments are already in place as the body's parameters. Missing
+         * parameters and registers the body reads before writing are set to nil;
+         * each return copies its values to R[A] .. R[A+C-2] and jumps past the
+         * inlined code. A return ending the body is expanded in place, others
+         * (and one that a skip may jump over) jump to stubs after the body.
+         */
+        Optional<InlinedCall> build_inlined_call(const InlineBody& body,
+                                                 const Relocation& relocation,
+                                                 Register a,
+                                                 Size arguments,
+                                                 Size results,
+                                                 Size call_line) {
+            const auto& prototype = *body.prototype;
+            const auto& code = prototype.instructions;
+            const bool has_lines = prototype.line_info.size() == code.size();
+            auto line_of = [&](Size pc) { return has_lines ? prototype.line_info[pc] : call_line; };
+
+            InlinedCall call;
+            std::vector<std::pair<Size, Size>> jumps;  // JMP position, stub index (SIZE_MAX: end)
+            auto emit = [&](Instruction instr, Size line) {
+                call.code.push_back(instr);
+                call.lines.push_back(line);
+            };
+            auto emit_jump = [&](Size stub, Size line) {
+                jumps.emplace_back(call.code.size(), stub);
+                emit(InstructionEncoder::encode_asbx(OpCode::OP_JMP, 0, 0), line);
+            };
+
+            // Copy a return's values into the result registers, padding with nil
+            auto emit_results = [&](Instruction ret, Size line) {
+                OpCode op = InstructionEncoder::decode_opcode(ret);
+                Size first = InstructionEncoder::decode_a(ret);
+                Size count = op == OpCode::OP_RETURN0   ? 0
+                             : op == OpCode::OP_RETURN1 ? 1
+                                                        : InstructionEncoder::decode_b(ret) - 1;
+                for (Size i = 0; i < results; ++i) {
+                    auto target = static_cast<Register>(a + i);
+                    if (i < count) {
+                        emit(InstructionEncoder::encode_abc(
+                                 OpCode::OP_MOVE, target,
+                                 static_cast<Register>(relocation.base + first + i), 0),
+                             line);
+                    } else {
+                        emit(InstructionEncoder::encode_abc(OpCode::OP_LOADNIL, target,
+                                                            static_cast<Register>(results - i - 1), 0),
+                             line);
+                        break;
                     }
+                }
+            };
+
+            const Size parameters = prototype.parameter_count;
+            Size nil_first = std::min(arguments, parameters);
+            Size nil_end = std::max(arguments < parameters ? parameters : 0, body.live_in_end);
+            if (nil_end > nil_first) {
+                emit(InstructionEncoder::encode_abc(OpCode::OP_LOADNIL,
+                                                    static_cast<Register>(relocation.base + nil_first),
+                                                    static_cast<Register>(nil_end - nil_first - 1), 0),
+                     call_line);
+            }
 
-                    // Intersect with other processed predecessors
-                    for (Size pred : nodes_[i].predecessors) {
-                        if (dominators_[pred] != SIZE_MAX && pred != new_dom) {
-                            new_dom = intersect_dominators(pred, new_dom);
-                        }
+            std::vector<Size> stubs;  // Returns placed after the body
+            bool falls_through = false;
+            for (Size pc = 0; pc < code.size(); ++pc) {
+                Instruction instr = code[pc];
+                if (!is_return(InstructionEncoder::decode_opcode(instr))) {
+                    auto relocated = relocate(instr, relocation);
+                    if (!relocated) {
+                        return std::nullopt;
                     }
+                    emit(*relocated, line_of(pc));
+                    continue;
+                }
 
-                    if (dominators_[i] != new_dom) {
-                        dominators_[i] = new_dom;
-                        changed = true;
-                    }
+                const bool skipped =
+                    pc > 0 && optimization_analysis::skips_next(InstructionEncoder::decode_opcode(code[pc - 1]));
+                if (pc + 1 == code.size() && !skipped) {
+                    emit_results(instr, line_of(pc));
+                    falls_through = true;
+                } else {
+                    emit_jump(stubs.size(), line_of(pc));
+                    stubs.push_back(pc);
                 }
             }
 
-            // Build dominator tree
-            for (Size i = 0; i < nodes_.size(); ++i) {
-                if (i != 0 && dominators_[i] != SIZE_MAX) {
-                    dominator_tree_[dominators_[i]].push_back(i);
+            // Body branches keep their offsets: only the final return grew
+            std::vector<Size> stub_start(stubs.size());
+            for (Size index = 0; index < stubs.size(); ++index) {
+                if (index > 0 || falls_through) {
+                    emit_jump(SIZE_MAX, call_line);
                 }
+                stub_start[index] = call.code.size();
+                emit_results(code[stubs[index]], line_of(stubs[index]));
+            }
+
+            const Size end = call.code.size();
+            for (auto [position, stub] : jumps) {
+                Size target = stub == SIZE_MAX ? end : stub_start[stub];
+                call.code[position] = InstructionEncoder::encode_asbx(
+                    OpCode::OP_JMP, 0,
+                    static_cast<std::int32_t>(target) - static_cast<std::int32_t>(position) - 1);
             }
+            return call;
         }
 
-        void ControlFlowGraph::build_cfg(const BytecodeFunction& function) {
-            if (function.instructions.empty()) return;
+    }  // namespace
+
+    std::unordered_map<String, Size> FunctionInliningPass::take_counters() {
+        return std::exchange(counters_, {});
+    }
 
-            // Find basic block boundaries
-            std::unordered_set<Size> leaders;
-            leaders.insert(0); // First instruction is always a leader
+    Status FunctionInliningPass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting function inlining");
 
-            for (Size i = 0; i < function.instructions.size(); ++i) {
-                Instruction instr = function.instructions[i];
-                OpCode op = InstructionEncoder::decode_opcode(instr);
+        if (function.prototypes.empty()) {
+            return std::monostate{};
+        }
+
+        std::vector<Optional<InlineBody>> bodies;
+        bodies.reserve(function.prototypes.size());
+        for (const auto& prototype : function.prototypes) {
+            bodies.push_back(analyze_body(prototype));
+        }
+
+        auto& code = function.instructions;
+        std::vector<Size> depth(code.size(), 0);  // Inlining depth of each instruction
+        Size growth = 0;
+        Size inlined = 0;
+
+        Optional<ControlFlowGraph> cfg;
+        std::vector<Size> writer_count;
+        std::vector<Size> writer;
+        Size next = 0;
+        while (next < code.size()) {
+            const Size pc = next++;
+            Instruction call = code[pc];
+            if (InstructionEncoder::decode_opcode(call) != OpCode::OP_CALL) {
+                continue;
+            }
 
-                // Jump targets are leaders
-                if (op == OpCode::OP_JMP) {
-                    std::int32_t offset = InstructionEncoder::decode_sbx(instr);
-                    Size target = i + 1 + offset;
-                    if (target < function.instructions.size()) {
-                        leaders.insert(target);
+            if (!cfg) {
+                cfg.emplace(function);
+                cfg->compute_dominators();
+                cfg->compute_liveness();
+
+                // The only instruction writing each register, if there is one
+                const Size frame = cfg->frame_size();
+                writer_count.assign(frame, 0);
+                writer.assign(frame, 0);
+                for (Size i = 0; i < code.size(); ++i) {
+                    auto effects = optimization_analysis::register_effects(code[i]);
+                    if (!effects) {
+                        return std::monostate{};  // No register model to reason with
                     }
-                    // Instruction after jump is also a leader
-                    if (i + 1 < function.instructions.size()) {
-                        leaders.insert(i + 1);
+                    for (Size w = 0; w < effects->write_count; ++w) {
+                        const auto& range = effects->writes[w];
+                        for (Size reg = range.first; reg < std::min(range.end(frame), frame); ++reg) {
+                            ++writer_count[reg];
+                            writer[reg] = i;
+                        }
                     }
-                } else if (op == OpCode::OP_FORLOOP || op == OpCode::OP_FORPREP || op == OpCode::OP_TFORLOOP) {
-                    std::uint32_t offset = InstructionEncoder::decode_bx(instr);
-                    Size target = i + 1 + offset;
-                    if (target < function.instructions.size()) {
-                        leaders.insert(target);
+                }
+            }
+
+            // Follow the callee register back to the CLOSURE that created its value
+            Optional<Size> index;
+            Register reg = InstructionEncoder::decode_a(call);
+            Size at = pc;
+            for (Size step = 0; step < MAX_COPY_CHAIN && !cfg->captured().contains(reg); ++step) {
+                const Size block = cfg->block_of(at);
+                const Size start = cfg->nodes()[block].start_instruction;
+                Optional<Size> definition;
+                for (Size i = at; i-- > start;) {
+                    RegisterSet reads;
+                    RegisterSet writes;
+                    optimization_analysis::instruction_registers(code[i], cfg->frame_size(), reads, writes);
+                    if (writes.contains(reg)) {
+                        definition = i;
+                        break;
                     }
-                    if (i + 1 < function.instructions.size()) {
-                        leaders.insert(i + 1);
+                }
+                if (!definition) {
+                    // A single definition elsewhere must dominate the use
+                    if (reg >= writer_count.size() || writer_count[reg] != 1 ||
+                        cfg->block_of(writer[reg]) == block ||
+                        !cfg->dominates(cfg->block_of(writer[reg]), block)) {
+                        break;
                     }
+                    definition = writer[reg];
+                }
+
+                Instruction instr = code[*definition];
+                OpCode op = InstructionEncoder::decode_opcode(instr);
+                if (op == OpCode::OP_CLOSURE) {
+                    index = InstructionEncoder::decode_bx(instr);
+                    break;
+                }
+                if (op != OpCode::OP_MOVE) {
+                    break;
                 }
+                reg = InstructionEncoder::decode_b(instr);
+                at = *definition;
+            }
+            if (!index || *index >= bodies.size()) {
+                continue;
             }
 
-            // Create basic blocks
-            std::vector<Size> sorted_leaders(leaders.begin(), leaders.end());
-            std::sort(sorted_leaders.begin(), sorted_leaders.end());
+            const auto& body = bodies[*index];
+            if (!body) {
+                ++counters_["callee_rejected"];
+                continue;
+            }
+            if (depth[pc] >= MAX_INLINE_DEPTH) {
+                ++counters_["depth_limited"];
+                continue;
+            }
 
-            nodes_.clear();
-            for (Size i = 0; i < sorted_leaders.size(); ++i) {
-                CFGNode node;
-                node.start_instruction = sorted_leaders[i];
+            const Register a = InstructionEncoder::decode_a(call);
+            const Size b = InstructionEncoder::decode_b(call);
+            const Size c = InstructionEncoder::decode_c(call);
+            if (b == 0 || c == 0 ||
+                (pc > 0 && optimization_analysis::skips_next(InstructionEncoder::decode_opcode(code[pc - 1])))) {
+                ++counters_["site_rejected"];
+                continue;
+            }
 
-                if (i + 1 < sorted_leaders.size()) {
-                    node.end_instruction = sorted_leaders[i + 1] - 1;
-                } else {
-                    node.end_instruction = function.instructions.size() - 1;
+            // Registers the body may clobber, apart from the results, must be dead after the call
+            Relocation relocation = body->relocation;
+            relocation.base = static_cast<Size>(a) + 1;
+            const Size frame_end = relocation.base + body->frame;
+            const auto& node = cfg->nodes()[cfg->block_of(pc)];
+            auto live = block_liveness(*cfg, function, node);
+            RegisterSet clobbered;
+            clobbered.insert_range(a + c - 1, std::min(frame_end, clobbered.capacity()));
+            clobbered.intersect(live[pc + 1 - node.start_instruction]);
+            if (!clobbered.empty() || frame_end > FRAME_LIMIT) {
+                ++counters_["site_rejected"];
+                continue;
+            }
+
+            std::vector<ConstantValue> constants = function.constants;
+            relocation.constants.clear();
+            for (const auto& value : body->prototype->constants) {
+                auto found = std::ranges::find(constants, value);
+                relocation.constants.push_back(static_cast<Size>(found - constants.begin()));
+                if (found == constants.end()) {
+                    constants.push_back(value);
                 }
+            }
 
-                nodes_.push_back(node);
+            const bool has_lines = function.line_info.size() == code.size();
+            auto inlined_call = build_inlined_call(*body, relocation, a, b - 1, c - 1,
+                                                   has_lines ? function.line_info[pc] : 0);
+            if (!inlined_call) {
+                ++counters_["site_rejected"];
+                continue;
+            }
+            const Size added = inlined_call->code.size();
+            if (growth + added > MAX_INLINE_GROWTH) {
+                ++counters_["budget_limited"];
+                continue;
             }
 
-            // Build edges between basic blocks
-            for (Size i = 0; i < nodes_.size(); ++i) {
-                auto& node = nodes_[i];
-                Size last_instr = node.end_instruction;
+            // Splice the body in ahead of the call, then drop the call; branches to it land on the body
+            optimization_analysis::Insertion insertion;
+            insertion.pc = pc;
+            insertion.code = inlined_call->code;
+            optimization_analysis::insert_instructions(function, {insertion},
+                                                       [](Size, Size) { return Size{0}; });
+            if (has_lines) {
+                std::ranges::copy(inlined_call->lines, function.line_info.begin() + static_cast<std::ptrdiff_t>(pc));
+            }
+            std::vector<bool> removed(code.size(), false);
+            removed[pc + added] = true;
+            optimization_analysis::remove_instructions(function, removed);
+
+            function.constants = std::move(constants);
+            function.stack_size = std::max(function.stack_size, frame_end);
+            const Size call_depth = depth[pc];
+            depth.erase(depth.begin() + static_cast<std::ptrdiff_t>(pc));
+            depth.insert(depth.begin() + static_cast<std::ptrdiff_t>(pc), added, call_depth + 1);
+
+            OPTIMIZER_LOG_DEBUG("Inlined '{}' at pc {} (depth {}, {} instructions)",
+                                function.prototypes[*index].name, pc, call_depth + 1, added);
+            growth += added;
+            ++inlined;
+            cfg.reset();
+            next = pc;  // Calls in the inlined body come next
+        }
 
-                if (last_instr < function.instructions.size()) {
-                    Instruction instr = function.instructions[last_instr];
-                    OpCode op = InstructionEncoder::decode_opcode(instr);
+        counters_["inlined"] += inlined;
+        counters_["inlined_instructions"] += growth;
+        OPTIMIZER_LOG_INFO("Function inlining completed, inlined calls: {}", inlined);
+        return std::monostate{};
+    }
 
-                    // Add fall-through edge
-                    if (op != OpCode::OP_JMP && op != OpCode::OP_RETURN &&
-                        op != OpCode::OP_RETURN0 && op != OpCode::OP_RETURN1 &&
-                        op != OpCode::OP_TAILCALL) {
-                        if (i + 1 < nodes_.size()) {
-                            node.successors.push_back(i + 1);
-                            nodes_[i + 1].predecessors.push_back(i);
-                        }
-                    }
+    // NumericTypeInferencePass Implementation
+    namespace {
 
-                    // Add jump edges
-                    if (op == OpCode::OP_JMP) {
-                        std::int32_t offset = InstructionEncoder::decode_sbx(instr);
-                        Size target = last_instr + 1 + offset;
+        /**
+         * @brief What inference knows about an SSA value
+         *
+         * Unknown is the optimistic start: no definition reaching the value has
+         * been seen yet. It only remains for values in unreachable code.
+         */
+        enum class NumericType : std::uint8_t { Unknown, Number, Any };
 
-                        // Find target basic block
-                        for (Size j = 0; j < nodes_.size(); ++j) {
-                            if (nodes_[j].start_instruction == target) {
-                                node.successors.push_back(j);
-                                nodes_[j].predecessors.push_back(i);
-                                break;
-                            }
-                        }
-                    }
-                }
+        NumericType join(NumericType x, NumericType y) noexcept {
+            if (x == NumericType::Unknown) {
+                return y;
             }
+            if (y == NumericType::Unknown || x == y) {
+                return x;
+            }
+            return NumericType::Any;
         }
 
-        void ControlFlowGraph::compute_def_use_sets(const BytecodeFunction& function) {
-            for (auto& node : nodes_) {
-                for (Size i = node.start_instruction; i <= node.end_instruction && i < function.instructions.size(); ++i) {
-                    Instruction instr = function.instructions[i];
-                    OpCode op = InstructionEncoder::decode_opcode(instr);
-
-                    // Add definitions
-                    Register a = InstructionEncoder::decode_a(instr);
-                    if (a < 255) {
-                        node.def.insert(a);
-                    }
-
-                    // Add uses
-                    switch (op) {
-                        case OpCode::OP_MOVE:
-                        case OpCode::OP_UNM:
-                        case OpCode::OP_NOT:
-                        case OpCode::OP_LEN:
-                        case OpCode::OP_BNOT: {
-                            Register b = InstructionEncoder::decode_b(instr);
-                            if (b < 255) {
-                                node.use.insert(b);
-                            }
-                            break;
-                        }
+        /**
+         * @brief Type of an arithmetic result from the types of its operands
+         */
+        NumericType arithmetic(NumericType x, NumericType y) noexcept {
+            if (x == NumericType::Any || y == NumericType::Any) {
+                return NumericType::Any;  // Coercion or a metamethod decides the result
+            }
+            if (x == NumericType::Unknown || y == NumericType::Unknown) {
+                return NumericType::Unknown;
+            }
+            return NumericType::Number;
+        }
 
-                        case OpCode::OP_ADD:
-                        case OpCode::OP_SUB:
-                        case OpCode::OP_MUL:
-                        case OpCode::OP_DIV:
-                        case OpCode::OP_MOD:
-                        case OpCode::OP_POW:
-                        case OpCode::OP_BAND:
-                        case OpCode::OP_BOR:
-                        case OpCode::OP_BXOR:
-                        case OpCode::OP_SHL:
-                        case OpCode::OP_SHR: {
-                            Register b = InstructionEncoder::decode_b(instr);
-                            Register c = InstructionEncoder::decode_c(instr);
-                            if (b < 255) node.use.insert(b);
-                            if (c < 255) node.use.insert(c);
-                            break;
-                        }
+        bool holds_number(const std::vector<ConstantValue>& constants, Size index) {
+            return index < constants.size() && (is_number_constant(constants[index]) ||
+                                                 std::holds_alternative<Int>(constants[index]));
+        }
 
-                        default:
-                            break;
+        /**
+         * @brief Numeric types of the SSA values of one function
+         */
+        class NumericTypes {
+        public:
+            NumericTypes(const ssa::Function& function, const std::vector<ConstantValue>& constants)
+                : function_(function),
+                  constants_(constants),
+                  types_(function.value_count(), NumericType::Unknown) {
+                for (ssa::ValueId id = 0; id < types_.size(); ++id) {
+                    if (function.value(id).kind == ssa::ValueKind::Entry) {
+                        types_[id] = NumericType::Any;  // Parameters, or nil
                     }
                 }
             }
-        }
-
-        Size ControlFlowGraph::intersect_dominators(Size b1, Size b2) {
-            Size finger1 = b1;
-            Size finger2 = b2;
 
-            while (finger1 != finger2) {
-                while (finger1 > finger2) {
-                    finger1 = dominators_[finger1];
+            /**
+             * @brief Solve to a fixed point; each value can only move down the lattice twice
+             */
+            void solve() {
+                bool changed = true;
+                while (changed) {
+                    changed = false;
+                    for (const auto& block : function_.blocks()) {
+                        for (ssa::ValueId phi : block.phis) {
+                            changed = update(phi, phi_type(phi)) || changed;
+                        }
+                    }
+                    for (const auto& node : function_.nodes()) {
+                        for (Size i = 0; i < node.defs.size(); ++i) {
+                            changed = update(node.defs[i], def_type(node, i)) || changed;
+                        }
+                    }
                 }
-                while (finger2 > finger1) {
-                    finger2 = dominators_[finger2];
+            }
+
+            /**
+             * @brief Type of register reg as read by node
+             */
+            [[nodiscard]] NumericType operand(const ssa::Node& node, Register reg) const {
+                for (Size i = 0; i < node.use_registers.size(); ++i) {
+                    if (node.use_registers[i] == reg) {
+                        return types_[function_.resolve(node.uses[i])];
+                    }
                 }
+                return NumericType::Any;  // Captured by a closure
             }
 
-            return finger1;
-        }
+        private:
+            const ssa::Function& function_;
+            const std::vector<ConstantValue>& constants_;
+            std::vector<NumericType> types_;
 
-        // DataFlowAnalysis implementation
-        std::unordered_map<Register, std::vector<Size>>
-        DataFlowAnalysis::compute_reaching_definitions(const BytecodeFunction& function) {
-            std::unordered_map<Register, std::vector<Size>> reaching_defs;
+            bool update(ssa::ValueId id, NumericType type) {
+                type = join(types_[id], type);
+                if (type == types_[id]) {
+                    return false;
+                }
+                types_[id] = type;
+                return true;
+            }
 
-            // Simple implementation - track all definitions for each register
-            for (Size i = 0; i < function.instructions.size(); ++i) {
-                Instruction instr = function.instructions[i];
+            /**
+             * @brief Numeric for loops write their counters on one outcome only
+             * @return true if the written register of node reaches block with the new value
+             */
+            [[nodiscard]] bool writes_on_edge(const ssa::Node& node, Register reg, Size block) const {
+                Instruction instr = node.instruction;
                 Register a = InstructionEncoder::decode_a(instr);
-
-                if (a < 255) {
-                    reaching_defs[a].push_back(i);
+                Size target = function_.blocks()[block].first;
+                switch (InstructionEncoder::decode_opcode(instr)) {
+                    case OpCode::OP_FORPREP:
+                        return reg == a + 3 && target == node.pc + 1;
+                    case OpCode::OP_FORLOOP:
+                        return (reg == a || reg == a + 3) &&
+                               static_cast<std::int64_t>(target) ==
+                                   static_cast<std::int64_t>(node.pc) + 1 +
+                                       InstructionEncoder::decode_sbx(instr);
+                    default:
+                        return false;
                 }
             }
 
-            return reaching_defs;
-        }
-
-        std::unordered_set<Register>
-        DataFlowAnalysis::compute_live_variables(const BytecodeFunction& function, Size instruction) {
-            std::unordered_set<Register> live;
+            [[nodiscard]] NumericType phi_type(ssa::ValueId phi) const {
+                const auto& value = function_.value(phi);
+                const auto& block = function_.blocks()[value.block];
+                const Size offset = value.block == 0 ? 1 : 0;  // The entry value comes first
+
+                NumericType type = NumericType::Unknown;
+                for (Size i = 0; i < value.operands.size(); ++i) {
+                    ssa::ValueId operand = function_.resolve(value.operands[i]);
+                    const auto& definition = function_.value(operand);
+                    if (i >= offset && definition.kind == ssa::ValueKind::Def) {
+                        const auto& node = function_.nodes()[definition.node];
+                        if (node.block == block.predecessors[i - offset] &&
+                            writes_on_edge(node, definition.reg, value.block)) {
+                            type = join(type, NumericType::Number);
+                            continue;
+                        }
+                    }
+                    type = join(type, types_[operand]);
+                }
+                return type;
+            }
 
-            // Simple backward scan from the given instruction
-            for (Size i = instruction; i < function.instructions.size(); ++i) {
-                Instruction instr = function.instructions[i];
-                OpCode op = InstructionEncoder::decode_opcode(instr);
+            [[nodiscard]] NumericType def_type(const ssa::Node& node, Size index) const {
+                Instruction instr = node.instruction;
+                Register a = InstructionEncoder::decode_a(instr);
+                Register b = InstructionEncoder::decode_b(instr);
+                Register c = InstructionEncoder::decode_c(instr);
+                Register reg = node.def_registers[index];
 
-                // Add used registers
-                switch (op) {
+                switch (InstructionEncoder::decode_opcode(instr)) {
+                    case OpCode::OP_LOADI:
+                    case OpCode::OP_LOADF:
+                        return NumericType::Number;
+                    case OpCode::OP_LOADK:
+                        return holds_number(constants_, InstructionEncoder::decode_bx(instr))
+                                   ? NumericType::Number
+                                   : NumericType::Any;
                     case OpCode::OP_MOVE:
-                    case OpCode::OP_UNM:
-                    case OpCode::OP_NOT:
-                    case OpCode::OP_LEN:
-                    case OpCode::OP_BNOT: {
-                        Register b = InstructionEncoder::decode_b(instr);
-                        if (b < 255) live.insert(b);
-                        break;
-                    }
-
+                        return operand(node, b);
                     case OpCode::OP_ADD:
                     case OpCode::OP_SUB:
                     case OpCode::OP_MUL:
                     case OpCode::OP_DIV:
                     case OpCode::OP_MOD:
                     case OpCode::OP_POW:
-                    case OpCode::OP_BAND:
-                    case OpCode::OP_BOR:
-                    case OpCode::OP_BXOR:
-                    case OpCode::OP_SHL:
-                    case OpCode::OP_SHR: {
-                        Register b = InstructionEncoder::decode_b(instr);
-                        Register c = InstructionEncoder::decode_c(instr);
-                        if (b < 255) live.insert(b);
-                        if (c < 255) live.insert(c);
-                        break;
-                    }
-
+                        return arithmetic(operand(node, b), operand(node, c));
+                    case OpCode::OP_ADDK:
+                    case OpCode::OP_SUBK:
+                    case OpCode::OP_MULK:
+                    case OpCode::OP_MODK:
+                    case OpCode::OP_POWK:
+                    case OpCode::OP_DIVK:
+                        return arithmetic(operand(node, b), holds_number(constants_, c)
+                                                                 ? NumericType::Number
+                                                                 : NumericType::Any);
+                    case OpCode::OP_ADDI:
+                    case OpCode::OP_UNM:
+                        return arithmetic(operand(node, b), NumericType::Number);
+                    case OpCode::OP_FORPREP:
+                    case OpCode::OP_FORLOOP:
+                        // A number where the loop runs; otherwise the register keeps its value
+                        if (reg == a || reg == a + 3) {
+                            return join(NumericType::Number, types_[function_.resolve(node.previous[index])]);
+                        }
+                        return NumericType::Any;
                     default:
-                        break;
+                        return NumericType::Any;
                 }
             }
+        };
 
-            return live;
+    }  // namespace
+
+    std::unordered_map<String, Size> NumericTypeInferencePass::take_counters() {
+        return std::exchange(counters_, {});
+    }
+
+    Status NumericTypeInferencePass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting numeric type inference");
+
+        auto& code = function.instructions;
+        const bool has_candidates = std::ranges::any_of(code, [](Instruction instr) {
+            OpCode op = InstructionEncoder::decode_opcode(instr);
+            return instruction_utils::number_typed_opcode(op) != op;
+        });
+        if (!has_candidates) {
+            return std::monostate{};
+        }
+        auto ssa_form = ssa::Function::build(function);
+        if (!ssa_form) {
+            OPTIMIZER_LOG_DEBUG("Numeric type inference skipped: function has no SSA form");
+            return std::monostate{};
         }
 
-        std::unordered_map<Register, std::vector<Size>>
-        DataFlowAnalysis::compute_use_def_chains(const BytecodeFunction& function) {
-            std::unordered_map<Register, std::vector<Size>> use_def_chains;
+        NumericTypes types(*ssa_form, function.constants);
+        types.solve();
 
-            // Build use-def chains by tracking definitions and uses
-            std::unordered_map<Register, Size> last_def;
+        Size typed = 0;
+        Size untyped = 0;
+        for (const auto& node : ssa_form->nodes()) {
+            Instruction instr = node.instruction;
+            OpCode op = InstructionEncoder::decode_opcode(instr);
+            OpCode typed_op = instruction_utils::number_typed_opcode(op);
+            if (typed_op == op || !ssa_form->blocks()[node.block].reachable) {
+                continue;
+            }
 
-            for (Size i = 0; i < function.instructions.size(); ++i) {
-                Instruction instr = function.instructions[i];
-                OpCode op = InstructionEncoder::decode_opcode(instr);
+            // Arithmetic reads B and C; comparisons read A and B
+            const bool comparison =
+                op == OpCode::OP_EQ || op == OpCode::OP_LT || op == OpCode::OP_LE;
+            Register left = comparison ? InstructionEncoder::decode_a(instr) : InstructionEncoder::decode_b(instr);
+            Register right = comparison ? InstructionEncoder::decode_b(instr) : InstructionEncoder::decode_c(instr);
+            if (types.operand(node, left) != NumericType::Number ||
+                types.operand(node, right) != NumericType::Number) {
+                ++untyped;
+                continue;
+            }
 
-                // Process uses first
-                switch (op) {
-                    case OpCode::OP_MOVE:
-                    case OpCode::OP_UNM:
-                    case OpCode::OP_NOT:
-                    case OpCode::OP_LEN:
-                    case OpCode::OP_BNOT: {
-                        Register b = InstructionEncoder::decode_b(instr);
-                        if (b < 255 && last_def.find(b) != last_def.end()) {
-                            use_def_chains[b].push_back(last_def[b]);
-                        }
-                        break;
-                    }
+            code[node.pc] = LuaInstruction(instr).with_opcode(typed_op).raw;
+            ++typed;
+        }
 
-                    case OpCode::OP_ADD:
-                    case OpCode::OP_SUB:
-                    case OpCode::OP_MUL:
-                    case OpCode::OP_DIV:
-                    case OpCode::OP_MOD:
-                    case OpCode::OP_POW:
-                    case OpCode::OP_BAND:
-                    case OpCode::OP_BOR:
-                    case OpCode::OP_BXOR:
-                    case OpCode::OP_SHL:
-                    case OpCode::OP_SHR: {
-                        Register b = InstructionEncoder::decode_b(instr);
-                        Register c = InstructionEncoder::decode_c(instr);
-
-                        if (b < 255 && last_def.find(b) != last_def.end()) {
-                            use_def_chains[b].push_back(last_def[b]);
-                        }
-                        if (c < 255 && last_def.find(c) != last_def.end()) {
-                            use_def_chains[c].push_back(last_def[c]);
-                        }
-                        break;
-                    }
+        counters_["typed"] += typed;
+        counters_["untyped"] += untyped;
+        OPTIMIZER_LOG_INFO("Numeric type inference completed, typed instructions: {}", typed);
+        return std::monostate{};
+    }
 
-                    default:
-                        break;
+    // SuperinstructionFusionPass Implementation
+    std::unordered_map<String, Size> SuperinstructionFusionPass::take_counters() {
+        return std::exchange(counters_, {});
+    }
+
+    Status SuperinstructionFusionPass::optimize(BytecodeFunction& function) {
+        OPTIMIZER_LOG_DEBUG("Starting superinstruction fusion");
+
+        auto& code = function.instructions;
+        const Size count = code.size();
+        auto opcode_at = [&](Size pc) { return InstructionEncoder::decode_opcode(code[pc]); };
+
+        // entries[pc]: instructions that branch or skip to pc instead of falling through
+        std::vector<std::vector<Size>> entries(count + 1);
+        for (Size pc = 0; pc < count; ++pc) {
+            if (auto target = optimization_analysis::branch_target(code, pc)) {
+                entries[*target].push_back(pc);
+            }
+            if (optimization_analysis::skips_next(opcode_at(pc)) && pc + 2 <= count) {
+                entries[pc + 2].push_back(pc);
+            }
+        }
+        auto entered_from_within = [&](Size pc, Size first, Size last) {
+            return std::ranges::all_of(entries[pc],
+                                       [&](Size source) { return source >= first && source <= last; });
+        };
+
+        // Liveness is only needed once a compare-and-branch sequence turns up
+        Optional<optimization_analysis::ControlFlowGraph> cfg;
+        auto live_at = [&](Register reg, Size pc) {
+            if (pc >= count) {
+                return false;
+            }
+            if (!cfg) {
+                cfg.emplace(function);
+                cfg->compute_liveness();
+            }
+            const auto& node = cfg->nodes()[cfg->block_of(pc)];
+            return node.start_instruction != pc || node.live_in.contains(reg);
+        };
+
+        std::vector<bool> removed(count, false);
+        Size compare_jumps = 0;
+        Size move_calls = 0;
+        for (Size pc = 0; pc + 1 < count; ++pc) {
+            Instruction instr = code[pc];
+            OpCode op = opcode_at(pc);
+
+            // LOADFALSE R; CMP a b 0; LOADTRUE R; TEST R 0; JMP -> CMPJMP a b (to the JMP's target)
+            if (op == OpCode::OP_LOADFALSE && pc + 4 < count) {
+                Register flag = InstructionEncoder::decode_a(instr);
+                Instruction compare = code[pc + 1];
+                OpCode fused = instruction_utils::compare_jump_opcode(opcode_at(pc + 1));
+                Register left = InstructionEncoder::decode_a(compare);
+                Register right = InstructionEncoder::decode_b(compare);
+                auto target = optimization_analysis::branch_target(code, pc + 4);
+
+                bool matches =
+                    instruction_utils::is_compare_jump(fused) &&
+                    InstructionEncoder::decode_c(compare) == 0 && left != flag && right != flag &&
+                    opcode_at(pc + 2) == OpCode::OP_LOADTRUE &&
+                    InstructionEncoder::decode_a(code[pc + 2]) == flag &&
+                    opcode_at(pc + 3) == OpCode::OP_TEST &&
+                    InstructionEncoder::decode_a(code[pc + 3]) == flag &&
+                    InstructionEncoder::decode_c(code[pc + 3]) == 0 &&
+                    opcode_at(pc + 4) == OpCode::OP_JMP && target && *target > pc + 4 &&
+                    *target - pc - 1 <= InstructionEncoder::MAX_C;
+                for (Size i = pc + 1; matches && i <= pc + 4; ++i) {
+                    matches = entered_from_within(i, pc, pc + 4);
                 }
 
-                // Process definition
-                Register a = InstructionEncoder::decode_a(instr);
-                if (a < 255) {
-                    last_def[a] = i;
+                // The flag is gone afterwards, so nothing may read it on either edge
+                if (matches && !live_at(flag, pc + 5) && !live_at(flag, *target)) {
+                    code[pc] = InstructionEncoder::encode_abc(
+                        fused, left, right, static_cast<Register>(*target - pc - 1));
+                    std::fill(removed.begin() + static_cast<std::ptrdiff_t>(pc + 1),
+                              removed.begin() + static_cast<std::ptrdiff_t>(pc + 5), true);
+                    ++compare_jumps;
+                    pc += 4;
+                    continue;
                 }
             }
 
-            return use_def_chains;
+            // MOVE R[A+1] R[B]; CALL A 2 C -> MOVECALL A B C
+            if (op == OpCode::OP_MOVE && opcode_at(pc + 1) == OpCode::OP_CALL) {
+                Instruction call = code[pc + 1];
+                Register base = InstructionEncoder::decode_a(call);
+                if (InstructionEncoder::decode_b(call) == 2 &&
+                    InstructionEncoder::decode_a(instr) == base + 1 && entries[pc + 1].empty()) {
+                    code[pc] = InstructionEncoder::encode_abc(OpCode::OP_MOVECALL, base,
+                                                              InstructionEncoder::decode_b(instr),
+                                                              InstructionEncoder::decode_c(call));
+                    removed[pc + 1] = true;
+                    ++move_calls;
+                    ++pc;
+                }
+            }
         }
 
-    }  // namespace optimization_analysis
+        optimization_analysis::remove_instructions(function, removed);
+
+        counters_["compare_jumps"] += compare_jumps;
+        counters_["move_calls"] += move_calls;
+        OPTIMIZER_LOG_INFO("Superinstruction fusion completed, fused sequences: {}",
+                           compare_jumps + move_calls);
+        return std::monostate{};
+    }
 
 }  // namespace rangelua::backend
@@ -0,0 +1,981 @@
+/**
+ * @file ssa.cpp
+ * @brief SSA construction, SSA passes and lowering back to register bytecode
+ * @version 0.1.0
+ */
+
+#include <rangelua/backend/ssa.hpp>
+#include <rangelua/utils/logger.hpp>
+
+#include <cmath>
+#include <cstring>
+
+namespace rangelua::backend::ssa {
+
+    namespace {
+
+        using optimization_analysis::register_effects;
+
+        bool is_load(OpCode op) noexcept {
+            switch (op) {
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                case OpCode::OP_LOADK:
+                case OpCode::OP_LOADTRUE:
+                case OpCode::OP_LOADFALSE:
+                case OpCode::OP_LOADNIL:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * @brief Instructions that cannot fail, call metamethods or touch memory other than registers
+         */
+        bool is_pure(OpCode op) noexcept {
+            return is_load(op) || op == OpCode::OP_MOVE || op == OpCode::OP_NOT ||
+                   op == OpCode::OP_GETUPVAL;
+        }
+
+        /**
+         * @brief Identical constants: same type and, for numbers, the same bits
+         */
+        bool same_constant(const ConstantValue& left, const ConstantValue& right) {
+            if (left.index() != right.index()) {
+                return false;
+            }
+            if (const auto* x = std::get_if<Number>(&left)) {
+                Number y = std::get<Number>(right);
+                return std::memcmp(x, &y, sizeof(Number)) == 0;
+            }
+            return left == right;
+        }
+
+        bool is_truthy(const ConstantValue& value) {
+            if (std::holds_alternative<std::monostate>(value)) {
+                return false;
+            }
+            if (const auto* flag = std::get_if<bool>(&value)) {
+                return *flag;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Value a load instruction puts in its register
+         */
+        Optional<ConstantValue> loaded_constant(Instruction instr, const std::vector<ConstantValue>& constants) {
+            switch (InstructionEncoder::decode_opcode(instr)) {
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                    return ConstantValue{static_cast<Number>(InstructionEncoder::decode_sbx(instr))};
+                case OpCode::OP_LOADK: {
+                    Size index = InstructionEncoder::decode_bx(instr);
+                    if (index >= constants.size()) {
+                        return std::nullopt;
+                    }
+                    if (const auto* integer = std::get_if<Int>(&constants[index])) {
+                        return ConstantValue{static_cast<Number>(*integer)};
+                    }
+                    return constants[index];
+                }
+                case OpCode::OP_LOADTRUE:
+                    return ConstantValue{true};
+                case OpCode::OP_LOADFALSE:
+                    return ConstantValue{false};
+                case OpCode::OP_LOADNIL:
+                    return ConstantValue{std::monostate{}};
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        /**
+         * @brief Value a node read from a register, or NO_VALUE
+         */
+        ValueId use_of(const Node& node, Register reg) {
+            for (Size i = 0; i < node.use_registers.size(); ++i) {
+                if (node.use_registers[i] == reg) {
+                    return node.uses[i];
+                }
+            }
+            return NO_VALUE;
+        }
+
+        /**
+         * @brief Rename the plain register operands equal to from
+         * @return nullopt if from is also read in a way that cannot be renamed
+         */
+        Optional<Instruction> rename_operand(Instruction instr, Register from, Register to) {
+            OpCode op = InstructionEncoder::decode_opcode(instr);
+            Register a = InstructionEncoder::decode_a(instr);
+            Register b = InstructionEncoder::decode_b(instr);
+            Register c = InstructionEncoder::decode_c(instr);
+            bool rename_a = false;
+            bool rename_b = false;
+            bool rename_c = false;
+
+            switch (op) {
+                case OpCode::OP_MOVE:
+                case OpCode::OP_GETI:
+                case OpCode::OP_GETFIELD:
+                case OpCode::OP_UNM:
+                case OpCode::OP_BNOT:
+                case OpCode::OP_NOT:
+                case OpCode::OP_LEN:
+                case OpCode::OP_SELF:
+                    rename_b = true;
+                    break;
+                case OpCode::OP_TESTSET:
+                    // A is read too (it keeps its value when the test fails)
+                    if (a == from) {
+                        return std::nullopt;
+                    }
+                    rename_b = true;
+                    break;
+                case OpCode::OP_GETTABLE:
+                case OpCode::OP_ADD:
+                case OpCode::OP_SUB:
+                case OpCode::OP_MUL:
+                case OpCode::OP_MOD:
+                case OpCode::OP_POW:
+                case OpCode::OP_DIV:
+                case OpCode::OP_IDIV:
+                case OpCode::OP_BAND:
+                case OpCode::OP_BOR:
+                case OpCode::OP_BXOR:
+                case OpCode::OP_SHL:
+                case OpCode::OP_SHR:
+                    rename_b = rename_c = true;
+                    break;
+                case OpCode::OP_SETTABLE:
+                    rename_a = rename_b = rename_c = true;
+                    break;
+                case OpCode::OP_SETI:
+                case OpCode::OP_SETFIELD:
+                    rename_a = rename_c = true;
+                    break;
+                case OpCode::OP_SETTABUP:
+                    rename_c = true;
+                    break;
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                    rename_a = rename_b = true;
+                    break;
+                case OpCode::OP_SETUPVAL:
+                case OpCode::OP_EQK:
+                case OpCode::OP_EQI:
+                case OpCode::OP_LTI:
+                case OpCode::OP_LEI:
+                case OpCode::OP_GTI:
+                case OpCode::OP_GEI:
+                case OpCode::OP_TEST:
+                case OpCode::OP_RETURN1:
+                    rename_a = true;
+                    break;
+                default:
+                    return std::nullopt;
+            }
+
+            if (rename_a && a == from) {
+                a = to;
+            }
+            if (rename_b && b == from) {
+                b = to;
+            }
+            if (rename_c && c == from) {
+                c = to;
+            }
+            return InstructionEncoder::encode_abc(op, a, b, c);
+        }
+
+    }  // namespace
+
+    /**
+     * @brief SSA construction after Braun et al., "Simple and Efficient Construction of SSA Form"
+     *
+     * Blocks are filled in code order. A block is sealed once all of its
+     * predecessors are filled; reads in unsealed blocks (loop headers) create
+     * incomplete phis that get their operands when the block is sealed.
+     */
+    class Function::Builder {
+    public:
+        Builder(Function& function, const BytecodeFunction& source)
+            : f_(function), source_(source) {}
+
+        void build(const optimization_analysis::ControlFlowGraph& cfg) {
+            registers_ = f_.register_count_;
+
+            // Blocks and edges come from the shared CFG; only edges from reachable blocks matter
+            for (Size b = 0; b < cfg.node_count(); ++b) {
+                const auto& node = cfg.nodes()[b];
+                Block block{node.start_instruction,
+                            node.end_instruction + 1,
+                            {},
+                            node.successors,
+                            {},
+                            cfg.is_reachable(b)};
+                for (Size predecessor : node.predecessors) {
+                    if (cfg.is_reachable(predecessor)) {
+                        block.predecessors.push_back(predecessor);
+                    }
+                }
+                f_.blocks_.push_back(std::move(block));
+            }
+
+            const Size block_count = f_.blocks_.size();
+            current_.assign(block_count * registers_, NO_VALUE);
+            entry_.assign(registers_, NO_VALUE);
+            sealed_.assign(block_count, false);
+            filled_.assign(block_count, false);
+            incomplete_.resize(block_count);
+
+            const auto& code = source_.instructions;
+            f_.nodes_.resize(code.size());
+            for (Size b = 0; b < block_count; ++b) {
+                if (!f_.blocks_[b].reachable) {
+                    for (Size pc = f_.blocks_[b].first; pc < f_.blocks_[b].last; ++pc) {
+                        f_.nodes_[pc] = Node{pc, code[pc], b, {}, {}, {}, {}, {}, false, false, false};
+                    }
+                }
+            }
+
+            // Reverse postorder fills every block's forward predecessors first,
+            // so only loop headers get incomplete phis
+            for (Size b : cfg.reverse_postorder()) {
+                try_seal(b);
+                for (Size pc = f_.blocks_[b].first; pc < f_.blocks_[b].last; ++pc) {
+                    fill_node(b, pc);
+                }
+                filled_[b] = true;
+                try_seal(b);
+                for (Size s : f_.blocks_[b].successors) {
+                    try_seal(s);
+                }
+            }
+
+            remove_trivial_phis();
+        }
+
+    private:
+        Function& f_;
+        const BytecodeFunction& source_;
+        Size registers_ = 0;
+        std::vector<ValueId> current_;  // Latest value of each register, per block
+        std::vector<ValueId> entry_;
+        std::vector<bool> sealed_;
+        std::vector<bool> filled_;
+        std::vector<std::vector<std::pair<Register, ValueId>>> incomplete_;
+
+        ValueId& current(Size block, Register reg) { return current_[block * registers_ + reg]; }
+
+        ValueId new_value(ValueKind kind, Register reg, Size block, Size node = 0) {
+            f_.values_.push_back(Value{kind, reg, block, node, {}, NO_VALUE});
+            return static_cast<ValueId>(f_.values_.size() - 1);
+        }
+
+        ValueId new_phi(Register reg, Size block) {
+            ValueId phi = new_value(ValueKind::Phi, reg, block);
+            f_.blocks_[block].phis.push_back(phi);
+            return phi;
+        }
+
+        ValueId entry_value(Register reg) {
+            if (entry_[reg] == NO_VALUE) {
+                entry_[reg] = new_value(ValueKind::Entry, reg, 0);
+            }
+            return entry_[reg];
+        }
+
+        void fill_node(Size block, Size pc) {
+            const auto& code = source_.instructions;
+            Node node;
+            node.pc = pc;
+            node.instruction = code[pc];
+            node.block = block;
+            node.removable = pc == 0 || !optimization_analysis::skips_next(
+                                            InstructionEncoder::decode_opcode(code[pc - 1]));
+
+            auto effects = register_effects(code[pc]);
+            for (Size i = 0; i < effects->read_count; ++i) {
+                const auto& range = effects->reads[i];
+                for (Size r = range.first; r < range.end(registers_); ++r) {
+                    if (f_.tracked_[r]) {
+                        node.use_registers.push_back(static_cast<Register>(r));
+                        node.uses.push_back(read(static_cast<Register>(r), block));
+                    }
+                }
+            }
+            for (Size i = 0; i < effects->write_count; ++i) {
+                const auto& range = effects->writes[i];
+                if (range.first >= registers_) {
+                    node.removable = false;
+                }
+                for (Size r = range.first; r < range.end(registers_); ++r) {
+                    auto reg = static_cast<Register>(r);
+                    if (!f_.tracked_[r]) {
+                        node.removable = false;
+                        continue;
+                    }
+                    node.previous.push_back(read(reg, block));
+                    ValueId def = new_value(ValueKind::Def, reg, block, pc);
+                    node.def_registers.push_back(reg);
+                    node.defs.push_back(def);
+                    current(block, reg) = def;
+                }
+            }
+            f_.nodes_[pc] = std::move(node);
+        }
+
+        ValueId read(Register reg, Size block) {
+            ValueId value = current(block, reg);
+            if (value != NO_VALUE) {
+                return f_.resolve(value);
+            }
+            return read_recursive(reg, block);
+        }
+
+        ValueId read_recursive(Register reg, Size block) {
+            // Chains of single-predecessor blocks are walked without recursion
+            std::vector<Size> chain;
+            Size b = block;
+            ValueId value = NO_VALUE;
+
+            while (true) {
+                if (b != block && current(b, reg) != NO_VALUE) {
+                    value = f_.resolve(current(b, reg));
+                    break;
+                }
+                const auto& predecessors = f_.blocks_[b].predecessors;
+                if (!sealed_[b]) {
+                    value = new_phi(reg, b);
+                    incomplete_[b].emplace_back(reg, value);
+                    break;
+                }
+                if (b == 0 && predecessors.empty()) {
+                    value = entry_value(reg);
+                    break;
+                }
+                if (b != 0 && predecessors.size() == 1) {
+                    chain.push_back(b);
+                    b = predecessors[0];
+                    continue;
+                }
+                // Join point; recording the phi first breaks cycles through loops
+                ValueId phi = new_phi(reg, b);
+                current(b, reg) = phi;
+                value = add_phi_operands(reg, phi);
+                break;
+            }
+
+            current(b, reg) = value;
+            for (Size c : chain) {
+                current(c, reg) = value;
+            }
+            return value;
+        }
+
+        ValueId add_phi_operands(Register reg, ValueId phi) {
+            Size block = f_.values_[phi].block;
+            if (block == 0) {
+                f_.values_[phi].operands.push_back(entry_value(reg));
+            }
+            for (Size i = 0; i < f_.blocks_[block].predecessors.size(); ++i) {
+                ValueId operand = read(reg, f_.blocks_[block].predecessors[i]);
+                f_.values_[phi].operands.push_back(operand);
+            }
+            return try_remove_trivial_phi(phi);
+        }
+
+        ValueId try_remove_trivial_phi(ValueId phi) {
+            ValueId same = NO_VALUE;
+            for (ValueId operand : f_.values_[phi].operands) {
+                operand = f_.resolve(operand);
+                if (operand == same || operand == phi) {
+                    continue;
+                }
+                if (same != NO_VALUE) {
+                    return phi;
+                }
+                same = operand;
+            }
+            if (same == NO_VALUE) {
+                // Only reachable through itself: the register is never set on the way in
+                same = entry_value(f_.values_[phi].reg);
+            }
+            f_.values_[phi].replaced_by = same;
+            return same;
+        }
+
+        void try_seal(Size block) {
+            if (sealed_[block] || !f_.blocks_[block].reachable) {
+                return;
+            }
+            for (Size predecessor : f_.blocks_[block].predecessors) {
+                if (!filled_[predecessor]) {
+                    return;
+                }
+            }
+            sealed_[block] = true;
+            auto pending = std::move(incomplete_[block]);
+            for (const auto& [reg, phi] : pending) {
+                add_phi_operands(reg, phi);
+            }
+        }
+
+        void remove_trivial_phis() {
+            // Removing a phi can make phis that use it trivial
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto& block : f_.blocks_) {
+                    for (ValueId phi : block.phis) {
+                        if (f_.values_[phi].replaced_by == NO_VALUE &&
+                            try_remove_trivial_phi(phi) != phi) {
+                            changed = true;
+                        }
+                    }
+                }
+            }
+            for (auto& block : f_.blocks_) {
+                std::erase_if(block.phis,
+                              [&](ValueId phi) { return f_.values_[phi].replaced_by != NO_VALUE; });
+            }
+        }
+    };
+
+    Optional<Function> Function::build(const BytecodeFunction& function) {
+        auto captured = optimization_analysis::captured_registers(function);
+        if (!captured) {
+            return std::nullopt;
+        }
+        for (Instruction instr : function.instructions) {
+            if (!register_effects(instr)) {
+                return std::nullopt;
+            }
+        }
+
+        optimization_analysis::ControlFlowGraph cfg(function);
+        Function result;
+        result.constants_ = function.constants;
+        result.register_count_ = cfg.frame_size();
+        result.tracked_.assign(result.register_count_, true);
+        for (Register reg : *captured) {
+            if (reg < result.register_count_) {
+                result.tracked_[reg] = false;
+            }
+        }
+
+        if (!function.instructions.empty()) {
+            Builder builder(result, function);
+            builder.build(cfg);
+        }
+        return result;
+    }
+
+    ValueId Function::resolve(ValueId id) const noexcept {
+        while (values_[id].replaced_by != NO_VALUE) {
+            id = values_[id].replaced_by;
+        }
+        return id;
+    }
+
+    void Function::replace_value(ValueId from, ValueId to) {
+        from = resolve(from);
+        to = resolve(to);
+        if (from != to) {
+            values_[from].replaced_by = to;
+        }
+    }
+
+    void Function::rewrite(Size node, Instruction instruction, Register source, ValueId source_value) {
+        Node& target = nodes_[node];
+        std::vector<Register> use_registers;
+        std::vector<ValueId> uses;
+
+        auto effects = register_effects(instruction);
+        for (Size i = 0; effects && i < effects->read_count; ++i) {
+            const auto& range = effects->reads[i];
+            for (Size r = range.first; r < range.end(register_count_); ++r) {
+                if (!tracked_[r]) {
+                    continue;
+                }
+                auto reg = static_cast<Register>(r);
+                ValueId value = (source_value != NO_VALUE && reg == source) ? source_value
+                                                                             : use_of(target, reg);
+                if (value != NO_VALUE) {
+                    use_registers.push_back(reg);
+                    uses.push_back(value);
+                }
+            }
+        }
+
+        target.instruction = instruction;
+        target.use_registers = std::move(use_registers);
+        target.uses = std::move(uses);
+        target.rewritten = true;
+    }
+
+    void Function::remove(Size node) {
+        Node& target = nodes_[node];
+        target.removed = true;
+        target.use_registers.clear();
+        target.uses.clear();
+    }
+
+    const ConstantValue* Function::constant(ValueId id) const {
+        id = resolve(id);
+        return id < constant_values_.size() && constant_values_[id] ? &*constant_values_[id]
+                                                                    : nullptr;
+    }
+
+    void Function::set_constant(ValueId id, ConstantValue value) {
+        id = resolve(id);
+        if (id >= constant_values_.size()) {
+            constant_values_.resize(values_.size());
+        }
+        constant_values_[id] = std::move(value);
+    }
+
+    Size Function::lower(BytecodeFunction& function) const {
+        std::vector<bool> removed(function.instructions.size(), false);
+        bool any_removed = false;
+        for (const auto& node : nodes_) {
+            if (node.removed) {
+                removed[node.pc] = true;
+                any_removed = true;
+            } else if (node.rewritten) {
+                function.instructions[node.pc] = node.instruction;
+            }
+        }
+        function.constants = constants_;
+        return any_removed ? optimization_analysis::remove_instructions(function, removed) : 0;
+    }
+
+    // ConstantPropagationPass Implementation
+    Size ConstantPropagationPass::run(Function& function) {
+        enum class State : std::uint8_t { Unknown, Constant, Varying };
+
+        const Size count = function.value_count();
+        std::vector<State> state(count, State::Unknown);
+        std::vector<ConstantValue> constant(count);
+        std::vector<std::vector<ValueId>> users(count);
+        std::vector<ValueId> worklist;
+
+        // Def-use edges between representative values
+        for (const auto& block : function.blocks()) {
+            for (ValueId phi : block.phis) {
+                for (ValueId operand : function.value(phi).operands) {
+                    users[function.resolve(operand)].push_back(phi);
+                }
+                worklist.push_back(phi);
+            }
+        }
+        for (const auto& node : function.nodes()) {
+            if (node.removed) {
+                continue;
+            }
+            for (ValueId def : node.defs) {
+                for (ValueId use : node.uses) {
+                    users[function.resolve(use)].push_back(def);
+                }
+                worklist.push_back(def);
+            }
+        }
+
+        auto evaluate = [&](ValueId id) -> std::pair<State, ConstantValue> {
+            const Value& value = function.value(id);
+            if (value.kind == ValueKind::Entry || value.replaced_by != NO_VALUE) {
+                return {State::Varying, {}};
+            }
+
+            if (value.kind == ValueKind::Phi) {
+                State result = State::Unknown;
+                ConstantValue merged;
+                for (ValueId operand : value.operands) {
+                    operand = function.resolve(operand);
+                    if (operand == id || state[operand] == State::Unknown) {
+                        continue;
+                    }
+                    if (state[operand] == State::Varying ||
+                        (result == State::Constant && !same_constant(merged, constant[operand]))) {
+                        return {State::Varying, {}};
+                    }
+                    result = State::Constant;
+                    merged = constant[operand];
+                }
+                return {result, merged};
+            }
+
+            const Node& node = function.nodes()[value.node];
+            Instruction instr = node.instruction;
+            OpCode op = InstructionEncoder::decode_opcode(instr);
+            auto operand = [&](Register reg) -> Optional<ConstantValue> {
+                ValueId use = use_of(node, reg);
+                if (use == NO_VALUE || state[function.resolve(use)] != State::Constant) {
+                    return std::nullopt;
+                }
+                return constant[function.resolve(use)];
+            };
+            auto operand_unknown = [&](Register reg) {
+                ValueId use = use_of(node, reg);
+                return use != NO_VALUE && state[function.resolve(use)] == State::Unknown;
+            };
+
+            if (auto loaded = loaded_constant(instr, function.constants())) {
+                return {State::Constant, *loaded};
+            }
+
+            Register b = InstructionEncoder::decode_b(instr);
+            Register c = InstructionEncoder::decode_c(instr);
+            switch (op) {
+                case OpCode::OP_MOVE:
+                case OpCode::OP_NOT:
+                case OpCode::OP_UNM: {
+                    if (operand_unknown(b)) {
+                        return {State::Unknown, {}};
+                    }
+                    auto source = operand(b);
+                    if (!source) {
+                        break;
+                    }
+                    if (op == OpCode::OP_MOVE) {
+                        return {State::Constant, *source};
+                    }
+                    if (op == OpCode::OP_NOT) {
+                        return {State::Constant, ConstantValue{!is_truthy(*source)}};
+                    }
+                    if (const auto* number = std::get_if<Number>(&*source)) {
+                        return {State::Constant, ConstantValue{-*number}};
+                    }
+                    break;
+                }
+                case OpCode::OP_ADD:
+                case OpCode::OP_SUB:
+                case OpCode::OP_MUL:
+                case OpCode::OP_DIV: {
+                    if (operand_unknown(b) || operand_unknown(c)) {
+                        return {State::Unknown, {}};
+                    }
+                    auto left = operand(b);
+                    auto right = operand(c);
+                    const auto* x = left ? std::get_if<Number>(&*left) : nullptr;
+                    const auto* y = right ? std::get_if<Number>(&*right) : nullptr;
+                    if (x == nullptr || y == nullptr) {
+                        break;
+                    }
+                    // Numbers are doubles in the VM, so these match runtime results exactly
+                    switch (op) {
+                        case OpCode::OP_ADD:
+                            return {State::Constant, ConstantValue{*x + *y}};
+                        case OpCode::OP_SUB:
+                            return {State::Constant, ConstantValue{*x - *y}};
+                        case OpCode::OP_MUL:
+                            return {State::Constant, ConstantValue{*x * *y}};
+                        default:
+                            if (*y == 0.0) {
+                                break;
+                            }
+                            return {State::Constant, ConstantValue{*x / *y}};
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            return {State::Varying, {}};
+        };
+
+        while (!worklist.empty()) {
+            ValueId id = worklist.back();
+            worklist.pop_back();
+            if (state[id] == State::Varying) {
+                continue;
+            }
+
+            auto [next, value] = evaluate(id);
+            if (next == State::Constant && state[id] == State::Constant &&
+                !same_constant(value, constant[id])) {
+                next = State::Varying;
+            }
+            if (next == state[id]) {
+                continue;
+            }
+            state[id] = next;
+            constant[id] = std::move(value);
+            for (ValueId user : users[id]) {
+                worklist.push_back(user);
+            }
+        }
+
+        // Values still Unknown only depend on themselves through loops and are never set
+        Size changes = 0;
+        for (ValueId id = 0; id < count; ++id) {
+            if (state[id] == State::Constant) {
+                function.set_constant(id, constant[id]);
+            }
+        }
+        for (Size i = 0; i < function.nodes().size(); ++i) {
+            const Node& node = function.nodes()[i];
+            OpCode op = InstructionEncoder::decode_opcode(node.instruction);
+            if (node.removed || node.defs.size() != 1 || is_load(op) ||
+                state[node.defs[0]] != State::Constant) {
+                continue;
+            }
+            auto load = optimization_analysis::load_constant(
+                function.constants(), node.def_registers[0], constant[node.defs[0]]);
+            if (load && *load != node.instruction) {
+                function.rewrite(i, *load);
+                ++changes;
+            }
+        }
+
+        OPTIMIZER_LOG_DEBUG("SSA constant propagation: {} instructions rematerialized", changes);
+        return changes;
+    }
+
+    // CopyPropagationPass Implementation
+    Size CopyPropagationPass::run(Function& function) {
+        Size changes = 0;
+        auto& nodes = function.nodes();
+
+        // Node index of the latest write to each register in the current block
+        std::vector<Size> last_write(function.register_count(), 0);
+        std::vector<Size> written_in(function.register_count(), SIZE_MAX);
+
+        for (Size b = 0; b < function.blocks().size(); ++b) {
+            const Block& block = function.blocks()[b];
+            if (!block.reachable) {
+                continue;
+            }
+
+            for (Size i = block.first; i < block.last; ++i) {
+                if (nodes[i].removed) {
+                    continue;
+                }
+
+                for (Size u = 0; u < nodes[i].uses.size(); ++u) {
+                    const Value& used = function.value(function.resolve(nodes[i].uses[u]));
+                    if (used.kind != ValueKind::Def || used.block != b) {
+                        continue;
+                    }
+                    const Node& copy = nodes[used.node];
+                    if (copy.removed || copy.uses.empty() ||
+                        InstructionEncoder::decode_opcode(copy.instruction) != OpCode::OP_MOVE) {
+                        continue;
+                    }
+
+                    Register reg = nodes[i].use_registers[u];
+                    Register source = copy.use_registers[0];
+                    bool source_kept = written_in[source] != b || last_write[source] < used.node;
+                    if (source == reg || !source_kept) {
+                        continue;
+                    }
+                    auto renamed = rename_operand(nodes[i].instruction, reg, source);
+                    if (!renamed) {
+                        continue;
+                    }
+                    function.rewrite(i, *renamed, source, function.resolve(copy.uses[0]));
+                    ++changes;
+                    break;  // Use lists changed; later uses are handled on the next run
+                }
+
+                for (Register reg : nodes[i].def_registers) {
+                    last_write[reg] = i;
+                    written_in[reg] = b;
+                }
+            }
+        }
+
+        OPTIMIZER_LOG_DEBUG("SSA copy propagation: {} operands renamed", changes);
+        return changes;
+    }
+
+    // GlobalValueNumberingPass Implementation
+    Size GlobalValueNumberingPass::run(Function& function) {
+        constexpr Size NONE = SIZE_MAX;
+        std::vector<Size> number(function.value_count(), NONE);
+        std::unordered_map<String, Size> table;
+        Size next = 0;
+        Size changes = 0;
+
+        auto number_of = [&](ValueId id) {
+            id = function.resolve(id);
+            if (number[id] == NONE) {
+                number[id] = next++;
+            }
+            return number[id];
+        };
+        auto constant_key = [](const ConstantValue& value) {
+            String key(1, static_cast<char>('0' + value.index()));
+            if (const auto* x = std::get_if<Number>(&value)) {
+                key.append(reinterpret_cast<const char*>(x), sizeof(Number));
+            } else if (const auto* text = std::get_if<String>(&value)) {
+                key += *text;
+            } else if (const auto* flag = std::get_if<bool>(&value)) {
+                key += *flag ? '1' : '0';
+            }
+            return key;
+        };
+        auto lookup = [&](const String& key) {
+            auto [it, inserted] = table.emplace(key, next);
+            if (inserted) {
+                ++next;
+            }
+            return it->second;
+        };
+
+        for (Size b = 0; b < function.blocks().size(); ++b) {
+            const Block& block = function.blocks()[b];
+            if (!block.reachable) {
+                continue;
+            }
+
+            // Phis whose operands are all congruent take their number; others are new
+            for (ValueId phi : block.phis) {
+                Size common = NONE;
+                bool congruent = true;
+                for (ValueId operand : function.value(phi).operands) {
+                    operand = function.resolve(operand);
+                    if (operand == phi) {
+                        continue;
+                    }
+                    if (number[operand] == NONE || (common != NONE && number[operand] != common)) {
+                        congruent = false;
+                        break;
+                    }
+                    common = number[operand];
+                }
+                number[phi] = congruent && common != NONE ? common : next++;
+            }
+
+            for (Size i = block.first; i < block.last; ++i) {
+                const Node& node = function.nodes()[i];
+                if (node.removed) {
+                    continue;
+                }
+                OpCode op = InstructionEncoder::decode_opcode(node.instruction);
+
+                for (ValueId def : node.defs) {
+                    if (const ConstantValue* known = function.constant(def)) {
+                        number[def] = lookup(constant_key(*known));
+                    } else if (auto loaded = loaded_constant(node.instruction, function.constants())) {
+                        number[def] = lookup(constant_key(*loaded));
+                    } else if (op == OpCode::OP_MOVE && !node.uses.empty()) {
+                        number[def] = number_of(node.uses[0]);
+                    } else if (op == OpCode::OP_NOT && !node.uses.empty()) {
+                        Size operand = number_of(node.uses[0]);
+                        String key(1, '!');
+                        key.append(reinterpret_cast<const char*>(&operand), sizeof(operand));
+                        number[def] = lookup(key);
+                    } else {
+                        number[def] = next++;
+                    }
+                }
+
+                // The register already holds a congruent value: the definition is redundant
+                if (node.removable && node.defs.size() == 1 && is_pure(op) &&
+                    op != OpCode::OP_GETUPVAL) {
+                    ValueId before = function.resolve(node.previous[0]);
+                    if (number_of(before) == number[node.defs[0]]) {
+                        function.replace_value(node.defs[0], before);
+                        function.remove(i);
+                        ++changes;
+                    }
+                }
+            }
+        }
+
+        OPTIMIZER_LOG_DEBUG("SSA value numbering: {} redundant definitions removed", changes);
+        return changes;
+    }
+
+    // DeadDefinitionEliminationPass Implementation
+    Size DeadDefinitionEliminationPass::run(Function& function) {
+        std::vector<bool> live(function.value_count(), false);
+        std::vector<ValueId> worklist;
+
+        auto mark = [&](ValueId id) {
+            id = function.resolve(id);
+            if (!live[id]) {
+                live[id] = true;
+                worklist.push_back(id);
+            }
+        };
+        auto removable = [](const Node& node) {
+            return node.removable && is_pure(InstructionEncoder::decode_opcode(node.instruction));
+        };
+
+        for (const auto& node : function.nodes()) {
+            if (!node.removed && !removable(node)) {
+                for (ValueId use : node.uses) {
+                    mark(use);
+                }
+            }
+        }
+        while (!worklist.empty()) {
+            const Value& value = function.value(worklist.back());
+            worklist.pop_back();
+            if (value.kind == ValueKind::Phi) {
+                for (ValueId operand : value.operands) {
+                    mark(operand);
+                }
+            } else if (value.kind == ValueKind::Def) {
+                for (ValueId use : function.nodes()[value.node].uses) {
+                    mark(use);
+                }
+            }
+        }
+
+        Size changes = 0;
+        for (Size i = 0; i < function.nodes().size(); ++i) {
+            const Node& node = function.nodes()[i];
+            if (node.removed || !removable(node)) {
+                continue;
+            }
+            bool used = std::any_of(node.defs.begin(), node.defs.end(),
+                                    [&](ValueId def) { return live[function.resolve(def)]; });
+            if (!used) {
+                function.remove(i);
+                ++changes;
+            }
+        }
+
+        OPTIMIZER_LOG_DEBUG("SSA dead definitions: {} instructions removed", changes);
+        return changes;
+    }
+
+    // PassManager Implementation
+    void PassManager::add_pass(UniquePtr<Pass> pass) {
+        passes_.push_back(std::move(pass));
+    }
+
+    Size PassManager::run(Function& function, Size max_rounds) {
+        Size total = 0;
+        for (Size round = 0; round < max_rounds; ++round) {
+            Size round_changes = 0;
+            for (const auto& pass : passes_) {
+                Size changes = pass->run(function);
+                statistics_[String{pass->name()}] += changes;
+                round_changes += changes;
+            }
+            total += round_changes;
+            if (round_changes == 0) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    PassManager PassManager::create_default() {
+        PassManager manager;
+        manager.add_pass(std::make_unique<ConstantPropagationPass>());
+        manager.add_pass(std::make_unique<CopyPropagationPass>());
+        manager.add_pass(std::make_unique<GlobalValueNumberingPass>());
+        manager.add_pass(std::make_unique<DeadDefinitionEliminationPass>());
+        return manager;
+    }
+
+}  // namespace rangelua::backend::ssa
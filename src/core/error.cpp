@@ -96,12 +96,12 @@ namespace rangelua {
          * @brief Format source location for display
          */
         [[maybe_unused]] String format_source_location(const SourceLocation& loc) {
-            if (loc.filename_.empty()) {
+            if (loc.filename().empty()) {
                 return "<unknown>";
             }
 
             std::ostringstream oss;
-            oss << loc.filename_;
+            oss << loc.filename();
             if (loc.line_ > 0) {
                 oss << ":" << loc.line_;
                 if (loc.column_ > 0) {
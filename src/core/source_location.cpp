@@ -0,0 +1,46 @@
+/**
+ * @file source_location.cpp
+ * @brief File name table behind compact source locations
+ * @version 0.1.0
+ */
+
+#include <rangelua/core/types.hpp>
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace rangelua {
+
+    namespace {
+        struct FileTable {
+            std::mutex mutex;
+            // A deque never relocates its elements, so views into the names stay valid
+            std::deque<String> names{String{}};
+            std::unordered_map<StringView, SourceFileTable::FileId> ids{{StringView{}, 0}};
+        };
+
+        FileTable& file_table() {
+            static FileTable table;
+            return table;
+        }
+    }  // namespace
+
+    SourceFileTable::FileId SourceFileTable::intern(StringView filename) {
+        auto& table = file_table();
+        std::lock_guard lock(table.mutex);
+        if (auto it = table.ids.find(filename); it != table.ids.end()) {
+            return it->second;
+        }
+        const auto id = static_cast<FileId>(table.names.size());
+        table.ids.emplace(table.names.emplace_back(filename), id);
+        return id;
+    }
+
+    StringView SourceFileTable::name(FileId id) noexcept {
+        auto& table = file_table();
+        std::lock_guard lock(table.mutex);
+        return id < table.names.size() ? StringView{table.names[id]} : StringView{};
+    }
+
+}  // namespace rangelua
@@ -0,0 +1,79 @@
+/**
+ * @file arena.cpp
+ * @brief Block management for the AST arena
+ * @version 0.1.0
+ */
+
+#include <rangelua/frontend/arena.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace rangelua::frontend {
+
+    namespace {
+        thread_local ASTArena* current_arena = nullptr;
+    }  // namespace
+
+    void* ASTArena::allocate_block(Size size, Size alignment) {
+        // Oversized requests get a block of their own and leave the bump block untouched
+        const Size needed = size + alignment;
+        if (cursor_ != nullptr && needed > next_block_size_ / 2) {
+            auto& block = blocks_.emplace_back(new std::byte[needed]);
+            bytes_reserved_ += needed;
+            bytes_used_ += size;
+            auto address = (reinterpret_cast<std::uintptr_t>(block.get()) + alignment - 1) &
+                           ~(static_cast<std::uintptr_t>(alignment) - 1);
+            return reinterpret_cast<void*>(address);
+        }
+
+        const Size block_size = std::max(next_block_size_, needed);
+        // make_unique would zero the block; only the bytes handed out are ever written
+        auto& block = blocks_.emplace_back(new std::byte[block_size]);
+        bytes_reserved_ += block_size;
+        next_block_size_ = std::min(next_block_size_ * 2, config::MAX_AST_ARENA_BLOCK_SIZE);
+        bump_block_ = block.get();
+        cursor_ = bump_block_;
+        limit_ = cursor_ + block_size;
+        return allocate(size, alignment);
+    }
+
+    void ASTArena::reset() noexcept {
+        peak_bytes_used_ = peak_bytes_used();
+        bytes_used_ = 0;
+        if (cursor_ == nullptr) {
+            return;
+        }
+        // Keep the block being bumped through, the largest so far, and free the rest
+        auto kept = std::find_if(blocks_.begin(), blocks_.end(), [this](const auto& block) {
+            return block.get() == bump_block_;
+        });
+        std::unique_ptr<std::byte[]> block = std::move(*kept);
+        blocks_.clear();
+        blocks_.push_back(std::move(block));
+        bytes_reserved_ = static_cast<Size>(limit_ - bump_block_);
+        cursor_ = bump_block_;
+    }
+
+    StringView ASTArena::intern(StringView text) {
+        if (text.empty()) {
+            return {};
+        }
+        auto* copy = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(copy, text.data(), text.size());
+        return {copy, text.size()};
+    }
+
+    ASTArena* ASTArena::current() noexcept {
+        return current_arena;
+    }
+
+    ASTArena::Scope::Scope(ASTArena& arena) noexcept : previous_(current_arena) {
+        current_arena = &arena;
+    }
+
+    ASTArena::Scope::~Scope() {
+        current_arena = previous_;
+    }
+
+}  // namespace rangelua::frontend
@@ -4,14 +4,20 @@
  * @version 0.1.0
  */
 
+#include <rangelua/core/config.hpp>
 #include <rangelua/frontend/lexer.hpp>
+#include <rangelua/frontend/number_literal.hpp>
+#include <rangelua/frontend/scanner.hpp>
 #include <rangelua/utils/logger.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <charconv>
+#include <deque>
+#include <functional>
 #include <sstream>
-#include <unordered_map>
+#include <unordered_set>
 
 namespace rangelua::frontend {
 
@@ -57,10 +63,6 @@ namespace rangelua::frontend {
             return c >= '0' && c <= '9';
         }
 
-        constexpr bool is_alnum(char c) noexcept {
-            return is_alpha(c) || is_digit(c);
-        }
-
         constexpr bool is_hex_digit(char c) noexcept {
             return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
         }
@@ -88,30 +90,50 @@ namespace rangelua::frontend {
     class Lexer::Impl {
     public:
         explicit Impl(StringView source, String filename)
-            : source_(source), filename_(std::move(filename)), position_(0) {}
+            : source_(source),
+              filename_(std::move(filename)),
+              file_id_(SourceFileTable::intern(filename_)),
+              position_(0) {}
+
+        // Constructor for a fragment of a larger source, whose locations continue from start
+        explicit Impl(StringView source, const SourceLocation& start)
+            : source_(source),
+              filename_(start.filename()),
+              file_id_(start.file_id_),
+              position_(0),
+              line_(start.line_),
+              column_(start.column_) {}
+
+        // Constructor that reads the source incrementally from a stream
+        explicit Impl(std::istream& input, String filename)
+            : stream_(&input),
+              filename_(std::move(filename)),
+              file_id_(SourceFileTable::intern(filename_)),
+              position_(0) {}
 
         Token next_token() {
-            if (peeked_token_.has_value()) {
-                auto token = std::move(peeked_token_.value());
-                peeked_token_.reset();
-                utils::loggers::lexer()->debug("Returning peeked token: {}", token.to_string());
-                return token;
+            if (has_peeked_token_) {
+                has_peeked_token_ = false;
+                token_offset_ = peeked_offset_;
+                LEXER_LOG_DEBUG("Returning peeked token: {}", peeked_token_.to_string());
+                return peeked_token_;
             }
 
             skip_whitespace_and_comments();
+            token_offset_ = consumed_ + position_;
 
             if (at_end()) {
-                utils::loggers::lexer()->debug("Reached end of file");
+                LEXER_LOG_DEBUG("Reached end of file");
                 return {TokenType::EndOfFile, "", current_location()};
             }
 
             const auto start_location = current_location();
             const char current_char = current();
 
-            utils::loggers::lexer()->debug("Tokenizing character '{}' at {}:{}",
-                                           current_char,
-                                           start_location.line_,
-                                           start_location.column_);
+            LEXER_LOG_DEBUG("Tokenizing character '{}' at {}:{}",
+                            current_char,
+                            start_location.line_,
+                            start_location.column_);
 
             Token token;
             // Handle different token types
@@ -136,22 +158,39 @@ namespace rangelua::frontend {
                 token = read_operator_or_delimiter(start_location);
             }
 
-            utils::loggers::lexer()->debug("Generated token: {}", token.to_string());
+            if (stream_ != nullptr && in_window(token.value)) {
+                // The window is reused for later input, so the text is copied out of it: names
+                // once per distinct name, anything else into storage reused a few tokens later
+                token.value = token.type == TokenType::Identifier || token.is_keyword()
+                                  ? intern_name(token.value)
+                                  : store_owned(String(token.value));
+            }
+
+            LEXER_LOG_DEBUG("Generated token: {}", token.to_string());
             return token;
         }
 
         const Token& peek_token() {
-            if (!peeked_token_.has_value()) {
+            if (!has_peeked_token_) {
+                const Size offset = token_offset_;
                 peeked_token_ = next_token();
+                peeked_offset_ = token_offset_;
+                token_offset_ = offset;
+                has_peeked_token_ = true;
             }
-            return peeked_token_.value();
+            return peeked_token_;
         }
 
         [[nodiscard]] SourceLocation current_location() const noexcept {
-            return SourceLocation{filename_, line_, column_};
+            return SourceLocation{file_id_, line_, column_};
         }
 
-        [[nodiscard]] bool at_end() const noexcept { return position_ >= source_.size(); }
+        // Reads more of a streamed source when the window is exhausted
+        [[nodiscard]] bool at_end() noexcept { return !has_byte(position_); }
+
+        [[nodiscard]] Size bytes_read() const noexcept { return consumed_ + source_.size(); }
+
+        [[nodiscard]] Size token_offset() const noexcept { return token_offset_; }
 
         [[nodiscard]] bool has_errors() const noexcept { return !errors_.empty(); }
 
@@ -160,12 +199,70 @@ namespace rangelua::frontend {
         [[nodiscard]] const String& filename() const noexcept { return filename_; }
 
     private:
+        // Whether the byte at pos is available, reading from the stream until it is
+        [[nodiscard]] bool has_byte(Size pos) noexcept {
+            return pos < source_.size() || (stream_ != nullptr && refill_until(pos));
+        }
+
+        [[gnu::noinline]] bool refill_until(Size pos) noexcept {
+            while (pos >= source_.size()) {
+                if (!refill()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Append the next block of a streamed source to the window
+        bool refill() noexcept {
+            if (stream_exhausted_) {
+                return false;
+            }
+            const Size old_size = window_.size();
+            window_.resize(old_size + config::LEXER_BUFFER_SIZE);
+            stream_->read(window_.data() + old_size,
+                          static_cast<std::streamsize>(config::LEXER_BUFFER_SIZE));
+            const auto count = static_cast<Size>(stream_->gcount());
+            window_.resize(old_size + count);
+            source_ = window_;
+            if (count < config::LEXER_BUFFER_SIZE) {
+                stream_exhausted_ = true;
+            }
+            return count > 0;
+        }
+
+        // Drop the input before the current position; only called between tokens
+        void discard_consumed_input() {
+            window_.erase(0, position_);
+            consumed_ += position_;
+            position_ = 0;
+            source_ = window_;
+        }
+
+        [[nodiscard]] bool in_window(StringView text) const noexcept {
+            const auto* begin = window_.data();
+            return std::less_equal<>{}(begin, text.data()) &&
+                   std::less<>{}(text.data(), begin + window_.size());
+        }
+
+        // Run a block scan; on a streamed source, continue it across window refills
+        template <typename Scan>
+        [[nodiscard]] Size scan_from(Size position, Scan scan) noexcept {
+            Size end = scan(source_, position);
+            while (end == source_.size() && stream_ != nullptr && refill()) {
+                end = scan(source_, end);
+            }
+            return end;
+        }
+
         // Character access and movement
-        [[nodiscard]] char current() const noexcept { return at_end() ? '\0' : source_[position_]; }
+        [[nodiscard]] char current() noexcept {
+            return has_byte(position_) ? source_[position_] : '\0';
+        }
 
-        [[nodiscard]] char peek(Size offset = 1) const noexcept {
+        [[nodiscard]] char peek(Size offset = 1) noexcept {
             const auto pos = position_ + offset;
-            return pos >= source_.size() ? '\0' : source_[pos];
+            return has_byte(pos) ? source_[pos] : '\0';
         }
 
         void advance() noexcept {
@@ -186,6 +283,58 @@ namespace rangelua::frontend {
             return c;
         }
 
+        // Source text from start up to the current position
+        [[nodiscard]] StringView text_from(Size start) const noexcept {
+            return source_.substr(start, position_ - start);
+        }
+
+        // Move forward to end, counting the lines crossed on the way
+        void move_to(Size end) noexcept {
+            const Size newlines = scan_.count_newlines(source_, position_, end);
+            if (newlines == 0) {
+                column_ += end - position_;
+            } else {
+                line_ += newlines;
+                column_ = end - source_.rfind('\n', end - 1);
+            }
+            position_ = end;
+        }
+
+        // Digits never span lines, so only the column moves
+        void skip_digits() noexcept {
+            const Size end = scan_from(position_, scan_.find_digits_end);
+            column_ += end - position_;
+            position_ = end;
+        }
+
+        void skip_hex_digits() noexcept {
+            while (is_hex_digit(current())) {
+                ++position_;
+                ++column_;
+            }
+        }
+
+        // Keep token text that is not in the source alive for as long as tokens may refer to it.
+        // Streamed text lives for the next LEXER_TOKEN_TEXT_SLOTS copies, well beyond the parser's
+        // lookahead; the parser copies literals and interns names before moving further on.
+        StringView store_owned(String text) {
+            if (stream_ == nullptr) {
+                return owned_strings_.emplace_back(std::move(text));
+            }
+            String& slot = recent_text_[recent_slot_];
+            recent_slot_ = (recent_slot_ + 1) % recent_text_.size();
+            slot = std::move(text);
+            return slot;
+        }
+
+        // Names of a streamed source, one copy per distinct name for the lexer's lifetime
+        StringView intern_name(StringView text) {
+            if (auto it = names_.find(text); it != names_.end()) {
+                return *it;
+            }
+            return *names_.insert(owned_strings_.emplace_back(text)).first;
+        }
+
         // Error reporting
         void report_error(const String& message) {
             std::ostringstream oss;
@@ -193,27 +342,46 @@ namespace rangelua::frontend {
             errors_.push_back(oss.str());
         }
 
+        const scan::Kernels& scan_ = scan::kernels();
+        // A streamed source is read block by block into the window, which source_ then views
+        std::istream* stream_ = nullptr;
+        String window_;
+        Size consumed_ = 0;  // Bytes discarded from the front of the window
+        bool stream_exhausted_ = false;
         StringView source_;
         String filename_;
+        SourceFileTable::FileId file_id_ = 0;
         Size position_ = 0;
         Size line_ = 1;
         Size column_ = 1;
         std::vector<String> errors_;
-        Optional<Token> peeked_token_;
+        // Decoded strings of an in-memory source and names copied out of the window; a deque
+        // keeps them in place
+        std::deque<String> owned_strings_;
+        std::unordered_set<StringView> names_;
+        std::array<String, config::LEXER_TOKEN_TEXT_SLOTS> recent_text_;
+        Size recent_slot_ = 0;
+        Token peeked_token_;
+        bool has_peeked_token_ = false;
+        Size token_offset_ = 0;  // Input offset of the last token returned
+        Size peeked_offset_ = 0;
 
         // Token reading method implementations
         void skip_whitespace_and_comments() {
             while (!at_end()) {
+                if (stream_ != nullptr && position_ >= config::LEXER_BUFFER_SIZE) {
+                    // No token is in progress, so the text before it is no longer needed
+                    discard_consumed_input();
+                }
+
                 const char c = current();
 
-                if (is_space(c)) {
-                    advance();
-                } else if (is_newline(c)) {
-                    advance();
-                    // Handle \r\n sequence
-                    if (c == '\r' && current() == '\n') {
-                        advance();
-                    }
+                if (c == ' ' && !is_space(peek()) && !is_newline(peek())) {
+                    // A single space between tokens is not worth a block scan
+                    ++position_;
+                    ++column_;
+                } else if (is_space(c) || is_newline(c)) {
+                    move_to(scan_from(position_, scan_.skip_whitespace));
                 } else if (c == '-' && peek() == '-') {
                     // Single-line comment
                     advance();  // skip first '-'
@@ -228,10 +396,10 @@ namespace rangelua::frontend {
                         }
                     }
 
-                    // Skip to end of line
-                    while (!at_end() && !is_newline(current())) {
-                        advance();
-                    }
+                    // Skip to end of line; the comment body has no newlines to count
+                    const Size line_end = scan_from(position_, scan_.find_line_end);
+                    column_ += line_end - position_;
+                    position_ = line_end;
                 } else {
                     break;
                 }
@@ -239,12 +407,13 @@ namespace rangelua::frontend {
         }
 
         Token read_identifier_or_keyword(const SourceLocation& start_location) {
-            String identifier;
-
-            while (!at_end() && is_alnum(current())) {
-                identifier += advance_and_return();
-            }
+            // Identifiers never span lines, so only the column moves
+            const Size start = position_;
+            const Size end = scan_from(position_, scan_.find_identifier_end);
+            column_ += end - position_;
+            position_ = end;
 
+            const StringView identifier = text_from(start);
             // Check if it's a keyword
             if (auto keyword_type = string_to_keyword(identifier)) {
                 return {keyword_type.value(), identifier, start_location};
@@ -254,35 +423,41 @@ namespace rangelua::frontend {
         }
 
         Token read_number(const SourceLocation& start_location) {
-            String number_str;
+            const Size start = position_;
             bool is_float = false;
             bool is_hex = false;
 
             // Check if number starts with a dot
             if (current() == '.') {
                 is_float = true;
-                number_str += advance_and_return();  // '.'
+                advance();  // '.'
 
                 // Read fractional part
-                while (!at_end() && is_digit(current())) {
-                    number_str += advance_and_return();
-                }
+                skip_digits();
             } else {
                 // Check for hexadecimal prefix
                 if (current() == '0' && (peek() == 'x' || peek() == 'X')) {
                     is_hex = true;
-                    number_str += advance_and_return();  // '0'
-                    number_str += advance_and_return();  // 'x' or 'X'
+                    advance();  // '0'
+                    advance();  // 'x' or 'X'
 
-                    if (!is_hex_digit(current())) {
+                    if (!is_hex_digit(current()) && !(current() == '.' && is_hex_digit(peek()))) {
                         report_error("malformed hexadecimal number");
-                        return {TokenType::Invalid, number_str, start_location};
+                        return {TokenType::Invalid, text_from(start), start_location};
                     }
                 }
 
                 // Read integer part
-                while (!at_end() && (is_hex ? is_hex_digit(current()) : is_digit(current()))) {
-                    number_str += advance_and_return();
+                if (is_hex) {
+                    skip_hex_digits();
+                    // Hexadecimal floats may have a fraction, as in 0x1.8p3
+                    if (current() == '.' && peek() != '.') {
+                        is_float = true;
+                        advance();  // '.'
+                        skip_hex_digits();
+                    }
+                } else {
+                    skip_digits();
                 }
             }
 
@@ -292,12 +467,10 @@ namespace rangelua::frontend {
                 // Look ahead to ensure it's not ".." (concat operator)
                 if (peek() != '.') {
                     is_float = true;
-                    number_str += advance_and_return();  // '.'
+                    advance();  // '.'
 
                     // Read fractional part
-                    while (!at_end() && is_digit(current())) {
-                        number_str += advance_and_return();
-                    }
+                    skip_digits();
                 }
             }
 
@@ -305,60 +478,60 @@ namespace rangelua::frontend {
             if ((is_hex && (current() == 'p' || current() == 'P')) ||
                 (!is_hex && (current() == 'e' || current() == 'E'))) {
                 is_float = true;
-                number_str += advance_and_return();  // 'e', 'E', 'p', or 'P'
+                advance();  // 'e', 'E', 'p', or 'P'
 
                 // Optional sign
                 if (current() == '+' || current() == '-') {
-                    number_str += advance_and_return();
+                    advance();
                 }
 
                 // Exponent digits
                 if (!is_digit(current())) {
                     report_error("malformed number exponent");
-                    return {TokenType::Invalid, number_str, start_location};
+                    return {TokenType::Invalid, text_from(start), start_location};
                 }
 
-                while (!at_end() && is_digit(current())) {
-                    number_str += advance_and_return();
-                }
+                skip_digits();
             }
 
-            // Parse the number value
-            if (is_float) {
-                try {
-                    Number value = std::stod(number_str);
-                    return {TokenType::Number, number_str, start_location, value};
-                } catch (const std::exception&) {
-                    report_error("invalid number format");
-                    return {TokenType::Invalid, number_str, start_location};
-                }
-            } else {
-                try {
-                    Int value =
-                        is_hex ? std::stoll(number_str, nullptr, 16) : std::stoll(number_str);
-                    return {TokenType::Number, number_str, start_location, value};
-                } catch (const std::exception&) {
-                    report_error("invalid integer format");
-                    return {TokenType::Invalid, number_str, start_location};
-                }
+            // Convert the text in place; integers that overflow become floats as in Lua
+            const StringView number_text = text_from(start);
+            const auto literal = parse_number_literal(number_text);
+            if (!literal) {
+                report_error("malformed number");
+                return {TokenType::Invalid, number_text, start_location};
+            }
+            if (literal->is_integer) {
+                return {TokenType::Number, number_text, start_location, literal->integer};
             }
+            return {TokenType::Number, number_text, start_location, literal->number};
         }
 
         Token read_string(const SourceLocation& start_location) {
             const char quote = advance_and_return();  // Skip opening quote
+            const Size content_start = position_;
+            // Without escapes the value is a view of the source; the first escape starts a copy
             String result;
+            bool decoded = false;
+            auto string_value = [&]() -> StringView {
+                return decoded ? store_owned(std::move(result)) : text_from(content_start);
+            };
 
             while (!at_end() && current() != quote) {
                 if (is_newline(current())) {
                     report_error("unfinished string");
-                    return {TokenType::Invalid, result, start_location};
+                    return {TokenType::Invalid, string_value(), start_location};
                 }
 
                 if (current() == '\\') {
+                    if (!decoded) {
+                        result.assign(text_from(content_start));
+                        decoded = true;
+                    }
                     advance();  // Skip backslash
                     if (at_end()) {
                         report_error("unfinished string");
-                        return {TokenType::Invalid, result, start_location};
+                        return {TokenType::Invalid, string_value(), start_location};
                     }
 
                     char escaped = advance_and_return();
@@ -409,13 +582,13 @@ namespace rangelua::frontend {
                         case 'x':  // Hexadecimal escape
                             if (at_end() || !is_hex_digit(current())) {
                                 report_error("invalid hexadecimal escape sequence");
-                                return {TokenType::Invalid, result, start_location};
+                                return {TokenType::Invalid, string_value(), start_location};
                             }
                             {
                                 int hex1 = hex_value(advance_and_return());
                                 if (at_end() || !is_hex_digit(current())) {
                                     report_error("invalid hexadecimal escape sequence");
-                                    return {TokenType::Invalid, result, start_location};
+                                    return {TokenType::Invalid, string_value(), start_location};
                                 }
                                 int hex2 = hex_value(advance_and_return());
                                 result += static_cast<char>(hex1 * 16 + hex2);
@@ -430,27 +603,37 @@ namespace rangelua::frontend {
                                 }
                                 if (value > 255) {
                                     report_error("decimal escape sequence out of range");
-                                    return {TokenType::Invalid, result, start_location};
+                                    return {TokenType::Invalid, string_value(), start_location};
                                 }
                                 result += static_cast<char>(value);
                             } else {
                                 report_error("invalid escape sequence");
-                                return {TokenType::Invalid, result, start_location};
+                                return {TokenType::Invalid, string_value(), start_location};
                             }
                             break;
                     }
                 } else {
-                    result += advance_and_return();
+                    // Take the run up to the next quote, escape or line break in one step
+                    const Size run_end =
+                        scan_from(position_, [this, quote](StringView text, Size from) {
+                            return scan_.find_string_special(text, from, quote);
+                        });
+                    if (decoded) {
+                        result.append(text_from(position_).data(), run_end - position_);
+                    }
+                    column_ += run_end - position_;
+                    position_ = run_end;
                 }
             }
 
             if (at_end()) {
                 report_error("unfinished string");
-                return {TokenType::Invalid, result, start_location};
+                return {TokenType::Invalid, string_value(), start_location};
             }
 
+            const StringView value = string_value();
             advance();  // Skip closing quote
-            return {TokenType::String, result, start_location};
+            return {TokenType::String, value, start_location};
         }
 
         int check_long_string_separator() {
@@ -482,8 +665,6 @@ namespace rangelua::frontend {
         }
 
         Token read_long_string(const SourceLocation& start_location, int sep_level) {
-            String result;
-
             // The opening sequence has already been consumed by check_long_string_separator
             // Skip first newline if present
             if (is_newline(current())) {
@@ -493,6 +674,8 @@ namespace rangelua::frontend {
                 }
             }
 
+            // Long strings have no escapes, so the value is always a view of the source
+            const Size content_start = position_;
             while (!at_end()) {
                 if (current() == ']') {
                     // Check for closing sequence
@@ -512,21 +695,24 @@ namespace rangelua::frontend {
                     // Check if we have the exact number of '=' and a final ']'
                     if (close_level == sep_level && !at_end() && current() == ']') {
                         advance();  // Skip final ']'
-                        return {TokenType::String, result, start_location};
+                        return {TokenType::String,
+                                source_.substr(content_start, saved_pos - content_start),
+                                start_location};
                     }
 
-                    // Not the closing sequence, restore and add to result
+                    // Not the closing sequence, restore and keep it in the string
                     position_ = saved_pos;
                     line_ = saved_line;
                     column_ = saved_col;
-                    result += advance_and_return();
+                    advance();
                 } else {
-                    result += advance_and_return();
+                    // Jump to the next ']' that could close it
+                    move_to(scan_from(position_, scan_.find_closing_bracket));
                 }
             }
 
             report_error("unfinished long string");
-            return {TokenType::Invalid, result, start_location};
+            return {TokenType::Invalid, text_from(content_start), start_location};
         }
 
         void skip_long_comment(int sep_level) {
@@ -559,7 +745,8 @@ namespace rangelua::frontend {
                     column_ = saved_col;
                     advance();
                 } else {
-                    advance();
+                    // Jump to the next ']' that could close it
+                    move_to(scan_from(position_, scan_.find_closing_bracket));
                 }
             }
 
@@ -656,7 +843,7 @@ namespace rangelua::frontend {
                     return {TokenType::Comma, ",", start_location};
                 default:
                     report_error("unexpected character: '" + String(1, c) + "'");
-                    return {TokenType::Invalid, String(1, c), start_location};
+                    return {TokenType::Invalid, source_.substr(position_ - 1, 1), start_location};
             }
         }
     };
@@ -664,13 +851,11 @@ namespace rangelua::frontend {
     Lexer::Lexer(StringView source, String filename)
         : impl_(std::make_unique<Impl>(source, std::move(filename))) {}
 
-    Lexer::Lexer(std::istream& input, String filename) : impl_(nullptr) {
-        // Read entire stream into string
-        std::ostringstream buffer;
-        buffer << input.rdbuf();
-        String source = buffer.str();
-        impl_ = std::make_unique<Impl>(source, std::move(filename));
-    }
+    Lexer::Lexer(StringView source, const SourceLocation& start)
+        : impl_(std::make_unique<Impl>(source, start)) {}
+
+    Lexer::Lexer(std::istream& input, String filename)
+        : impl_(std::make_unique<Impl>(input, std::move(filename))) {}
 
     Lexer::~Lexer() = default;
 
@@ -700,6 +885,14 @@ namespace rangelua::frontend {
         return tokens;
     }
 
+    Size Lexer::bytes_read() const noexcept {
+        return impl_->bytes_read();
+    }
+
+    Size Lexer::token_offset() const noexcept {
+        return impl_->token_offset();
+    }
+
     bool Lexer::has_errors() const noexcept {
         return impl_->has_errors();
     }
@@ -849,32 +1042,48 @@ namespace rangelua::frontend {
     }
 
     Optional<TokenType> string_to_keyword(StringView str) noexcept {
-        static const std::unordered_map<StringView, TokenType> keywords = {
-            {"and", TokenType::And},
-            {"break", TokenType::Break},
-            {"do", TokenType::Do},
-            {"else", TokenType::Else},
-            {"elseif", TokenType::Elseif},
-            {"end", TokenType::End},
-            {"false", TokenType::False},
-            {"for", TokenType::For},
-            {"function", TokenType::Function},
-            {"goto", TokenType::Goto},
-            {"if", TokenType::If},
-            {"in", TokenType::In},
-            {"local", TokenType::Local},
-            {"nil", TokenType::Nil},
-            {"not", TokenType::Not},
-            {"or", TokenType::Or},
-            {"repeat", TokenType::Repeat},
-            {"return", TokenType::Return},
-            {"then", TokenType::Then},
-            {"true", TokenType::True},
-            {"until", TokenType::Until},
-            {"while", TokenType::While}};
-
-        auto it = keywords.find(str);
-        return it != keywords.end() ? Optional<TokenType>{it->second} : std::nullopt;
+        // Keywords are 2 to 8 lowercase letters; most identifiers are ruled out before any compare
+        if (str.size() < 2 || str.size() > 8 || str[0] < 'a' || str[0] > 'w') {
+            return std::nullopt;
+        }
+
+        struct Keyword {
+            StringView text;
+            TokenType type;
+        };
+        static constexpr Keyword keywords[] = {{"and", TokenType::And},
+                                               {"break", TokenType::Break},
+                                               {"do", TokenType::Do},
+                                               {"else", TokenType::Else},
+                                               {"elseif", TokenType::Elseif},
+                                               {"end", TokenType::End},
+                                               {"false", TokenType::False},
+                                               {"for", TokenType::For},
+                                               {"function", TokenType::Function},
+                                               {"goto", TokenType::Goto},
+                                               {"if", TokenType::If},
+                                               {"in", TokenType::In},
+                                               {"local", TokenType::Local},
+                                               {"nil", TokenType::Nil},
+                                               {"not", TokenType::Not},
+                                               {"or", TokenType::Or},
+                                               {"repeat", TokenType::Repeat},
+                                               {"return", TokenType::Return},
+                                               {"then", TokenType::Then},
+                                               {"true", TokenType::True},
+                                               {"until", TokenType::Until},
+                                               {"while", TokenType::While}};
+
+        // The table is sorted, so the search stops once it is past the first letter
+        for (const auto& keyword : keywords) {
+            if (keyword.text[0] > str[0]) {
+                break;
+            }
+            if (keyword.text == str) {
+                return keyword.type;
+            }
+        }
+        return std::nullopt;
     }
 
 }  // namespace rangelua::frontend
@@ -0,0 +1,127 @@
+/**
+ * @file number_literal.cpp
+ * @brief Conversion of Lua numeric literals to integer and float values
+ * @version 0.1.0
+ */
+
+#include <rangelua/frontend/number_literal.hpp>
+
+#include <charconv>
+#include <cstdlib>
+#include <limits>
+#include <system_error>
+
+namespace rangelua::frontend {
+
+    namespace {
+        constexpr bool is_digit(char c) noexcept {
+            return c >= '0' && c <= '9';
+        }
+
+        constexpr int hex_value(char c) noexcept {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        /**
+         * @brief Float conversion shared by decimal and hexadecimal literals
+         *
+         * from_chars leaves the value unset when it is out of range, while the
+         * reference interpreter accepts the HUGE_VAL or zero that strtod gives;
+         * that rare case is handed to strtod on a terminated copy.
+         */
+        Optional<Number>
+        parse_float(StringView literal, StringView digits, std::chars_format format) noexcept {
+            Number value = 0.0;
+            const char* end = digits.data() + digits.size();
+            auto [stop, error] = std::from_chars(digits.data(), end, value, format);
+            if (stop != end) {
+                return std::nullopt;
+            }
+            if (error == std::errc::result_out_of_range) {
+                try {
+                    const String copy(literal);
+                    return std::strtod(copy.c_str(), nullptr);
+                } catch (...) {
+                    return std::nullopt;
+                }
+            }
+            if (error != std::errc{}) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        Optional<NumberLiteral> parse_hexadecimal(StringView literal) noexcept {
+            const StringView digits = literal.substr(2);
+            if (digits.empty()) {
+                return std::nullopt;
+            }
+
+            // Integers wrap around instead of overflowing
+            UInt value = 0;
+            Size position = 0;
+            while (position < digits.size() && hex_value(digits[position]) >= 0) {
+                value = value * 16 + static_cast<UInt>(hex_value(digits[position]));
+                ++position;
+            }
+            if (position == digits.size()) {
+                return NumberLiteral{true, static_cast<Int>(value), 0.0};
+            }
+
+            // from_chars would also take a sign, "inf" or "nan", none of which is a literal
+            if (hex_value(digits[0]) < 0 && digits[0] != '.') {
+                return std::nullopt;
+            }
+            if (auto number = parse_float(literal, digits, std::chars_format::hex)) {
+                return NumberLiteral{false, 0, *number};
+            }
+            return std::nullopt;
+        }
+
+        Optional<NumberLiteral> parse_decimal(StringView literal) noexcept {
+            if (literal.empty()) {
+                return std::nullopt;
+            }
+
+            // Plain digits are an integer as long as they fit
+            constexpr auto max_int = static_cast<UInt>(std::numeric_limits<Int>::max());
+            UInt value = 0;
+            Size position = 0;
+            bool overflow = false;
+            for (; position < literal.size() && is_digit(literal[position]); ++position) {
+                const auto digit = static_cast<UInt>(literal[position] - '0');
+                if (value > (max_int - digit) / 10) {
+                    overflow = true;
+                    break;
+                }
+                value = value * 10 + digit;
+            }
+            if (position == literal.size() && !overflow) {
+                return NumberLiteral{true, static_cast<Int>(value), 0.0};
+            }
+
+            // A float, or an integer too large for Int, which is read as a float
+            if (!is_digit(literal[0]) && literal[0] != '.') {
+                return std::nullopt;
+            }
+            if (auto number = parse_float(literal, literal, std::chars_format::general)) {
+                return NumberLiteral{false, 0, *number};
+            }
+            return std::nullopt;
+        }
+    }  // namespace
+
+    Optional<NumberLiteral> parse_number_literal(StringView text) noexcept {
+        if (text.size() >= 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+            return parse_hexadecimal(text);
+        }
+        return parse_decimal(text);
+    }
+
+}  // namespace rangelua::frontend
@@ -5,8 +5,11 @@
  */
 
 #include <rangelua/frontend/parser.hpp>
+#include <rangelua/utils/debug.hpp>
 #include <rangelua/utils/logger.hpp>
 
+#include <utility>
+
 namespace rangelua::frontend {
 
     // Parser implementation
@@ -25,6 +28,7 @@ namespace rangelua::frontend {
         Result<ProgramPtr> parse() {
             PARSER_LOG_INFO("Starting parse of program");
 
+            ASTArena::Scope arena_scope(*arena_);
             StatementList statements;
 
             // Skip initial newlines and comments
@@ -44,7 +48,80 @@ namespace rangelua::frontend {
             }
 
             PARSER_LOG_INFO("Completed parsing {} statements", statements.size());
-            return ASTBuilder::make_program(std::move(statements), SourceLocation{lexer_.filename(), 1, 1});
+            PARSER_LOG_DEBUG("AST arena: {} nodes, {} bytes in {} blocks",
+                             arena_->object_count(),
+                             arena_->bytes_used(),
+                             arena_->block_count());
+
+            // The program takes the arena with it; later parses start a fresh one
+            auto arena = std::exchange(arena_, std::make_unique<ASTArena>());
+            return ASTBuilder::make_program(
+                std::move(statements), SourceLocation{lexer_.filename(), 1, 1}, std::move(arena));
+        }
+
+        Status parse(StatementSink& sink) {
+            if (!config_.single_pass) {
+                auto program_result = parse();
+                if (is_error(program_result)) {
+                    return get_error(program_result);
+                }
+                const auto& program = get_value(program_result);
+                sink.begin_chunk(program->location());
+                for (const auto& statement : program->statements()) {
+                    if (auto status = sink.consume(*statement); is_error(status)) {
+                        return status;
+                    }
+                }
+                return sink.end_chunk();
+            }
+
+            PARSER_LOG_INFO("Starting single-pass parse of program");
+
+            ASTArena::Scope arena_scope(*arena_);
+            sink.begin_chunk(SourceLocation{lexer_.filename(), 1, 1});
+
+            skip_newlines_and_comments();
+
+            Size statement_count = 0;
+            while (!is_at_end()) {
+                auto stmt_result = parse_statement();
+                if (is_success(stmt_result)) {
+                    const auto statement = get_value(std::move(stmt_result));
+                    if (auto status = sink.consume(*statement); is_error(status)) {
+                        return status;
+                    }
+                    ++statement_count;
+                } else {
+                    // Error recovery: try to synchronize to next statement
+                    add_error("Failed to parse statement", current_location());
+                    synchronize();
+                }
+
+                // The statement has been destroyed, so its memory can be reused for the next
+                arena_->reset();
+                skip_newlines_and_comments();
+            }
+
+            PARSER_LOG_INFO("Completed single-pass parse of {} statements", statement_count);
+            PARSER_LOG_DEBUG("AST arena: {} nodes, at most {} bytes at once",
+                             arena_->object_count(),
+                             arena_->peak_bytes_used());
+            return sink.end_chunk();
+        }
+
+        Result<ExpressionPtr> parse_single_expression() {
+            ASTArena::Scope arena_scope(*arena_);
+            return parse_expression();
+        }
+
+        Result<StatementPtr> parse_single_statement() {
+            ASTArena::Scope arena_scope(*arena_);
+            return parse_statement();
+        }
+
+        Result<StatementPtr> parse_single_block() {
+            ASTArena::Scope arena_scope(*arena_);
+            return parse_block_until(TokenType::EndOfFile);
         }
 
         Result<ExpressionPtr> parse_expression() {
@@ -109,10 +186,13 @@ namespace rangelua::frontend {
 
         const ParserConfig& config() const noexcept { return config_; }
 
+        const ASTArena& arena() const noexcept { return *arena_; }
+
     private:
         UniquePtr<Lexer> owned_lexer_;  // Optional owned lexer
         Lexer& lexer_;
         ParserConfig config_;
+        UniquePtr<ASTArena> arena_ = std::make_unique<ASTArena>();  // Nodes of the current parse
         std::vector<SyntaxError> errors_;
         Token current_token_;
         [[maybe_unused]] Size parse_dbepth_ = 0;
@@ -127,6 +207,9 @@ namespace rangelua::frontend {
 
         bool is_at_end() const noexcept { return current_token_.type == TokenType::EndOfFile; }
 
+        // Names must outlive the token they came from
+        StringView intern(StringView text) { return arena_->intern(text); }
+
         bool check(TokenType type) const noexcept { return current_token_.type == type; }
 
         bool match(TokenType type) {
@@ -158,7 +241,7 @@ namespace rangelua::frontend {
         void add_error(const String& message, const SourceLocation& location) {
             errors_.emplace_back(message, location);
             PARSER_LOG_ERROR(
-                "Parse error at {}:{}: {}", location.filename_, location.line_, message);
+                "Parse error at {}:{}: {}", location.filename(), location.line_, message);
         }
 
         void add_enhanced_error(const String& message,
@@ -170,7 +253,7 @@ namespace rangelua::frontend {
             }
             errors_.emplace_back(enhanced_message, location);
             PARSER_LOG_ERROR(
-                "Parse error at {}:{}: {}", location.filename_, location.line_, enhanced_message);
+                "Parse error at {}:{}: {}", location.filename(), location.line_, enhanced_message);
         }
 
         String get_token_suggestion(TokenType expected) {
@@ -299,7 +382,7 @@ namespace rangelua::frontend {
                     auto location = current_location();
                     advance();
 
-                    auto key = ASTBuilder::make_literal(field_name, location);
+                    auto key = ASTBuilder::make_literal(String(field_name), location);
                     left = ASTBuilder::make_table_access(
                         std::move(left), std::move(key), true, location);
                 } else if (current_token_.type == TokenType::Colon) {
@@ -354,7 +437,8 @@ namespace rangelua::frontend {
                 case TokenType::String: {
                     auto value = current_token_.value;
                     advance();
-                    return ASTBuilder::make_literal(LiteralExpression::Value{value}, location);
+                    return ASTBuilder::make_literal(LiteralExpression::Value{String(value)},
+                                                    location);
                 }
 
                 case TokenType::True: {
@@ -438,23 +522,34 @@ namespace rangelua::frontend {
             }
 
             // Parse local variable declaration
-            std::vector<String> names;
+            NameList names;
+            LocalDeclarationStatement::AttributeList attributes;
 
             if (!check(TokenType::Identifier)) {
                 add_error("Expected identifier after 'local'", current_location());
                 return ErrorCode::SYNTAX_ERROR;
             }
 
-            names.push_back(current_token_.value);
+            names.push_back(intern(current_token_.value));
             advance();
+            auto attribute = parse_attribute();
+            if (!attribute) {
+                return ErrorCode::SYNTAX_ERROR;
+            }
+            attributes.push_back(*attribute);
 
             while (match(TokenType::Comma)) {
                 if (!check(TokenType::Identifier)) {
                     add_error("Expected identifier after ','", current_location());
                     return ErrorCode::SYNTAX_ERROR;
                 }
-                names.push_back(current_token_.value);
+                names.push_back(intern(current_token_.value));
                 advance();
+                attribute = parse_attribute();
+                if (!attribute) {
+                    return ErrorCode::SYNTAX_ERROR;
+                }
+                attributes.push_back(*attribute);
             }
 
             ExpressionList values;
@@ -475,7 +570,36 @@ namespace rangelua::frontend {
             }
 
             return ASTBuilder::make_local_declaration(
-                std::move(names), std::move(values), current_location());
+                std::move(names), std::move(values), current_location(), std::move(attributes));
+        }
+
+        // Parse an optional '<name>' attribute after a local variable name
+        Optional<LocalDeclarationStatement::Attribute> parse_attribute() {
+            if (!match(TokenType::Less)) {
+                return LocalDeclarationStatement::Attribute::None;
+            }
+
+            if (!check(TokenType::Identifier)) {
+                add_error("Expected attribute name after '<'", current_location());
+                return std::nullopt;
+            }
+
+            LocalDeclarationStatement::Attribute attribute;
+            if (current_token_.value == "const") {
+                attribute = LocalDeclarationStatement::Attribute::Const;
+            } else if (current_token_.value == "close") {
+                attribute = LocalDeclarationStatement::Attribute::Close;
+            } else {
+                add_error("Unknown attribute '" + String(current_token_.value) + "'",
+                          current_location());
+                return std::nullopt;
+            }
+            advance();
+
+            if (!expect(TokenType::Greater, "Expected '>' after attribute name")) {
+                return std::nullopt;
+            }
+            return attribute;
         }
 
         // Parse local function as local declaration with function expression
@@ -487,7 +611,7 @@ namespace rangelua::frontend {
                 return ErrorCode::SYNTAX_ERROR;
             }
 
-            String function_name = current_token_.value;
+            String function_name(current_token_.value);
             advance();
 
             // Parse parameters
@@ -498,7 +622,7 @@ namespace rangelua::frontend {
             FunctionExpression::ParameterList parameters;
             if (!check(TokenType::RightParen)) {
                 if (check(TokenType::Identifier)) {
-                    parameters.emplace_back(current_token_.value);
+                    parameters.emplace_back(intern(current_token_.value));
                     advance();
 
                     while (match(TokenType::Comma)) {
@@ -507,7 +631,7 @@ namespace rangelua::frontend {
                             advance();
                             break;
                         } else if (check(TokenType::Identifier)) {
-                            parameters.emplace_back(current_token_.value);
+                            parameters.emplace_back(intern(current_token_.value));
                             advance();
                         } else {
                             add_error("Expected parameter name", current_location());
@@ -525,21 +649,22 @@ namespace rangelua::frontend {
             }
 
             // Parse body
-            auto body_result = parse_block_until(TokenType::End);
+            Optional<SourceRange> deferred_body;
+            auto body_result = parse_function_body(deferred_body);
             if (!is_success(body_result)) {
                 return body_result;
             }
 
-            if (!expect(TokenType::End, "Expected 'end' after function body")) {
-                return ErrorCode::SYNTAX_ERROR;
-            }
-
             // Create function expression
-            auto function_expr = ASTBuilder::make_function_expression(
-                std::move(parameters), get_value(std::move(body_result)), current_location());
+            auto function_expr =
+                ASTBuilder::make_function_expression(std::move(parameters),
+                                                     get_value(std::move(body_result)),
+                                                     current_location(),
+                                                     deferred_body);
 
             // Create local declaration with function expression as value
-            std::vector<String> names = {std::move(function_name)};
+            NameList names;
+            names.push_back(intern(function_name));
             ExpressionList values;
             values.push_back(std::move(function_expr));
 
@@ -570,7 +695,7 @@ namespace rangelua::frontend {
                 auto location = current_location();
                 advance();
 
-                auto key = ASTBuilder::make_literal(field_name, location);
+                auto key = ASTBuilder::make_literal(String(field_name), location);
                 name =
                     ASTBuilder::make_table_access(std::move(name), std::move(key), true, location);
             }
@@ -586,7 +711,7 @@ namespace rangelua::frontend {
                 auto location = current_location();
                 advance();
 
-                auto key = ASTBuilder::make_literal(method_name, location);
+                auto key = ASTBuilder::make_literal(String(method_name), location);
                 name =
                     ASTBuilder::make_table_access(std::move(name), std::move(key), true, location);
             }
@@ -613,7 +738,7 @@ namespace rangelua::frontend {
             FunctionExpression::ParameterList parameters;
             if (!check(TokenType::RightParen)) {
                 if (check(TokenType::Identifier)) {
-                    parameters.emplace_back(current_token_.value);
+                    parameters.emplace_back(intern(current_token_.value));
                     advance();
 
                     while (match(TokenType::Comma)) {
@@ -622,7 +747,7 @@ namespace rangelua::frontend {
                             advance();
                             break;
                         } else if (check(TokenType::Identifier)) {
-                            parameters.emplace_back(current_token_.value);
+                            parameters.emplace_back(intern(current_token_.value));
                             advance();
                         } else {
                             add_enhanced_error("Expected parameter name", current_location(),
@@ -641,6 +766,26 @@ namespace rangelua::frontend {
             }
 
             // Parse body
+            Optional<SourceRange> deferred_body;
+            auto body_result = parse_function_body(deferred_body);
+            if (!is_success(body_result)) {
+                return body_result;
+            }
+
+            return ASTBuilder::make_function_declaration(std::move(name),
+                                                         std::move(parameters),
+                                                         get_value(std::move(body_result)),
+                                                         is_local,
+                                                         current_location(),
+                                                         deferred_body);
+        }
+
+        // Body of a function after its parameter list, up to and including 'end'
+        Result<StatementPtr> parse_function_body(Optional<SourceRange>& deferred_body) {
+            if (config_.lazy_functions) {
+                return skip_function_body(deferred_body);
+            }
+
             auto body_result = parse_block_until(TokenType::End);
             if (!is_success(body_result)) {
                 return body_result;
@@ -649,12 +794,69 @@ namespace rangelua::frontend {
             if (!expect(TokenType::End, "Expected 'end' after function body")) {
                 return ErrorCode::SYNTAX_ERROR;
             }
+            return body_result;
+        }
 
-            return ASTBuilder::make_function_declaration(std::move(name),
-                                                         std::move(parameters),
-                                                         get_value(std::move(body_result)),
-                                                         is_local,
-                                                         current_location());
+        // Pre-scan for lazy mode: find the 'end' of the body by matching block keywords and
+        // brackets, without building a tree. Unbalanced nesting and malformed tokens are
+        // reported here; any other syntax error in the body surfaces when it is compiled.
+        Result<StatementPtr> skip_function_body(Optional<SourceRange>& deferred_body) {
+            SourceRange range;
+            range.begin = lexer_.token_offset();
+            range.begin_location = current_location();
+
+            std::vector<TokenType> closers;  // Token that closes each open block or bracket
+            while (!is_at_end()) {
+                const TokenType type = current_token_.type;
+                switch (type) {
+                    case TokenType::Function:
+                    case TokenType::Do:
+                    case TokenType::If:
+                        closers.push_back(TokenType::End);
+                        break;
+                    case TokenType::Repeat:
+                        closers.push_back(TokenType::Until);
+                        break;
+                    case TokenType::LeftParen:
+                        closers.push_back(TokenType::RightParen);
+                        break;
+                    case TokenType::LeftBracket:
+                        closers.push_back(TokenType::RightBracket);
+                        break;
+                    case TokenType::LeftBrace:
+                        closers.push_back(TokenType::RightBrace);
+                        break;
+                    case TokenType::End:
+                    case TokenType::Until:
+                    case TokenType::RightParen:
+                    case TokenType::RightBracket:
+                    case TokenType::RightBrace:
+                        if (closers.empty() && type == TokenType::End) {
+                            range.end = lexer_.token_offset();
+                            range.end_location = current_location();
+                            advance();  // consume 'end'
+                            deferred_body = range;
+                            return ASTBuilder::make_block(StatementList{}, range.end_location);
+                        }
+                        if (closers.empty() || closers.back() != type) {
+                            add_error("Unexpected '" + String(current_token_.value) +
+                                          "' in function body",
+                                      current_location());
+                            return ErrorCode::SYNTAX_ERROR;
+                        }
+                        closers.pop_back();
+                        break;
+                    case TokenType::Invalid:
+                        add_error("Invalid token in function body", current_location());
+                        return ErrorCode::SYNTAX_ERROR;
+                    default:
+                        break;
+                }
+                advance();
+            }
+
+            add_error("Expected 'end' after function body", current_location());
+            return ErrorCode::SYNTAX_ERROR;
         }
 
         Result<StatementPtr> parse_block_until(TokenType end_token) {
@@ -767,7 +969,7 @@ namespace rangelua::frontend {
             }
 
             // Parse elseif clauses
-            std::vector<IfStatement::ElseIfClause> elseif_clauses;
+            IfStatement::ElseIfClauseList elseif_clauses;
             while (match(TokenType::Elseif)) {
                 auto elseif_condition_result = parse_expression();
                 if (!is_success(elseif_condition_result)) {
@@ -896,15 +1098,15 @@ namespace rangelua::frontend {
                                                     current_location());
             } else {
                 // Generic for loop: for vars in explist do ... end
-                std::vector<String> variables;
-                variables.push_back(first_var);
+                NameList variables;
+                variables.push_back(intern(first_var));
 
                 while (match(TokenType::Comma)) {
                     if (!check(TokenType::Identifier)) {
                         add_error("Expected variable name after ','", current_location());
                         return ErrorCode::SYNTAX_ERROR;
                     }
-                    variables.push_back(current_token_.value);
+                    variables.push_back(intern(current_token_.value));
                     advance();
                 }
 
@@ -1127,7 +1329,7 @@ namespace rangelua::frontend {
                         if (match(TokenType::Assign)) {
                             // Record field: name = value
                             auto key = ASTBuilder::make_literal(
-                                LiteralExpression::Value{checkpoint_token.value},
+                                LiteralExpression::Value{String(checkpoint_token.value)},
                                 checkpoint_token.location);
                             auto value_result = parse_expression();
                             if (!is_success(value_result)) {
@@ -1187,7 +1389,7 @@ namespace rangelua::frontend {
             FunctionExpression::ParameterList parameters;
             if (!check(TokenType::RightParen)) {
                 if (check(TokenType::Identifier)) {
-                    parameters.emplace_back(current_token_.value);
+                    parameters.emplace_back(intern(current_token_.value));
                     advance();
 
                     while (match(TokenType::Comma)) {
@@ -1196,7 +1398,7 @@ namespace rangelua::frontend {
                             advance();
                             break;
                         } else if (check(TokenType::Identifier)) {
-                            parameters.emplace_back(current_token_.value);
+                            parameters.emplace_back(intern(current_token_.value));
                             advance();
                         } else {
                             add_error("Expected parameter name", current_location());
@@ -1214,17 +1416,16 @@ namespace rangelua::frontend {
             }
 
             // Parse body
-            auto body_result = parse_block_until(TokenType::End);
+            Optional<SourceRange> deferred_body;
+            auto body_result = parse_function_body(deferred_body);
             if (!is_success(body_result)) {
                 return ErrorCode::SYNTAX_ERROR;
             }
 
-            if (!expect(TokenType::End, "Expected 'end' after function body")) {
-                return ErrorCode::SYNTAX_ERROR;
-            }
-
-            return ASTBuilder::make_function_expression(
-                std::move(parameters), get_value(std::move(body_result)), current_location());
+            return ASTBuilder::make_function_expression(std::move(parameters),
+                                                        get_value(std::move(body_result)),
+                                                        current_location(),
+                                                        deferred_body);
         }
     };
 
@@ -1242,12 +1443,20 @@ namespace rangelua::frontend {
         return impl_->parse();
     }
 
+    Status Parser::parse(StatementSink& sink) {
+        return impl_->parse(sink);
+    }
+
     Result<ExpressionPtr> Parser::parse_expression() {
-        return impl_->parse_expression();
+        return impl_->parse_single_expression();
     }
 
     Result<StatementPtr> Parser::parse_statement() {
-        return impl_->parse_statement();
+        return impl_->parse_single_statement();
+    }
+
+    Result<StatementPtr> Parser::parse_block() {
+        return impl_->parse_single_block();
     }
 
     bool Parser::has_errors() const noexcept {
@@ -1262,6 +1471,10 @@ namespace rangelua::frontend {
         return impl_->config();
     }
 
+    const ASTArena& Parser::arena() const noexcept {
+        return impl_->arena();
+    }
+
     // AST implementations
     void LiteralExpression::accept(ASTVisitor& visitor) const {
         visitor.visit(*this);
@@ -1276,7 +1489,7 @@ namespace rangelua::frontend {
     }
 
     String IdentifierExpression::to_string() const {
-        return "IdentifierExpression(" + name_ + ")";
+        return "IdentifierExpression(" + String(name_) + ")";
     }
 
     void BinaryOpExpression::accept(ASTVisitor& visitor) const {
@@ -1341,7 +1554,7 @@ namespace rangelua::frontend {
     }
 
     String MethodCallExpression::to_string() const {
-        return "MethodCallExpression(" + method_name_ + ")";
+        return "MethodCallExpression(" + String(method_name_) + ")";
     }
 
     void TableAccessExpression::accept(ASTVisitor& visitor) const {
@@ -1461,7 +1674,7 @@ namespace rangelua::frontend {
     }
 
     String GotoStatement::to_string() const {
-        return "GotoStatement(" + label_ + ")";
+        return "GotoStatement(" + String(label_) + ")";
     }
 
     void LabelStatement::accept(ASTVisitor& visitor) const {
@@ -1469,7 +1682,7 @@ namespace rangelua::frontend {
     }
 
     String LabelStatement::to_string() const {
-        return "LabelStatement(" + name_ + ")";
+        return "LabelStatement(" + String(name_) + ")";
     }
 
     void ExpressionStatement::accept(ASTVisitor& visitor) const {
@@ -1697,131 +1910,160 @@ namespace rangelua::frontend {
     }  // namespace parser_utils
 
     // AST builder implementations
+    namespace {
+        ASTArena& current_arena() {
+            ASTArena* arena = ASTArena::current();
+            RANGELUA_ASSERT_MSG(arena != nullptr,
+                                "AST nodes must be built inside an ASTArena::Scope");
+            return *arena;
+        }
+
+        template <typename T, typename... Args>
+        ArenaPtr<T> make_node(Args&&... args) {
+            return ArenaPtr<T>(current_arena().create<T>(std::forward<Args>(args)...));
+        }
+
+        StringView intern(StringView text) {
+            return current_arena().intern(text);
+        }
+    }  // namespace
+
     ExpressionPtr ASTBuilder::make_literal(LiteralExpression::Value value,
                                            SourceLocation location) {
-        return std::make_unique<LiteralExpression>(std::move(value), std::move(location));
+        return make_node<LiteralExpression>(std::move(value), std::move(location));
     }
 
-    ExpressionPtr ASTBuilder::make_identifier(String name, SourceLocation location) {
-        return std::make_unique<IdentifierExpression>(std::move(name), std::move(location));
+    ExpressionPtr ASTBuilder::make_identifier(StringView name, SourceLocation location) {
+        return make_node<IdentifierExpression>(intern(name), std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_binary_op(BinaryOpExpression::Operator op,
                                              ExpressionPtr left,
                                              ExpressionPtr right,
                                              SourceLocation location) {
-        return std::make_unique<BinaryOpExpression>(
+        return make_node<BinaryOpExpression>(
             op, std::move(left), std::move(right), std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_unary_op(UnaryOpExpression::Operator op,
                                             ExpressionPtr operand,
                                             SourceLocation location) {
-        return std::make_unique<UnaryOpExpression>(op, std::move(operand), std::move(location));
+        return make_node<UnaryOpExpression>(op, std::move(operand), std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_function_call(ExpressionPtr function,
                                                  ExpressionList arguments,
                                                  SourceLocation location) {
-        return std::make_unique<FunctionCallExpression>(
+        return make_node<FunctionCallExpression>(
             std::move(function), std::move(arguments), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_block(StatementList statements, SourceLocation location) {
-        return std::make_unique<BlockStatement>(std::move(statements), std::move(location));
+        return make_node<BlockStatement>(std::move(statements), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_assignment(ExpressionList targets,
                                              ExpressionList values,
                                              SourceLocation location) {
-        return std::make_unique<AssignmentStatement>(
+        return make_node<AssignmentStatement>(
             std::move(targets), std::move(values), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_if(ExpressionPtr condition,
                                      StatementPtr then_body,
-                                     std::vector<IfStatement::ElseIfClause> elseif_clauses,
+                                     IfStatement::ElseIfClauseList elseif_clauses,
                                      StatementPtr else_body,
                                      SourceLocation location) {
-        return std::make_unique<IfStatement>(std::move(condition),
+        return make_node<IfStatement>(std::move(condition),
                                              std::move(then_body),
                                              std::move(elseif_clauses),
                                              std::move(else_body),
                                              std::move(location));
     }
 
-    ProgramPtr ASTBuilder::make_program(StatementList statements, SourceLocation location) {
-        return std::make_unique<Program>(std::move(statements), std::move(location));
+    ProgramPtr ASTBuilder::make_program(StatementList statements,
+                                        SourceLocation location,
+                                        UniquePtr<ASTArena> arena) {
+        return std::make_unique<Program>(
+            std::move(statements), std::move(location), std::move(arena));
     }
 
     // New AST builder methods
     ExpressionPtr ASTBuilder::make_method_call(ExpressionPtr object,
-                                               String method_name,
+                                               StringView method_name,
                                                ExpressionList arguments,
                                                SourceLocation location) {
-        return std::make_unique<MethodCallExpression>(
-            std::move(object), std::move(method_name), std::move(arguments), std::move(location));
+        return make_node<MethodCallExpression>(
+            std::move(object), intern(method_name), std::move(arguments), std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_table_access(ExpressionPtr table,
                                                 ExpressionPtr key,
                                                 bool is_dot_notation,
                                                 SourceLocation location) {
-        return std::make_unique<TableAccessExpression>(
+        return make_node<TableAccessExpression>(
             std::move(table), std::move(key), is_dot_notation, std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_table_constructor(TableConstructorExpression::FieldList fields,
                                                      SourceLocation location) {
-        return std::make_unique<TableConstructorExpression>(std::move(fields), std::move(location));
+        return make_node<TableConstructorExpression>(std::move(fields), std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_function_expression(FunctionExpression::ParameterList parameters,
                                                        StatementPtr body,
-                                                       SourceLocation location) {
-        return std::make_unique<FunctionExpression>(
-            std::move(parameters), std::move(body), std::move(location));
+                                                       SourceLocation location,
+                                                       Optional<SourceRange> deferred_body) {
+        return make_node<FunctionExpression>(
+            std::move(parameters), std::move(body), std::move(location), deferred_body);
     }
 
     ExpressionPtr ASTBuilder::make_vararg(SourceLocation location) {
-        return std::make_unique<VarargExpression>(std::move(location));
+        return make_node<VarargExpression>(std::move(location));
     }
 
     ExpressionPtr ASTBuilder::make_parenthesized(ExpressionPtr expression,
                                                  SourceLocation location) {
-        return std::make_unique<ParenthesizedExpression>(std::move(expression),
+        return make_node<ParenthesizedExpression>(std::move(expression),
                                                          std::move(location));
     }
 
-    StatementPtr ASTBuilder::make_local_declaration(std::vector<String> names,
-                                                    ExpressionList values,
-                                                    SourceLocation location) {
-        return std::make_unique<LocalDeclarationStatement>(
-            std::move(names), std::move(values), std::move(location));
+    StatementPtr ASTBuilder::make_local_declaration(
+        NameList names,
+        ExpressionList values,
+        SourceLocation location,
+        LocalDeclarationStatement::AttributeList attributes) {
+        return make_node<LocalDeclarationStatement>(
+            std::move(names), std::move(values), std::move(location), std::move(attributes));
     }
 
     StatementPtr ASTBuilder::make_function_declaration(ExpressionPtr name,
                                                        FunctionExpression::ParameterList parameters,
                                                        StatementPtr body,
                                                        bool is_local,
-                                                       SourceLocation location) {
-        return std::make_unique<FunctionDeclarationStatement>(
-            std::move(name), std::move(parameters), std::move(body), is_local, std::move(location));
+                                                       SourceLocation location,
+                                                       Optional<SourceRange> deferred_body) {
+        return make_node<FunctionDeclarationStatement>(std::move(name),
+                                                       std::move(parameters),
+                                                       std::move(body),
+                                                       is_local,
+                                                       std::move(location),
+                                                       deferred_body);
     }
 
     StatementPtr
     ASTBuilder::make_while(ExpressionPtr condition, StatementPtr body, SourceLocation location) {
-        return std::make_unique<WhileStatement>(
+        return make_node<WhileStatement>(
             std::move(condition), std::move(body), std::move(location));
     }
 
-    StatementPtr ASTBuilder::make_for_numeric(String variable,
+    StatementPtr ASTBuilder::make_for_numeric(StringView variable,
                                               ExpressionPtr start,
                                               ExpressionPtr stop,
                                               ExpressionPtr step,
                                               StatementPtr body,
                                               SourceLocation location) {
-        return std::make_unique<ForNumericStatement>(std::move(variable),
+        return make_node<ForNumericStatement>(intern(variable),
                                                      std::move(start),
                                                      std::move(stop),
                                                      std::move(step),
@@ -1829,43 +2071,43 @@ namespace rangelua::frontend {
                                                      std::move(location));
     }
 
-    StatementPtr ASTBuilder::make_for_generic(std::vector<String> variables,
+    StatementPtr ASTBuilder::make_for_generic(NameList variables,
                                               ExpressionList expressions,
                                               StatementPtr body,
                                               SourceLocation location) {
-        return std::make_unique<ForGenericStatement>(
+        return make_node<ForGenericStatement>(
             std::move(variables), std::move(expressions), std::move(body), std::move(location));
     }
 
     StatementPtr
     ASTBuilder::make_repeat(StatementPtr body, ExpressionPtr condition, SourceLocation location) {
-        return std::make_unique<RepeatStatement>(
+        return make_node<RepeatStatement>(
             std::move(body), std::move(condition), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_do(StatementPtr body, SourceLocation location) {
-        return std::make_unique<DoStatement>(std::move(body), std::move(location));
+        return make_node<DoStatement>(std::move(body), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_return(ExpressionList values, SourceLocation location) {
-        return std::make_unique<ReturnStatement>(std::move(values), std::move(location));
+        return make_node<ReturnStatement>(std::move(values), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_break(SourceLocation location) {
-        return std::make_unique<BreakStatement>(std::move(location));
+        return make_node<BreakStatement>(std::move(location));
     }
 
-    StatementPtr ASTBuilder::make_goto(String label, SourceLocation location) {
-        return std::make_unique<GotoStatement>(std::move(label), std::move(location));
+    StatementPtr ASTBuilder::make_goto(StringView label, SourceLocation location) {
+        return make_node<GotoStatement>(intern(label), std::move(location));
     }
 
-    StatementPtr ASTBuilder::make_label(String name, SourceLocation location) {
-        return std::make_unique<LabelStatement>(std::move(name), std::move(location));
+    StatementPtr ASTBuilder::make_label(StringView name, SourceLocation location) {
+        return make_node<LabelStatement>(intern(name), std::move(location));
     }
 
     StatementPtr ASTBuilder::make_expression_statement(ExpressionPtr expression,
                                                        SourceLocation location) {
-        return std::make_unique<ExpressionStatement>(std::move(expression), std::move(location));
+        return make_node<ExpressionStatement>(std::move(expression), std::move(location));
     }
 
 }  // namespace rangelua::frontend
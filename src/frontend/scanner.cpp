@@ -0,0 +1,357 @@
+/**
+ * @file scanner.cpp
+ * @brief SSE2/AVX2 byte scanning for the lexer with a runtime-selected scalar fallback
+ * @version 0.1.0
+ */
+
+#include <rangelua/frontend/scanner.hpp>
+#include <rangelua/utils/logger.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RANGELUA_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define RANGELUA_SCAN_X86 0
+#endif
+
+namespace rangelua::frontend::scan {
+
+    namespace {
+        /*
+         * Byte classes. Each one answers "does this byte stop the scan?" for a
+         * single byte and, on x86-64, for a whole SSE2 or AVX2 register at once
+         * (0xFF in every lane that stops). Range tests shift the range so that
+         * it starts at -128 and use one signed comparison.
+         */
+
+        constexpr bool is_space_byte(char c) noexcept {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        constexpr bool is_identifier_byte(char c) noexcept {
+            const char lower = static_cast<char>(c | 0x20);
+            return (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+#if RANGELUA_SCAN_X86
+        inline __m128i in_range_sse2(__m128i bytes, char low, char high) noexcept {
+            const __m128i shifted =
+                _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80 - low)));
+            return _mm_cmplt_epi8(shifted,
+                                  _mm_set1_epi8(static_cast<char>(-128 + (high - low) + 1)));
+        }
+
+        inline __m128i equals_sse2(__m128i bytes, char value) noexcept {
+            return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(value));
+        }
+
+        inline __m128i invert_sse2(__m128i mask) noexcept {
+            return _mm_xor_si128(mask, _mm_set1_epi8(-1));
+        }
+
+        __attribute__((target("avx2"))) inline __m256i in_range_avx2(__m256i bytes,
+                                                                      char low,
+                                                                      char high) noexcept {
+            const __m256i shifted =
+                _mm256_add_epi8(bytes, _mm256_set1_epi8(static_cast<char>(0x80 - low)));
+            return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + (high - low) + 1)),
+                                     shifted);
+        }
+
+        __attribute__((target("avx2"))) inline __m256i equals_avx2(__m256i bytes,
+                                                                    char value) noexcept {
+            return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(value));
+        }
+
+        __attribute__((target("avx2"))) inline __m256i invert_avx2(__m256i mask) noexcept {
+            return _mm256_xor_si256(mask, _mm256_set1_epi8(-1));
+        }
+#endif
+
+        struct WhitespaceEnd {
+            [[nodiscard]] bool stops(char c) const noexcept { return !is_space_byte(c); }
+#if RANGELUA_SCAN_X86
+            [[nodiscard]] __m128i stops(__m128i b) const noexcept {
+                return invert_sse2(_mm_or_si128(in_range_sse2(b, '\t', '\r'), equals_sse2(b, ' ')));
+            }
+            [[nodiscard]] __attribute__((target("avx2"))) __m256i stops(__m256i b) const noexcept {
+                return invert_avx2(
+                    _mm256_or_si256(in_range_avx2(b, '\t', '\r'), equals_avx2(b, ' ')));
+            }
+#endif
+        };
+
+        struct IdentifierEnd {
+            [[nodiscard]] bool stops(char c) const noexcept { return !is_identifier_byte(c); }
+#if RANGELUA_SCAN_X86
+            [[nodiscard]] __m128i stops(__m128i b) const noexcept {
+                const __m128i lower = _mm_or_si128(b, _mm_set1_epi8(0x20));
+                const __m128i letter = in_range_sse2(lower, 'a', 'z');
+                const __m128i digit = in_range_sse2(b, '0', '9');
+                return invert_sse2(
+                    _mm_or_si128(_mm_or_si128(letter, digit), equals_sse2(b, '_')));
+            }
+            [[nodiscard]] __attribute__((target("avx2"))) __m256i stops(__m256i b) const noexcept {
+                const __m256i lower = _mm256_or_si256(b, _mm256_set1_epi8(0x20));
+                const __m256i letter = in_range_avx2(lower, 'a', 'z');
+                const __m256i digit = in_range_avx2(b, '0', '9');
+                return invert_avx2(
+                    _mm256_or_si256(_mm256_or_si256(letter, digit), equals_avx2(b, '_')));
+            }
+#endif
+        };
+
+        struct DigitsEnd {
+            [[nodiscard]] bool stops(char c) const noexcept { return c < '0' || c > '9'; }
+#if RANGELUA_SCAN_X86
+            [[nodiscard]] __m128i stops(__m128i b) const noexcept {
+                return invert_sse2(in_range_sse2(b, '0', '9'));
+            }
+            [[nodiscard]] __attribute__((target("avx2"))) __m256i stops(__m256i b) const noexcept {
+                return invert_avx2(in_range_avx2(b, '0', '9'));
+            }
+#endif
+        };
+
+        struct LineEnd {
+            [[nodiscard]] bool stops(char c) const noexcept { return c == '\n' || c == '\r'; }
+#if RANGELUA_SCAN_X86
+            [[nodiscard]] __m128i stops(__m128i b) const noexcept {
+                return _mm_or_si128(equals_sse2(b, '\n'), equals_sse2(b, '\r'));
+            }
+            [[nodiscard]] __attribute__((target("avx2"))) __m256i stops(__m256i b) const noexcept {
+                return _mm256_or_si256(equals_avx2(b, '\n'), equals_avx2(b, '\r'));
+            }
+#endif
+        };
+
+        struct StringSpecial {
+            char quote;
+
+            [[nodiscard]] bool stops(char c) const noexcept {
+                return c == quote || c == '\\' || c == '\n' || c == '\r';
+            }
+#if RANGELUA_SCAN_X86
+            [[nodiscard]] __m128i stops(__m128i b) const noexcept {
+                return _mm_or_si128(_mm_or_si128(equals_sse2(b, quote), equals_sse2(b, '\\')),
+                                    _mm_or_si128(equals_sse2(b, '\n'), equals_sse2(b, '\r')));
+            }
+            [[nodiscard]] __attribute__((target("avx2"))) __m256i stops(__m256i b) const noexcept {
+                return _mm256_or_si256(
+                    _mm256_or_si256(equals_avx2(b, quote), equals_avx2(b, '\\')),
+                    _mm256_or_si256(equals_avx2(b, '\n'), equals_avx2(b, '\r')));
+            }
+#endif
+        };
+
+        // Drivers: whole blocks first, then the remaining bytes one at a time
+
+        template <typename Class>
+        Size scan_scalar(StringView text, Size position, const Class& byte_class) noexcept {
+            while (position < text.size() && !byte_class.stops(text[position])) {
+                ++position;
+            }
+            return position;
+        }
+
+        Size count_scalar(StringView text, Size begin, Size end) noexcept {
+            Size count = 0;
+            for (Size i = begin; i < end; ++i) {
+                count += text[i] == '\n' ? 1 : 0;
+            }
+            return count;
+        }
+
+#if RANGELUA_SCAN_X86
+        template <typename Class>
+        Size scan_sse2(StringView text, Size position, const Class& byte_class) noexcept {
+            const char* data = text.data();
+            while (position + 16 <= text.size()) {
+                const __m128i block =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+                const auto mask = static_cast<unsigned>(_mm_movemask_epi8(byte_class.stops(block)));
+                if (mask != 0) {
+                    return position + static_cast<Size>(std::countr_zero(mask));
+                }
+                position += 16;
+            }
+            return scan_scalar(text, position, byte_class);
+        }
+
+        template <typename Class>
+        __attribute__((target("avx2"))) Size scan_avx2(StringView text,
+                                                        Size position,
+                                                        const Class& byte_class) noexcept {
+            const char* data = text.data();
+            while (position + 32 <= text.size()) {
+                const __m256i block =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+                const auto mask =
+                    static_cast<std::uint32_t>(_mm256_movemask_epi8(byte_class.stops(block)));
+                if (mask != 0) {
+                    return position + static_cast<Size>(std::countr_zero(mask));
+                }
+                position += 32;
+            }
+            return scan_sse2(text, position, byte_class);
+        }
+
+        Size count_sse2(StringView text, Size begin, Size end) noexcept {
+            const char* data = text.data();
+            Size count = 0;
+            for (; begin + 16 <= end; begin += 16) {
+                const __m128i block =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + begin));
+                count += static_cast<Size>(std::popcount(
+                    static_cast<unsigned>(_mm_movemask_epi8(equals_sse2(block, '\n')))));
+            }
+            return count + count_scalar(text, begin, end);
+        }
+
+        __attribute__((target("avx2"))) Size count_avx2(StringView text,
+                                                         Size begin,
+                                                         Size end) noexcept {
+            const char* data = text.data();
+            Size count = 0;
+            for (; begin + 32 <= end; begin += 32) {
+                const __m256i block =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + begin));
+                count += static_cast<Size>(std::popcount(
+                    static_cast<std::uint32_t>(_mm256_movemask_epi8(equals_avx2(block, '\n')))));
+            }
+            return count + count_sse2(text, begin, end);
+        }
+#endif
+
+        Size find_closing_bracket(StringView text, Size position) noexcept {
+            // A single-byte search is what the C library's memchr is vectorized for already
+            if (position >= text.size()) {
+                return text.size();
+            }
+            const void* found = std::memchr(text.data() + position, ']', text.size() - position);
+            return found != nullptr
+                       ? static_cast<Size>(static_cast<const char*>(found) - text.data())
+                       : text.size();
+        }
+
+        template <template <typename> class Driver>
+        constexpr Kernels make_kernels(Implementation implementation,
+                                       Size (*count)(StringView, Size, Size) noexcept) {
+            return {
+                implementation,
+                [](StringView text, Size position) noexcept {
+                    return Driver<WhitespaceEnd>::run(text, position, WhitespaceEnd{});
+                },
+                [](StringView text, Size position) noexcept {
+                    return Driver<IdentifierEnd>::run(text, position, IdentifierEnd{});
+                },
+                [](StringView text, Size position) noexcept {
+                    return Driver<DigitsEnd>::run(text, position, DigitsEnd{});
+                },
+                [](StringView text, Size position) noexcept {
+                    return Driver<LineEnd>::run(text, position, LineEnd{});
+                },
+                [](StringView text, Size position, char quote) noexcept {
+                    return Driver<StringSpecial>::run(text, position, StringSpecial{quote});
+                },
+                find_closing_bracket,
+                count,
+            };
+        }
+
+        template <typename Class>
+        struct ScalarDriver {
+            static Size run(StringView text, Size position, const Class& byte_class) noexcept {
+                return scan_scalar(text, position, byte_class);
+            }
+        };
+
+        constexpr Kernels scalar_kernels = make_kernels<ScalarDriver>(Implementation::Scalar,
+                                                                      count_scalar);
+
+#if RANGELUA_SCAN_X86
+        template <typename Class>
+        struct SSE2Driver {
+            static Size run(StringView text, Size position, const Class& byte_class) noexcept {
+                return scan_sse2(text, position, byte_class);
+            }
+        };
+
+        template <typename Class>
+        struct AVX2Driver {
+            static Size run(StringView text, Size position, const Class& byte_class) noexcept {
+                return scan_avx2(text, position, byte_class);
+            }
+        };
+
+        constexpr Kernels sse2_kernels = make_kernels<SSE2Driver>(Implementation::SSE2, count_sse2);
+        constexpr Kernels avx2_kernels = make_kernels<AVX2Driver>(Implementation::AVX2, count_avx2);
+#endif
+
+        const Kernels* kernels_for(Implementation implementation) noexcept {
+            switch (implementation) {
+#if RANGELUA_SCAN_X86
+                case Implementation::AVX2:
+                    return &avx2_kernels;
+                case Implementation::SSE2:
+                    return &sse2_kernels;
+#endif
+                default:
+                    return &scalar_kernels;
+            }
+        }
+
+        std::atomic<const Kernels*>& active_kernels() noexcept {
+            static std::atomic<const Kernels*> kernels{kernels_for(detect_implementation())};
+            return kernels;
+        }
+
+    }  // namespace
+
+    Implementation detect_implementation() noexcept {
+#if RANGELUA_SCAN_X86
+        // SSE2 is part of x86-64; AVX2 also needs OS support for the YMM state,
+        // which __builtin_cpu_supports checks along with the CPUID bit
+        static const Implementation detected = __builtin_cpu_supports("avx2")
+                                                   ? Implementation::AVX2
+                                                   : Implementation::SSE2;
+        return detected;
+#else
+        return Implementation::Scalar;
+#endif
+    }
+
+    Implementation active_implementation() noexcept {
+        return kernels().implementation;
+    }
+
+    bool set_implementation(Implementation implementation) noexcept {
+        if (implementation > detect_implementation()) {
+            return false;
+        }
+        active_kernels().store(kernels_for(implementation), std::memory_order_relaxed);
+        LEXER_LOG_DEBUG("Lexer scanning uses {}", implementation_name(implementation));
+        return true;
+    }
+
+    StringView implementation_name(Implementation implementation) noexcept {
+        switch (implementation) {
+            case Implementation::Scalar:
+                return "scalar";
+            case Implementation::SSE2:
+                return "sse2";
+            case Implementation::AVX2:
+                return "avx2";
+        }
+        return "unknown";
+    }
+
+    const Kernels& kernels() noexcept {
+        return *active_kernels().load(std::memory_order_relaxed);
+    }
+
+}  // namespace rangelua::frontend::scan
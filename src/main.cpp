@@ -4,14 +4,23 @@
  * @version 0.1.0
  */
 
+#include <rangelua/frontend/scanner.hpp>
 #include <rangelua/rangelua.hpp>
 #include <rangelua/utils/logger.hpp>
+#include <rangelua/utils/mapped_file.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <sys/resource.h>
+
 using namespace rangelua;
 
 /**
@@ -26,6 +35,23 @@ struct Options {
     bool version = false;
     bool help = false;
     bool debug = false;
+    bool profile = false;
+    std::string jit = "on";
+    std::string trace = "on";
+    std::string lex_scan = "auto";
+    std::string aot_output;  // Write C++ for the script here instead of running it
+    std::string aot_module;  // Native module to bind before running
+    std::string chunk_output;  // Write a precompiled bytecode chunk here instead of running
+    std::string cache_dir;     // Reuse compiled chunks cached in this directory
+    bool cache_stats = false;
+    bool parse_stats = false;
+    bool single_pass = false;  // Generate code per top-level statement, freeing each one's AST
+    bool lazy = false;         // Compile function bodies when their closure is first called
+    int jobs = 1;              // Threads compiling function bodies; 0 means one per core
+    bool lex_stats = false;
+    int optimization_level = 2;  // -O0 .. -O3
+    bool opt_stats = false;
+    bool count_instructions = false;
 };
 
 /**
@@ -45,6 +71,57 @@ Options parse_args(int argc, char* argv[]) {
             opts.interactive = true;
         } else if (arg == "--debug" || arg == "-d") {
             opts.debug = true;
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg == "--jit") {
+            if (i + 1 < argc) {
+                opts.jit = argv[++i];
+            }
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) {
+                opts.trace = argv[++i];
+            }
+        } else if (arg == "--lex-scan") {
+            if (i + 1 < argc) {
+                opts.lex_scan = argv[++i];
+            }
+        } else if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' &&
+                   arg[2] <= '3') {
+            opts.optimization_level = arg[2] - '0';
+        } else if (arg == "--opt-stats") {
+            opts.opt_stats = true;
+        } else if (arg == "--count-instructions") {
+            opts.count_instructions = true;
+        } else if (arg == "--aot") {
+            if (i + 1 < argc) {
+                opts.aot_output = argv[++i];
+            }
+        } else if (arg == "-c") {
+            if (i + 1 < argc) {
+                opts.chunk_output = argv[++i];
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                opts.cache_dir = argv[++i];
+            }
+        } else if (arg == "--cache-stats") {
+            opts.cache_stats = true;
+        } else if (arg == "--parse-stats") {
+            opts.parse_stats = true;
+        } else if (arg == "--single-pass") {
+            opts.single_pass = true;
+        } else if (arg == "--lazy") {
+            opts.lazy = true;
+        } else if (arg == "--jobs" || arg == "-j") {
+            if (i + 1 < argc) {
+                opts.jobs = std::max(0, std::atoi(argv[++i]));
+            }
+        } else if (arg == "--lex-stats") {
+            opts.lex_stats = true;
+        } else if (arg == "--aot-load") {
+            if (i + 1 < argc) {
+                opts.aot_module = argv[++i];
+            }
         } else if (arg == "--log-level") {
             if (i + 1 < argc) {
                 opts.log_level = argv[++i];
@@ -57,7 +134,8 @@ Options parse_args(int argc, char* argv[]) {
             if (i + 1 < argc) {
                 opts.log_file = argv[++i];
             }
-        } else if (!arg.empty() && arg[0] != '-') {
+        } else if (arg == "-" || (!arg.empty() && arg[0] != '-')) {
+            // A lone "-" names standard input
             opts.files.push_back(arg);
         }
     }
@@ -75,7 +153,25 @@ void print_help() {
     std::cout << "  -h, --help          Show this help message\n";
     std::cout << "  -v, --version       Show version information\n";
     std::cout << "  -i, --interactive   Enter interactive mode\n";
+    std::cout << "  -                   Run the script read from standard input as it arrives\n";
     std::cout << "  -d, --debug         Enable debug mode\n";
+    std::cout << "  --profile           Collect type feedback and print it to stderr\n";
+    std::cout << "  --jit MODE          Baseline JIT: on (hot code), off, eager (compile on first call)\n";
+    std::cout << "  --trace MODE        Loop tracing: on (hot loops), off, eager (record first iteration)\n";
+    std::cout << "  --lex-scan MODE     Lexer scanning: auto (best the CPU has), avx2, sse2, scalar\n";
+    std::cout << "  -O0 .. -O3          Bytecode optimization level (default -O2, -O0 disables)\n";
+    std::cout << "  --opt-stats         Print per-pass optimizer statistics to stderr\n";
+    std::cout << "  --parse-stats       Print source size, parse and codegen time, AST arena usage to stderr\n";
+    std::cout << "  --single-pass       Compile each top-level statement's AST as parsed, then free it\n";
+    std::cout << "  --lazy              Compile function bodies on first use, not with the chunk\n";
+    std::cout << "  -j, --jobs N        Compile function bodies on N threads (0: one per core)\n";
+    std::cout << "  --lex-stats         Tokenize the script on its own first; print tokens and time\n";
+    std::cout << "  --count-instructions Print interpreted instruction and opcode pair counts to stderr\n";
+    std::cout << "  --aot FILE          Compile the script to C++ source in FILE instead of running it\n";
+    std::cout << "  --aot-load FILE     Run with a native module built from --aot output\n";
+    std::cout << "  -c FILE             Precompile the script to a bytecode chunk in FILE\n";
+    std::cout << "  --cache-dir DIR     Cache compiled scripts in DIR and reuse them on later runs\n";
+    std::cout << "  --cache-stats       Print compilation cache hits, misses and time saved to stderr\n";
     std::cout
         << "  --log-level LEVEL   Set global log level (trace, debug, info, warn, error, off)\n";
     std::cout << "                      When specified without --module-log, enables all modules\n";
@@ -93,6 +189,11 @@ void print_help() {
     std::cout << "  rangelua --log-level debug script.lua  # All modules debug logging\n";
     std::cout << "  rangelua --module-log \"parser:debug\" script.lua  # Only parser debug\n";
     std::cout << "  rangelua -i                            # Interactive mode\n";
+    std::cout << "  generate_script | rangelua -           # Stream a script through a pipe\n";
+    std::cout << "  rangelua -O0 script.lua                # Run unoptimized bytecode\n";
+    std::cout << "  rangelua --aot s.cpp script.lua && c++ -O2 -shared -fPIC s.cpp -o s.so\n";
+    std::cout << "  rangelua --aot-load ./s.so script.lua  # Run with the compiled module\n";
+    std::cout << "  rangelua -c script.rlc script.lua && rangelua script.rlc  # Skip compilation\n";
 }
 
 /**
@@ -147,22 +248,206 @@ void run_interactive() {
     }
 }
 
+/**
+ * @brief Build the state configuration selected on the command line
+ */
+api::StateConfig make_state_config(const Options& opts) {
+    api::StateConfig config;
+    config.optimization_level =
+        static_cast<backend::Optimizer::OptimizationLevel>(opts.optimization_level);
+    config.enable_profiling = opts.profile;
+    config.vm_config.count_instructions = opts.count_instructions;
+    config.cache_directory = opts.cache_dir;
+    config.single_pass = opts.single_pass;
+    config.lazy_functions = opts.lazy;
+    config.compile_jobs = static_cast<Size>(opts.jobs);
+    if (opts.jit == "off") {
+        config.vm_config.enable_jit = false;
+    } else if (opts.jit == "eager") {
+        config.vm_config.jit_call_threshold = 1;
+        config.vm_config.jit_backedge_threshold = 1;
+    }
+    if (opts.trace == "off") {
+        config.vm_config.enable_tracing = false;
+    } else if (opts.trace == "eager") {
+        config.vm_config.trace_hot_threshold = 1;
+    }
+    return config;
+}
+
+/**
+ * @brief Print statistics, sorted by key
+ */
+void print_statistics(const std::unordered_map<std::string, Size>& statistics,
+                      const std::string& prefix = "") {
+    std::vector<std::pair<std::string, Size>> entries(statistics.begin(), statistics.end());
+    std::sort(entries.begin(), entries.end());
+    for (const auto& [key, value] : entries) {
+        std::cerr << prefix << key << ": " << value << "\n";
+    }
+}
+
+/**
+ * @brief Print optimizer statistics, sorted by key
+ */
+void print_optimizer_stats(const api::State& state) {
+    print_statistics(state.optimizer_statistics());
+}
+
+/**
+ * @brief Time a standalone lexing pass over a file and print the token count
+ */
+void print_lex_stats(const std::string& filename) {
+    // Lex a mapped file in place like State::execute_file does; stream anything else
+    utils::MappedFile mapping(filename);
+    std::ifstream file;
+    if (!mapping.ok()) {
+        file.open(filename, std::ios::binary);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    frontend::Lexer lexer = mapping.ok() ? frontend::Lexer(mapping.text(), filename)
+                                         : frontend::Lexer(file, filename);
+    Size tokens = 0;
+    while (lexer.next_token().type != frontend::TokenType::EndOfFile) {
+        ++tokens;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    print_statistics({{"lex_source_bytes", lexer.bytes_read()},
+                      {"lex_tokens", tokens},
+                      {"lex_time_us", static_cast<Size>(elapsed.count())}});
+    std::cerr << "lex_scan: "
+              << frontend::scan::implementation_name(frontend::scan::active_implementation())
+              << "\n";
+}
+
 /**
  * @brief Execute file
  */
-int execute_file(const std::string& filename) {
-    api::State state;
+int execute_file(const std::string& filename, const Options& opts) {
+    // Standard input can only be read once, so it is not lexed ahead of execution
+    const bool from_stdin = filename == "-";
+    if (opts.lex_stats && !from_stdin) {
+        print_lex_stats(filename);
+    }
+
+    api::State state(make_state_config(opts));
+
+    if (!opts.aot_module.empty() && is_error(state.load_aot_module(opts.aot_module))) {
+        std::cerr << "Failed to load AOT module '" << opts.aot_module << "'\n";
+        return 1;
+    }
+
+    auto result = from_stdin ? state.execute(std::cin, "stdin") : state.execute_file(filename);
+    if (opts.profile) {
+        std::cerr << state.dump_feedback();
+    }
+    if (opts.opt_stats) {
+        print_optimizer_stats(state);
+    }
+    if (opts.count_instructions) {
+        std::cerr << state.dump_instruction_counts();
+    }
+    if (opts.cache_stats) {
+        print_statistics(state.cache_statistics(), "cache_");
+    }
+    if (opts.parse_stats) {
+        auto statistics = state.parse_statistics();
+        // Peak resident memory of the whole process, in kilobytes on Linux
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            statistics["peak_rss_kb"] = static_cast<Size>(usage.ru_maxrss);
+        }
+        print_statistics(statistics);
+    }
 
-    auto result = state.execute_file(filename);
     if (std::holds_alternative<std::vector<runtime::Value>>(result)) {
         return 0;
     } else {
-        std::cerr << "Error executing file '" << filename
+        std::cerr << "Error executing file '" << (from_stdin ? "stdin" : filename)
                   << "': " << static_cast<int>(std::get<ErrorCode>(result)) << "\n";
         return 1;
     }
 }
 
+/**
+ * @brief Compile a script to an AOT C++ module source
+ */
+int compile_aot(const std::string& filename, const Options& opts) {
+    std::ifstream input(filename);
+    if (!input.is_open()) {
+        std::cerr << "Cannot open file '" << filename << "'\n";
+        return 1;
+    }
+    std::string source((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    api::State state(make_state_config(opts));
+    auto function = state.compile(source, filename);
+    if (is_error(function)) {
+        std::cerr << "Error compiling file '" << filename
+                  << "': " << static_cast<int>(get_error(function)) << "\n";
+        return 1;
+    }
+
+    // Native code is emitted for every prototype, so none may stay deferred
+    auto& chunk = std::get<backend::BytecodeFunction>(function);
+    if (is_error(backend::compile_deferred_prototypes(chunk, static_cast<Size>(opts.jobs)))) {
+        std::cerr << "Error compiling file '" << filename << "'\n";
+        return 1;
+    }
+
+    if (opts.opt_stats) {
+        print_optimizer_stats(state);
+    }
+
+    std::ofstream output(opts.aot_output);
+    output << runtime::jit::AotCompiler::emit(chunk, filename);
+    if (!output) {
+        std::cerr << "Cannot write '" << opts.aot_output << "'\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Precompile a script to a binary bytecode chunk
+ */
+int compile_chunk(const std::string& filename, const Options& opts) {
+    std::ifstream input(filename);
+    if (!input.is_open()) {
+        std::cerr << "Cannot open file '" << filename << "'\n";
+        return 1;
+    }
+    std::string source((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    api::State state(make_state_config(opts));
+    auto function = state.compile(source, filename);
+    if (is_error(function)) {
+        std::cerr << "Error compiling file '" << filename
+                  << "': " << static_cast<int>(get_error(function)) << "\n";
+        return 1;
+    }
+
+    // A chunk holds bytecode only, so bodies deferred by --lazy are compiled now
+    auto& chunk = std::get<backend::BytecodeFunction>(function);
+    if (is_error(backend::compile_deferred_prototypes(chunk, static_cast<Size>(opts.jobs)))) {
+        std::cerr << "Error compiling file '" << filename << "'\n";
+        return 1;
+    }
+
+    if (opts.opt_stats) {
+        print_optimizer_stats(state);
+    }
+
+    if (is_error(backend::ChunkWriter::write_file(chunk, opts.chunk_output))) {
+        std::cerr << "Cannot write '" << opts.chunk_output << "'\n";
+        return 1;
+    }
+    return 0;
+}
+
 /**
  * @brief Main entry point
  */
@@ -205,13 +490,30 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (opts.lex_scan != "auto") {
+        using frontend::scan::Implementation;
+        const std::unordered_map<std::string, Implementation> implementations = {
+            {"avx2", Implementation::AVX2},
+            {"sse2", Implementation::SSE2},
+            {"scalar", Implementation::Scalar}};
+        auto it = implementations.find(opts.lex_scan);
+        if (it == implementations.end() || !frontend::scan::set_implementation(it->second)) {
+            std::cerr << "Lexer scanning '" << opts.lex_scan << "' is not available\n";
+            return 1;
+        }
+    }
+
     int exit_code = 0;
 
     try {
-        if (opts.files.empty() || opts.interactive) {
+        if (!opts.aot_output.empty() && !opts.files.empty()) {
+            exit_code = compile_aot(opts.files[0], opts);
+        } else if (!opts.chunk_output.empty() && !opts.files.empty()) {
+            exit_code = compile_chunk(opts.files[0], opts);
+        } else if (opts.files.empty() || opts.interactive) {
             run_interactive();
         } else {
-            exit_code = execute_file(opts.files[0]);
+            exit_code = execute_file(opts.files[0], opts);
         }
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << "\n";
@@ -0,0 +1,147 @@
+/**
+ * @file feedback.cpp
+ * @brief Per-instruction type feedback implementation
+ * @version 0.1.0
+ */
+
+#include <rangelua/backend/bytecode.hpp>
+#include <rangelua/runtime/feedback.hpp>
+
+#include <array>
+#include <sstream>
+
+namespace rangelua::runtime {
+
+    namespace {
+
+        constexpr FeedbackKind classify(OpCode op) noexcept {
+            switch (instruction_utils::generic_opcode(op)) {
+                case OpCode::OP_ADD:
+                case OpCode::OP_SUB:
+                case OpCode::OP_MUL:
+                case OpCode::OP_MOD:
+                case OpCode::OP_POW:
+                case OpCode::OP_DIV:
+                case OpCode::OP_IDIV:
+                case OpCode::OP_BAND:
+                case OpCode::OP_BOR:
+                case OpCode::OP_BXOR:
+                case OpCode::OP_SHL:
+                case OpCode::OP_SHR:
+                    return FeedbackKind::BinaryBC;
+                case OpCode::OP_ADDI:
+                case OpCode::OP_ADDK:
+                case OpCode::OP_SUBK:
+                case OpCode::OP_MULK:
+                case OpCode::OP_MODK:
+                case OpCode::OP_POWK:
+                case OpCode::OP_DIVK:
+                case OpCode::OP_IDIVK:
+                case OpCode::OP_BANDK:
+                case OpCode::OP_BORK:
+                case OpCode::OP_BXORK:
+                case OpCode::OP_SHRI:
+                case OpCode::OP_SHLI:
+                case OpCode::OP_UNM:
+                case OpCode::OP_BNOT:
+                case OpCode::OP_NOT:
+                case OpCode::OP_LEN:
+                    return FeedbackKind::UnaryB;
+                case OpCode::OP_EQ:
+                case OpCode::OP_LT:
+                case OpCode::OP_LE:
+                case OpCode::OP_EQJMP:
+                case OpCode::OP_LTJMP:
+                case OpCode::OP_LEJMP:
+                    return FeedbackKind::CompareAB;
+                case OpCode::OP_EQK:
+                case OpCode::OP_EQI:
+                case OpCode::OP_LTI:
+                case OpCode::OP_LEI:
+                case OpCode::OP_GTI:
+                case OpCode::OP_GEI:
+                    return FeedbackKind::CompareA;
+                case OpCode::OP_CALL:
+                case OpCode::OP_TAILCALL:
+                case OpCode::OP_MOVECALL:
+                    return FeedbackKind::Call;
+                case OpCode::OP_GETTABLE:
+                case OpCode::OP_GETI:
+                case OpCode::OP_GETFIELD:
+                case OpCode::OP_SELF:
+                    return FeedbackKind::FieldReadB;
+                case OpCode::OP_SETTABLE:
+                case OpCode::OP_SETI:
+                case OpCode::OP_SETFIELD:
+                    return FeedbackKind::FieldWriteA;
+                case OpCode::OP_JMP:
+                    return FeedbackKind::Jump;
+                case OpCode::OP_FORLOOP:
+                case OpCode::OP_TFORLOOP:
+                    return FeedbackKind::Loop;
+                default:
+                    return FeedbackKind::None;
+            }
+        }
+
+        constexpr auto kind_table = [] {
+            std::array<FeedbackKind, 1U << LuaInstruction::OPCODE_BITS> table{};
+            for (Size i = 0; i < table.size(); ++i) {
+                table[i] = classify(static_cast<OpCode>(i));
+            }
+            return table;
+        }();
+
+    }  // namespace
+
+    FeedbackKind feedback_kind(OpCode op) noexcept {
+        return kind_table[static_cast<Size>(op) & (kind_table.size() - 1)];
+    }
+
+    String type_set_to_string(TypeSet types) {
+        static constexpr const char* names[] = {
+            "nil", "boolean", "number", "string", "table", "function", "userdata", "thread"};
+
+        String result;
+        for (unsigned i = 0; i < std::size(names); ++i) {
+            if ((types & (1U << i)) != 0) {
+                if (!result.empty()) {
+                    result += '|';
+                }
+                result += names[i];
+            }
+        }
+        return result.empty() ? String("-") : result;
+    }
+
+    FeedbackVector::FeedbackVector(String name, Size instruction_count)
+        : name_(std::move(name)), slots_(instruction_count) {}
+
+    String FeedbackVector::to_string() const {
+        std::ostringstream oss;
+        oss << "function " << name_ << " (invocations=" << invocations_
+            << ", backedges=" << backedges_ << ")\n";
+
+        for (Size pc = 0; pc < slots_.size(); ++pc) {
+            const auto& s = slots_[pc];
+            if (!s.executed) {
+                continue;
+            }
+
+            oss << "  [" << pc << "] " << backend::Disassembler::opcode_name(s.opcode)
+                << " x" << s.count;
+            if (s.operand_types[0] != 0 || s.operand_types[1] != 0) {
+                oss << " types=" << type_set_to_string(s.operand_types[0]);
+                if (s.operand_types[1] != 0) {
+                    oss << "," << type_set_to_string(s.operand_types[1]);
+                }
+            }
+            if (s.has_target) {
+                oss << " target=" << (s.polymorphic ? "polymorphic" : "monomorphic");
+            }
+            oss << "\n";
+        }
+        return oss.str();
+    }
+
+}  // namespace rangelua::runtime
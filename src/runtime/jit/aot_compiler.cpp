@@ -0,0 +1,426 @@
+/**
+ * @file aot_compiler.cpp
+ * @brief Bytecode to C++ translation for ahead-of-time compiled modules
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/jit/aot.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+namespace rangelua::runtime::jit {
+
+    namespace {
+
+        /**
+         * @brief Layout-compatible copies of the runtime ABI types, compiled into every module
+         */
+        constexpr const char* MODULE_PRELUDE = R"(#include <cstdint>
+
+namespace {
+
+    using Helper = std::int64_t (*)(void*, std::uint64_t, std::uint32_t, std::uint32_t);
+    using Entry = std::int64_t (*)(void*, std::int64_t);
+    using NumberLoad = void (*)(void*, const std::uint8_t*, std::uint32_t, double*);
+    using NumberStore = void (*)(void*, const std::uint8_t*, std::uint32_t, const double*);
+
+    struct Runtime {
+        std::uint32_t abi_version;
+        std::uint32_t helper_count;
+        const Helper* helpers;
+        const std::uint64_t* strategies;
+        NumberLoad load_numbers;
+        NumberStore store_numbers;
+    };
+
+    struct Prototype {
+        const std::uint32_t* instructions;
+        std::uint32_t instruction_count;
+        Entry entry;
+    };
+
+    struct ModuleInfo {
+        std::uint32_t abi_version;
+        std::uint32_t prototype_count;
+        const Prototype* prototypes;
+    };
+
+    const Helper* h = nullptr;
+    const std::uint64_t* s = nullptr;
+    NumberLoad ld = nullptr;
+    NumberStore st = nullptr;
+)";
+
+        String hex(std::uint32_t value) {
+            char buffer[16];
+            std::snprintf(buffer, sizeof(buffer), "0x%08Xu", value);
+            return buffer;
+        }
+
+        /**
+         * @brief Text safe to place in a line comment
+         */
+        String comment_text(const String& text) {
+            String result;
+            for (char c : text) {
+                result += (c == '\n' || c == '\r') ? ' ' : c;
+            }
+            return result;
+        }
+
+        Instruction generic_instruction(Instruction instruction) {
+            OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+            return LuaInstruction(instruction).with_opcode(instruction_utils::generic_opcode(op)).raw;
+        }
+
+        /**
+         * @brief How an instruction is translated
+         */
+        enum class Lowering : std::uint8_t {
+            Helper,      // Call its helper stencil
+            Arithmetic,  // ADDF/SUBF/MULF/DIVF on C++ doubles
+            Constant,    // LOADI/LOADF, whose value is part of the instruction
+            Move,        // MOVE, inside a run only when its source is a number there
+            Compare,     // EQF/LTF/LEF on C++ doubles, then branch
+            Loop,        // Numeric FORLOOP on C++ doubles (FORPREP checked the operands)
+        };
+
+        Lowering lowering(Instruction instruction) noexcept {
+            switch (backend::InstructionEncoder::decode_opcode(instruction)) {
+                case OpCode::OP_LOADI:
+                case OpCode::OP_LOADF:
+                    return Lowering::Constant;
+                case OpCode::OP_MOVE:
+                    return Lowering::Move;
+                case OpCode::OP_ADDF:
+                case OpCode::OP_SUBF:
+                case OpCode::OP_MULF:
+                case OpCode::OP_DIVF:
+                    return Lowering::Arithmetic;
+                case OpCode::OP_EQF:
+                case OpCode::OP_LTF:
+                case OpCode::OP_LEF:
+                    return Lowering::Compare;
+                case OpCode::OP_FORLOOP:
+                    // The loop variable R[A+3] has to be a valid register number
+                    return backend::InstructionEncoder::decode_a(instruction) + 3 <= 255
+                               ? Lowering::Loop
+                               : Lowering::Helper;
+                default:
+                    return Lowering::Helper;
+            }
+        }
+
+        const char* operator_text(OpCode op) noexcept {
+            switch (op) {
+                case OpCode::OP_ADDF:
+                    return "+";
+                case OpCode::OP_SUBF:
+                    return "-";
+                case OpCode::OP_MULF:
+                    return "*";
+                case OpCode::OP_DIVF:
+                    return "/";
+                case OpCode::OP_EQF:
+                    return "==";
+                case OpCode::OP_LTF:
+                    return "<";
+                default:
+                    return "<=";
+            }
+        }
+
+        String register_text(Size reg) {
+            return "r[" + std::to_string(reg) + "]";
+        }
+
+        /**
+         * @brief End of the number run starting at start, or start if there is none
+         *
+         * A run is typed arithmetic together with the constant loads and copies
+         * of numbers between it, closed by at most one comparison or loop step.
+         * Without any typed instruction it would only add loads and stores.
+         */
+        Size number_run_end(const std::vector<Instruction>& instructions, Size start) {
+            std::set<Size> numbers;  // Registers known to hold numbers so far in the run
+            bool typed = false;
+            Size end = start;
+            for (; end < instructions.size(); ++end) {
+                Instruction instruction = instructions[end];
+                Size a = backend::InstructionEncoder::decode_a(instruction);
+                Size b = backend::InstructionEncoder::decode_b(instruction);
+                Lowering kind = lowering(instruction);
+                if (kind == Lowering::Arithmetic) {
+                    numbers.insert({a, b, backend::InstructionEncoder::decode_c(instruction)});
+                    typed = true;
+                } else if (kind == Lowering::Constant ||
+                           (kind == Lowering::Move && numbers.count(b) != 0)) {
+                    numbers.insert(a);
+                } else {
+                    break;
+                }
+            }
+            if (end < instructions.size() && (lowering(instructions[end]) == Lowering::Compare ||
+                                              lowering(instructions[end]) == Lowering::Loop)) {
+                ++end;
+                typed = true;
+            }
+            return typed ? end : start;
+        }
+
+    }  // namespace
+
+    String AotCompiler::emit(const backend::BytecodeFunction& main, const String& source_name) {
+        String out;
+        out += "// Generated by rangelua --aot from " + comment_text(source_name) + "\n";
+        out += "// Build: c++ -O2 -shared -fPIC <this file> -o <module>.so\n\n";
+        out += MODULE_PRELUDE;
+
+        std::vector<Size> emitted;
+        if (!main.instructions.empty()) {
+            emit_prototype(out, 0, main.name, main.instructions);
+            emitted.push_back(0);
+        }
+        for (Size i = 0; i < main.prototypes.size(); ++i) {
+            const auto& prototype = main.prototypes[i];
+            if (!prototype.instructions.empty()) {
+                emit_prototype(out, i + 1, prototype.name, prototype.instructions);
+                emitted.push_back(i + 1);
+            }
+        }
+
+        out += "\n    const Prototype prototypes[] = {\n";
+        for (Size index : emitted) {
+            auto id = std::to_string(index);
+            out += "        {code_" + id + ", sizeof(code_" + id + ") / sizeof(code_" + id +
+                   "[0]), &proto_" + id + "},\n";
+        }
+        out += "    };\n\n";
+        out += "    const ModuleInfo module_info = {" + std::to_string(AOT_ABI_VERSION) + "u, " +
+               std::to_string(emitted.size()) + "u, prototypes};\n\n";
+        out += "}  // namespace\n\n";
+
+        out += "extern \"C\" const void* " + String(AOT_ENTRY_SYMBOL) + "(const void* runtime) {\n";
+        out += "    const auto* rt = static_cast<const Runtime*>(runtime);\n";
+        out += "    if (rt == nullptr || rt->abi_version != " + std::to_string(AOT_ABI_VERSION) +
+               "u || rt->helper_count < " +
+               std::to_string(static_cast<unsigned>(HelperId::Count)) + "u) {\n";
+        out += "        return nullptr;\n";
+        out += "    }\n";
+        out += "    h = rt->helpers;\n";
+        out += "    s = rt->strategies;\n";
+        out += "    ld = rt->load_numbers;\n";
+        out += "    st = rt->store_numbers;\n";
+        out += "    return &module_info;\n";
+        out += "}\n";
+        return out;
+    }
+
+    void AotCompiler::emit_prototype(String& out,
+                                     Size index,
+                                     const String& name,
+                                     const std::vector<Instruction>& instructions) {
+        const auto id = std::to_string(index);
+        const Size count = instructions.size();
+        auto in_range = [count](std::int64_t target) {
+            return target >= 0 && target <= static_cast<std::int64_t>(count);
+        };
+        auto label = [](std::int64_t pc) { return "pc_" + std::to_string(pc); };
+        auto jump = [&](std::int64_t target) {
+            return in_range(target) ? "goto " + label(target) + ";"
+                                    : "{ next = " + std::to_string(target) + "; goto dispatch; }";
+        };
+        auto opcode_text = [&](Size pc) {
+            return String(backend::Disassembler::opcode_name(
+                backend::InstructionEncoder::decode_opcode(instructions[pc])));
+        };
+
+        out += "\n    // " + comment_text(name.empty() ? String("<anonymous>") : name) + " (" +
+               std::to_string(count) + " instructions)\n";
+        out += "    const std::uint32_t code_" + id + "[] = {";
+        for (Size pc = 0; pc < count; ++pc) {
+            out += (pc % 6 == 0) ? "\n        " : " ";
+            out += hex(AotModule::module_instruction(instructions[pc])) + ",";
+        }
+        out += "\n    };\n";
+
+        // One helper call per instruction, as the baseline JIT emits it
+        auto emit_call = [&](String& code, Size pc) {
+            Instruction instruction = generic_instruction(instructions[pc]);
+            OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+            auto pc_value = static_cast<std::int64_t>(pc);
+
+            if (op == OpCode::OP_JMP) {
+                std::int64_t target =
+                    pc_value + 1 + backend::InstructionEncoder::decode_sbx(instruction);
+                if (in_range(target)) {
+                    code += "        goto " + label(target) + ";\n";
+                    return;
+                }
+            }
+
+            Stencil stencil = select_stencil(op, instruction, pc);
+            code += "        next = h[" + std::to_string(static_cast<unsigned>(stencil.helper)) +
+                    "](frame, s[" + std::to_string(static_cast<unsigned>(op)) + "], " +
+                    hex(instruction) + ", " + std::to_string(pc) + ");\n";
+            if (in_range(stencil.alternate) && stencil.alternate != pc_value + 1) {
+                code += "        if (next == " + std::to_string(stencil.alternate) + ") goto " +
+                        label(stencil.alternate) + ";\n";
+            }
+            code += "        if (next != " + std::to_string(pc + 1) + ") goto dispatch;\n";
+        };
+
+        // Register lists for the loads and stores of number runs
+        String tables;
+        Size table_count = 0;
+        auto register_list = [&](const std::set<Size>& registers) {
+            String list_name = "regs_" + id + "_" + std::to_string(table_count++);
+            tables += "    const std::uint8_t " + list_name + "[] = {";
+            for (Size reg : registers) {
+                tables += (reg == *registers.begin() ? "" : ", ") + std::to_string(reg) + "u";
+            }
+            tables += "};\n";
+            return list_name + ", " + std::to_string(registers.size()) + "u";
+        };
+
+        String body;
+        String entries;  // Helper calls for pcs inside a run, which only jumps can reach
+        Size highest = 0;
+        Size pc = 0;
+        while (pc < count) {
+            Size end = number_run_end(instructions, pc);
+            if (end == pc) {
+                body += "    " + label(static_cast<std::int64_t>(pc)) + ":  // " + opcode_text(pc) +
+                        "\n";
+                emit_call(body, pc);
+                ++pc;
+                continue;
+            }
+
+            // Registers of the run live in r[] from their first read until they are stored
+            // back, before the run branches or ends
+            std::set<Size> loaded;
+            std::set<Size> dirty;
+            String code;
+            auto read = [&](Size reg) {
+                if (dirty.count(reg) == 0) {
+                    loaded.insert(reg);
+                }
+                highest = std::max(highest, reg);
+                return register_text(reg);
+            };
+            auto write = [&](Size reg) {
+                dirty.insert(reg);
+                highest = std::max(highest, reg);
+                return register_text(reg);
+            };
+            auto store = [&](const std::set<Size>& registers, const char* indent) {
+                if (!registers.empty()) {
+                    code += String(indent) + "st(frame, " + register_list(registers) + ", r);\n";
+                }
+            };
+
+            for (Size at = pc; at < end; ++at) {
+                Instruction instruction = instructions[at];
+                OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+                Size a = backend::InstructionEncoder::decode_a(instruction);
+                if (at != pc) {
+                    code += "        // " + std::to_string(at) + ": " + opcode_text(at) + "\n";
+                    entries += "    " + label(static_cast<std::int64_t>(at)) + ":  // " +
+                               opcode_text(at) + "\n";
+                    emit_call(entries, at);
+                }
+
+                switch (lowering(instruction)) {
+                    case Lowering::Arithmetic: {
+                        String left = read(backend::InstructionEncoder::decode_b(instruction));
+                        String right = read(backend::InstructionEncoder::decode_c(instruction));
+                        code += "        " + write(a) + " = " + left + " " + operator_text(op) +
+                                " " + right + ";\n";
+                        break;
+                    }
+                    case Lowering::Constant: {
+                        auto value = backend::InstructionEncoder::decode_sbx(instruction);
+                        code += "        " + write(a) + " = " + std::to_string(value) + ";\n";
+                        break;
+                    }
+                    case Lowering::Move: {
+                        String source = read(backend::InstructionEncoder::decode_b(instruction));
+                        code += "        " + write(a) + " = " + source + ";\n";
+                        break;
+                    }
+                    case Lowering::Compare: {
+                        String condition = read(a) + " " + operator_text(op) + " " +
+                                           read(backend::InstructionEncoder::decode_b(instruction));
+                        store(dirty, "        ");
+                        // Skips the next instruction when the result matches k
+                        bool k = backend::InstructionEncoder::decode_c(instruction) != 0;
+                        code += "        if (" + (k ? condition : "!(" + condition + ")") + ") " +
+                                jump(static_cast<std::int64_t>(at) + 2) + "\n";
+                        dirty.clear();
+                        break;
+                    }
+                    case Lowering::Loop: {
+                        String index_text = read(a);
+                        String limit = read(a + 1);
+                        String step = read(a + 2);
+                        code += "        " + write(a) + " += " + step + ";\n";
+                        std::set<Size> continuing = dirty;
+                        continuing.insert(a + 3);
+                        code += "        if (" + step + " > 0 ? " + index_text + " <= " + limit +
+                                " : " + index_text + " >= " + limit + ") {\n";
+                        code += "            " + register_text(a + 3) + " = " + index_text + ";\n";
+                        highest = std::max(highest, a + 3);
+                        store(continuing, "            ");
+                        code += "            " +
+                                jump(static_cast<std::int64_t>(at) + 1 +
+                                     backend::InstructionEncoder::decode_sbx(instruction)) +
+                                "\n";
+                        code += "        }\n";
+                        break;
+                    }
+                    case Lowering::Helper:
+                        break;
+                }
+            }
+            store(dirty, "        ");
+
+            body += "    " + label(static_cast<std::int64_t>(pc)) + ":  // " + opcode_text(pc) +
+                    ", numbers in r[] up to pc " + std::to_string(end - 1) + "\n";
+            if (!loaded.empty()) {
+                body += "        ld(frame, " + register_list(loaded) + ", r);\n";
+            }
+            body += code;
+            if (end - pc > 1) {
+                entries += "        goto " + label(static_cast<std::int64_t>(end)) + ";\n";
+            }
+            pc = end;
+        }
+
+        out += tables + "\n";
+
+        // Same control flow as the baseline JIT: the switch replaces its address table
+        out += "    std::int64_t proto_" + id + "(void* frame, std::int64_t next) {\n";
+        if (table_count != 0) {
+            out += "        double r[" + std::to_string(highest + 1) + "];\n";
+        }
+        out += "    dispatch:\n";
+        out += "        switch (next) {\n";
+        for (Size target = 0; target <= count; ++target) {
+            out += "            case " + std::to_string(target) + ": goto " +
+                   label(static_cast<std::int64_t>(target)) + ";\n";
+        }
+        out += "            default: return next;\n";
+        out += "        }\n";
+        out += body;
+
+        // Falling off the end leaves the frame with pc == count
+        out += "    " + label(static_cast<std::int64_t>(count)) + ":\n";
+        out += "        return " + std::to_string(count) + ";\n";
+        out += entries;
+        out += "    }\n";
+    }
+
+}  // namespace rangelua::runtime::jit
@@ -0,0 +1,153 @@
+/**
+ * @file aot_module.cpp
+ * @brief Loading and binding of ahead-of-time compiled modules
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/jit/aot.hpp>
+#include <rangelua/runtime/vm/instruction_strategy.hpp>
+#include <rangelua/utils/logger.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#define RANGELUA_HAS_DLOPEN 1
+#endif
+
+namespace rangelua::runtime::jit {
+
+    namespace {
+
+        constexpr Size STRATEGY_SLOTS = 128;  // Opcode field is 7 bits wide
+
+        /**
+         * @brief Helper and strategy tables shared by every loaded module
+         */
+        struct SharedRuntime {
+            std::unique_ptr<InstructionStrategyRegistry> registry;
+            HelperFunction helpers[static_cast<Size>(HelperId::Count)] = {};
+            std::uint64_t strategies[STRATEGY_SLOTS] = {};
+            AotRuntime runtime;
+
+            SharedRuntime() : registry(InstructionStrategyFactory::create_registry()) {
+                for (Size i = 0; i < static_cast<Size>(HelperId::Count); ++i) {
+                    helpers[i] = helper_address(static_cast<HelperId>(i));
+                }
+                for (Size op = 0; op < STRATEGY_SLOTS; ++op) {
+                    strategies[op] = reinterpret_cast<std::uint64_t>(
+                        registry->get_strategy(static_cast<OpCode>(op)));
+                }
+                runtime.helper_count = static_cast<std::uint32_t>(HelperId::Count);
+                runtime.helpers = helpers;
+                runtime.strategies = strategies;
+                runtime.load_numbers = &JitHelpers::load_numbers;
+                runtime.store_numbers = &JitHelpers::store_numbers;
+            }
+        };
+
+        const SharedRuntime& shared_runtime() {
+            static const SharedRuntime instance;
+            return instance;
+        }
+
+        /**
+         * @brief FNV-1a over the module form of an instruction stream
+         */
+        template <typename Word>
+        std::uint64_t fingerprint(const Word* code, Size count) noexcept {
+            std::uint64_t hash = 14695981039346656037ULL;
+            for (Size i = 0; i < count; ++i) {
+                auto instruction = static_cast<Instruction>(code[i]);
+                hash = (hash ^ AotModule::module_instruction(instruction)) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+    }  // namespace
+
+    Instruction AotModule::module_instruction(Instruction instruction) noexcept {
+        OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+        OpCode generic = instruction_utils::generic_opcode(op);
+        if (instruction_utils::number_typed_opcode(generic) == op) {
+            return instruction;
+        }
+        return LuaInstruction(instruction).with_opcode(generic).raw;
+    }
+
+    Result<std::shared_ptr<const AotModule>> AotModule::load(const String& path) {
+#ifdef RANGELUA_HAS_DLOPEN
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            VM_LOG_ERROR("AOT: cannot load {}: {}", path, dlerror());
+            return make_error<std::shared_ptr<const AotModule>>(ErrorCode::IO_ERROR);
+        }
+
+        using BindFunction = const void* (*)(const void*);
+        auto bind = reinterpret_cast<BindFunction>(dlsym(handle, AOT_ENTRY_SYMBOL));
+        if (bind == nullptr) {
+            VM_LOG_ERROR("AOT: {} does not export {}", path, AOT_ENTRY_SYMBOL);
+            dlclose(handle);
+            return make_error<std::shared_ptr<const AotModule>>(ErrorCode::IO_ERROR);
+        }
+
+        const auto& shared = shared_runtime();
+        const auto* info = static_cast<const AotModuleInfo*>(bind(&shared.runtime));
+        if (info == nullptr || info->abi_version != AOT_ABI_VERSION) {
+            VM_LOG_ERROR("AOT: {} was built for a different runtime version", path);
+            dlclose(handle);
+            return make_error<std::shared_ptr<const AotModule>>(ErrorCode::RUNTIME_ERROR);
+        }
+
+        auto module = std::make_shared<AotModule>();
+        for (std::uint32_t i = 0; i < info->prototype_count; ++i) {
+            const AotPrototype& prototype = info->prototypes[i];
+
+            // Generated code calls through the strategy table; a missing entry would be a null call
+            bool supported = prototype.entry != nullptr;
+            for (std::uint32_t pc = 0; supported && pc < prototype.instruction_count; ++pc) {
+                OpCode op = backend::InstructionEncoder::decode_opcode(prototype.instructions[pc]);
+                supported = shared.strategies[static_cast<Size>(op)] != 0;
+            }
+            if (!supported) {
+                VM_LOG_WARN("AOT: skipping prototype {} in {}: unsupported instructions", i, path);
+                continue;
+            }
+
+            auto code = std::make_shared<CompiledFunction>();
+            code->entry = prototype.entry;
+            code->instruction_count = prototype.instruction_count;
+
+            module->by_fingerprint_.emplace(
+                fingerprint(prototype.instructions, prototype.instruction_count),
+                module->prototypes_.size());
+            module->prototypes_.push_back(Entry{&prototype, std::move(code)});
+        }
+        // The handle is intentionally kept open: closures may hold entry points into it
+        return std::shared_ptr<const AotModule>(std::move(module));
+#else
+        VM_LOG_ERROR("AOT: loading native modules is not supported on this platform ({})", path);
+        return make_error<std::shared_ptr<const AotModule>>(ErrorCode::RUNTIME_ERROR);
+#endif
+    }
+
+    std::shared_ptr<const CompiledFunction>
+    AotModule::find(const std::vector<Instruction>& instructions) const {
+        auto [begin, end] =
+            by_fingerprint_.equal_range(fingerprint(instructions.data(), instructions.size()));
+        for (auto it = begin; it != end; ++it) {
+            const Entry& entry = prototypes_[it->second];
+            if (entry.prototype->instruction_count != instructions.size()) {
+                continue;
+            }
+            bool same = true;
+            for (Size pc = 0; same && pc < instructions.size(); ++pc) {
+                same = module_instruction(entry.prototype->instructions[pc]) ==
+                       module_instruction(instructions[pc]);
+            }
+            if (same) {
+                return entry.code;
+            }
+        }
+        return nullptr;
+    }
+
+}  // namespace rangelua::runtime::jit
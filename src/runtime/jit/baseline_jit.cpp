@@ -0,0 +1,492 @@
+/**
+ * @file baseline_jit.cpp
+ * @brief Baseline template JIT compiler implementation
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/jit/baseline_jit.hpp>
+#include <rangelua/runtime/jit/x64_assembler.hpp>
+#include <rangelua/runtime/value.hpp>
+#include <rangelua/runtime/vm.hpp>
+#include <rangelua/runtime/vm/instruction_strategy.hpp>
+#include <rangelua/utils/logger.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+
+namespace rangelua::runtime::jit {
+
+    Stencil select_stencil(OpCode op, Instruction instruction, Size pc) noexcept {
+        auto next_but_one = static_cast<std::int64_t>(pc) + 2;
+
+        switch (instruction_utils::generic_opcode(op)) {
+            case OpCode::OP_MOVE:
+                return {HelperId::Move};
+            case OpCode::OP_LOADI:
+                return {HelperId::LoadInteger};
+            case OpCode::OP_LOADF:
+                return {HelperId::LoadFloat};
+            case OpCode::OP_LOADFALSE:
+                return {HelperId::LoadFalse};
+            case OpCode::OP_LOADTRUE:
+                return {HelperId::LoadTrue};
+            case OpCode::OP_TEST:
+                return {HelperId::Test, next_but_one};
+            case OpCode::OP_ADD:
+                return {HelperId::Add};
+            case OpCode::OP_SUB:
+                return {HelperId::Sub};
+            case OpCode::OP_MUL:
+                return {HelperId::Mul};
+            case OpCode::OP_DIV:
+                return {HelperId::Div};
+            case OpCode::OP_EQ:
+                return {HelperId::Eq, next_but_one};
+            case OpCode::OP_LT:
+                return {HelperId::Lt, next_but_one};
+            case OpCode::OP_LE:
+                return {HelperId::Le, next_but_one};
+            case OpCode::OP_FORLOOP:
+                return {HelperId::ForLoop,
+                        static_cast<std::int64_t>(pc) + 1 +
+                            backend::InstructionEncoder::decode_sbx(instruction)};
+            case OpCode::OP_FORPREP:
+                return {HelperId::Generic,
+                        static_cast<std::int64_t>(pc) + 1 +
+                            backend::InstructionEncoder::decode_sbx(instruction)};
+            case OpCode::OP_HOISTGET:
+            case OpCode::OP_EQJMP:
+            case OpCode::OP_LTJMP:
+            case OpCode::OP_LEJMP:
+                return {HelperId::Generic,
+                        static_cast<std::int64_t>(pc) + 1 +
+                            backend::InstructionEncoder::decode_c(instruction)};
+            default:
+                return {};
+        }
+    }
+
+    HelperFunction helper_address(HelperId id) noexcept {
+        static constexpr HelperFunction helpers[] = {
+            &JitHelpers::execute_generic,
+            &JitHelpers::move,
+            &JitHelpers::load_integer,
+            &JitHelpers::load_float,
+            &JitHelpers::load_false,
+            &JitHelpers::load_true,
+            &JitHelpers::test,
+            &JitHelpers::add,
+            &JitHelpers::sub,
+            &JitHelpers::mul,
+            &JitHelpers::div,
+            &JitHelpers::eq,
+            &JitHelpers::lt,
+            &JitHelpers::le,
+            &JitHelpers::for_loop,
+        };
+        static_assert(std::size(helpers) == static_cast<Size>(HelperId::Count));
+        return helpers[static_cast<Size>(id)];
+    }
+
+    BaselineCompiler::BaselineCompiler(const InstructionStrategyRegistry& registry)
+        : registry_(registry) {}
+
+    std::shared_ptr<const CompiledFunction>
+    BaselineCompiler::compile(const backend::BytecodeFunction& function) {
+        const auto& code = function.instructions;
+        const Size count = code.size();
+        if (count == 0 || count > static_cast<Size>(std::numeric_limits<std::int32_t>::max() / 2)) {
+            return nullptr;
+        }
+
+        X64Assembler as;
+        std::vector<Label> pcs;
+        pcs.reserve(count + 1);
+        for (Size pc = 0; pc <= count; ++pc) {
+            pcs.push_back(as.new_label());
+        }
+        Label dispatch = as.new_label();
+        Label exit = as.new_label();
+        Label table = as.new_label();
+
+        auto in_range = [count](std::int64_t target) {
+            return target >= 0 && target <= static_cast<std::int64_t>(count);
+        };
+
+        // Prologue: r12 holds the JitFrame, rax the pc to start at
+        as.push_callee_saved();
+        as.mov_r12_rdi();
+        as.mov_rax_rsi();
+        as.jmp(dispatch);
+
+        for (Size pc = 0; pc < count; ++pc) {
+            as.bind(pcs[pc]);
+
+            Instruction instruction = code[pc];
+            OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+
+            // Unconditional jumps inside the function become native jumps
+            if (instruction_utils::generic_opcode(op) == OpCode::OP_JMP) {
+                std::int64_t target = static_cast<std::int64_t>(pc) + 1 +
+                                      backend::InstructionEncoder::decode_sbx(instruction);
+                if (in_range(target)) {
+                    as.jmp(pcs[static_cast<Size>(target)]);
+                    continue;
+                }
+            }
+
+            IInstructionStrategy* strategy = registry_.get_strategy(op);
+            if (strategy == nullptr) {
+                VM_LOG_WARN("JIT: no strategy for opcode {} in {}",
+                            static_cast<int>(op), function.name);
+                return nullptr;
+            }
+
+            Stencil stencil = select_stencil(op, instruction, pc);
+
+            as.mov_rdi_r12();
+            as.mov_rsi_imm64(reinterpret_cast<std::uint64_t>(strategy));
+            as.mov_edx_imm32(instruction);
+            as.mov_ecx_imm32(static_cast<std::uint32_t>(pc));
+            as.mov_rax_imm64(reinterpret_cast<std::uint64_t>(helper_address(stencil.helper)));
+            as.call_rax();
+
+            if (in_range(stencil.alternate) &&
+                stencil.alternate != static_cast<std::int64_t>(pc) + 1) {
+                as.cmp_rax_imm32(static_cast<std::int32_t>(stencil.alternate));
+                as.je(pcs[static_cast<Size>(stencil.alternate)]);
+            }
+            as.cmp_rax_imm32(static_cast<std::int32_t>(pc + 1));
+            as.jne(dispatch);
+        }
+
+        // Falling off the end leaves the frame with pc == count
+        as.bind(pcs[count]);
+        as.mov_rax_imm64(count);
+        as.jmp(exit);
+
+        // Indirect dispatch for computed targets; anything out of range leaves
+        as.bind(dispatch);
+        as.test_rax_rax();
+        as.js(exit);
+        as.cmp_rax_imm32(static_cast<std::int32_t>(count));
+        as.jae(exit);
+        as.jmp_table_indexed_by_rax(table);
+
+        as.bind(exit);
+        as.pop_callee_saved_and_return();
+
+        pcs.pop_back();
+        as.emit_address_table(table, pcs);
+
+        std::uint8_t* memory = arena_.begin_write(as.size());
+        if (memory == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(memory, as.code().data(), as.size());
+        as.relocate(memory);
+        if (!arena_.end_write(memory, as.size())) {
+            return nullptr;
+        }
+
+        auto compiled = std::make_shared<CompiledFunction>();
+        compiled->entry = reinterpret_cast<EntryPoint>(memory);
+        compiled->instruction_count = count;
+        compiled->code_size = as.size();
+
+        ++stats_.compiled;
+        stats_.code_bytes += as.size();
+        VM_LOG_DEBUG("JIT: compiled {} ({} instructions, {} bytes)",
+                     function.name, count, as.size());
+        return compiled;
+    }
+
+    // Helper stencils
+
+    std::int64_t JitHelpers::resume_point(JitFrame* jf) {
+        VirtualMachine* vm = jf->vm;
+        if (vm->state_ != VMState::Running || vm->call_stack_.size() != jf->depth) {
+            return -1;
+        }
+        return static_cast<std::int64_t>(vm->call_stack_.back().instruction_pointer);
+    }
+
+    Value* JitHelpers::registers(JitFrame* jf, std::uint32_t pc, Size highest) {
+        VirtualMachine* vm = jf->vm;
+        CallFrame& frame = vm->call_stack_.back();
+        frame.instruction_pointer = pc + 1;
+
+        // Growing the stack is left to the generic path (stack_at)
+        Size top = frame.stack_base + highest + 1;
+        if (top > vm->stack_.size() || top > vm->config_.stack_size) {
+            return nullptr;
+        }
+        vm->stack_top_ = std::max(vm->stack_top_, top);
+        return vm->stack_.data() + frame.stack_base;
+    }
+
+    void JitHelpers::touch(JitFrame* jf, Size reg) {
+        VirtualMachine* vm = jf->vm;
+        vm->stack_top_ = std::max(vm->stack_top_, vm->call_stack_.back().stack_base + reg + 1);
+    }
+
+    std::int64_t JitHelpers::execute_generic(JitFrame* jf,
+                                             std::uint64_t strategy,
+                                             std::uint32_t instruction,
+                                             std::uint32_t pc) {
+        VirtualMachine* vm = jf->vm;
+        vm->call_stack_.back().instruction_pointer = pc + 1;
+
+        try {
+            auto* executor = reinterpret_cast<IInstructionStrategy*>(strategy);
+            auto status = executor->execute(*vm, instruction);
+            if (is_error(status)) {
+                jf->status = status;
+                return -1;
+            }
+        } catch (...) {
+            // Unwinding through native frames is not possible; rethrown by the VM
+            jf->exception = std::current_exception();
+            return -1;
+        }
+        return resume_point(jf);
+    }
+
+    std::int64_t JitHelpers::move(JitFrame* jf,
+                                  std::uint64_t strategy,
+                                  std::uint32_t instruction,
+                                  std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+
+        Value* r = registers(jf, pc, std::max(a, b));
+        if (r == nullptr) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        r[a] = r[b];
+        return pc + 1;
+    }
+
+    std::int64_t JitHelpers::load_integer(JitFrame* jf,
+                                          std::uint64_t strategy,
+                                          std::uint32_t instruction,
+                                          std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+
+        Value* r = registers(jf, pc, a);
+        if (r == nullptr) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        r[a] = Value(static_cast<Int>(backend::InstructionEncoder::decode_sbx(instruction)));
+        return pc + 1;
+    }
+
+    std::int64_t JitHelpers::load_float(JitFrame* jf,
+                                        std::uint64_t strategy,
+                                        std::uint32_t instruction,
+                                        std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+
+        Value* r = registers(jf, pc, a);
+        if (r == nullptr) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        r[a] = Value(static_cast<Number>(backend::InstructionEncoder::decode_sbx(instruction)));
+        return pc + 1;
+    }
+
+    std::int64_t JitHelpers::load_false(JitFrame* jf,
+                                        std::uint64_t strategy,
+                                        std::uint32_t instruction,
+                                        std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+
+        Value* r = registers(jf, pc, a);
+        if (r == nullptr) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        r[a] = Value(false);
+        return pc + 1;
+    }
+
+    std::int64_t JitHelpers::load_true(JitFrame* jf,
+                                       std::uint64_t strategy,
+                                       std::uint32_t instruction,
+                                       std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+
+        Value* r = registers(jf, pc, a);
+        if (r == nullptr) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        r[a] = Value(true);
+        return pc + 1;
+    }
+
+    std::int64_t JitHelpers::test(JitFrame* jf,
+                                  std::uint64_t strategy,
+                                  std::uint32_t instruction,
+                                  std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        Value* r = registers(jf, pc, a);
+        if (r == nullptr) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        return (c != 0) != r[a].is_truthy() ? pc + 2 : pc + 1;
+    }
+
+    template <typename Op>
+    std::int64_t JitHelpers::arithmetic(JitFrame* jf,
+                                        std::uint64_t strategy,
+                                        std::uint32_t instruction,
+                                        std::uint32_t pc,
+                                        Op op) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        Value* r = registers(jf, pc, std::max({a, b, c}));
+        if (r == nullptr || !r[b].is_number() || !r[c].is_number()) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        r[a] = Value(op(r[b].as_number(), r[c].as_number()));
+        return pc + 1;
+    }
+
+    template <typename Op>
+    std::int64_t JitHelpers::compare(JitFrame* jf,
+                                     std::uint64_t strategy,
+                                     std::uint32_t instruction,
+                                     std::uint32_t pc,
+                                     Op op) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register k = backend::InstructionEncoder::decode_c(instruction);
+
+        Value* r = registers(jf, pc, std::max(a, b));
+        if (r == nullptr || !r[a].is_number() || !r[b].is_number()) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+        return (k != 0) == op(r[a].as_number(), r[b].as_number()) ? pc + 2 : pc + 1;
+    }
+
+    std::int64_t JitHelpers::add(JitFrame* jf,
+                                 std::uint64_t strategy,
+                                 std::uint32_t instruction,
+                                 std::uint32_t pc) {
+        return arithmetic(jf, strategy, instruction, pc, std::plus<Number>{});
+    }
+
+    std::int64_t JitHelpers::sub(JitFrame* jf,
+                                 std::uint64_t strategy,
+                                 std::uint32_t instruction,
+                                 std::uint32_t pc) {
+        return arithmetic(jf, strategy, instruction, pc, std::minus<Number>{});
+    }
+
+    std::int64_t JitHelpers::mul(JitFrame* jf,
+                                 std::uint64_t strategy,
+                                 std::uint32_t instruction,
+                                 std::uint32_t pc) {
+        return arithmetic(jf, strategy, instruction, pc, std::multiplies<Number>{});
+    }
+
+    std::int64_t JitHelpers::div(JitFrame* jf,
+                                 std::uint64_t strategy,
+                                 std::uint32_t instruction,
+                                 std::uint32_t pc) {
+        return arithmetic(jf, strategy, instruction, pc, std::divides<Number>{});
+    }
+
+    std::int64_t JitHelpers::eq(JitFrame* jf,
+                                std::uint64_t strategy,
+                                std::uint32_t instruction,
+                                std::uint32_t pc) {
+        return compare(jf, strategy, instruction, pc, std::equal_to<Number>{});
+    }
+
+    std::int64_t JitHelpers::lt(JitFrame* jf,
+                                std::uint64_t strategy,
+                                std::uint32_t instruction,
+                                std::uint32_t pc) {
+        return compare(jf, strategy, instruction, pc, std::less<Number>{});
+    }
+
+    std::int64_t JitHelpers::le(JitFrame* jf,
+                                std::uint64_t strategy,
+                                std::uint32_t instruction,
+                                std::uint32_t pc) {
+        return compare(jf, strategy, instruction, pc, std::less_equal<Number>{});
+    }
+
+    std::int64_t JitHelpers::for_loop(JitFrame* jf,
+                                      std::uint64_t strategy,
+                                      std::uint32_t instruction,
+                                      std::uint32_t pc) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+
+        // The loop variable R[A+3] must be addressable before any state changes
+        VirtualMachine* vm = jf->vm;
+        Size loop_variable = vm->call_stack_.back().stack_base + a + 3;
+        Value* r = registers(jf, pc, a + 2);
+        if (r == nullptr || loop_variable >= vm->stack_.size() ||
+            loop_variable >= vm->config_.stack_size || !r[a].is_number() ||
+            !r[a + 1].is_number() || !r[a + 2].is_number()) {
+            return execute_generic(jf, strategy, instruction, pc);
+        }
+
+        Number step = r[a + 2].as_number();
+        Number index = r[a].as_number() + step;
+        Number limit = r[a + 1].as_number();
+        r[a] = Value(index);
+
+        if (step > 0 ? index <= limit : index >= limit) {
+            touch(jf, a + 3);
+            r[a + 3] = Value(index);
+            return static_cast<std::int64_t>(pc) + 1 +
+                   backend::InstructionEncoder::decode_sbx(instruction);
+        }
+        return pc + 1;
+    }
+
+    void JitHelpers::load_numbers(JitFrame* jf,
+                                  const std::uint8_t* registers,
+                                  std::uint32_t count,
+                                  double* values) {
+        // Earlier typed instructions or FORPREP proved these registers hold numbers
+        VirtualMachine* vm = jf->vm;
+        Size base = vm->call_stack_.back().stack_base;
+        for (std::uint32_t i = 0; i < count; ++i) {
+            Size index = base + registers[i];
+            const Value& value = index < vm->stack_.size() ? vm->stack_[index]
+                                                           : vm->stack_at(registers[i]);
+            values[registers[i]] = value.as_number();
+        }
+    }
+
+    void JitHelpers::store_numbers(JitFrame* jf,
+                                   const std::uint8_t* registers,
+                                   std::uint32_t count,
+                                   const double* values) {
+        // Registers come in ascending order, so the last one bounds the stack
+        VirtualMachine* vm = jf->vm;
+        Size base = vm->call_stack_.back().stack_base;
+        Size top = base + registers[count - 1] + 1;
+        if (top > vm->stack_.size() || top > vm->config_.stack_size) {
+            for (std::uint32_t i = 0; i < count; ++i) {
+                vm->stack_at(registers[i]) = Value(values[registers[i]]);
+            }
+            return;
+        }
+        for (std::uint32_t i = 0; i < count; ++i) {
+            vm->stack_[base + registers[i]] = Value(values[registers[i]]);
+        }
+        vm->stack_top_ = std::max(vm->stack_top_, top);
+    }
+
+}  // namespace rangelua::runtime::jit
@@ -0,0 +1,111 @@
+/**
+ * @file code_arena.cpp
+ * @brief Executable memory arena implementation
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/jit/code_arena.hpp>
+#include <rangelua/utils/logger.hpp>
+
+#include <algorithm>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define RANGELUA_HAS_MMAP 1
+#endif
+
+namespace rangelua::runtime::jit {
+
+    namespace {
+
+        Size page_size() noexcept {
+#ifdef RANGELUA_HAS_MMAP
+            static const Size size = static_cast<Size>(sysconf(_SC_PAGESIZE));
+            return size;
+#else
+            return 4096;
+#endif
+        }
+
+        Size round_up(Size value, Size alignment) noexcept {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+    }  // namespace
+
+    CodeArena::CodeArena(Size chunk_size) : chunk_size_(round_up(chunk_size, page_size())) {}
+
+    CodeArena::~CodeArena() {
+#ifdef RANGELUA_HAS_MMAP
+        for (const auto& chunk : chunks_) {
+            munmap(chunk.base, chunk.size);
+        }
+#endif
+    }
+
+    bool CodeArena::protect(const Chunk& chunk, bool writable) noexcept {
+#ifdef RANGELUA_HAS_MMAP
+        int prot = writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC);
+        return mprotect(chunk.base, chunk.size, prot) == 0;
+#else
+        return false;
+#endif
+    }
+
+    std::uint8_t* CodeArena::begin_write(Size size) {
+#ifdef RANGELUA_HAS_MMAP
+        if (writing_ != nullptr || size == 0) {
+            return nullptr;
+        }
+
+        // Keep code 16-byte aligned
+        size = round_up(size, 16);
+
+        Chunk* target = nullptr;
+        if (!chunks_.empty() && chunks_.back().size - chunks_.back().used >= size) {
+            target = &chunks_.back();
+        } else {
+            Size bytes = std::max(chunk_size_, round_up(size, page_size()));
+            void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) {
+                VM_LOG_WARN("JIT: failed to map {} bytes of code memory", bytes);
+                return nullptr;
+            }
+            chunks_.push_back(Chunk{static_cast<std::uint8_t*>(memory), bytes, 0});
+            target = &chunks_.back();
+        }
+
+        if (!protect(*target, true)) {
+            VM_LOG_WARN("JIT: failed to make code memory writable");
+            return nullptr;
+        }
+
+        writing_ = target;
+        std::uint8_t* code = target->base + target->used;
+        target->used += size;
+        used_bytes_ += size;
+        return code;
+#else
+        (void)size;
+        return nullptr;
+#endif
+    }
+
+    bool CodeArena::end_write(std::uint8_t* code, Size size) {
+        if (writing_ == nullptr) {
+            return false;
+        }
+
+        __builtin___clear_cache(reinterpret_cast<char*>(code),
+                                reinterpret_cast<char*>(code + size));
+        bool sealed = protect(*writing_, false);
+        if (!sealed) {
+            VM_LOG_ERROR("JIT: failed to make code memory executable");
+        }
+        writing_ = nullptr;
+        return sealed;
+    }
+
+}  // namespace rangelua::runtime::jit
@@ -0,0 +1,251 @@
+/**
+ * @file trace_executor.cpp
+ * @brief Trace interpreter with side exits back to the bytecode interpreter
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/jit/trace.hpp>
+#include <rangelua/runtime/objects.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace rangelua::runtime::jit {
+
+    namespace {
+
+        bool is_unboxed(ValueType type) noexcept {
+            return type == ValueType::Number || type == ValueType::Boolean;
+        }
+
+        /**
+         * @brief Array slot addressed by a trace key, or 0 when the access leaves the array part
+         */
+        Size array_slot(const Table& table, Number key) noexcept {
+            if (key < 1 || key != std::floor(key) ||
+                key > static_cast<Number>(table.arraySize())) {
+                return 0;
+            }
+            return static_cast<Size>(key);
+        }
+
+        Number divide(Number dividend, Number divisor) noexcept {
+            if (divisor != 0.0) {
+                return dividend / divisor;
+            }
+            if (dividend > 0.0) {
+                return std::numeric_limits<Number>::infinity();
+            }
+            if (dividend < 0.0) {
+                return -std::numeric_limits<Number>::infinity();
+            }
+            return std::numeric_limits<Number>::quiet_NaN();
+        }
+
+        /**
+         * @brief Runs trace IR over unboxed numbers and boxed objects, one slot per IR value
+         */
+        class TraceRunner {
+        public:
+            TraceRunner(const Trace& trace, Value* registers, TraceScratch& scratch)
+                : trace_(trace), registers_(registers), scratch_(scratch) {
+                Size count = trace.ir.size();
+                if (scratch.numbers.size() < count) {
+                    scratch.numbers.resize(count);
+                    scratch.objects.resize(count);
+                }
+                if (scratch.phi_numbers.size() < trace.phis.size()) {
+                    scratch.phi_numbers.resize(trace.phis.size());
+                    scratch.phi_objects.resize(trace.phis.size());
+                }
+                numbers_ = scratch.numbers.data();
+                objects_ = scratch.objects.data();
+            }
+
+            TraceExit run() {
+                const auto& ir = trace_.ir;
+                Size count = ir.size();
+                Size i = 0;
+
+                for (;;) {
+                    for (; i < count; ++i) {
+                        const auto& instruction = ir[i];
+                        switch (instruction.op) {
+                            case IrOp::SLoad: {
+                                const Value& value = registers_[instruction.slot];
+                                if (value.type() != instruction.type) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                store(i, instruction.type, value);
+                                break;
+                            }
+                            case IrOp::KNum:
+                            case IrOp::KBool:
+                                numbers_[i] = instruction.number;
+                                break;
+                            case IrOp::Add:
+                                numbers_[i] = numbers_[instruction.a] + numbers_[instruction.b];
+                                break;
+                            case IrOp::Sub:
+                                numbers_[i] = numbers_[instruction.a] - numbers_[instruction.b];
+                                break;
+                            case IrOp::Mul:
+                                numbers_[i] = numbers_[instruction.a] * numbers_[instruction.b];
+                                break;
+                            case IrOp::Div:
+                                numbers_[i] = divide(numbers_[instruction.a], numbers_[instruction.b]);
+                                break;
+                            case IrOp::Unm:
+                                numbers_[i] = -numbers_[instruction.a];
+                                break;
+                            case IrOp::Not:
+                                numbers_[i] = numbers_[instruction.a] == 0 ? 1 : 0;
+                                break;
+                            case IrOp::ArrayGet: {
+                                const auto& table = objects_[instruction.a].as_table();
+                                Size slot = table->metatable()
+                                                ? 0
+                                                : array_slot(*table, numbers_[instruction.b]);
+                                if (slot == 0) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                Value element = table->getArray(slot);
+                                if (element.type() != instruction.type) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                store(i, instruction.type, element);
+                                break;
+                            }
+                            case IrOp::ArraySet: {
+                                const auto& table = objects_[instruction.a].as_table();
+                                Size slot = table->metatable()
+                                                ? 0
+                                                : array_slot(*table, numbers_[instruction.b]);
+                                if (slot == 0) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                table->setArray(slot, box(instruction.c));
+                                break;
+                            }
+                            case IrOp::GuardLt:
+                                if ((numbers_[instruction.a] < numbers_[instruction.b]) !=
+                                    instruction.expected) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                break;
+                            case IrOp::GuardLe:
+                                if ((numbers_[instruction.a] <= numbers_[instruction.b]) !=
+                                    instruction.expected) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                break;
+                            case IrOp::GuardEq:
+                                if ((numbers_[instruction.a] == numbers_[instruction.b]) !=
+                                    instruction.expected) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                break;
+                            case IrOp::GuardTruthy:
+                                if ((numbers_[instruction.a] != 0) != instruction.expected) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                break;
+                            case IrOp::GuardCallee:
+                                if (objects_[instruction.a].as_function().get() !=
+                                    instruction.object) {
+                                    return leave(instruction.snapshot, true);
+                                }
+                                break;
+                            case IrOp::LoopTest: {
+                                Number index = numbers_[instruction.a];
+                                Number limit = numbers_[instruction.b];
+                                bool more = numbers_[instruction.c] > 0 ? index <= limit
+                                                                         : index >= limit;
+                                if (!more) {
+                                    return leave(instruction.snapshot, false);
+                                }
+                                break;
+                            }
+                        }
+                    }
+
+                    carry_phis();
+                    first_iteration_ = false;
+                    i = trace_.body_start;
+                }
+            }
+
+        private:
+            void store(Size ref, ValueType type, const Value& value) {
+                if (type == ValueType::Number) {
+                    numbers_[ref] = value.as_number();
+                } else if (type == ValueType::Boolean) {
+                    numbers_[ref] = value.as_boolean() ? 1 : 0;
+                } else {
+                    objects_[ref] = value;
+                }
+            }
+
+            [[nodiscard]] Value box(IrRef ref) const {
+                switch (trace_.ir[ref].type) {
+                    case ValueType::Number:
+                        return Value(numbers_[ref]);
+                    case ValueType::Boolean:
+                        return Value(numbers_[ref] != 0);
+                    default:
+                        return objects_[ref];
+                }
+            }
+
+            /**
+             * @brief Parallel copy of the loop-carried values into their loads
+             */
+            void carry_phis() {
+                const auto& phis = trace_.phis;
+                for (Size k = 0; k < phis.size(); ++k) {
+                    IrRef value = phis[k].second;
+                    if (is_unboxed(trace_.ir[value].type)) {
+                        scratch_.phi_numbers[k] = numbers_[value];
+                    } else {
+                        scratch_.phi_objects[k] = objects_[value];
+                    }
+                }
+                for (Size k = 0; k < phis.size(); ++k) {
+                    IrRef load = phis[k].first;
+                    if (is_unboxed(trace_.ir[load].type)) {
+                        numbers_[load] = scratch_.phi_numbers[k];
+                    } else {
+                        objects_[load] = scratch_.phi_objects[k];
+                    }
+                }
+            }
+
+            /**
+             * @brief Write the snapshot back to the stack and report where to resume
+             */
+            TraceExit leave(std::uint16_t snapshot_index, bool side_exit) {
+                const auto& snapshot = trace_.snapshots[snapshot_index];
+                for (const auto& entry : snapshot.entries) {
+                    if (entry.carried && first_iteration_) {
+                        continue;
+                    }
+                    registers_[entry.slot] = box(entry.ref);
+                }
+                return TraceExit{snapshot.pc, side_exit};
+            }
+
+            const Trace& trace_;
+            Value* registers_;
+            TraceScratch& scratch_;
+            Number* numbers_ = nullptr;
+            Value* objects_ = nullptr;
+            bool first_iteration_ = true;
+        };
+
+    }  // namespace
+
+    TraceExit execute_trace(const Trace& trace, Value* registers, TraceScratch& scratch) {
+        return TraceRunner(trace, registers, scratch).run();
+    }
+
+}  // namespace rangelua::runtime::jit
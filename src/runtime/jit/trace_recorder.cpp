@@ -0,0 +1,962 @@
+/**
+ * @file trace_recorder.cpp
+ * @brief Loop trace recording and trace IR construction
+ * @version 0.1.0
+ */
+
+#include <rangelua/backend/bytecode.hpp>
+#include <rangelua/runtime/jit/trace.hpp>
+#include <rangelua/runtime/objects.hpp>
+#include <rangelua/runtime/vm/instruction_strategy.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace rangelua::runtime::jit {
+
+    namespace {
+
+        constexpr Size MAX_REGISTERS = LuaInstruction::MAX_A + 1;
+
+        bool is_traceable(ValueType type) noexcept {
+            return type == ValueType::Number || type == ValueType::Boolean ||
+                   type == ValueType::Table || type == ValueType::Function;
+        }
+
+        bool is_constant(const IrInstruction& instruction) noexcept {
+            return instruction.op == IrOp::KNum || instruction.op == IrOp::KBool;
+        }
+
+        /**
+         * @brief Array slot of a recorded table access, or 0 if it is not a plain in-range access
+         */
+        Size recorded_array_slot(const Value& table, const Value& key) {
+            if (!table.is_table() || !key.is_number()) {
+                return 0;
+            }
+
+            const auto& t = table.as_table();
+            if (t->metatable()) {
+                return 0;
+            }
+
+            Number index = key.as_number();
+            if (index < 1 || index != std::floor(index) ||
+                index > static_cast<Number>(t->arraySize())) {
+                return 0;
+            }
+            return static_cast<Size>(index);
+        }
+
+        const char* type_label(ValueType type) noexcept {
+            switch (type) {
+                case ValueType::Number:
+                    return "num";
+                case ValueType::Boolean:
+                    return "bool";
+                case ValueType::Table:
+                    return "tab";
+                case ValueType::Function:
+                    return "fun";
+                default:
+                    return "?";
+            }
+        }
+
+        const char* op_name(IrOp op) noexcept {
+            switch (op) {
+                case IrOp::SLoad:
+                    return "SLOAD";
+                case IrOp::KNum:
+                    return "KNUM";
+                case IrOp::KBool:
+                    return "KBOOL";
+                case IrOp::Add:
+                    return "ADD";
+                case IrOp::Sub:
+                    return "SUB";
+                case IrOp::Mul:
+                    return "MUL";
+                case IrOp::Div:
+                    return "DIV";
+                case IrOp::Unm:
+                    return "UNM";
+                case IrOp::Not:
+                    return "NOT";
+                case IrOp::ArrayGet:
+                    return "AGET";
+                case IrOp::ArraySet:
+                    return "ASET";
+                case IrOp::GuardLt:
+                    return "GLT";
+                case IrOp::GuardLe:
+                    return "GLE";
+                case IrOp::GuardEq:
+                    return "GEQ";
+                case IrOp::GuardTruthy:
+                    return "GTRUTHY";
+                case IrOp::GuardCallee:
+                    return "GCALLEE";
+                case IrOp::LoopTest:
+                    return "LOOP";
+            }
+            return "?";
+        }
+
+    }  // namespace
+
+    bool IrInstruction::is_guard() const noexcept {
+        switch (op) {
+            case IrOp::SLoad:
+            case IrOp::ArrayGet:
+            case IrOp::ArraySet:
+            case IrOp::GuardLt:
+            case IrOp::GuardLe:
+            case IrOp::GuardEq:
+            case IrOp::GuardTruthy:
+            case IrOp::GuardCallee:
+            case IrOp::LoopTest:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    String Trace::to_string() const {
+        std::ostringstream out;
+        out << "trace loop_pc=" << loop_pc << " start_pc=" << start_pc << " recorded="
+            << recorded_instructions << " inlined=" << inlined_calls << " folded=" << folded
+            << " hoisted=" << hoisted << '\n';
+
+        for (Size i = 0; i < ir.size(); ++i) {
+            if (i == body_start) {
+                out << "  ---- loop ----\n";
+            }
+            const auto& instruction = ir[i];
+            out << "  " << std::setw(4) << std::setfill('0') << i << std::setfill(' ') << ' '
+                << std::left << std::setw(8) << op_name(instruction.op) << std::right;
+            switch (instruction.op) {
+                case IrOp::SLoad:
+                    out << " #" << static_cast<unsigned>(instruction.slot) << ' '
+                        << type_label(instruction.type);
+                    break;
+                case IrOp::KNum:
+                case IrOp::KBool:
+                    out << ' ' << instruction.number;
+                    break;
+                default:
+                    for (IrRef operand : {instruction.a, instruction.b, instruction.c}) {
+                        if (operand != IR_NONE) {
+                            out << ' ' << operand;
+                        }
+                    }
+                    break;
+            }
+            if (instruction.is_guard() && instruction.op != IrOp::SLoad) {
+                out << "  [exit " << snapshots[instruction.snapshot].pc << ']';
+            }
+            out << '\n';
+        }
+
+        for (const auto& [load, value] : phis) {
+            out << "  PHI " << load << " <- " << value << '\n';
+        }
+        return out.str();
+    }
+
+    TraceRecorder::TraceRecorder(const backend::BytecodeFunction* function,
+                                 Size depth,
+                                 Size loop_pc,
+                                 Size start_pc,
+                                 Size max_length)
+        : function_(function),
+          depth_(depth),
+          loop_pc_(loop_pc),
+          start_pc_(start_pc),
+          max_length_(max_length) {
+        steps_.reserve(64);
+    }
+
+    TraceRecorder::State TraceRecorder::record(IVMContext& context,
+                                               Size depth,
+                                               Size pc,
+                                               Instruction instruction,
+                                               const Value* registers,
+                                               Size register_count) {
+        if (depth < depth_ || depth > depth_ + 1 || steps_.size() >= max_length_) {
+            return State::Aborted;
+        }
+
+        Size level = depth - depth_;
+        if (level == 0 &&
+            (context.current_function() != function_ || pc < start_pc_ || pc > loop_pc_)) {
+            return State::Aborted;  // Left the loop or unwound into another function
+        }
+
+        LuaInstruction decoded(instruction);
+        OpCode op = instruction_utils::generic_opcode(decoded.opcode());
+
+        Step step;
+        step.pc = pc;
+        step.instruction = instruction;
+        step.level = level;
+
+        // Numeric for loops read their control registers, not B and C
+        Register a = decoded.A();
+        Register operands[3] = {a, decoded.B(), decoded.C()};
+        if (op == OpCode::OP_FORLOOP) {
+            operands[1] = static_cast<Register>(a + 1);
+            operands[2] = static_cast<Register>(a + 2);
+        }
+        for (Size i = 0; i < 3; ++i) {
+            if (operands[i] < register_count) {
+                step.operands[i] = registers[operands[i]];
+            }
+        }
+        if (op == OpCode::OP_LOADK) {
+            step.constant = context.get_constant(static_cast<std::uint16_t>(decoded.Bx()));
+        }
+
+        steps_.push_back(std::move(step));
+        return (level == 0 && pc == loop_pc_) ? State::Completed : State::Recording;
+    }
+
+    /**
+     * @brief Turns a recorded loop iteration into optimized trace IR
+     *
+     * Stack slots are renamed into SSA values as they are read and written; the
+     * first read of a slot becomes a type-guarded load, and slots that are both
+     * loaded and written become loop-carried phis. Calls to small Lua functions
+     * are inlined by mapping the callee's registers onto the caller's values.
+     */
+    class TraceBuilder {
+    public:
+        explicit TraceBuilder(const TraceRecorder& recorder) : recorder_(recorder) {}
+
+        std::shared_ptr<const Trace> build();
+
+    private:
+        using Step = TraceRecorder::Step;
+
+        bool emit_step(const Step& step);
+        bool emit_arithmetic(const Step& step, IrOp op);
+        bool emit_compare(const Step& step, IrOp op);
+        bool emit_array_get(const Step& step, bool immediate_index);
+        bool emit_array_set(const Step& step, bool immediate_index);
+        bool emit_call(const Step& step);
+        bool emit_return(const Step& step);
+        bool emit_loop(const Step& step);
+        bool close_loop();
+        void hoist_invariants();
+
+        IrRef read(Size level, Register reg, const Value& recorded);
+        void write(Size level, Register reg, IrRef ref);
+        IrRef append(const IrInstruction& instruction);
+        IrRef number_constant(Number value);
+        IrRef boolean_constant(bool value);
+        IrRef arithmetic(IrOp op, IrRef left, IrRef right);
+        bool guard(IrInstruction instruction);
+        std::uint16_t snapshot(Size level, Size pc);
+
+        [[nodiscard]] ValueType type_of(IrRef ref) const { return ir_[ref].type; }
+
+        const TraceRecorder& recorder_;
+        std::vector<IrInstruction> ir_;
+        std::vector<Snapshot> snapshots_;
+
+        // Loop frame: current SSA value, loop-entry load and write flag per slot
+        std::vector<IrRef> slots_ = std::vector<IrRef>(MAX_REGISTERS, IR_NONE);
+        std::vector<IrRef> loads_ = std::vector<IrRef>(MAX_REGISTERS, IR_NONE);
+        std::vector<bool> written_ = std::vector<bool>(MAX_REGISTERS, false);
+        Size max_slot_ = 0;
+        bool has_store_ = false;
+
+        // Inlined callee
+        std::vector<IrRef> callee_slots_ = std::vector<IrRef>(MAX_REGISTERS, IR_NONE);
+        bool in_call_ = false;
+        Register call_base_ = 0;
+        Size call_results_ = 0;
+        std::uint16_t call_snapshot_ = 0;
+
+        std::vector<std::pair<IrRef, IrRef>> phis_;
+        IrRef body_start_ = 0;
+        Size inlined_calls_ = 0;
+        Size folded_ = 0;
+        Size hoisted_ = 0;
+    };
+
+    std::shared_ptr<const Trace> TraceBuilder::build() {
+        snapshots_.push_back(Snapshot{recorder_.start_pc_, {}});
+
+        for (const auto& step : recorder_.steps_) {
+            if (!emit_step(step)) {
+                return nullptr;
+            }
+            if (ir_.size() >= IR_NONE || snapshots_.size() >= IR_NONE) {
+                return nullptr;
+            }
+        }
+        if (in_call_ || !close_loop()) {
+            return nullptr;
+        }
+
+        hoist_invariants();
+
+        auto trace = std::make_shared<Trace>();
+        trace->loop_pc = recorder_.loop_pc_;
+        trace->start_pc = recorder_.start_pc_;
+        trace->ir = std::move(ir_);
+        trace->snapshots = std::move(snapshots_);
+        trace->phis = std::move(phis_);
+        trace->max_slot = max_slot_;
+        trace->recorded_instructions = recorder_.steps_.size();
+        trace->inlined_calls = inlined_calls_;
+        trace->folded = folded_;
+        trace->hoisted = hoisted_;
+        trace->body_start = body_start_;
+        return trace;
+    }
+
+    bool TraceBuilder::emit_step(const Step& step) {
+        LuaInstruction instruction(step.instruction);
+        OpCode op = instruction_utils::generic_opcode(instruction.opcode());
+        Size level = step.level;
+        Register a = instruction.A();
+        Register b = instruction.B();
+
+        if ((level == 1) != in_call_) {
+            return false;
+        }
+
+        switch (op) {
+            case OpCode::OP_MOVE: {
+                IrRef value = read(level, b, step.operands[1]);
+                if (value == IR_NONE) {
+                    return false;
+                }
+                write(level, a, value);
+                return true;
+            }
+            case OpCode::OP_LOADI:
+            case OpCode::OP_LOADF:
+                write(level, a, number_constant(static_cast<Number>(instruction.sBx())));
+                return true;
+            case OpCode::OP_LOADK:
+                if (step.constant.is_number()) {
+                    write(level, a, number_constant(step.constant.as_number()));
+                    return true;
+                }
+                if (step.constant.is_boolean()) {
+                    write(level, a, boolean_constant(step.constant.as_boolean()));
+                    return true;
+                }
+                return false;
+            case OpCode::OP_LOADTRUE:
+                write(level, a, boolean_constant(true));
+                return true;
+            case OpCode::OP_LOADFALSE:
+                write(level, a, boolean_constant(false));
+                return true;
+            case OpCode::OP_ADD:
+                return emit_arithmetic(step, IrOp::Add);
+            case OpCode::OP_SUB:
+                return emit_arithmetic(step, IrOp::Sub);
+            case OpCode::OP_MUL:
+                return emit_arithmetic(step, IrOp::Mul);
+            case OpCode::OP_DIV:
+                return emit_arithmetic(step, IrOp::Div);
+            case OpCode::OP_UNM: {
+                if (!step.operands[1].is_number()) {
+                    return false;
+                }
+                IrRef operand = read(level, b, step.operands[1]);
+                if (operand == IR_NONE) {
+                    return false;
+                }
+                if (is_constant(ir_[operand])) {
+                    ++folded_;
+                    write(level, a, number_constant(-ir_[operand].number));
+                    return true;
+                }
+                IrInstruction negate;
+                negate.op = IrOp::Unm;
+                negate.a = operand;
+                write(level, a, append(negate));
+                return true;
+            }
+            case OpCode::OP_NOT: {
+                IrRef operand = read(level, b, step.operands[1]);
+                if (operand == IR_NONE) {
+                    return false;
+                }
+                if (type_of(operand) != ValueType::Boolean) {
+                    write(level, a, boolean_constant(false));  // Numbers and objects are truthy
+                    return true;
+                }
+                if (is_constant(ir_[operand])) {
+                    ++folded_;
+                    write(level, a, boolean_constant(ir_[operand].number == 0));
+                    return true;
+                }
+                IrInstruction negate;
+                negate.op = IrOp::Not;
+                negate.type = ValueType::Boolean;
+                negate.a = operand;
+                write(level, a, append(negate));
+                return true;
+            }
+            case OpCode::OP_EQ:
+            case OpCode::OP_EQJMP:
+                return emit_compare(step, IrOp::GuardEq);
+            case OpCode::OP_LT:
+            case OpCode::OP_LTJMP:
+                return emit_compare(step, IrOp::GuardLt);
+            case OpCode::OP_LE:
+            case OpCode::OP_LEJMP:
+                return emit_compare(step, IrOp::GuardLe);
+            case OpCode::OP_TEST: {
+                IrRef value = read(level, a, step.operands[0]);
+                if (value == IR_NONE) {
+                    return false;
+                }
+                IrInstruction test;
+                test.op = IrOp::GuardTruthy;
+                test.a = value;
+                test.expected = step.operands[0].is_truthy();
+                test.snapshot = snapshot(level, step.pc);
+                return guard(test);
+            }
+            case OpCode::OP_JMP:
+                return true;  // The trace follows the recorded path
+            case OpCode::OP_GETTABLE:
+                return emit_array_get(step, false);
+            case OpCode::OP_GETI:
+                return emit_array_get(step, true);
+            case OpCode::OP_SETTABLE:
+                return level == 0 && emit_array_set(step, false);
+            case OpCode::OP_SETI:
+                return level == 0 && emit_array_set(step, true);
+            case OpCode::OP_CALL:
+                return level == 0 && emit_call(step);
+            case OpCode::OP_MOVECALL: {
+                // The argument copy, then the call it was fused with
+                IrRef argument = read(level, b, step.operands[1]);
+                if (level != 0 || argument == IR_NONE) {
+                    return false;
+                }
+                write(level, static_cast<Register>(a + 1), argument);
+                Step call = step;
+                call.instruction =
+                    LuaInstruction::create_abc(OpCode::OP_CALL, a, 2, instruction.C()).raw;
+                return emit_call(call);
+            }
+            case OpCode::OP_RETURN:
+                return level == 1 && emit_return(step);
+            case OpCode::OP_FORLOOP:
+                return level == 0 && step.pc == recorder_.loop_pc_ && emit_loop(step);
+            default:
+                return false;
+        }
+    }
+
+    bool TraceBuilder::emit_arithmetic(const Step& step, IrOp op) {
+        if (!step.operands[1].is_number() || !step.operands[2].is_number()) {
+            return false;
+        }
+
+        LuaInstruction instruction(step.instruction);
+        IrRef left = read(step.level, instruction.B(), step.operands[1]);
+        IrRef right = read(step.level, instruction.C(), step.operands[2]);
+        if (left == IR_NONE || right == IR_NONE) {
+            return false;
+        }
+        write(step.level, instruction.A(), arithmetic(op, left, right));
+        return true;
+    }
+
+    bool TraceBuilder::emit_compare(const Step& step, IrOp op) {
+        const Value& left_value = step.operands[0];
+        const Value& right_value = step.operands[1];
+        bool numbers = left_value.is_number() && right_value.is_number();
+        bool booleans = left_value.is_boolean() && right_value.is_boolean();
+        if (!numbers && !(op == IrOp::GuardEq && booleans)) {
+            return false;
+        }
+
+        LuaInstruction instruction(step.instruction);
+        IrRef left = read(step.level, instruction.A(), left_value);
+        IrRef right = read(step.level, instruction.B(), right_value);
+        if (left == IR_NONE || right == IR_NONE) {
+            return false;
+        }
+
+        bool outcome = false;
+        if (booleans) {
+            outcome = left_value.as_boolean() == right_value.as_boolean();
+        } else if (op == IrOp::GuardEq) {
+            outcome = left_value.as_number() == right_value.as_number();
+        } else if (op == IrOp::GuardLt) {
+            outcome = left_value.as_number() < right_value.as_number();
+        } else {
+            outcome = left_value.as_number() <= right_value.as_number();
+        }
+
+        IrInstruction compare;
+        compare.op = op;
+        compare.a = left;
+        compare.b = right;
+        compare.expected = outcome;
+        compare.snapshot = snapshot(step.level, step.pc);
+        return guard(compare);
+    }
+
+    bool TraceBuilder::emit_array_get(const Step& step, bool immediate_index) {
+        LuaInstruction instruction(step.instruction);
+        const Value& table = step.operands[1];
+        Value key = immediate_index ? Value(static_cast<Number>(instruction.C()))
+                                    : step.operands[2];
+
+        Size slot = recorded_array_slot(table, key);
+        if (slot == 0) {
+            return false;
+        }
+        ValueType element = table.as_table()->getArray(slot).type();
+        if (!is_traceable(element)) {
+            return false;
+        }
+
+        IrRef table_ref = read(step.level, instruction.B(), table);
+        IrRef key_ref = immediate_index ? number_constant(key.as_number())
+                                        : read(step.level, instruction.C(), key);
+        if (table_ref == IR_NONE || key_ref == IR_NONE) {
+            return false;
+        }
+
+        IrInstruction get;
+        get.op = IrOp::ArrayGet;
+        get.type = element;
+        get.a = table_ref;
+        get.b = key_ref;
+        get.snapshot = snapshot(step.level, step.pc);
+        write(step.level, instruction.A(), append(get));
+        return true;
+    }
+
+    bool TraceBuilder::emit_array_set(const Step& step, bool immediate_index) {
+        LuaInstruction instruction(step.instruction);
+        const Value& table = step.operands[0];
+        Value key = immediate_index ? Value(static_cast<Number>(instruction.B()))
+                                    : step.operands[1];
+        const Value& value = step.operands[2];
+
+        if (recorded_array_slot(table, key) == 0 || !is_traceable(value.type())) {
+            return false;
+        }
+
+        IrRef table_ref = read(0, instruction.A(), table);
+        IrRef key_ref = immediate_index ? number_constant(key.as_number())
+                                        : read(0, instruction.B(), key);
+        IrRef value_ref = read(0, instruction.C(), value);
+        if (table_ref == IR_NONE || key_ref == IR_NONE || value_ref == IR_NONE) {
+            return false;
+        }
+
+        IrInstruction set;
+        set.op = IrOp::ArraySet;
+        set.a = table_ref;
+        set.b = key_ref;
+        set.c = value_ref;
+        set.snapshot = snapshot(0, step.pc);
+        append(set);
+        has_store_ = true;
+        return true;
+    }
+
+    bool TraceBuilder::emit_call(const Step& step) {
+        LuaInstruction instruction(step.instruction);
+        Register base = instruction.A();
+        Size argument_count = instruction.B();
+        Size result_count = instruction.C();
+
+        // Fixed argument and result counts only: B = 0 / C = 0 mean "up to top"
+        if (argument_count == 0 || (result_count != 1 && result_count != 2)) {
+            return false;
+        }
+        --argument_count;
+
+        const Value& callee = step.operands[0];
+        if (!callee.is_function()) {
+            return false;
+        }
+        const auto& function = callee.as_function();
+        if (function->isCFunction() || function->isVararg() ||
+            function->parameterCount() > argument_count) {
+            return false;
+        }
+
+        IrRef function_ref = read(0, base, callee);
+        if (function_ref == IR_NONE) {
+            return false;
+        }
+
+        // Guards inside the callee resume the interpreter at the call itself
+        call_snapshot_ = snapshot(0, step.pc);
+
+        IrInstruction identity;
+        identity.op = IrOp::GuardCallee;
+        identity.a = function_ref;
+        identity.object = function.get();
+        identity.expected = true;
+        identity.snapshot = call_snapshot_;
+        append(identity);
+
+        std::fill(callee_slots_.begin(), callee_slots_.end(), IR_NONE);
+        for (Size i = 0; i < function->parameterCount(); ++i) {
+            IrRef argument = slots_[base + 1 + i];
+            if (argument == IR_NONE) {
+                return false;
+            }
+            callee_slots_[i] = argument;
+        }
+
+        in_call_ = true;
+        call_base_ = base;
+        call_results_ = result_count;
+        ++inlined_calls_;
+        return true;
+    }
+
+    bool TraceBuilder::emit_return(const Step& step) {
+        LuaInstruction instruction(step.instruction);
+        Size value_count = instruction.B();
+
+        if (value_count == 2) {
+            if (call_results_ == 2) {
+                IrRef result = callee_slots_[instruction.A()];
+                if (result == IR_NONE) {
+                    return false;
+                }
+                write(0, call_base_, result);
+            }
+        } else if (value_count != 1 || call_results_ != 1) {
+            return false;  // Multiple or missing results
+        }
+
+        in_call_ = false;
+        return true;
+    }
+
+    bool TraceBuilder::emit_loop(const Step& step) {
+        Register a = LuaInstruction(step.instruction).A();
+        for (const auto& value : step.operands) {
+            if (!value.is_number()) {
+                return false;
+            }
+        }
+
+        IrRef index = read(0, a, step.operands[0]);
+        IrRef limit = read(0, static_cast<Register>(a + 1), step.operands[1]);
+        IrRef increment = read(0, static_cast<Register>(a + 2), step.operands[2]);
+        if (index == IR_NONE || limit == IR_NONE || increment == IR_NONE) {
+            return false;
+        }
+
+        // FORLOOP stores the new index before testing it, and the loop variable only when continuing
+        IrRef next = arithmetic(IrOp::Add, index, increment);
+        write(0, a, next);
+
+        IrInstruction test;
+        test.op = IrOp::LoopTest;
+        test.a = next;
+        test.b = limit;
+        test.c = increment;
+        test.snapshot = snapshot(0, recorder_.loop_pc_ + 1);
+        append(test);
+
+        write(0, static_cast<Register>(a + 3), next);
+        return true;
+    }
+
+    bool TraceBuilder::close_loop() {
+        // Slots read before being written carry their value into the next iteration
+        for (Size slot = 0; slot <= max_slot_; ++slot) {
+            if (!written_[slot] || loads_[slot] == IR_NONE || loads_[slot] == slots_[slot]) {
+                continue;
+            }
+            if (type_of(loads_[slot]) != type_of(slots_[slot])) {
+                return false;  // Type changes across iterations
+            }
+            phis_.emplace_back(loads_[slot], slots_[slot]);
+        }
+
+        // Complete every exit with the slots written later in the iteration
+        for (Size i = 1; i < snapshots_.size(); ++i) {
+            auto& entries = snapshots_[i].entries;
+            Size known = entries.size();
+            for (Size slot = 0; slot <= max_slot_; ++slot) {
+                if (!written_[slot]) {
+                    continue;
+                }
+                bool present = false;
+                for (Size j = 0; j < known; ++j) {
+                    if (entries[j].slot == slot) {
+                        present = true;
+                        break;
+                    }
+                }
+                if (present) {
+                    continue;
+                }
+                if (loads_[slot] != IR_NONE) {
+                    entries.push_back(SnapshotEntry{static_cast<Register>(slot), loads_[slot], false});
+                } else {
+                    // Still holds the previous iteration's value
+                    entries.push_back(SnapshotEntry{static_cast<Register>(slot), slots_[slot], true});
+                }
+            }
+        }
+        return true;
+    }
+
+    void TraceBuilder::hoist_invariants() {
+        Size count = ir_.size();
+        std::vector<bool> carried(count, false);
+        for (const auto& [load, value] : phis_) {
+            carried[load] = true;
+        }
+
+        // Loads and constants always run once on entry; pure operations and guards
+        // on loop-invariant operands join them
+        std::vector<bool> header(count, false);
+        std::vector<bool> invariant(count, false);
+        auto operands_invariant = [&](const IrInstruction& instruction) {
+            for (IrRef operand : {instruction.a, instruction.b, instruction.c}) {
+                if (operand != IR_NONE && !invariant[operand]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        for (Size i = 0; i < count; ++i) {
+            auto& instruction = ir_[i];
+            switch (instruction.op) {
+                case IrOp::SLoad:
+                    header[i] = true;
+                    invariant[i] = !carried[i];
+                    break;
+                case IrOp::KNum:
+                case IrOp::KBool:
+                    header[i] = invariant[i] = true;
+                    break;
+                case IrOp::ArraySet:
+                case IrOp::LoopTest:
+                    break;
+                case IrOp::ArrayGet:
+                    header[i] = invariant[i] = !has_store_ && operands_invariant(instruction);
+                    break;
+                default:
+                    header[i] = invariant[i] = operands_invariant(instruction);
+                    break;
+            }
+
+            if (header[i] && !is_constant(instruction) && instruction.op != IrOp::SLoad) {
+                ++hoisted_;
+                if (instruction.is_guard()) {
+                    instruction.snapshot = 0;  // Nothing has been written yet on entry
+                }
+            }
+        }
+
+        std::vector<IrRef> order;
+        order.reserve(count);
+        for (Size i = 0; i < count; ++i) {
+            if (header[i]) {
+                order.push_back(static_cast<IrRef>(i));
+            }
+        }
+        body_start_ = static_cast<IrRef>(order.size());
+        for (Size i = 0; i < count; ++i) {
+            if (!header[i]) {
+                order.push_back(static_cast<IrRef>(i));
+            }
+        }
+
+        std::vector<IrRef> remap(count, IR_NONE);
+        std::vector<IrInstruction> reordered;
+        reordered.reserve(count);
+        for (IrRef old_ref : order) {
+            remap[old_ref] = static_cast<IrRef>(reordered.size());
+            reordered.push_back(ir_[old_ref]);
+        }
+
+        auto rename = [&](IrRef& ref) {
+            if (ref != IR_NONE) {
+                ref = remap[ref];
+            }
+        };
+        for (auto& instruction : reordered) {
+            rename(instruction.a);
+            rename(instruction.b);
+            rename(instruction.c);
+        }
+        for (auto& [load, value] : phis_) {
+            rename(load);
+            rename(value);
+        }
+        for (auto& snapshot : snapshots_) {
+            for (auto& entry : snapshot.entries) {
+                rename(entry.ref);
+            }
+        }
+        ir_ = std::move(reordered);
+    }
+
+    IrRef TraceBuilder::read(Size level, Register reg, const Value& recorded) {
+        if (level == 1) {
+            return callee_slots_[reg];
+        }
+        if (slots_[reg] != IR_NONE) {
+            return slots_[reg];
+        }
+        if (!is_traceable(recorded.type())) {
+            return IR_NONE;
+        }
+
+        IrInstruction load;
+        load.op = IrOp::SLoad;
+        load.type = recorded.type();
+        load.slot = reg;
+        IrRef ref = append(load);
+        slots_[reg] = ref;
+        loads_[reg] = ref;
+        max_slot_ = std::max<Size>(max_slot_, reg);
+        return ref;
+    }
+
+    void TraceBuilder::write(Size level, Register reg, IrRef ref) {
+        if (level == 1) {
+            callee_slots_[reg] = ref;
+            return;
+        }
+        slots_[reg] = ref;
+        written_[reg] = true;
+        max_slot_ = std::max<Size>(max_slot_, reg);
+    }
+
+    IrRef TraceBuilder::append(const IrInstruction& instruction) {
+        ir_.push_back(instruction);
+        return static_cast<IrRef>(ir_.size() - 1);
+    }
+
+    IrRef TraceBuilder::number_constant(Number value) {
+        for (Size i = 0; i < ir_.size(); ++i) {
+            if (ir_[i].op == IrOp::KNum &&
+                std::memcmp(&ir_[i].number, &value, sizeof(Number)) == 0) {
+                return static_cast<IrRef>(i);
+            }
+        }
+        IrInstruction constant;
+        constant.op = IrOp::KNum;
+        constant.number = value;
+        return append(constant);
+    }
+
+    IrRef TraceBuilder::boolean_constant(bool value) {
+        Number encoded = value ? 1 : 0;
+        for (Size i = 0; i < ir_.size(); ++i) {
+            if (ir_[i].op == IrOp::KBool && ir_[i].number == encoded) {
+                return static_cast<IrRef>(i);
+            }
+        }
+        IrInstruction constant;
+        constant.op = IrOp::KBool;
+        constant.type = ValueType::Boolean;
+        constant.number = encoded;
+        return append(constant);
+    }
+
+    IrRef TraceBuilder::arithmetic(IrOp op, IrRef left, IrRef right) {
+        // Division by zero is left to the executor, which mirrors the interpreter's signs
+        if (is_constant(ir_[left]) && is_constant(ir_[right]) &&
+            !(op == IrOp::Div && ir_[right].number == 0)) {
+            Number x = ir_[left].number;
+            Number y = ir_[right].number;
+            ++folded_;
+            switch (op) {
+                case IrOp::Add:
+                    return number_constant(x + y);
+                case IrOp::Sub:
+                    return number_constant(x - y);
+                case IrOp::Mul:
+                    return number_constant(x * y);
+                default:
+                    return number_constant(x / y);
+            }
+        }
+
+        IrInstruction instruction;
+        instruction.op = op;
+        instruction.a = left;
+        instruction.b = right;
+        return append(instruction);
+    }
+
+    bool TraceBuilder::guard(IrInstruction instruction) {
+        // Truthiness of numbers and objects never changes
+        if (instruction.op == IrOp::GuardTruthy && type_of(instruction.a) != ValueType::Boolean) {
+            ++folded_;
+            return instruction.expected;
+        }
+
+        if (is_constant(ir_[instruction.a]) &&
+            (instruction.b == IR_NONE || is_constant(ir_[instruction.b]))) {
+            Number x = ir_[instruction.a].number;
+            Number y = instruction.b == IR_NONE ? 0 : ir_[instruction.b].number;
+            bool outcome = false;
+            switch (instruction.op) {
+                case IrOp::GuardLt:
+                    outcome = x < y;
+                    break;
+                case IrOp::GuardLe:
+                    outcome = x <= y;
+                    break;
+                case IrOp::GuardEq:
+                    outcome = x == y;
+                    break;
+                default:
+                    outcome = x != 0;
+                    break;
+            }
+            ++folded_;
+            return outcome == instruction.expected;
+        }
+
+        append(instruction);
+        return true;
+    }
+
+    std::uint16_t TraceBuilder::snapshot(Size level, Size pc) {
+        if (level == 1) {
+            return call_snapshot_;
+        }
+
+        Snapshot snapshot;
+        snapshot.pc = pc;
+        for (Size slot = 0; slot <= max_slot_; ++slot) {
+            if (written_[slot]) {
+                snapshot.entries.push_back(
+                    SnapshotEntry{static_cast<Register>(slot), slots_[slot], false});
+            }
+        }
+        snapshots_.push_back(std::move(snapshot));
+        return static_cast<std::uint16_t>(snapshots_.size() - 1);
+    }
+
+    std::shared_ptr<const Trace> TraceRecorder::compile() const {
+        return TraceBuilder(*this).build();
+    }
+
+}  // namespace rangelua::runtime::jit
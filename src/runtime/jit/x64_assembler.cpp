@@ -0,0 +1,194 @@
+/**
+ * @file x64_assembler.cpp
+ * @brief Minimal x86-64 machine code emitter implementation
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/jit/x64_assembler.hpp>
+
+#include <cstring>
+
+namespace rangelua::runtime::jit {
+
+    Label X64Assembler::new_label() {
+        labels_.push_back(-1);
+        return Label{labels_.size() - 1};
+    }
+
+    void X64Assembler::bind(Label label) {
+        labels_[label.id] = static_cast<std::int64_t>(code_.size());
+
+        // Resolve pending forward jumps to this label
+        for (const auto& fixup : fixups_) {
+            if (fixup.label == label.id) {
+                auto rel = static_cast<std::int64_t>(code_.size()) -
+                           static_cast<std::int64_t>(fixup.position + 4);
+                patch32(fixup.position, static_cast<std::uint32_t>(static_cast<std::int32_t>(rel)));
+            }
+        }
+    }
+
+    void X64Assembler::push_callee_saved() {
+        emit8(0x53);  // push rbx
+        emit8(0x41);  // push r12
+        emit8(0x54);
+        emit8(0x41);  // push r13
+        emit8(0x55);
+    }
+
+    void X64Assembler::pop_callee_saved_and_return() {
+        emit8(0x41);  // pop r13
+        emit8(0x5D);
+        emit8(0x41);  // pop r12
+        emit8(0x5C);
+        emit8(0x5B);  // pop rbx
+        emit8(0xC3);  // ret
+    }
+
+    void X64Assembler::mov_r12_rdi() {
+        emit8(0x49);
+        emit8(0x89);
+        emit8(0xFC);
+    }
+
+    void X64Assembler::mov_rdi_r12() {
+        emit8(0x4C);
+        emit8(0x89);
+        emit8(0xE7);
+    }
+
+    void X64Assembler::mov_rax_rsi() {
+        emit8(0x48);
+        emit8(0x89);
+        emit8(0xF0);
+    }
+
+    void X64Assembler::mov_rsi_imm64(std::uint64_t value) {
+        emit8(0x48);
+        emit8(0xBE);
+        emit64(value);
+    }
+
+    void X64Assembler::mov_edx_imm32(std::uint32_t value) {
+        emit8(0xBA);
+        emit32(value);
+    }
+
+    void X64Assembler::mov_ecx_imm32(std::uint32_t value) {
+        emit8(0xB9);
+        emit32(value);
+    }
+
+    void X64Assembler::mov_rax_imm64(std::uint64_t value) {
+        emit8(0x48);
+        emit8(0xB8);
+        emit64(value);
+    }
+
+    void X64Assembler::call_rax() {
+        emit8(0xFF);
+        emit8(0xD0);
+    }
+
+    void X64Assembler::test_rax_rax() {
+        emit8(0x48);
+        emit8(0x85);
+        emit8(0xC0);
+    }
+
+    void X64Assembler::cmp_rax_imm32(std::int32_t value) {
+        emit8(0x48);
+        emit8(0x3D);
+        emit32(static_cast<std::uint32_t>(value));
+    }
+
+    void X64Assembler::jmp(Label target) {
+        emit8(0xE9);
+        emit_rel32(target);
+    }
+
+    void X64Assembler::je(Label target) {
+        emit8(0x0F);
+        emit8(0x84);
+        emit_rel32(target);
+    }
+
+    void X64Assembler::jne(Label target) {
+        emit8(0x0F);
+        emit8(0x85);
+        emit_rel32(target);
+    }
+
+    void X64Assembler::js(Label target) {
+        emit8(0x0F);
+        emit8(0x88);
+        emit_rel32(target);
+    }
+
+    void X64Assembler::jae(Label target) {
+        emit8(0x0F);
+        emit8(0x83);
+        emit_rel32(target);
+    }
+
+    void X64Assembler::jmp_table_indexed_by_rax(Label table) {
+        // lea rcx, [rip + table]
+        emit8(0x48);
+        emit8(0x8D);
+        emit8(0x0D);
+        emit_rel32(table);
+        // jmp qword [rcx + rax*8]
+        emit8(0xFF);
+        emit8(0x24);
+        emit8(0xC1);
+    }
+
+    void X64Assembler::emit_address_table(Label table, const std::vector<Label>& entries) {
+        while (code_.size() % 8 != 0) {
+            emit8(0xCC);  // int3 padding
+        }
+        bind(table);
+        for (const auto& entry : entries) {
+            absolute_fixups_.push_back(AbsoluteFixup{code_.size(), entry.id});
+            emit64(0);
+        }
+    }
+
+    void X64Assembler::relocate(std::uint8_t* load_address) const {
+        for (const auto& fixup : absolute_fixups_) {
+            auto address = reinterpret_cast<std::uint64_t>(load_address) +
+                           static_cast<std::uint64_t>(labels_[fixup.label]);
+            std::memcpy(load_address + fixup.position, &address, sizeof(address));
+        }
+    }
+
+    void X64Assembler::emit32(std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            emit8(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void X64Assembler::emit64(std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            emit8(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void X64Assembler::emit_rel32(Label target) {
+        std::int64_t bound = labels_[target.id];
+        if (bound >= 0) {
+            auto rel = bound - static_cast<std::int64_t>(code_.size() + 4);
+            emit32(static_cast<std::uint32_t>(static_cast<std::int32_t>(rel)));
+        } else {
+            fixups_.push_back(Fixup{code_.size(), target.id});
+            emit32(0);
+        }
+    }
+
+    void X64Assembler::patch32(Size position, std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            code_[position + static_cast<Size>(i)] = static_cast<std::uint8_t>(value >> (8 * i));
+        }
+    }
+
+}  // namespace rangelua::runtime::jit
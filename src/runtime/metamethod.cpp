@@ -81,6 +81,9 @@ namespace rangelua::runtime {
 
         VM_LOG_DEBUG("call_metamethod: calling function with {} arguments", args.size());
 
+        // The metamethod may return anything, so no cached load may span this call
+        MutationEpoch::bump();
+
         // Get the function pointer to check if it's a C function or Lua function
         auto function_result = metamethod.to_function();
         if (is_error(function_result)) {
@@ -121,6 +124,7 @@ namespace rangelua::runtime {
         }
 
         VM_LOG_DEBUG("call_metamethod: calling function with {} arguments", args.size());
+        MutationEpoch::bump();
 
         // Use VM context to call the function (handles both C and Lua functions)
         std::vector<Value> results;
@@ -32,6 +32,7 @@ namespace rangelua::runtime {
             }
         } else {
             hashPart_[key] = value;
+            MutationEpoch::bump();
         }
     }
 
@@ -69,6 +70,7 @@ namespace rangelua::runtime {
             }
         } else {
             hashPart_.erase(key);
+            MutationEpoch::bump();
         }
     }
 
@@ -114,6 +116,7 @@ namespace rangelua::runtime {
 
     void Table::setMetatable(GCPtr<Table> metatable) {
         metatable_ = metatable;
+        MutationEpoch::bump();
     }
 
     GCPtr<Table> Table::metatable() const {
@@ -283,6 +286,7 @@ namespace rangelua::runtime {
     }
 
     void Upvalue::setValue(const Value& value) {
+        MutationEpoch::bump();
         if (isOpen_) {
             if (stackLocation_) {
                 *stackLocation_ = value;
@@ -366,6 +370,14 @@ namespace rangelua::runtime {
         isVararg_ = vararg;
     }
 
+    Size Function::stackSize() const noexcept {
+        return stackSize_;
+    }
+
+    void Function::setStackSize(Size size) noexcept {
+        stackSize_ = size;
+    }
+
     bool Function::isCFunction() const noexcept {
         return type_ == Type::C_FUNCTION;
     }
@@ -388,6 +400,12 @@ namespace rangelua::runtime {
         return bytecode_;
     }
 
+    void Function::patchInstruction(Size index, Instruction instruction) noexcept {
+        if (index < bytecode_.size()) {
+            bytecode_[index] = instruction;
+        }
+    }
+
     const std::vector<Size>& Function::lineInfo() const {
         if (!isLuaFunction() && !isClosure()) {
             throw std::runtime_error("Function is not a Lua function or closure");
@@ -395,6 +413,12 @@ namespace rangelua::runtime {
         return line_info_;
     }
 
+    void Function::setBody(std::vector<Instruction> bytecode, std::vector<Size> line_info) {
+        bytecode_ = std::move(bytecode);
+        line_info_ = std::move(line_info);
+        deferred_body_.reset();
+    }
+
     void Function::addConstant(const Value& constant) {
         constants_.push_back(constant);
     }
@@ -525,6 +549,7 @@ namespace rangelua::runtime {
 
     void Userdata::setMetatable(GCPtr<Table> metatable) {
         metatable_ = std::move(metatable);
+        MutationEpoch::bump();
     }
 
     GCPtr<Table> Userdata::metatable() const {
@@ -633,6 +658,7 @@ namespace rangelua::runtime {
         }
 
         status_ = Status::RUNNING;
+        MutationEpoch::bump();
 
         // TODO: Implement actual coroutine execution
         // For now, just return the yielded values
@@ -654,6 +680,7 @@ namespace rangelua::runtime {
 
         yieldedValues_ = values;
         status_ = Status::SUSPENDED;
+        MutationEpoch::bump();
 
         return values;
     }
@@ -19,10 +19,6 @@
 
 namespace rangelua::runtime {
 
-    ValueType Value::type() const noexcept {
-        return static_cast<ValueType>(data_.index());
-    }
-
     Result<Value::Boolean> Value::to_boolean() const noexcept {
         if (is_boolean()) {
             return std::get<Boolean>(data_);
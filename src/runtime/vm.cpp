@@ -229,10 +229,49 @@ Status VirtualMachine::step() {
         return std::monostate{};
     }
 
+    if (frame.compiled) {
+        return run_compiled(frame);
+    }
+
     // Fetch instruction
     Instruction instr = frame.function->instructions[frame.instruction_pointer++];
     OpCode opcode = backend::InstructionEncoder::decode_opcode(instr);
 
+    if (trace_recorder_) [[unlikely]] {
+        record_trace_step(frame, instr);
+    }
+
+    if (config_.count_instructions) [[unlikely]] {
+        auto& counts = instruction_counts_;
+        OpCode generic = instruction_utils::generic_opcode(opcode);
+        ++counts.executed;
+        ++counts.opcodes[static_cast<Size>(generic)];
+        if (counts.previous != OpCode::NUM_OPCODES) {
+            ++counts.pairs[static_cast<Size>(counts.previous) * InstructionCounts::OPCODES +
+                           static_cast<Size>(generic)];
+        }
+        counts.previous = generic;
+    }
+
+    // Numeric for loops are left to the tracer; other back-edges tier the frame up
+    bool traced_loop = opcode == OpCode::OP_FORLOOP && config_.enable_tracing && frame.closure &&
+                       !frame.feedback;
+    Size loop_pc = frame.instruction_pointer - 1;
+    if (!traced_loop &&
+        (opcode == OpCode::OP_FORLOOP || opcode == OpCode::OP_TFORLOOP ||
+         (opcode == OpCode::OP_JMP && backend::InstructionEncoder::decode_sbx(instr) < 0))) {
+        count_backedge(frame);
+    }
+
+    if (frame.feedback) [[unlikely]] {
+        // Counts, types and targets are all sampled, so instructions run only a few
+        // times may be missing; the hot ones the later tiers care about are not
+        if (--feedback_countdown_ == 0) {
+            feedback_countdown_ = std::max<Size>(config_.profiling_sample_interval, 1);
+            record_feedback(frame, instr);
+        }
+    }
+
     VM_LOG_DEBUG("Executing instruction: {} (PC: {})",
                  backend::Disassembler::opcode_name(opcode),
                  frame.instruction_pointer - 1);
@@ -243,6 +282,8 @@ Status VirtualMachine::step() {
     if (std::holds_alternative<ErrorCode>(result)) {
         VM_LOG_ERROR("Instruction execution failed: {}",
                      error_code_to_string(std::get<ErrorCode>(result)));
+    } else if (traced_loop && frame.instruction_pointer != loop_pc + 1) {
+        on_loop_backedge(frame, loop_pc);  // The loop continues
     }
 
     return result;
@@ -400,6 +441,448 @@ void VirtualMachine::set_instruction_pointer(Size ip) noexcept {
     }
 }
 
+FeedbackVector& VirtualMachine::feedback_vector_for(const backend::BytecodeFunction& function,
+                                                    const GCPtr<Function>& closure) {
+    // Prototypes are identified by the chunk run and their index in its prototype table; the
+    // line they start on is only a label, since several prototypes may begin on the same line
+    PrototypeState* prototype = closure ? &closure->prototypeState() : nullptr;
+    if (prototype != nullptr && prototype->feedback != nullptr) {
+        return *prototype->feedback;  // Found on an earlier call
+    }
+
+    String key;
+    String label;
+    if (prototype != nullptr && prototype->chunk != 0) {
+        key = closure->getSource() + "@" + std::to_string(prototype->chunk);
+        if (prototype->index == PrototypeState::npos) {
+            label = function.source_name + ":" + function.name;
+        } else {
+            key += "#" + std::to_string(prototype->index);
+            label = closure->getSource() + ":" +
+                    std::to_string(function.line_info.empty() ? 0 : function.line_info.front());
+        }
+    } else {
+        key = function.source_name + ":" + function.name;
+        label = key;
+    }
+
+    auto it = feedback_.find(key);
+    if (it == feedback_.end()) {
+        it = feedback_.emplace(key, FeedbackVector(label, function.instructions.size())).first;
+    } else if (it->second.slots().size() != function.instructions.size()) {
+        // A different prototype under the same key would mix unrelated slots
+        VM_LOG_WARN("Feedback vector {} does not match its prototype ({} slots, {} instructions)",
+                    key,
+                    it->second.slots().size(),
+                    function.instructions.size());
+        it->second = FeedbackVector(label, function.instructions.size());
+    }
+    if (prototype != nullptr && prototype->chunk != 0) {
+        prototype->feedback = &it->second;
+    }
+    return it->second;
+}
+
+void VirtualMachine::record_feedback(CallFrame& frame, Instruction instruction) {
+    static const Value nil_value;
+
+    // Each sample stands for profiling_sample_interval executed instructions
+    Size weight = std::max<Size>(config_.profiling_sample_interval, 1);
+
+    auto& slot = frame.feedback->slot(frame.instruction_pointer - 1);
+    if (!slot.executed) [[unlikely]] {
+        // Quickening rewrites the opcode in place but never changes its generic form
+        OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+        slot.opcode = instruction_utils::generic_opcode(op);
+        slot.kind = feedback_kind(op);
+        slot.executed = true;
+    }
+    slot.count += weight;
+
+    FeedbackKind kind = slot.kind;
+    if (kind == FeedbackKind::None) {
+        return;
+    }
+
+    // Read registers directly: stack_at() would grow the stack as a side effect
+    auto value_at = [&](Register reg) -> const Value& {
+        Size index = frame.stack_base + reg;
+        return index < stack_.size() ? stack_[index] : nil_value;
+    };
+    auto shape_of = [](const Value& receiver) -> const void* {
+        return receiver.is_table() ? receiver.as_table()->metatable().get() : nullptr;
+    };
+
+    Register a = backend::InstructionEncoder::decode_a(instruction);
+    Register b = backend::InstructionEncoder::decode_b(instruction);
+
+    switch (kind) {
+        case FeedbackKind::BinaryBC:
+            slot.operand_types[0] |= type_bit(value_at(b).type());
+            slot.operand_types[1] |=
+                type_bit(value_at(backend::InstructionEncoder::decode_c(instruction)).type());
+            break;
+        case FeedbackKind::UnaryB:
+            slot.operand_types[0] |= type_bit(value_at(b).type());
+            break;
+        case FeedbackKind::CompareAB:
+            slot.operand_types[0] |= type_bit(value_at(a).type());
+            slot.operand_types[1] |= type_bit(value_at(b).type());
+            break;
+        case FeedbackKind::CompareA:
+            slot.operand_types[0] |= type_bit(value_at(a).type());
+            break;
+        case FeedbackKind::Call: {
+            const Value& callee = value_at(a);
+            slot.operand_types[0] |= type_bit(callee.type());
+            slot.observe_target(callee.is_function() ? callee.as_gc_object() : nullptr);
+            break;
+        }
+        case FeedbackKind::FieldReadB: {
+            const Value& receiver = value_at(b);
+            slot.operand_types[0] |= type_bit(receiver.type());
+            slot.observe_target(shape_of(receiver));
+            break;
+        }
+        case FeedbackKind::FieldWriteA: {
+            const Value& receiver = value_at(a);
+            slot.operand_types[0] |= type_bit(receiver.type());
+            slot.observe_target(shape_of(receiver));
+            break;
+        }
+        case FeedbackKind::Jump:
+            if (backend::InstructionEncoder::decode_sbx(instruction) < 0) {
+                frame.feedback->record_backedge(weight);
+            }
+            break;
+        case FeedbackKind::Loop:
+            // Jumps back on every iteration except the last
+            frame.feedback->record_backedge(weight);
+            break;
+        case FeedbackKind::None:
+            break;
+    }
+}
+
+const jit::CompiledFunction* VirtualMachine::compile_frame(CallFrame& frame) {
+    // Native frames cannot feed the profiler; a frame without a closure has no code owner
+    if (frame.feedback || !frame.closure) {
+        return nullptr;
+    }
+    // Code is shared by every closure of the prototype, and a failure is not retried
+    PrototypeState& prototype = frame.closure->prototypeState();
+    if (prototype.compiled_code) {
+        return prototype.compiled_code.get();
+    }
+    if (prototype.jit_failed) {
+        return nullptr;
+    }
+
+    if (!jit_compiler_) {
+        jit_compiler_ = std::make_unique<jit::BaselineCompiler>(*strategy_registry_);
+    }
+
+    auto compiled = jit_compiler_->compile(*frame.function);
+    if (!compiled) {
+        VM_LOG_WARN("JIT: failed to compile {}, interpreting it from now on",
+                    frame.function->name);
+        prototype.jit_failed = true;
+        return nullptr;
+    }
+
+    prototype.compiled_code = compiled;
+    return compiled.get();
+}
+
+Status VirtualMachine::load_aot_module(const String& path) {
+    auto module = jit::AotModule::load(path);
+    if (is_error(module)) {
+        return get_error(module);
+    }
+    aot_module_ = get_value(std::move(module));
+    VM_LOG_INFO("AOT: loaded {} ({} prototypes)", path, aot_module_->prototype_count());
+    return std::monostate{};
+}
+
+Status VirtualMachine::run_compiled(CallFrame& frame) {
+    jit::JitFrame context;
+    context.vm = this;
+    context.depth = call_stack_.size();
+
+    std::int64_t next =
+        frame.compiled->entry(&context, static_cast<std::int64_t>(frame.instruction_pointer));
+
+    // frame may be gone: helpers return -1 whenever the call stack changed
+    if (context.exception) {
+        std::rethrow_exception(context.exception);
+    }
+    if (next >= 0 && call_stack_.size() == context.depth) {
+        call_stack_.back().instruction_pointer = static_cast<Size>(next);
+    }
+    return context.status;
+}
+
+void VirtualMachine::count_backedge(CallFrame& frame) {
+    // Frames are not tiered up mid-recording: the recorder needs every instruction
+    if (config_.enable_jit && !trace_recorder_ &&
+        ++frame.backedge_counter >= config_.jit_backedge_threshold) {
+        frame.backedge_counter = 0;
+        frame.compiled = compile_frame(frame);
+    }
+}
+
+void VirtualMachine::record_trace_step(CallFrame& frame, Instruction instruction) {
+    Size base = frame.stack_base;
+    Size available = stack_.size() > base ? stack_.size() - base : 0;
+    auto state = trace_recorder_->record(*this,
+                                         call_stack_.size(),
+                                         frame.instruction_pointer - 1,
+                                         instruction,
+                                         available > 0 ? &stack_[base] : nullptr,
+                                         available);
+    if (state == jit::TraceRecorder::State::Recording) {
+        return;
+    }
+
+    Size loop_pc = trace_recorder_->loop_pc();
+    auto& loop = recording_cache_->loops[loop_pc];
+    std::shared_ptr<const jit::Trace> trace;
+    if (state == jit::TraceRecorder::State::Completed) {
+        trace = trace_recorder_->compile();
+    }
+
+    if (trace) {
+        VM_LOG_DEBUG("Trace: recorded loop at PC {}\n{}", loop_pc, trace->to_string());
+        loop.trace = std::move(trace);
+        ++trace_stats_.recorded;
+    } else {
+        VM_LOG_DEBUG("Trace: aborted loop at PC {}", loop_pc);
+        loop.blacklisted = true;
+        ++trace_stats_.aborted;
+    }
+    trace_recorder_.reset();
+    recording_cache_.reset();
+}
+
+void VirtualMachine::on_loop_backedge(CallFrame& frame, Size loop_pc) {
+    auto& cache = frame.closure->traceCache();
+    if (!cache) {
+        cache = std::make_shared<jit::TraceCache>();
+    }
+    auto& loop = cache->loops[loop_pc];
+
+    if (loop.blacklisted) {
+        count_backedge(frame);
+        return;
+    }
+    if (trace_recorder_) {
+        return;  // Traces never run while another loop is being recorded
+    }
+
+    if (!loop.trace) {
+        if (++loop.hits >= config_.trace_hot_threshold) {
+            VM_LOG_DEBUG("Trace: recording loop at PC {}", loop_pc);
+            trace_recorder_ = std::make_unique<jit::TraceRecorder>(frame.function,
+                                                                   call_stack_.size(),
+                                                                   loop_pc,
+                                                                   frame.instruction_pointer,
+                                                                   config_.trace_max_length);
+            recording_cache_ = cache;
+        }
+        return;
+    }
+
+    // Keep the trace alive even if it is discarded below
+    auto trace = loop.trace;
+    Size top = frame.stack_base + trace->max_slot + 1;
+    if (top > config_.stack_size) {
+        loop.trace.reset();
+        loop.blacklisted = true;
+        return;
+    }
+    ensure_stack_size(top);
+    stack_top_ = std::max(stack_top_, top);
+
+    auto exit = jit::execute_trace(*trace, &stack_[frame.stack_base], trace_scratch_);
+    frame.instruction_pointer = exit.pc;
+    ++trace_stats_.entered;
+
+    if (exit.side_exit) {
+        ++trace_stats_.side_exits;
+        if (++loop.side_exits > config_.trace_max_side_exits) {
+            VM_LOG_DEBUG("Trace: discarding loop at PC {} after {} side exits",
+                         loop_pc,
+                         loop.side_exits);
+            loop.trace.reset();
+            loop.blacklisted = true;
+        }
+    }
+}
+
+String VirtualMachine::dump_feedback() const {
+    // Labels can repeat (prototypes starting on one line), so the key breaks ties
+    std::vector<std::pair<const String*, const FeedbackVector*>> vectors;
+    vectors.reserve(feedback_.size());
+    for (const auto& [key, vector] : feedback_) {
+        vectors.emplace_back(&key, &vector);
+    }
+    std::sort(vectors.begin(), vectors.end(), [](const auto& lhs, const auto& rhs) {
+        if (lhs.second->name() != rhs.second->name()) {
+            return lhs.second->name() < rhs.second->name();
+        }
+        return *lhs.first < *rhs.first;
+    });
+
+    String result;
+    for (const auto& [key, vector] : vectors) {
+        result += vector->to_string();
+    }
+    return result;
+}
+
+String VirtualMachine::dump_instruction_counts(Size top) const {
+    const auto& counts = instruction_counts_;
+    constexpr Size opcodes = InstructionCounts::OPCODES;
+
+    // Indices of the nonzero entries of values, most frequent first
+    auto ranked = [top](const std::vector<Size>& values) {
+        std::vector<Size> indices;
+        for (Size i = 0; i < values.size(); ++i) {
+            if (values[i] != 0) {
+                indices.push_back(i);
+            }
+        }
+        std::sort(indices.begin(), indices.end(), [&](Size lhs, Size rhs) {
+            return values[lhs] != values[rhs] ? values[lhs] > values[rhs] : lhs < rhs;
+        });
+        indices.resize(std::min(indices.size(), top));
+        return indices;
+    };
+    auto name = [](Size op) {
+        return String(backend::Disassembler::opcode_name(static_cast<OpCode>(op)));
+    };
+    auto share = [&](Size count) {
+        Size permille = count * 1000 / std::max<Size>(counts.executed, 1);
+        return std::to_string(permille / 10) + "." + std::to_string(permille % 10) + "%";
+    };
+
+    String result = "instructions executed: " + std::to_string(counts.executed) + "\n";
+    result += "top opcodes:\n";
+    for (Size op : ranked(counts.opcodes)) {
+        result += "  " + name(op) + ": " + std::to_string(counts.opcodes[op]) + " (" +
+                  share(counts.opcodes[op]) + ")\n";
+    }
+    result += "top opcode pairs:\n";
+    for (Size pair : ranked(counts.pairs)) {
+        result += "  " + name(pair / opcodes) + " " + name(pair % opcodes) + ": " +
+                  std::to_string(counts.pairs[pair]) + " (" + share(counts.pairs[pair]) + ")\n";
+    }
+    return result;
+}
+
+bool VirtualMachine::patch_current_instruction(Instruction instruction) noexcept {
+    if (call_stack_.empty()) {
+        return false;
+    }
+
+    const bool quickening =
+        instruction_utils::is_quickened(backend::InstructionEncoder::decode_opcode(instruction));
+    if (quickening && !config_.enable_quickening) {
+        return false;
+    }
+
+    auto& frame = call_stack_.back();
+    if (frame.compiled) {
+        return false;  // Native code has the instruction baked in
+    }
+    if (!frame.owned_function || frame.instruction_pointer == 0 ||
+        frame.instruction_pointer > frame.owned_function->instructions.size()) {
+        return false;
+    }
+
+    Size pc = frame.instruction_pointer - 1;
+    frame.owned_function->instructions[pc] = instruction;
+
+    // Keep the closure's code in sync so later activations start out specialized
+    if (frame.closure && frame.closure->isClosure()) {
+        frame.closure->patchInstruction(pc, instruction);
+    }
+
+    if (quickening) {
+        ++quickening_stats_.quickened;
+    } else {
+        ++quickening_stats_.deoptimized;
+        if (frame.closure) {
+            // Each miss doubles the warm-up until the site is left generic
+            auto& sites = frame.closure->prototypeState().quickening_sites;
+            if (pc < sites.size()) {
+                ++sites[pc].deopts;
+            }
+        }
+    }
+    return true;
+}
+
+bool VirtualMachine::observe_quickening(bool matched) {
+    if (call_stack_.empty() || !config_.enable_quickening) {
+        return false;
+    }
+
+    auto& frame = call_stack_.back();
+    if (frame.compiled || !frame.closure || !frame.owned_function ||
+        frame.instruction_pointer == 0) {
+        return false;
+    }
+
+    auto& sites = frame.closure->prototypeState().quickening_sites;
+    Size pc = frame.instruction_pointer - 1;
+    if (pc >= sites.size()) {
+        if (!matched) {
+            return false;  // Nothing to reset yet
+        }
+        sites.resize(frame.owned_function->instructions.size());
+    }
+
+    QuickeningSite& site = sites[pc];
+    if (site.deopts >= config_.quickening_max_deopts) {
+        return false;  // Polymorphic site: stays generic
+    }
+    if (!matched) {
+        site.matches = 0;
+        return false;
+    }
+    if (++site.matches < (config_.quickening_warmup << site.deopts)) {
+        return false;
+    }
+    site.matches = 0;
+    return true;
+}
+
+InvariantSlot& VirtualMachine::invariant_slot(Size index) {
+    auto& slots = call_stack_.back().invariant_slots;
+    if (index >= slots.size()) {
+        slots.resize(index + 1);
+    }
+    return slots[index];
+}
+
+std::shared_ptr<PrototypeState> VirtualMachine::prototype_state(Size index) {
+    CallFrame& frame = call_stack_.back();
+    auto& states = frame.prototype_states;
+    if (index >= states.size()) {
+        states.resize(index + 1);
+    }
+    if (!states[index]) {
+        if (frame.chunk == 0) {
+            frame.chunk = ++chunk_count_;
+        }
+        states[index] = std::make_shared<PrototypeState>();
+        states[index]->chunk = frame.chunk;
+        states[index]->index = index;
+    }
+    return states[index];
+}
+
 void VirtualMachine::adjust_instruction_pointer(std::int32_t offset) noexcept {
     if (!call_stack_.empty()) {
         call_stack_.back().instruction_pointer += offset;
@@ -656,6 +1139,19 @@ Status VirtualMachine::return_from_function(Register return_start, Size result_c
     return std::monostate{};
 }
 
+Value VirtualMachine::constant_to_value(const backend::ConstantValue& constant) {
+    return std::visit(
+        [](const auto& val) -> Value {
+            using T = std::decay_t<decltype(val)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                return Value{};
+            } else {
+                return Value(val);
+            }
+        },
+        constant);
+}
+
 Result<std::vector<Value>> VirtualMachine::call_lua_function(GCPtr<Function> function,
                                                              const std::vector<Value>& args) {
     if (!function) {
@@ -668,6 +1164,21 @@ Result<std::vector<Value>> VirtualMachine::call_lua_function(GCPtr<Function> fun
         return ErrorCode::TYPE_ERROR;
     }
 
+    // A closure over a deferred prototype compiles its body on the first call
+    if (const auto& deferred = function->deferredBody()) {
+        auto compiled = deferred->compile();
+        if (is_error(compiled)) {
+            VM_LOG_ERROR("Failed to compile deferred function body");
+            return get_error(compiled);
+        }
+        const auto& prototype = *get_value(compiled);
+        for (const auto& constant : prototype.constants) {
+            function->addConstant(constant_to_value(constant));
+        }
+        function->setStackSize(prototype.stack_size);
+        function->setBody(prototype.instructions, prototype.line_info);
+    }
+
     try {
         // Save the original stack top before setting up the function call
         // This will be where the return values should be placed
@@ -677,7 +1188,10 @@ Result<std::vector<Value>> VirtualMachine::call_lua_function(GCPtr<Function> fun
         auto bytecode_func = std::make_unique<backend::BytecodeFunction>();
         bytecode_func->name = "lua_function";
         bytecode_func->parameter_count = function->parameterCount();
-        bytecode_func->stack_size = 32;  // Increased stack size for safety
+        // Functions built without a prototype do not know their frame size
+        constexpr Size UNKNOWN_FRAME_SIZE = 32;
+        bytecode_func->stack_size =
+            function->stackSize() > 0 ? function->stackSize() : UNKNOWN_FRAME_SIZE;
         bytecode_func->instructions = function->bytecode();
         bytecode_func->is_vararg = function->isVararg();
         bytecode_func->line_info = function->lineInfo();
@@ -889,7 +1403,7 @@ void VirtualMachine::ensure_stack_size(Size size) {
 }
 
 Status VirtualMachine::setup_call_frame(
-    std::unique_ptr<const backend::BytecodeFunction> function,
+    std::unique_ptr<backend::BytecodeFunction> function,
     GCPtr<Function> closure,
     Size arg_count,
     Size stack_base) {
@@ -941,6 +1455,28 @@ Status VirtualMachine::setup_call_frame(
                     "Created main chunk closure with _ENV upvalue pointing to global table");
             }
             frame.closure = main_closure;
+
+            // Each run of a chunk numbers its prototypes afresh (see prototype_state)
+            frame.chunk = ++chunk_count_;
+            main_closure->prototypeState().chunk = frame.chunk;
+        }
+    }
+
+    if (config_.enable_profiling) {
+        frame.feedback = &feedback_vector_for(*frame.function, frame.closure);
+        frame.feedback->record_invocation();
+    } else if (frame.closure) {
+        if (!frame.closure->compiledCode()) {
+            Size calls = frame.closure->recordCall();
+            if (aot_module_ && calls == 1) {
+                frame.closure->setCompiledCode(aot_module_->find(frame.function->instructions));
+            } else if (config_.enable_jit && !trace_recorder_ &&
+                       calls >= config_.jit_call_threshold) {
+                compile_frame(frame);
+            }
+        }
+        if (!trace_recorder_) {
+            frame.compiled = frame.closure->compiledCode().get();
         }
     }
 
@@ -17,6 +17,7 @@
 #include <rangelua/runtime/vm/upvalue_strategies.hpp>
 #include <rangelua/runtime/vm/global_strategies.hpp>
 #include <rangelua/runtime/vm/misc_strategies.hpp>
+#include <rangelua/runtime/vm/quickened_strategies.hpp>
 
 namespace rangelua::runtime {
 
@@ -51,6 +52,9 @@ namespace rangelua::runtime {
             // Register miscellaneous operations
             MiscStrategyFactory::register_strategies(registry);
 
+            // Register quickened (type-specialized) operations
+            QuickenedStrategyFactory::register_strategies(registry);
+
             VM_LOG_INFO("Successfully registered all instruction strategies");
 
         } catch (const Exception& e) {
@@ -75,10 +79,13 @@ namespace rangelua::runtime {
         VM_LOG_DEBUG("Validating instruction strategy coverage");
 
         Size missing_count = 0;
-        Size total_opcodes = static_cast<Size>(OpCode::NUM_OPCODES);
+        Size total_opcodes = static_cast<Size>(OpCode::NUM_ALL_OPCODES);
 
         for (Size i = 0; i < total_opcodes; ++i) {
             OpCode opcode = static_cast<OpCode>(i);
+            if (opcode == OpCode::NUM_OPCODES) {
+                continue;  // Separator between generic and quickened opcodes
+            }
 
             if (!registry.has_strategy(opcode)) {
                 VM_LOG_WARN("Missing strategy for opcode {} ({})",
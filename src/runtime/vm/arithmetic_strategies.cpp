@@ -8,8 +8,11 @@
 #include <rangelua/runtime/metamethod.hpp>
 #include <rangelua/runtime/value.hpp>
 #include <rangelua/runtime/vm/arithmetic_strategies.hpp>
+#include <rangelua/runtime/vm/quickened_strategies.hpp>
 #include <rangelua/utils/logger.hpp>
 
+#include <functional>
+
 namespace rangelua::runtime {
 
     // Helper function for arithmetic operations
@@ -35,6 +38,8 @@ namespace rangelua::runtime {
 
             Value result;
 
+            quickening::observe_binary(context, instruction, left, right);
+
             // Try direct numeric operation first for performance
             if (left.is_number() && right.is_number()) {
                 // Direct numeric operations
@@ -303,6 +308,39 @@ namespace rangelua::runtime {
         return std::monostate{};
     }
 
+    // Statically typed operations: type inference proved both operands are numbers
+    namespace {
+        template <typename Operation>
+        Status perform_number_operation(IVMContext& context,
+                                        Instruction instruction,
+                                        Operation operation) {
+            Register a = backend::InstructionEncoder::decode_a(instruction);
+            Register b = backend::InstructionEncoder::decode_b(instruction);
+            Register c = backend::InstructionEncoder::decode_c(instruction);
+
+            Number left = context.stack_at(b).as_number();
+            Number right = context.stack_at(c).as_number();
+            context.stack_at(a) = Value(operation(left, right));
+            return std::monostate{};
+        }
+    }  // namespace
+
+    Status AddFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_operation(context, instruction, std::plus<Number>{});
+    }
+
+    Status SubFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_operation(context, instruction, std::minus<Number>{});
+    }
+
+    Status MulFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_operation(context, instruction, std::multiplies<Number>{});
+    }
+
+    Status DivFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_operation(context, instruction, std::divides<Number>{});
+    }
+
     // ArithmeticStrategyFactory implementation
     void ArithmeticStrategyFactory::register_strategies(InstructionStrategyRegistry& registry) {
         VM_LOG_DEBUG("Registering arithmetic operation strategies");
@@ -329,7 +367,13 @@ namespace rangelua::runtime {
         registry.register_strategy(std::make_unique<DivKStrategy>());
         registry.register_strategy(std::make_unique<IDivKStrategy>());
 
-        VM_LOG_DEBUG("Registered {} arithmetic operation strategies", 15);
+        // Statically typed operations
+        registry.register_strategy(std::make_unique<AddFStrategy>());
+        registry.register_strategy(std::make_unique<SubFStrategy>());
+        registry.register_strategy(std::make_unique<MulFStrategy>());
+        registry.register_strategy(std::make_unique<DivFStrategy>());
+
+        VM_LOG_DEBUG("Registered {} arithmetic operation strategies", 19);
     }
 
 }  // namespace rangelua::runtime
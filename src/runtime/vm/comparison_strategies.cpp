@@ -5,10 +5,13 @@
  */
 
 #include <rangelua/runtime/vm/comparison_strategies.hpp>
+#include <rangelua/runtime/vm/quickened_strategies.hpp>
 #include <rangelua/backend/bytecode.hpp>
 #include <rangelua/runtime/value.hpp>
 #include <rangelua/utils/logger.hpp>
 
+#include <functional>
+
 namespace rangelua::runtime {
 
     // EqStrategy implementation
@@ -19,6 +22,7 @@ namespace rangelua::runtime {
 
         const Value& left = context.stack_at(a);
         const Value& right = context.stack_at(b);
+        quickening::observe_binary(context, instruction, left, right);
         bool result = (left == right);
 
         VM_LOG_DEBUG("EQ: if ((R[{}] == R[{}]) ~= {}) then pc++", a, b, k);
@@ -39,6 +43,7 @@ namespace rangelua::runtime {
 
         const Value& left = context.stack_at(a);
         const Value& right = context.stack_at(b);
+        quickening::observe_binary(context, instruction, left, right);
         bool result = (left < right);
 
         VM_LOG_DEBUG("LT: if ((R[{}] < R[{}]) ~= {}) then pc++", a, b, k);
@@ -58,6 +63,7 @@ namespace rangelua::runtime {
 
         const Value& left = context.stack_at(a);
         const Value& right = context.stack_at(b);
+        quickening::observe_binary(context, instruction, left, right);
         bool result = (left <= right);
 
         VM_LOG_DEBUG("LE: if ((R[{}] <= R[{}]) ~= {}) then pc++", a, b, k);
@@ -232,6 +238,84 @@ namespace rangelua::runtime {
         return std::monostate{};
     }
 
+    // Statically typed comparisons: type inference proved both operands are numbers
+    namespace {
+        template <typename Comparison>
+        Status perform_number_comparison(IVMContext& context,
+                                         Instruction instruction,
+                                         Comparison comparison) {
+            Register a = backend::InstructionEncoder::decode_a(instruction);
+            Register b = backend::InstructionEncoder::decode_b(instruction);
+            Register k = backend::InstructionEncoder::decode_c(instruction);
+
+            bool result =
+                comparison(context.stack_at(a).as_number(), context.stack_at(b).as_number());
+            if ((k != 0) == result) {
+                context.adjust_instruction_pointer(1);
+            }
+            return std::monostate{};
+        }
+    }  // namespace
+
+    Status EqFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_comparison(context, instruction, std::equal_to<Number>{});
+    }
+
+    Status LtFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_comparison(context, instruction, std::less<Number>{});
+    }
+
+    Status LeFStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        return perform_number_comparison(context, instruction, std::less_equal<Number>{});
+    }
+
+    // Compare-and-branch superinstructions: numbers are compared directly, anything
+    // else as the generic comparison would
+    namespace {
+        template <typename Comparison>
+        Status perform_compare_jump(IVMContext& context,
+                                    Instruction instruction,
+                                    Comparison comparison) {
+            Register a = backend::InstructionEncoder::decode_a(instruction);
+            Register b = backend::InstructionEncoder::decode_b(instruction);
+            Register c = backend::InstructionEncoder::decode_c(instruction);
+
+            const Value& left = context.stack_at(a);
+            const Value& right = context.stack_at(b);
+            bool result = left.is_number() && right.is_number()
+                              ? comparison(left.as_number(), right.as_number())
+                              : comparison(left, right);
+            if (!result) {
+                context.adjust_instruction_pointer(static_cast<std::int32_t>(c));
+            }
+            return std::monostate{};
+        }
+    }  // namespace
+
+    Status EqJmpStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        VM_LOG_DEBUG("EQJMP: if not (R[{}] == R[{}]) then pc += {}",
+                     backend::InstructionEncoder::decode_a(instruction),
+                     backend::InstructionEncoder::decode_b(instruction),
+                     backend::InstructionEncoder::decode_c(instruction));
+        return perform_compare_jump(context, instruction, std::equal_to<>{});
+    }
+
+    Status LtJmpStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        VM_LOG_DEBUG("LTJMP: if not (R[{}] < R[{}]) then pc += {}",
+                     backend::InstructionEncoder::decode_a(instruction),
+                     backend::InstructionEncoder::decode_b(instruction),
+                     backend::InstructionEncoder::decode_c(instruction));
+        return perform_compare_jump(context, instruction, std::less<>{});
+    }
+
+    Status LeJmpStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        VM_LOG_DEBUG("LEJMP: if not (R[{}] <= R[{}]) then pc += {}",
+                     backend::InstructionEncoder::decode_a(instruction),
+                     backend::InstructionEncoder::decode_b(instruction),
+                     backend::InstructionEncoder::decode_c(instruction));
+        return perform_compare_jump(context, instruction, std::less_equal<>{});
+    }
+
     // ComparisonStrategyFactory implementation
     void ComparisonStrategyFactory::register_strategies(InstructionStrategyRegistry& registry) {
         VM_LOG_DEBUG("Registering comparison operation strategies");
@@ -247,8 +331,14 @@ namespace rangelua::runtime {
         registry.register_strategy(std::make_unique<GeIStrategy>());
         registry.register_strategy(std::make_unique<TestStrategy>());
         registry.register_strategy(std::make_unique<TestSetStrategy>());
-
-        VM_LOG_DEBUG("Registered {} comparison operation strategies", 11);
+        registry.register_strategy(std::make_unique<EqFStrategy>());
+        registry.register_strategy(std::make_unique<LtFStrategy>());
+        registry.register_strategy(std::make_unique<LeFStrategy>());
+        registry.register_strategy(std::make_unique<EqJmpStrategy>());
+        registry.register_strategy(std::make_unique<LtJmpStrategy>());
+        registry.register_strategy(std::make_unique<LeJmpStrategy>());
+
+        VM_LOG_DEBUG("Registered {} comparison operation strategies", 17);
     }
 
 }  // namespace rangelua::runtime
@@ -23,53 +23,111 @@ namespace rangelua::runtime {
         return std::monostate{};
     }
 
-    // CallStrategy implementation
-    Status CallStrategy::execute_impl(IVMContext& context, Instruction instruction) {
-        Register a = backend::InstructionEncoder::decode_a(instruction);
-        Register b = backend::InstructionEncoder::decode_b(instruction);
-        Register c = backend::InstructionEncoder::decode_c(instruction);
+    namespace {
+
+        /**
+         * @brief Call R[A] with B-1 arguments and store C-1 results from R[A], as CALL does
+         */
+        Status call_register(IVMContext& context, Register a, Register b, Register c) {
+            const Value& function = context.stack_at(a);
+
+            if (!function.is_function()) {
+                // Try __call metamethod for non-function values
+                auto metamethod_result =
+                    MetamethodSystem::try_unary_metamethod(function, Metamethod::CALL);
+                if (is_error(metamethod_result)) {
+                    VM_LOG_ERROR("Attempt to call a {} value", function.type_name());
+                    return ErrorCode::TYPE_ERROR;
+                }
 
-        const Value& function = context.stack_at(a);
+                // If __call metamethod exists, use it as the function
+                Value call_metamethod = get_value(metamethod_result);
+                if (!call_metamethod.is_function()) {
+                    VM_LOG_ERROR("__call metamethod is not a function");
+                    return ErrorCode::TYPE_ERROR;
+                }
 
-        VM_LOG_DEBUG("CALL: R[{}], ... ,R[{}] := R[{}](R[{}], ... ,R[{}])",
-                     a, a + c - 2, a, a + 1, a + b - 1);
+                // Prepare arguments with the original value as the first argument
+                std::vector<Value> args;
+                args.push_back(function);  // Add self as first argument
 
-        if (!function.is_function()) {
-            // Try __call metamethod for non-function values
-            auto metamethod_result =
-                MetamethodSystem::try_unary_metamethod(function, Metamethod::CALL);
-            if (is_error(metamethod_result)) {
-                VM_LOG_ERROR("Attempt to call a {} value", function.type_name());
-                return ErrorCode::TYPE_ERROR;
-            }
+                Size arg_count = (b == 0) ? context.stack_size() - a - 1 : b - 1;
+                for (Size i = 0; i < arg_count; ++i) {
+                    args.push_back(context.stack_at(a + 1 + i));
+                }
+
+                // Call the metamethod
+                std::vector<Value> results;
+                auto call_status = context.call_function(call_metamethod, args, results);
+                if (std::holds_alternative<ErrorCode>(call_status)) {
+                    VM_LOG_ERROR("__call metamethod call failed");
+                    return std::get<ErrorCode>(call_status);
+                }
+
+                // Store results
+                Size result_count = (c == 0) ? results.size() : c - 1;
+                VM_LOG_DEBUG("Storing {} results from __call metamethod", result_count);
+
+                for (Size i = 0; i < result_count && i < results.size(); ++i) {
+                    context.stack_at(a + i) = std::move(results[i]);
+                }
+
+                // Fill remaining result slots with nil if needed
+                for (Size i = results.size(); i < result_count; ++i) {
+                    context.stack_at(a + i) = Value{};
+                }
 
-            // If __call metamethod exists, use it as the function
-            Value call_metamethod = get_value(metamethod_result);
-            if (!call_metamethod.is_function()) {
-                VM_LOG_ERROR("__call metamethod is not a function");
-                return ErrorCode::TYPE_ERROR;
+                return std::monostate{};
             }
 
-            // Prepare arguments with the original value as the first argument
+            // Prepare arguments
             std::vector<Value> args;
-            args.push_back(function);  // Add self as first argument
+            Size arg_count;
+
+            if (b == 0) {
+                // B=0 means variable arguments - use all values from stack top
+                Size stack_top = context.stack_size();
+                arg_count = (stack_top > a + 1) ? (stack_top - a - 1) : 0;
+                VM_LOG_DEBUG("B=0: using {} arguments from stack (stack_top={}, call_base={})",
+                             arg_count, stack_top, a);
+            } else {
+                // B-1 is the fixed number of arguments
+                arg_count = b - 1;
+                VM_LOG_DEBUG("B={}: using {} fixed arguments", b, arg_count);
+            }
 
-            Size arg_count = (b == 0) ? context.stack_size() - a - 1 : b - 1;
+            VM_LOG_DEBUG("Preparing {} arguments for function call", arg_count);
             for (Size i = 0; i < arg_count; ++i) {
                 args.push_back(context.stack_at(a + 1 + i));
             }
 
-            // Call the metamethod
+            // Call the function through the VM context
             std::vector<Value> results;
-            auto call_status = context.call_function(call_metamethod, args, results);
+            auto call_status = context.call_function(function, args, results);
             if (std::holds_alternative<ErrorCode>(call_status)) {
-                VM_LOG_ERROR("__call metamethod call failed");
+                VM_LOG_ERROR("Function call failed");
                 return std::get<ErrorCode>(call_status);
             }
 
             // Store results
-            Size result_count = (c == 0) ? results.size() : c - 1;
-            VM_LOG_DEBUG("Storing {} results from __call metamethod", result_count);
+            Size result_count;
+            if (c == 0) {
+                // C=0 means accept all return values (LUA_MULTRET)
+                result_count = results.size();
+                VM_LOG_DEBUG("C=0: accepting all {} return values", result_count);
+
+                // For C=0, we need to adjust the stack top to include all results
+                // This is important for subsequent instructions that might use these values
+                if (auto* vm = dynamic_cast<VirtualMachine*>(&context)) {
+                    // Set stack top to after all results
+                    vm->set_stack_top(a + result_count);
+                    VM_LOG_DEBUG("Set stack top to {} (after {} results)", a + result_count, result_count);
+                }
+            } else {
+                // C-1 is the expected number of return values
+                result_count = c - 1;
+                VM_LOG_DEBUG("C={}: expecting {} return values, got {}", c, result_count, results.size());
+            }
 
             for (Size i = 0; i < result_count && i < results.size(); ++i) {
                 context.stack_at(a + i) = std::move(results[i]);
@@ -83,65 +141,31 @@ namespace rangelua::runtime {
             return std::monostate{};
         }
 
-        // Prepare arguments
-        std::vector<Value> args;
-        Size arg_count;
+    }  // namespace
 
-        if (b == 0) {
-            // B=0 means variable arguments - use all values from stack top
-            Size stack_top = context.stack_size();
-            arg_count = (stack_top > a + 1) ? (stack_top - a - 1) : 0;
-            VM_LOG_DEBUG("B=0: using {} arguments from stack (stack_top={}, call_base={})",
-                         arg_count, stack_top, a);
-        } else {
-            // B-1 is the fixed number of arguments
-            arg_count = b - 1;
-            VM_LOG_DEBUG("B={}: using {} fixed arguments", b, arg_count);
-        }
-
-        VM_LOG_DEBUG("Preparing {} arguments for function call", arg_count);
-        for (Size i = 0; i < arg_count; ++i) {
-            args.push_back(context.stack_at(a + 1 + i));
-        }
+    // CallStrategy implementation
+    Status CallStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
 
-        // Call the function through the VM context
-        std::vector<Value> results;
-        auto call_status = context.call_function(function, args, results);
-        if (std::holds_alternative<ErrorCode>(call_status)) {
-            VM_LOG_ERROR("Function call failed");
-            return std::get<ErrorCode>(call_status);
-        }
+        VM_LOG_DEBUG("CALL: R[{}], ... ,R[{}] := R[{}](R[{}], ... ,R[{}])",
+                     a, a + c - 2, a, a + 1, a + b - 1);
 
-        // Store results
-        Size result_count;
-        if (c == 0) {
-            // C=0 means accept all return values (LUA_MULTRET)
-            result_count = results.size();
-            VM_LOG_DEBUG("C=0: accepting all {} return values", result_count);
-
-            // For C=0, we need to adjust the stack top to include all results
-            // This is important for subsequent instructions that might use these values
-            if (auto* vm = dynamic_cast<VirtualMachine*>(&context)) {
-                // Set stack top to after all results
-                vm->set_stack_top(a + result_count);
-                VM_LOG_DEBUG("Set stack top to {} (after {} results)", a + result_count, result_count);
-            }
-        } else {
-            // C-1 is the expected number of return values
-            result_count = c - 1;
-            VM_LOG_DEBUG("C={}: expecting {} return values, got {}", c, result_count, results.size());
-        }
+        return call_register(context, a, b, c);
+    }
 
-        for (Size i = 0; i < result_count && i < results.size(); ++i) {
-            context.stack_at(a + i) = std::move(results[i]);
-        }
+    // MoveCallStrategy implementation
+    Status MoveCallStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
 
-        // Fill remaining result slots with nil if needed
-        for (Size i = results.size(); i < result_count; ++i) {
-            context.stack_at(a + i) = Value{};
-        }
+        VM_LOG_DEBUG("MOVECALL: R[{}] := R[{}]; R[{}], ... ,R[{}] := R[{}](R[{}])",
+                     a + 1, b, a, a + c - 2, a, a + 1);
 
-        return std::monostate{};
+        context.stack_at(a + 1) = context.stack_at(b);
+        return call_register(context, a, 2, c);
     }
 
     // ReturnStrategy implementation
@@ -168,47 +192,18 @@ namespace rangelua::runtime {
         Register b = backend::InstructionEncoder::decode_b(instruction);
         Register c = backend::InstructionEncoder::decode_c(instruction);
 
-        const Value& function = context.stack_at(a);
-
         VM_LOG_DEBUG("TAILCALL: return R[{}](R[{}], ... ,R[{}])", a, a + 1, a + b - 1);
 
-        if (!function.is_function()) {
-            VM_LOG_ERROR("Attempt to call a {} value", function.type_name());
-            return ErrorCode::TYPE_ERROR;
-        }
-
-        // Prepare arguments
-        std::vector<Value> args;
-        Size arg_count = (b == 0) ? (context.stack_size() - a - 1) : (b - 1);
-
-        args.reserve(arg_count);
-        for (Size i = 0; i < arg_count; ++i) {
-            args.push_back(context.stack_at(a + 1 + i));
-        }
-
-        // For tail call, we replace the current call frame
-        // This is a simplified implementation - proper tail call optimization
-        // would reuse the current stack frame
-        std::vector<Value> results;
-        auto call_result = context.call_function(function, args, results);
-        if (is_error(call_result)) {
-            return call_result;
+        // The current frame is not reused yet: make the call exactly as CALL
+        // would, then return its results as the RETURN that followed it would
+        if (auto status = call_register(context, a, b, c); is_error(status)) {
+            return status;
         }
 
-        // Return all results from the tail call
-        Size result_count = (c == 0) ? results.size() : (c - 1);
-
-        // Move results to the beginning of the current frame
-        for (Size i = 0; i < result_count && i < results.size(); ++i) {
-            context.stack_at(a + i) = std::move(results[i]);
-        }
-
-        // Fill remaining slots with nil if needed
-        for (Size i = results.size(); i < result_count; ++i) {
-            context.stack_at(a + i) = Value{};
+        Size result_count = (c == 0) ? (context.stack_size() - a) : (c - 1);
+        if (auto* vm = dynamic_cast<VirtualMachine*>(&context)) {
+            return vm->return_from_function(a, result_count);
         }
-
-        // Return from current function with the tail call results
         return context.return_from_function(result_count);
     }
 
@@ -559,6 +554,7 @@ namespace rangelua::runtime {
 
         registry.register_strategy(std::make_unique<JmpStrategy>());
         registry.register_strategy(std::make_unique<CallStrategy>());
+        registry.register_strategy(std::make_unique<MoveCallStrategy>());
         registry.register_strategy(std::make_unique<TailCallStrategy>());
         registry.register_strategy(std::make_unique<ReturnStrategy>());
         registry.register_strategy(std::make_unique<Return0Strategy>());
@@ -571,7 +567,7 @@ namespace rangelua::runtime {
         registry.register_strategy(std::make_unique<CloseStrategy>());
         registry.register_strategy(std::make_unique<TbcStrategy>());
 
-        VM_LOG_DEBUG("Registered {} control flow operation strategies", 13);
+        VM_LOG_DEBUG("Registered {} control flow operation strategies", 14);
     }
 
 }  // namespace rangelua::runtime
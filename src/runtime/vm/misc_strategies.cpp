@@ -6,6 +6,7 @@
 
 #include <rangelua/backend/bytecode.hpp>
 #include <rangelua/runtime/metamethod.hpp>
+#include <rangelua/runtime/objects.hpp>
 #include <rangelua/runtime/value.hpp>
 #include <rangelua/runtime/vm.hpp>
 #include <rangelua/runtime/vm/misc_strategies.hpp>
@@ -280,6 +281,56 @@ namespace rangelua::runtime {
         return std::monostate{};
     }
 
+    // HoistClearStrategy implementation - loop preheader of a hoisted loop
+    Status HoistClearStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+
+        VM_LOG_DEBUG("HOISTCLEAR: slots {} .. {}", a, a + b - 1);
+
+        // Registers the cached values were computed from may differ on this entry
+        for (Size slot = a; slot < static_cast<Size>(a) + b; ++slot) {
+            context.invariant_slot(slot).valid = false;
+        }
+        return std::monostate{};
+    }
+
+    // HoistGetStrategy implementation - reuse a cached loop-invariant value
+    Status HoistGetStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        InvariantSlot& slot = context.invariant_slot(b);
+        const std::uint64_t epoch = MutationEpoch::current();
+        if (slot.valid && slot.epoch == epoch) {
+            VM_LOG_DEBUG("HOISTGET: R[{}] := slot {} (skipping {})", a, b, c);
+            context.stack_at(a) = slot.value;
+            context.adjust_instruction_pointer(static_cast<std::int32_t>(c));
+            return std::monostate{};
+        }
+
+        // Miss: the computation runs, and HOISTSET stores it at the epoch it started from
+        VM_LOG_DEBUG("HOISTGET: slot {} is stale", b);
+        slot.pending = epoch;
+        return std::monostate{};
+    }
+
+    // HoistSetStrategy implementation - cache a loop-invariant value
+    Status HoistSetStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+
+        VM_LOG_DEBUG("HOISTSET: slot {} := R[{}]", b, a);
+
+        // A mutation during the computation leaves the stored epoch behind the current one
+        InvariantSlot& slot = context.invariant_slot(b);
+        slot.value = context.stack_at(a);
+        slot.epoch = slot.pending;
+        slot.valid = true;
+        return std::monostate{};
+    }
+
     // MiscStrategyFactory implementation
     void MiscStrategyFactory::register_strategies(InstructionStrategyRegistry& registry) {
         VM_LOG_DEBUG("Registering miscellaneous operation strategies");
@@ -293,8 +344,11 @@ namespace rangelua::runtime {
         registry.register_strategy(std::make_unique<MmbiniStrategy>());
         registry.register_strategy(std::make_unique<MmbinkStrategy>());
         registry.register_strategy(std::make_unique<ExtraArgStrategy>());
+        registry.register_strategy(std::make_unique<HoistClearStrategy>());
+        registry.register_strategy(std::make_unique<HoistGetStrategy>());
+        registry.register_strategy(std::make_unique<HoistSetStrategy>());
 
-        VM_LOG_DEBUG("Registered {} miscellaneous operation strategies", 9);
+        VM_LOG_DEBUG("Registered {} miscellaneous operation strategies", 12);
     }
 
 }  // namespace rangelua::runtime
@@ -0,0 +1,229 @@
+/**
+ * @file quickened_strategies.cpp
+ * @brief Implementation of type-specialized (quickened) instruction strategies
+ * @version 0.1.0
+ */
+
+#include <rangelua/runtime/vm/quickened_strategies.hpp>
+#include <rangelua/backend/bytecode.hpp>
+#include <rangelua/runtime/objects.hpp>
+#include <rangelua/runtime/value.hpp>
+#include <rangelua/utils/logger.hpp>
+
+#include <cmath>
+
+namespace rangelua::runtime {
+
+    namespace {
+
+        /**
+         * @brief Array slot addressed by key, or 0 if the fast path does not apply
+         */
+        Size array_slot(const Value& table, const Value& key) noexcept {
+            if (!table.is_table() || !key.is_number()) {
+                return 0;
+            }
+
+            const auto& t = table.as_table();
+            if (t->metatable()) {
+                return 0;  // __index may intercept lookups
+            }
+
+            Number index = key.as_number();
+            if (index < 1 || index != std::floor(index) ||
+                index > static_cast<Number>(t->arraySize())) {
+                return 0;
+            }
+            return static_cast<Size>(index);
+        }
+
+        void quicken(IVMContext& context, Instruction instruction, OpCode specialized) noexcept {
+            Instruction quickened = LuaInstruction(instruction).with_opcode(specialized).raw;
+            if (context.patch_current_instruction(quickened)) {
+                VM_LOG_DEBUG("Quickened {} at PC {}",
+                             backend::Disassembler::opcode_name(specialized),
+                             context.instruction_pointer() - 1);
+            }
+        }
+
+    }  // namespace
+
+    namespace quickening {
+
+        void observe_binary(IVMContext& context,
+                            Instruction instruction,
+                            const Value& left,
+                            const Value& right) {
+            OpCode op = backend::InstructionEncoder::decode_opcode(instruction);
+            OpCode specialized = instruction_utils::number_specialized_opcode(op);
+            if (specialized == op) {
+                return;
+            }
+            if (context.observe_quickening(left.is_number() && right.is_number())) {
+                quicken(context, instruction, specialized);
+            }
+        }
+
+        void observe_index(IVMContext& context,
+                           Instruction instruction,
+                           const Value& table,
+                           const Value& key) {
+            if (context.observe_quickening(array_slot(table, key) != 0)) {
+                quicken(context, instruction, OpCode::OP_GETTABLE_ARRAY);
+            }
+        }
+
+    }  // namespace quickening
+
+    // AddNumStrategy implementation
+    Status AddNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        const Value& left = context.stack_at(b);
+        const Value& right = context.stack_at(c);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        context.stack_at(a) = Value(left.as_number() + right.as_number());
+        return std::monostate{};
+    }
+
+    // SubNumStrategy implementation
+    Status SubNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        const Value& left = context.stack_at(b);
+        const Value& right = context.stack_at(c);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        context.stack_at(a) = Value(left.as_number() - right.as_number());
+        return std::monostate{};
+    }
+
+    // MulNumStrategy implementation
+    Status MulNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        const Value& left = context.stack_at(b);
+        const Value& right = context.stack_at(c);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        context.stack_at(a) = Value(left.as_number() * right.as_number());
+        return std::monostate{};
+    }
+
+    // DivNumStrategy implementation
+    Status DivNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        const Value& left = context.stack_at(b);
+        const Value& right = context.stack_at(c);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        context.stack_at(a) = Value(left.as_number() / right.as_number());
+        return std::monostate{};
+    }
+
+    // EqNumStrategy implementation
+    Status EqNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+
+        const Value& left = context.stack_at(a);
+        const Value& right = context.stack_at(b);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register k = backend::InstructionEncoder::decode_c(instruction);
+        if ((k != 0) == (left.as_number() == right.as_number())) {
+            context.adjust_instruction_pointer(1);
+        }
+        return std::monostate{};
+    }
+
+    // LtNumStrategy implementation
+    Status LtNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+
+        const Value& left = context.stack_at(a);
+        const Value& right = context.stack_at(b);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register k = backend::InstructionEncoder::decode_c(instruction);
+        if ((k != 0) == (left.as_number() < right.as_number())) {
+            context.adjust_instruction_pointer(1);
+        }
+        return std::monostate{};
+    }
+
+    // LeNumStrategy implementation
+    Status LeNumStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+
+        const Value& left = context.stack_at(a);
+        const Value& right = context.stack_at(b);
+        if (!left.is_number() || !right.is_number()) {
+            return deoptimize(context, instruction);
+        }
+
+        Register k = backend::InstructionEncoder::decode_c(instruction);
+        if ((k != 0) == (left.as_number() <= right.as_number())) {
+            context.adjust_instruction_pointer(1);
+        }
+        return std::monostate{};
+    }
+
+    // GetTableArrayStrategy implementation
+    Status GetTableArrayStrategy::execute_impl(IVMContext& context, Instruction instruction) {
+        Register b = backend::InstructionEncoder::decode_b(instruction);
+        Register c = backend::InstructionEncoder::decode_c(instruction);
+
+        const Value& table = context.stack_at(b);
+        Size slot = array_slot(table, context.stack_at(c));
+        if (slot == 0) {
+            return deoptimize(context, instruction);
+        }
+
+        Register a = backend::InstructionEncoder::decode_a(instruction);
+        Value result = table.as_table()->getArray(slot);
+        context.stack_at(a) = std::move(result);
+        return std::monostate{};
+    }
+
+    // QuickenedStrategyFactory implementation
+    void QuickenedStrategyFactory::register_strategies(InstructionStrategyRegistry& registry) {
+        VM_LOG_DEBUG("Registering quickened instruction strategies");
+
+        registry.register_strategy(std::make_unique<AddNumStrategy>());
+        registry.register_strategy(std::make_unique<SubNumStrategy>());
+        registry.register_strategy(std::make_unique<MulNumStrategy>());
+        registry.register_strategy(std::make_unique<DivNumStrategy>());
+        registry.register_strategy(std::make_unique<EqNumStrategy>());
+        registry.register_strategy(std::make_unique<LtNumStrategy>());
+        registry.register_strategy(std::make_unique<LeNumStrategy>());
+        registry.register_strategy(std::make_unique<GetTableArrayStrategy>());
+
+        VM_LOG_DEBUG("Registered {} quickened instruction strategies", 8);
+    }
+
+}  // namespace rangelua::runtime
@@ -8,6 +8,7 @@
 #include <rangelua/runtime/metamethod.hpp>
 #include <rangelua/runtime/value.hpp>
 #include <rangelua/runtime/vm.hpp>
+#include <rangelua/runtime/vm/quickened_strategies.hpp>
 #include <rangelua/runtime/vm/table_strategies.hpp>
 #include <rangelua/utils/logger.hpp>
 
@@ -47,6 +48,8 @@ namespace rangelua::runtime {
             return std::monostate{};
         }
 
+        quickening::observe_index(context, instruction, table, key);
+
         // Get value from table
         Value result = table.get(key);
 
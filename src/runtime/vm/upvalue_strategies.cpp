@@ -62,9 +62,14 @@ namespace rangelua::runtime {
         auto function = makeGCObject<Function>(prototype.instructions, prototype.line_info, prototype.parameter_count);
         function->setSource(current_function->source_name);  // Inherit source name from parent
         function->makeClosure();  // Mark as closure
+        // Native code and call counts are shared by all closures of the prototype
+        function->setPrototypeState(context.prototype_state(bx));
+        // A deferred body stays uncompiled until the closure is first called
+        function->setDeferredBody(prototype.deferred);
 
-        // Copy vararg flag from prototype
+        // Copy vararg flag and frame size from prototype
         function->setVararg(prototype.is_vararg);
+        function->setStackSize(prototype.stack_size);
 
         // Copy constants from prototype to function
         for (const auto& constant : prototype.constants) {
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <mutex>
 #include <ranges>
 
 namespace rangelua::utils {
@@ -21,6 +22,11 @@ namespace rangelua::utils {
     std::unordered_map<std::string, Logger::LogLevel> Logger::module_levels_;
     bool Logger::initialized_ = false;
 
+    namespace {
+        // Module loggers are created on first use, which may be on a compilation worker thread
+        std::mutex registry_mutex;
+    }  // namespace
+
     void Logger::initialize(const String& name, LogLevel level) {
         if (initialized_) {
             return;
@@ -57,6 +63,7 @@ namespace rangelua::utils {
     }
 
     std::shared_ptr<spdlog::logger> Logger::create_logger(const String& module_name) {
+        std::lock_guard lock(registry_mutex);
         if (!initialized_) {
             initialize();
         }
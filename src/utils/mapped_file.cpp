@@ -0,0 +1,50 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Read-only memory mapping of a whole file
+ * @version 0.1.0
+ */
+
+#include <rangelua/utils/mapped_file.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rangelua::utils {
+
+    MappedFile::MappedFile(const String& path) {
+        // Opening a FIFO would block for, and then use up, its writer; leave it to the caller
+        struct stat info {};
+        if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            return;
+        }
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+            if (info.st_size == 0) {
+                empty_ = true;
+            } else {
+                const auto size = static_cast<Size>(info.st_size);
+                void* address =
+                    ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+                if (address != MAP_FAILED) {
+                    // Sources and chunks are read front to back exactly once
+                    ::madvise(address, size, MADV_SEQUENTIAL);
+                    address_ = address;
+                    size_ = size;
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (address_ != nullptr) {
+            ::munmap(address_, size_);
+        }
+    }
+
+}  // namespace rangelua::utils
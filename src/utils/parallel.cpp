@@ -0,0 +1,66 @@
+/**
+ * @file parallel.cpp
+ * @brief Running independent tasks on a small pool of worker threads
+ * @version 0.1.0
+ */
+
+#include <rangelua/utils/parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rangelua::utils {
+
+    Size resolve_jobs(Size jobs) noexcept {
+        if (jobs != 0) {
+            return jobs;
+        }
+        return std::max<Size>(1, std::thread::hardware_concurrency());
+    }
+
+    void parallel_for(Size count, Size jobs, const std::function<void(Size)>& task) {
+        const Size threads = std::min(resolve_jobs(jobs), count);
+        if (threads <= 1) {
+            for (Size index = 0; index < count; ++index) {
+                task(index);
+            }
+            return;
+        }
+
+        std::atomic<Size> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto work = [&] {
+            for (Size index = next++; index < count; index = next++) {
+                try {
+                    task(index);
+                } catch (...) {
+                    std::lock_guard lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    // Claim the remaining indices so every thread stops
+                    next = count;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (Size i = 1; i < threads; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+}  // namespace rangelua::utils
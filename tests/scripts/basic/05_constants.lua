@@ -0,0 +1,49 @@
+-- Test: <const> locals and constant expressions are evaluated at compile time with Lua semantics
+-- Expected output:
+-- cfg:name 1024 3
+-- 2 -4 1
+-- 0 3 -1 5
+-- a1b true true true false true
+-- 2051
+-- shadow:x
+-- cfg:y t 5
+-- 1
+-- 12
+
+-- Constants initialised from literal expressions
+local PREFIX <const> = "cfg:"
+local SIZE <const> = 2 ^ 10
+local HALF <const> = 7 // 2
+print(PREFIX .. "name", SIZE, HALF)
+
+-- Floor division and modulo round towards minus infinity
+local MOD <const>, DIV <const> = -7 % 3, 7 // -2
+print(MOD, DIV, 7 % -3 + 3)
+
+-- Bitwise operators work on integers and integral floats
+print(1 << 64, 3 | 1.0, ~0, #"hello")
+
+-- Concatenation and comparisons of literals
+print("a" .. 1 .. "b", 1 < 2.5, "a" < "b", 1 == 1.0, nil == false, not nil)
+
+-- Functions use captured constants without upvalues
+local function scaled(x)
+    return x * SIZE + HALF
+end
+print(scaled(2))
+
+-- Inner locals shadow constants
+do
+    local PREFIX = "shadow:"
+    print(PREFIX .. "x")
+end
+print(PREFIX .. "y", true and "t" or "f", nil or 5)
+
+-- A <const> local with a runtime value keeps its register
+local config <const> = {}
+config.level = 1
+print(config.level)
+
+local WIDTH <const> = 3
+local area = WIDTH * 4
+print(area)
@@ -0,0 +1,29 @@
+-- Test: String literals with and without escape sequences
+-- Expected output:
+-- plain	single
+-- tab	and "quotes"
+-- 5
+-- A	B	9
+-- long [[ with ]] brackets
+-- 2
+-- first
+-- second	escaped
+
+local plain, single = "plain", 'single'
+print(plain, single)
+
+-- Escaped strings are decoded; the following tokens must not disturb them
+local escaped = "tab\tand \"quotes\""
+print(escaped)
+print(#"a\nb\\c")
+print("\65", "\x42", #"\z
+      123456789")
+
+local long = [==[long [[ with ]] brackets]==]
+print(long)
+print(#[[
+ab]])
+
+local record = {name = "first", ["other\tkey"] = "second\tescaped"}
+print(record.name)
+print(record["other\tkey"])
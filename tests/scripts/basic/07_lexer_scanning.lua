@@ -0,0 +1,30 @@
+-- Test: Tokens that cross 16- and 32-byte scanning blocks
+-- Expected output:
+-- 42
+-- 12345678901234
+-- 3
+-- a string that is comfortably longer than thirty-two bytes	with a tab
+-- 	
+-- ]] and ]=] do not close this one
+-- false	:29: boom
+
+local an_identifier_that_is_longer_than_thirty_two_bytes_in_total = 42
+print(an_identifier_that_is_longer_than_thirty_two_bytes_in_total)
+
+print(12345678901234)
+
+
+
+      -- a comment after several blank lines and deep indentation, long enough to span blocks
+local x = 1 --[[ a long comment with ] and ]= inside
+that runs over
+several lines ]] + 2
+print(x)
+
+print("a string that is comfortably longer than thirty-two bytes\twith a tab")
+print("\t")
+print([==[]] and ]=] do not close this one]==])
+
+-- Line numbers after long comments and strings must still be right in error messages
+local ok, message = pcall(function() error("boom") end)
+print(ok, string.sub(message, #message - 8))
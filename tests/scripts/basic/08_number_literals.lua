@@ -0,0 +1,29 @@
+-- Test: Decimal and hexadecimal integer and float literals
+-- Expected output:
+-- 255	255	-1	0
+-- true	true	true	true
+-- true	true	true
+-- true	true	true
+-- true	true
+-- 3	true
+
+-- Hexadecimal integers wrap around modulo 2^64
+print(0xff, 0XFF, 0xffffffffffffffff, 0x10000000000000000)
+
+-- Hexadecimal floats, with and without a fraction or exponent
+print(0x1.8p3 == 12, 0x.8 == 0.5, 0xA. == 10, 0x1P-2 == 0.25)
+
+-- Decimal floats in every spelling
+print(5. == 5, .25 == 0.25, 1E+2 == 100)
+
+-- Correct rounding: 2^53 + 1 is not representable, and the decimal and hexadecimal
+-- spellings name the same double
+print(9007199254740993.0 == 9007199254740992.0,
+      0.1 == 0x1.999999999999ap-4,
+      1e23 == 0x1.52d02c7e14af6p+76)
+
+-- Integers too large for 64 bits are read as floats; huge exponents overflow to infinity
+print(9223372036854775808 == 0x1p63, 1e400 == math.huge)
+
+-- The largest integer still fits
+print(0x3, 0x7fffffffffffffff == 9223372036854775807)
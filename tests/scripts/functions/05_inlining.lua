@@ -0,0 +1,74 @@
+-- Test: Calls to small local functions behave the same when inlined
+-- Expected output:
+-- 3	0	4
+-- 2	1
+-- nil	7	nil
+-- nil
+-- 42
+-- 5
+-- 55
+-- hi bob
+-- 101
+-- 3
+-- nil	1
+-- 285
+
+-- Early returns from several places
+local function clamp(x, lo, hi)
+  if x < lo then return lo end
+  if x > hi then return hi end
+  return x
+end
+print(clamp(5, 1, 3), clamp(-2, 0, 9), clamp(4, 0, 9))
+
+-- Several results, and missing arguments
+local function pair(a, b) return b, a end
+local p, q = pair(1, 2)
+print(p, q)
+local r1, r2, r3 = pair(7)
+print(r1, r2, r3)
+
+local function nothing() end
+local z = nothing()
+print(z)
+
+-- A function passed to an inlined helper is inlined in turn
+local function apply(f, v) return f(v) end
+local function double(v) return v * 2 end
+print(apply(double, 21))
+
+-- Self-application stops at the depth limit
+local function self_apply(g, n) return g(g, n) end
+local function count(g, n) if n <= 0 then return 0 end return n end
+print(self_apply(count, 5))
+
+-- Loops and string operations in the body
+local function sum_to(n)
+  local s = 0
+  for i = 1, n do s = s + i end
+  return s
+end
+print(sum_to(10))
+
+local function greet(name) return "hi " .. name end
+print(greet("bob"))
+
+-- Reassigned locals are called, not inlined
+local function g1(v) return v + 1 end
+local h = g1
+h = function(v) return v + 100 end
+print(h(1))
+
+-- Globals read by the body
+local function uses_global(v) return math.abs(v) end
+print(uses_global(-3))
+
+-- Locals declared without a value start as nil
+local function maybe(x) local y; if x then y = 1 end; return y end
+print(maybe(false), maybe(true))
+
+-- Hot call in a loop
+local function sq(x) return x * x end
+local total = 0
+for i = 1, 9 do total = total + sq(i) end
+print(total)
@@ -0,0 +1,60 @@
+-- Test: Function bodies whose text trips a naive block scan compile the same lazily (--lazy)
+-- Expected output:
+-- end ] end end	30
+-- 5	3
+-- 12	nil
+-- 6
+-- 15
+-- unused functions defined
+
+local LIMIT <const> = 10
+
+-- Keywords inside strings, long strings and comments do not close the body
+local function tricky(x)
+  local words = {"end", 'until', [[ ] end ]], [==[ ]] end ]==]}
+  -- end end end
+  --[[ function do
+       end ]]
+  return words[1] .. " " .. string.sub(words[3], 2, 6) .. " " .. string.sub(words[4], 5, 7),
+    x * LIMIT
+end
+local text, scaled = tricky(3)
+print(text, scaled)
+
+-- Nested blocks and brackets of every kind
+function nested(...)
+  local count = #{...}
+  local total = 0
+  for i = 1, count do
+    if i % 2 == 0 then
+      repeat total = total + 1 until true
+    else
+      while false do end
+      do total = total + ({(i)})[1] end
+    end
+  end
+  return total, count
+end
+local total, count = nested(1, 2, 3)
+print(total, count)
+
+-- Anonymous functions and tables of functions
+local ops = {
+  triple = function(x) return x * 3 end,
+  pick = function(t, k) return t[k] end,
+}
+print(ops.triple(4), ops.pick({}, "missing"))
+
+local object = {base = 2}
+object.scale = function(self, n) return self.base * n end
+print(object.scale(object, 3))
+
+-- A body that is never called stays uncompiled in lazy mode
+function never_called()
+  local t = {[1] = {{}}, "}"}
+  return t[1][1]
+end
+
+local sum = function(a, b, c) return a + b + c end
+print(sum(4, 5, 6))
+print("unused functions defined")
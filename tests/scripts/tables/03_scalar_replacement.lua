@@ -0,0 +1,98 @@
+-- Test: Tables that never escape give the same results when kept in registers
+-- Expected output:
+-- 12
+-- 32
+-- 2
+-- nil
+-- 7
+-- 12
+-- 1
+-- 5
+-- 6
+-- 9
+-- 10
+-- true
+-- 0
+-- 11
+-- 2
+-- 8
+
+-- Short-lived tables in a loop
+local s = 0
+for i = 1, 3 do
+  local v = {x = i, y = 2}
+  s = s + v.x + v.y
+end
+print(s)
+
+-- Table built in an inlined helper
+local function len2(a, b)
+  local p = {x = a, y = b}
+  return p.x * p.x + p.y * p.y
+end
+local total = 0
+for i = 1, 3 do
+  local v = {x = i, y = 2}
+  v.x = v.x + 1
+  total = total + v.x + v.y + len2(i, 1)
+end
+print(total)
+
+-- Field updated in place, and a field never set
+local w = {x = 1, y = 2}
+w.x = w.x + 1
+print(w.x)
+print(w.z)
+
+-- Field written on one branch only
+local k = {x = 1}
+for i = 1, 4 do
+  if i % 2 == 0 then k.x = k.x + i end
+end
+print(k.x)
+
+-- String key loaded into a register
+local n = {}
+n["x"] = 12
+print(n.x)
+
+-- Tables that escape stay tables
+local a = {x = 1}
+print(rawget(a, "x"))
+
+local c = {x = 4}
+local c2 = c
+c2.x = 5
+print(c.x)
+
+local d = {}
+setmetatable(d, {__index = {x = 6}})
+print(d.x)
+
+local g = {}
+g[1] = 9
+print(g[1])
+
+local function mk(v) return {x = v} end
+print(mk(10).x)
+
+local h = {x = 1}
+print(h == h)
+
+local l = {x = 1}
+print(#l)
+
+local m = {x = 11}
+local key = "x"
+print(m[key])
+
+local holder = {}
+local b = {x = 2}
+holder.t = b
+local ht = holder.t
+print(ht.x)
+
+local flag = 0
+local e = {x = 7}
+if flag == 0 then e = {x = 8} end
+print(e.x)
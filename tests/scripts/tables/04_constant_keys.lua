@@ -0,0 +1,31 @@
+-- Test: Integer keys outside 0..255, from literals and <const> locals, index the right slot
+-- Expected output:
+-- 300	300	44
+-- 0	44	0
+-- neg	nil	neg
+-- 7	44	7
+-- big	nil
+
+local arr = {}
+for i = 1, 400 do
+  arr[i] = i
+end
+
+local M <const> = 300
+local K <const> = -1
+local SMALL <const> = 44
+
+print(arr[M], arr[300], arr[SMALL])
+arr[M] = 0
+print(arr[M], arr[44], arr[300])
+
+local t = {}
+t[K] = "neg"
+print(t[-1], t[255], t[K])
+
+arr[300] = 7
+print(arr[300], arr[44], arr[M])
+
+local BIG <const> = 1000000
+t[BIG] = "big"
+print(t[1000000], t[BIG % 256])
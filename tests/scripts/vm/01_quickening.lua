@@ -0,0 +1,47 @@
+-- Test: Type-specialized instructions fall back when operand types change
+-- Expected output:
+-- 30
+-- 3
+-- true
+-- false
+-- true
+-- true
+-- 20
+-- nil
+-- 30
+-- 11
+
+local function add(x, y)
+    return x + y
+end
+
+local function less(x, y)
+    return x < y
+end
+
+local function get(t, k)
+    return t[k]
+end
+
+local sum = 0
+for i = 1, 20 do
+    sum = add(sum, 1)
+end
+print(add(sum, 10))
+print(add(1, 2))
+
+print(less(1, 2))
+print(less(2, 1))
+print(less("a", "b"))
+print(less(1.5, 2.5))
+
+local arr = {10, 20, 30}
+for i = 1, 3 do
+    get(arr, i)
+end
+print(get(arr, 2))
+print(get(arr, "x"))
+print(get(arr, 3))
+
+local vec = {__add = function(x, y) return x.v + y.v end}
+print(add(setmetatable({v = 5}, vec), setmetatable({v = 6}, vec)))
@@ -0,0 +1,92 @@
+-- Test: Hot loops and functions give the same results once compiled to native code
+-- Expected output:
+-- 2001000
+-- 1000
+-- 150
+-- 4950
+-- 11325
+-- false
+-- 2525
+
+-- Numeric for loop long enough to be compiled mid-execution
+local sum = 0
+for i = 1, 2000 do
+    sum = sum + i
+end
+print(sum)
+
+-- While loop with a conditional break (backward jumps)
+local n = 0
+while true do
+    n = n + 1
+    if n >= 1000 then
+        break
+    end
+end
+print(n)
+
+-- Function called often enough to be compiled on entry
+local function step(x)
+    if x < 0 then
+        return 0
+    end
+    return x + 1
+end
+
+local calls = 0
+for i = 1, 150 do
+    calls = step(calls)
+end
+print(calls)
+
+-- Compiled function working on tables and comparisons
+local function total(t)
+    local s = 0
+    for i = 1, #t do
+        if t[i] <= 99 then
+            s = s + t[i]
+        end
+    end
+    return s
+end
+
+local values = {}
+for i = 0, 99 do
+    values[#values + 1] = i
+end
+local result = 0
+for i = 1, 120 do
+    result = total(values)
+end
+print(result)
+
+-- Instructions without a native stencil run their interpreter strategy
+local function mix(a, b)
+    return a .. b
+end
+local acc = 0
+for i = 1, 150 do
+    acc = acc + tonumber(mix(i, ""))
+end
+print(acc)
+
+-- Errors raised inside compiled code are still catchable
+local function fail(x)
+    if x > 100 then
+        error("too big")
+    end
+    return x
+end
+local ok = pcall(function()
+    for i = 1, 200 do
+        fail(i)
+    end
+end)
+print(ok)
+
+-- Floating point loop with a fractional step
+local f = 0
+for x = 0.5, 50, 0.5 do
+    f = f + x
+end
+print(f)
@@ -0,0 +1,103 @@
+-- Test: Hot numeric for loops give the same results when run as recorded traces
+-- Expected output:
+-- 1000000
+-- 375750
+-- 376250
+-- 338350
+-- 400
+-- 77
+-- 1717
+-- true
+-- 216225
+-- 3775
+
+-- Pure arithmetic on loop-carried locals
+local s = 0
+for i = 1, 1000 do
+    s = s + i * 2 - 1
+end
+print(s)
+
+-- Array reads and in-place array updates
+local t = {}
+for i = 1, 500 do
+    t[#t + 1] = 0
+end
+for i = 1, 500 do
+    t[i] = i * 3
+end
+local total = 0
+for i = 1, 500 do
+    total = total + t[i]
+end
+print(total)
+for i = 1, 500 do
+    t[i] = t[i] + 1
+end
+total = 0
+for i = 1, 500 do
+    total = total + t[i]
+end
+print(total)
+
+-- Small function inlined into the trace
+local function sq(x)
+    return x * x
+end
+local squares = 0
+for i = 1, 100 do
+    squares = squares + sq(i)
+end
+print(squares)
+
+-- Branch that stops matching the recorded path (side exits)
+local c = 0
+for i = 1, 300 do
+    if i > 200 then
+        c = c + 2
+    else
+        c = c + 1
+    end
+end
+print(c)
+
+-- Values written inside the loop are visible after it
+local last = 0
+for i = 1, 77 do
+    last = i
+end
+print(last)
+local down = 0
+for i = 100, 1, -3 do
+    down = down + i
+end
+print(down)
+
+-- Boolean carried across iterations
+local flag = false
+for i = 1, 101 do
+    flag = not flag
+end
+print(flag)
+
+-- Nested loops
+local grid = 0
+for i = 1, 30 do
+    for j = 1, 30 do
+        grid = grid + i * j
+    end
+end
+print(grid)
+
+-- Guard inside an inlined function
+local function clamp(x)
+    if x > 50 then
+        return 50
+    end
+    return x
+end
+local clamped = 0
+for i = 1, 100 do
+    clamped = clamped + clamp(i)
+end
+print(clamped)
@@ -0,0 +1,86 @@
+-- Test: Loop-invariant loads cached across iterations see every mutation
+-- Expected output:
+-- 302
+-- 31
+-- 20
+-- 10
+-- 96
+-- 15
+-- false
+-- 1.8918
+
+-- Global library replaced in the middle of the loop
+local saved_math = math
+local total = 0
+for i = 1, 6 do
+    total = total + math.floor(i / 2)
+    if i == 3 then
+        math = { floor = function(v) return 100 end }
+    end
+end
+print(total)
+math = saved_math
+
+-- Field of a local table written inside the loop
+local t = { k = 1 }
+local sum = 0
+for i = 1, 5 do
+    sum = sum + t.k
+    t.k = t.k * 2
+end
+print(sum)
+
+-- Metatable installed in the middle of the loop
+local plain = {}
+local seen = 0
+for i = 1, 4 do
+    if plain.x then seen = seen + plain.x end
+    if i == 2 then setmetatable(plain, { __index = { x = 10 } }) end
+end
+print(seen)
+
+-- Global table replaced by a function called from the loop
+cfg = { step = 1 }
+function bump() cfg = { step = cfg.step + 1 } end
+local s2 = 0
+for i = 1, 4 do
+    s2 = s2 + cfg.step
+    bump()
+end
+print(s2)
+
+-- Inner loop re-entered after the outer loop replaces the table
+cfg = { v = 2 }
+local nested = 0
+for j = 1, 3 do
+    for i = 1, 3 do
+        nested = nested + cfg.v
+    end
+    cfg = { v = j * 10 }
+end
+print(nested)
+
+-- While loop with a library lookup in its body
+local s = "hello"
+local k, w = 0, 0
+while k < 3 do
+    w = w + string.len(s)
+    k = k + 1
+end
+print(w)
+
+-- Errors are still raised on the first iteration
+local ok = pcall(function()
+    local missing = nil
+    for i = 1, 3 do
+        local v = missing.field
+    end
+end)
+print(ok)
+
+-- Invariant call target in a hot loop
+local x = 0
+for i = 1, 3 do
+    x = x + math.sin(i)
+end
+print(math.floor(x * 10000) / 10000)
@@ -0,0 +1,83 @@
+-- Test: Arithmetic on values proven to be numbers matches the generic instructions
+-- Expected output:
+-- 385
+-- 2.5
+-- inf
+-- false
+-- true
+-- 4
+-- 6
+-- 11
+-- x1
+-- 7
+-- 30
+
+-- Loop counters and arithmetic on literals
+local squares = 0
+for i = 1, 10 do
+    squares = squares + i * i
+end
+print(squares)
+
+local half = 5 / 2
+print(half)
+
+-- Division by zero and NaN comparisons
+local zero = 0
+local one = 1
+print(one / zero)
+local nan = zero / zero
+print(nan == nan)
+print(one < 2)
+
+-- A loop that never runs keeps its variables
+local count = 4
+for i = 10, 1 do
+    count = count + i
+end
+print(count)
+
+-- Metamethods still apply to tables
+local meta = {__add = function(a, b) return 6 end}
+local v = setmetatable({}, meta)
+print(v + 1)
+
+-- A number on one path and a table on the other
+local mixed = 0
+for i = 1, 4 do
+    if i % 2 == 0 then
+        mixed = mixed + i
+    else
+        mixed = v
+    end
+end
+print(mixed + 5)
+
+-- Values that stop being numbers after a loop
+local name = 0
+for i = 1, 1 do
+    name = name + i
+end
+name = "x" .. name
+print(name)
+
+-- Nested loops with comparisons
+local found = 0
+for i = 1, 5 do
+    for j = 1, 5 do
+        if i * j == 6 and i < j then
+            found = found + i + j
+        end
+    end
+end
+print(found + 2)
+
+local acc = 0
+local k = 0
+while k < 10 do
+    k = k + 1
+    if k <= 4 then
+        acc = acc + k * 3
+    end
+end
+print(acc)
@@ -0,0 +1,86 @@
+-- Test: Fused compare-and-branch and move-and-call instructions match the sequences they replace
+-- Expected output:
+-- 3775
+-- 10
+-- low
+-- mid
+-- high
+-- equal
+-- different
+-- true
+-- false
+-- apple
+-- 6
+-- 12
+-- 4
+
+-- Branches on number comparisons inside a loop
+local total = 0
+for i = 1, 100 do
+    if i <= 50 then
+        total = total + i
+    else
+        total = total + 50
+    end
+end
+print(total)
+
+-- A while loop and a repeat loop (its condition branches backwards)
+local n = 0
+while n < 10 do
+    n = n + 3
+end
+repeat
+    n = n - 2
+until n <= 12
+print(n)
+
+local function classify(x)
+    if x < 10 then
+        return "low"
+    elseif x <= 20 then
+        return "mid"
+    end
+    return "high"
+end
+print(classify(5))
+print(classify(20))
+print(classify(21))
+
+-- Equality of non-numbers still compares references and values
+local t = {}
+local u = t
+if t == u then
+    print("equal")
+end
+if t == {} then
+    print("same")
+else
+    print("different")
+end
+
+-- Comparisons whose result is kept are not fused
+local a, b = 3, 4
+local less = a < b
+local more = a > b
+print(less)
+print(more)
+
+-- Strings compare lexicographically
+local word = "apple"
+if word < "banana" then
+    print(word)
+end
+
+-- Calls with one copied argument
+local function double(x)
+    return x * 2
+end
+local three = 3
+print(double(three))
+local calls = 0
+for i = 1, 4 do
+    calls = calls + double(i) - i
+end
+print(calls + double(1))
+print(#tostring(1000))
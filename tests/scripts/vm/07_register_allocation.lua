@@ -0,0 +1,84 @@
+-- Test: Live-range register allocation keeps live values apart and block operands consecutive
+-- Expected output:
+-- 15
+-- 5 8 13
+-- 30 12
+-- a-b-c-d
+-- 4 10
+-- nil
+-- 6
+-- 55 -54
+-- 20
+-- 7 7
+
+-- Many short-lived temporaries in one statement each
+local x = 1
+local y = x + 2
+local z = (x + y) * (y + 3) - (x * 4)
+local w = (z + x) * 2 + (y - z) * 3 + (x + y + z)
+print(w)
+
+-- Rotations copy through each other's registers
+local a, b, c = 1, 2, 3
+for _ = 1, 3 do
+    a, b, c = b, c, b + c
+end
+print(a, b, c)
+
+-- Calls with several arguments and results
+local function pair(m, n)
+    return m + n, m * n
+end
+local s, t = pair(10, 20)
+local u, v = pair(s - 28, t - 194)
+print(s, v)
+
+-- Concatenation and table constructors read consecutive registers
+local parts = {"a", "b", "c", "d"}
+print(parts[1] .. "-" .. parts[2] .. "-" .. parts[3] .. "-" .. parts[4])
+
+-- Table fields written from temporaries
+local counter = {count = 0}
+counter.count = counter.count + 1
+counter.count = counter.count + 3
+local count = counter.count + 6
+print(#parts, count)
+
+-- A local read before it is assigned is nil
+local unset
+print(unset)
+
+-- Values live across loops and calls keep their registers
+local function sum_to(n)
+    local total = 0
+    for i = 1, n do
+        total = total + i
+    end
+    return total
+end
+local before = sum_to(3)
+print(before)
+local up, down = 0, 0
+for i = 1, 10 do
+    local step = i
+    up = up + step
+    if i > 1 then
+        down = down - step
+    end
+end
+print(up, down)
+
+-- Indexed reads inside a while loop
+local values = {2, 4, 6, 8}
+local acc, index = 0, 1
+while index <= #values do
+    acc = acc + values[index]
+    index = index + 1
+end
+print(acc)
+
+local last = 0
+for key = 1, 7 do
+    last = key
+end
+print(last, sum_to(7) - 21)
@@ -66,6 +66,9 @@ target("rangelua")
     set_rundir("$(projectdir)")
     add_deps("rangelua_core")
     add_files("src/main.cpp")
+    if is_plat("linux", "macosx") then
+        add_syslinks("pthread", "dl") -- compilation workers, AOT module loader
+    end
 
 -- Test runner target
 target("tests")